@@ -324,6 +324,7 @@ void ProgressIndicatorPy::init_type()
     add_varargs_method("start",&ProgressIndicatorPy::start,"start(string,int)");
     add_varargs_method("next",&ProgressIndicatorPy::next,"next()");
     add_varargs_method("stop",&ProgressIndicatorPy::stop,"stop()");
+    add_varargs_method("cancel",&ProgressIndicatorPy::cancel,"cancel()");
 }
 
 PyObject *ProgressIndicatorPy::PyMake(struct _typeobject *, PyObject *, PyObject *)
@@ -380,3 +381,12 @@ Py::Object ProgressIndicatorPy::stop(const Py::Tuple& args)
     _seq.reset();
     return Py::None();
 }
+
+Py::Object ProgressIndicatorPy::cancel(const Py::Tuple& args)
+{
+    if (!PyArg_ParseTuple(args.ptr(), ""))
+        throw Py::Exception();
+    if (_seq.get())
+        SequencerBase::Instance().tryToCancel();
+    return Py::None();
+}
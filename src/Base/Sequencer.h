@@ -115,6 +115,7 @@ class SequencerLauncher;
 class BaseExport SequencerBase
 {
     friend class SequencerLauncher;
+    friend class ProgressIndicatorPy;
 
 public:
     /**
@@ -395,6 +396,7 @@ public:
     Py::Object start(const Py::Tuple&);
     Py::Object next(const Py::Tuple&);
     Py::Object stop(const Py::Tuple&);
+    Py::Object cancel(const Py::Tuple&);
 
 private:
     static PyObject *PyMake(struct _typeobject *, PyObject *, PyObject *);
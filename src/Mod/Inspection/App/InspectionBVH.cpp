@@ -0,0 +1,238 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <numeric>
+#endif
+
+#include "InspectionBVH.h"
+
+using namespace Inspection;
+
+namespace {
+const std::size_t MaxLeafSize = 4;
+const int MaxStackSize = 64;
+}
+
+TriangleBVH::TriangleBVH(const std::vector<Base::Vector3f>& points,
+                         const std::vector<unsigned long>& indices)
+{
+    std::size_t count = indices.size() / 3;
+    std::vector<Triangle> input(count);
+    std::vector<Base::Vector3f> centers(count);
+    for (std::size_t i = 0; i < count; i++) {
+        Triangle& t = input[i];
+        t.v0 = points[indices[3*i]];
+        t.v1 = points[indices[3*i+1]];
+        t.v2 = points[indices[3*i+2]];
+        t.index = static_cast<unsigned long>(i);
+        centers[i] = (t.v0 + t.v1 + t.v2) / 3.0f;
+    }
+
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    nodes.reserve(2 * (count / MaxLeafSize + 1));
+    triangles.reserve(count);
+    if (count > 0)
+        build(input, centers, order, 0, count);
+}
+
+TriangleBVH::~TriangleBVH()
+{
+}
+
+void TriangleBVH::build(const std::vector<Triangle>& input, const std::vector<Base::Vector3f>& centers,
+                        std::vector<std::size_t>& order, std::size_t begin, std::size_t end)
+{
+    Node node;
+    for (int k = 0; k < 3; k++) {
+        node.bmin[k] = FLT_MAX;
+        node.bmax[k] = -FLT_MAX;
+    }
+
+    float cmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float cmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (std::size_t i = begin; i < end; i++) {
+        const Triangle& t = input[order[i]];
+        const Base::Vector3f* v[3] = {&t.v0, &t.v1, &t.v2};
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) {
+                node.bmin[k] = std::min(node.bmin[k], (*v[j])[k]);
+                node.bmax[k] = std::max(node.bmax[k], (*v[j])[k]);
+            }
+        }
+
+        const Base::Vector3f& c = centers[order[i]];
+        for (int k = 0; k < 3; k++) {
+            cmin[k] = std::min(cmin[k], c[k]);
+            cmax[k] = std::max(cmax[k], c[k]);
+        }
+    }
+
+    std::size_t index = nodes.size();
+    nodes.push_back(node);
+
+    if (end - begin <= MaxLeafSize) {
+        nodes[index].offset = static_cast<uint32_t>(triangles.size());
+        nodes[index].count = static_cast<uint32_t>(end - begin);
+        for (std::size_t i = begin; i < end; i++)
+            triangles.push_back(input[order[i]]);
+        return;
+    }
+
+    // split at the median of the triangle centers along the longest axis
+    int axis = 0;
+    for (int k = 1; k < 3; k++) {
+        if (cmax[k] - cmin[k] > cmax[axis] - cmin[axis])
+            axis = k;
+    }
+
+    std::size_t mid = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&centers, axis](std::size_t a, std::size_t b) {
+        return centers[a][axis] < centers[b][axis];
+    });
+
+    // the left child directly follows its parent
+    build(input, centers, order, begin, mid);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    nodes[index].count = 0;
+    build(input, centers, order, mid, end);
+}
+
+float TriangleBVH::sqrDistanceToBox(const Node& node, const Base::Vector3f& p)
+{
+    float dist = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        float d = std::max(std::max(node.bmin[k] - p[k], p[k] - node.bmax[k]), 0.0f);
+        dist += d * d;
+    }
+    return dist;
+}
+
+/**
+ * Computes the point of the triangle closest to \a p by checking the Voronoi
+ * regions of its vertices, edges and its interior.
+ */
+Base::Vector3f TriangleBVH::closestPoint(const Triangle& t, const Base::Vector3f& p)
+{
+    const Base::Vector3f& a = t.v0;
+    const Base::Vector3f& b = t.v1;
+    const Base::Vector3f& c = t.v2;
+    Base::Vector3f ab = b - a;
+    Base::Vector3f ac = c - a;
+
+    Base::Vector3f ap = p - a;
+    float d1 = ab * ap;
+    float d2 = ac * ap;
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+
+    Base::Vector3f bp = p - b;
+    float d3 = ab * bp;
+    float d4 = ac * bp;
+    if (d3 >= 0.0f && d4 <= d3)
+        return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+
+    Base::Vector3f cp = p - c;
+    float d5 = ab * cp;
+    float d6 = ac * cp;
+    if (d6 >= 0.0f && d5 <= d6)
+        return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float sum = va + vb + vc;
+    if (sum <= 0.0f) // degenerated triangle
+        return a;
+    return a + ab * (vb / sum) + ac * (vc / sum);
+}
+
+bool TriangleBVH::nearest(const Base::Vector3f& point, float maxDist, Nearest& result) const
+{
+    if (nodes.empty())
+        return false;
+
+    float best = maxDist < FLT_MAX ? maxDist * maxDist : FLT_MAX;
+    const Triangle* found = nullptr;
+
+    uint32_t stack[MaxStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (sqrDistanceToBox(node, point) >= best)
+            continue;
+
+        if (node.count > 0) {
+            const Triangle* it = &triangles[node.offset];
+            for (uint32_t i = 0; i < node.count; i++, it++) {
+                Base::Vector3f q = closestPoint(*it, point);
+                float dist = Base::DistanceP2(q, point);
+                if (dist < best) {
+                    best = dist;
+                    found = it;
+                    result.point = q;
+                }
+            }
+        }
+        else {
+            // visit the nearer child first
+            uint32_t left = static_cast<uint32_t>(&node - &nodes[0]) + 1;
+            uint32_t right = node.offset;
+            float dl = sqrDistanceToBox(nodes[left], point);
+            float dr = sqrDistanceToBox(nodes[right], point);
+            if (dl > dr) {
+                std::swap(left, right);
+                std::swap(dl, dr);
+            }
+            if (dr < best)
+                stack[top++] = right;
+            if (dl < best)
+                stack[top++] = left;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    result.index = found->index;
+    result.sqrDistance = best;
+    result.normal = (found->v1 - found->v0) % (found->v2 - found->v0);
+    result.normal.Normalize();
+    return true;
+}
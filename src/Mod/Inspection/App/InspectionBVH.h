@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef INSPECTION_BVH_H
+#define INSPECTION_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace Inspection
+{
+
+/**
+ * The TriangleBVH class is a bounding volume hierarchy over a set of triangles
+ * to find the nearest triangle to a point. Once built the structure is read-only
+ * and thus can be queried by several threads at the same time.
+ *
+ * The triangles are copied in the order of the leaves so that a query mainly
+ * works on contiguous memory.
+ */
+class InspectionExport TriangleBVH
+{
+public:
+    /// Result of a nearest triangle query
+    struct Nearest
+    {
+        /// Index of the triangle as passed to the constructor
+        unsigned long index;
+        /// The closest point on the triangle
+        Base::Vector3f point;
+        /// The unit normal of the triangle
+        Base::Vector3f normal;
+        /// The squared distance to the closest point
+        float sqrDistance;
+    };
+
+    /**
+     * Builds the hierarchy. Three consecutive entries of \a indices define a
+     * triangle with the given \a points.
+     */
+    TriangleBVH(const std::vector<Base::Vector3f>& points,
+                const std::vector<unsigned long>& indices);
+    ~TriangleBVH();
+
+    /// Returns the number of triangles
+    std::size_t size() const
+    { return triangles.size(); }
+    /**
+     * Searches for the triangle nearest to \a point. Only triangles with a
+     * distance less than \a maxDist are taken into account. Returns false if
+     * there is no such triangle.
+     */
+    bool nearest(const Base::Vector3f& point, float maxDist, Nearest& result) const;
+
+private:
+    struct Node
+    {
+        float bmin[3];
+        float bmax[3];
+        /// For leaves the first triangle, otherwise the index of the second child
+        uint32_t offset;
+        /// For leaves the number of triangles, zero for inner nodes
+        uint32_t count;
+    };
+    struct Triangle
+    {
+        Base::Vector3f v0, v1, v2;
+        unsigned long index;
+    };
+
+    void build(const std::vector<Triangle>& input, const std::vector<Base::Vector3f>& centers,
+               std::vector<std::size_t>& order, std::size_t begin, std::size_t end);
+    static float sqrDistanceToBox(const Node&, const Base::Vector3f&);
+    static Base::Vector3f closestPoint(const Triangle&, const Base::Vector3f&);
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+};
+
+} // namespace Inspection
+
+
+#endif // INSPECTION_BVH_H
@@ -24,7 +24,9 @@
 #include "PreCompiled.h"
 #include <numeric>
 #include <gp_Pnt.hxx>
+#include <BRepBndLib.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
+#include <Bnd_Box.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepGProp_Face.hxx>
@@ -56,6 +58,7 @@
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
+#include "InspectionBVH.h"
 
 
 using namespace Inspection;
@@ -257,35 +260,39 @@ namespace Inspection {
     };
 }
 
-InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset) : _mesh(rMesh.getKernel())
+InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset)
 {
+    const MeshCore::MeshKernel& kernel = rMesh.getKernel();
     Base::Matrix4D tmp;
-    _clTrf = rMesh.getTransform();
-    _bApply = _clTrf != tmp;
-
-    // Max. limit of grid elements
-    float fMaxGridElements=8000000.0f;
-    Base::BoundBox3f box = _mesh.GetBoundBox().Transformed(rMesh.getTransform());
-
-    // estimate the minimum allowed grid length
-    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
-    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(_mesh).GetAverageEdgeLength();
+    Base::Matrix4D clTrf = rMesh.getTransform();
+    bool bApply = clTrf != tmp;
+
+    std::vector<Base::Vector3f> points;
+    points.reserve(kernel.CountPoints());
+    const MeshCore::MeshPointArray& rPoints = kernel.GetPoints();
+    for (MeshCore::MeshPointArray::_TConstIterator it = rPoints.begin(); it != rPoints.end(); ++it) {
+        if (bApply)
+            points.push_back(clTrf * (*it));
+        else
+            points.push_back(*it);
+    }
 
-    // We want to avoid to get too small grid elements otherwise building up the grid structure would take
-    // too much time and memory. 
-    // Having quite a dense grid speeds up more the following algorithms extremely. Due to the issue above it's
-    // always a compromise between speed and memory usage.
-    fGridLen = std::max<float>(fMinGridLen, fGridLen);
+    std::vector<unsigned long> indices;
+    indices.reserve(3 * kernel.CountFacets());
+    const MeshCore::MeshFacetArray& rFacets = kernel.GetFacets();
+    for (MeshCore::MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        indices.insert(indices.end(), it->_aulPoints, it->_aulPoints + 3);
+    }
 
-    // build up grid structure to speed up algorithms
-    _pGrid = new MeshInspectGrid(_mesh, fGridLen, rMesh.getTransform());
-    _box = box;
+    // build up the hierarchy to speed up the search for the nearest facet
+    _pBVH = new TriangleBVH(points, indices);
+    _box = kernel.GetBoundBox().Transformed(clTrf);
     _box.Enlarge(offset);
 }
 
 InspectNominalMesh::~InspectNominalMesh()
 {
-    delete this->_pGrid;
+    delete this->_pBVH;
 }
 
 float InspectNominalMesh::getDistance(const Base::Vector3f& point) const
@@ -293,30 +300,13 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point) const
     if (!_box.IsInBox(point))
         return FLT_MAX; // must be inside bbox
 
-    std::vector<unsigned long> indices;
-    //_pGrid->GetElements(point, indices);
-    if (indices.empty()) {
-        std::set<unsigned long> inds;
-        _pGrid->MeshGrid::SearchNearestFromPoint(point, inds);
-        indices.insert(indices.begin(), inds.begin(), inds.end());
-    }
+    TriangleBVH::Nearest nearest;
+    if (!_pBVH->nearest(point, FLT_MAX, nearest))
+        return FLT_MAX;
 
-    float fMinDist=FLT_MAX;
-    bool positive = true;
-    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        MeshCore::MeshGeomFacet geomFace = _mesh.GetFacet(*it);
-        if (_bApply) {
-            geomFace.Transform(_clTrf);
-        }
-
-        float fDist = geomFace.DistanceToPoint(point);
-        if (fabs(fDist) < fabs(fMinDist)) {
-            fMinDist = fDist;
-            positive = point.DistanceToPlane(geomFace._aclPoints[0], geomFace.GetNormal()) > 0;
-        }
-    }
-
-    if (!positive)
+    // the sign depends on which side of the facet the point is
+    float fMinDist = std::sqrt(nearest.sqrDistance);
+    if ((point - nearest.point) * nearest.normal <= 0)
         fMinDist = -fMinDist;
     return fMinDist;
 }
@@ -438,9 +428,12 @@ float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
 
 // ----------------------------------------------------------------
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/)
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius)
     : _rShape(shape)
     , isSolid(false)
+    , bvh(0)
+    , radius(radius)
+    , deflection(0)
 {
     distss = new BRepExtrema_DistShapeShape();
     distss->LoadS1(_rShape);
@@ -457,15 +450,65 @@ InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radi
 
     }
     //distss->SetDeflection(radius);
+
+    // The exact distance computation is very expensive. So, use a tessellation
+    // of the shape to quickly skip all points that are clearly outside the
+    // search radius.
+    if (!_rShape.IsNull()) {
+        Bnd_Box bounds;
+        BRepBndLib::Add(_rShape, bounds);
+        bounds.SetGap(0.0);
+        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+        if (!bounds.IsVoid()) {
+            bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            float diagonal = static_cast<float>(gp_Pnt(xMin, yMin, zMin).Distance(gp_Pnt(xMax, yMax, zMax)));
+            deflection = std::max<float>(0.1f * radius, 0.001f * diagonal);
+
+            std::vector<Base::Vector3d> points;
+            std::vector<Data::ComplexGeoData::Facet> facets;
+            Part::TopoShape(_rShape).getFaces(points, facets, deflection);
+
+            std::vector<Base::Vector3f> pointsf;
+            pointsf.reserve(points.size());
+            for (std::vector<Base::Vector3d>::iterator it = points.begin(); it != points.end(); ++it)
+                pointsf.push_back(Base::toVector<float>(*it));
+
+            std::vector<unsigned long> indices;
+            indices.reserve(3 * facets.size());
+            for (std::vector<Data::ComplexGeoData::Facet>::iterator it = facets.begin(); it != facets.end(); ++it) {
+                indices.push_back(it->I1);
+                indices.push_back(it->I2);
+                indices.push_back(it->I3);
+            }
+
+            if (!indices.empty())
+                bvh = new TriangleBVH(pointsf, indices);
+        }
+    }
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
     delete distss;
+    delete bvh;
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 {
+    if (bvh) {
+        // The tessellation deviates at most by the deflection from the shape.
+        // Use twice the value to be on the safe side.
+        TriangleBVH::Nearest nearest;
+        if (bvh->nearest(point, FLT_MAX, nearest)) {
+            float fDist = std::sqrt(nearest.sqrDistance);
+            if (fDist > this->radius + 2.0f * this->deflection) {
+                if ((point - nearest.point) * nearest.normal < 0)
+                    return -FLT_MAX;
+                return FLT_MAX;
+            }
+        }
+    }
+
     gp_Pnt pnt3d(point.x,point.y,point.z);
     BRepBuilderAPI_MakeVertex mkVert(pnt3d);
     distss->LoadS2(mkVert.Vertex());
@@ -872,14 +915,25 @@ App::DocumentObjectExecReturn* Feature::execute(void)
     DistanceInspectionRMS res;
 
     if (useMultithreading) {
-        // Build vector of increasing indices
-        std::vector<unsigned long> index(count);
-        std::iota(index.begin(), index.end(), 0);
+        // Split the points into blocks because the overhead of scheduling
+        // every single point would dominate for fast distance queries
+        const unsigned long blockSize = 4096;
+        std::vector<std::pair<unsigned long, unsigned long> > blocks;
+        for (unsigned long index = 0; index < count; index += blockSize)
+            blocks.push_back(std::make_pair(index, std::min(index + blockSize, count)));
+        std::function<DistanceInspectionRMS(const std::pair<unsigned long, unsigned long>&)> fBlock =
+            [&](const std::pair<unsigned long, unsigned long>& block)
+        {
+            DistanceInspectionRMS res;
+            for (unsigned long index = block.first; index < block.second; index++)
+                res += fMap(index);
+            return res;
+        };
         // Perform map-reduce operation : compute distances and update sum of squares for RMS computation
         QFuture<DistanceInspectionRMS> future = QtConcurrent::mappedReduced(
-            index, fMap, &DistanceInspectionRMS::operator+=);
+            blocks, fBlock, &DistanceInspectionRMS::operator+=);
         // Setup progress bar
-        Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
+        Base::FutureWatcherProgress progress("Inspecting...", blocks.size());
         QFutureWatcher<DistanceInspectionRMS> watcher;
         QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
             &progress, SLOT(progressValueChanged(int)));
@@ -45,6 +45,7 @@ namespace Part   { class TopoShape;  }
 
 namespace Inspection
 {
+class TriangleBVH;
 
 /** Delivers the number of points to be checked and returns the appropriate point to an index. */
 class InspectionExport InspectActualGeometry
@@ -103,6 +104,11 @@ public:
     virtual float getDistance(const Base::Vector3f&) const = 0;
 };
 
+/**
+ * Calculates the signed distance to the nearest facet of a mesh. To find the
+ * nearest facet a bounding volume hierarchy over the transformed facets is used
+ * that can be shared by several threads.
+ */
 class InspectionExport InspectNominalMesh : public InspectNominalGeometry
 {
 public:
@@ -111,11 +117,8 @@ public:
     virtual float getDistance(const Base::Vector3f&) const;
 
 private:
-    const MeshCore::MeshKernel& _mesh;
-    MeshCore::MeshGrid* _pGrid;
+    TriangleBVH* _pBVH;
     Base::BoundBox3f _box;
-    bool _bApply;
-    Base::Matrix4D _clTrf;
 };
 
 class InspectionExport InspectNominalFastMesh : public InspectNominalGeometry
@@ -157,6 +160,10 @@ private:
     BRepExtrema_DistShapeShape* distss;
     const TopoDS_Shape& _rShape;
     bool isSolid;
+    // tessellation to skip points outside the search radius
+    TriangleBVH* bvh;
+    float radius;
+    float deflection;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
@@ -34,8 +34,10 @@
 #ifdef OPTIMIZE_CURVATURE
 #include <Eigen/Eigenvalues>
 #else
+#include <Mod/Mesh/App/WildMagic4/Wm4Vector2.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
-#include <Mod/Mesh/App/WildMagic4/Wm4MeshCurvature.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix2.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #endif
 
 #include "Curvature.h"
@@ -44,6 +46,8 @@
 #include "MeshKernel.h"
 #include "Iterator.h"
 #include "Tools.h"
+#include "Functional.h"
+#include "PointArrays.h"
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
 
@@ -293,47 +297,125 @@ void MeshCurvature::ComputePerVertex()
 {
     myCurvature.clear();
 
-    // get all points
-    std::vector< Wm4::Vector3<double> > aPnts;
-    aPnts.reserve(myKernel.CountPoints());
-    MeshPointIterator cPIt(myKernel);
-    for (cPIt.Init(); cPIt.More(); cPIt.Next()) {
-        Wm4::Vector3<double> cP(cPIt->x, cPIt->y, cPIt->z);
-        aPnts.push_back(cP);
-    }
-
-    // get all point connections
-    std::vector<int> aIdx;
-    aIdx.reserve(3*myKernel.CountFacets());
-    const MeshFacetArray& raFts = myKernel.GetFacets();
-    for (MeshFacetArray::const_iterator jt = raFts.begin(); jt != raFts.end(); ++jt) {
-        for (int i=0; i<3; i++) {
-            aIdx.push_back((int)jt->_aulPoints[i]);
-        }
-    }
-
     // in case of an empty mesh no curvature can be calculated
     if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
         return;
 
-    // compute vertex based curvatures
-    Wm4::MeshCurvature<double> meshCurv(myKernel.CountPoints(), &(aPnts[0]), myKernel.CountFacets(), &(aIdx[0]));
+    // This does the same as Wm4::MeshCurvature but instead of scattering the
+    // contribution of each facet to its corner points every point gathers the
+    // data of its adjacent facets. As the facets are always visited in the
+    // same order the result doesn't depend on the number of threads and the
+    // points can be processed independently from each other.
+    const MeshPointArray& rPoints = myKernel.GetPoints();
+    const MeshFacetArray& rFacets = myKernel.GetFacets();
+    MeshCompactPointToFacets pt2f(myKernel);
+    std::size_t numPoints = rPoints.size();
+
+    MeshPointSoA<double> aPnts(rPoints);
+    auto vertex = [&aPnts](unsigned long i) {
+        return Wm4::Vector3<double>(aPnts.x[i], aPnts.y[i], aPnts.z[i]);
+    };
+
+    // compute normal vectors (the length of the cross product provides a weighted sum)
+    std::vector< Wm4::Vector3<double> > aNormals(numPoints);
+    parallel_for(numPoints, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            Wm4::Vector3<double> kSum(0.0, 0.0, 0.0);
+            for (std::size_t pos = pt2f.Begin(i); pos != pt2f.End(i); ++pos) {
+                const unsigned long* aiV = rFacets[pt2f.Facet(pos)]._aulPoints;
+                Wm4::Vector3<double> kV0 = vertex(aiV[0]);
+                Wm4::Vector3<double> kEdge1 = vertex(aiV[1]) - kV0;
+                Wm4::Vector3<double> kEdge2 = vertex(aiV[2]) - kV0;
+                kSum += kEdge1.Cross(kEdge2);
+            }
+            kSum.Normalize();
+            aNormals[i] = kSum;
+        }
+    });
+
+    myCurvature.resize(numPoints);
+    parallel_for(numPoints, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const Wm4::Vector3<double>& kN = aNormals[i];
+            Wm4::Vector3<double> kV0 = vertex(i);
+            Wm4::Matrix3<double> kWWTrn(true);
+            Wm4::Matrix3<double> kDWTrn(true);
+
+            // Compute the edges from V0 to the other two corners of the facet,
+            // project them to tangent plane of vertex, and compute difference
+            // of adjacent normals.
+            for (std::size_t pos = pt2f.Begin(i); pos != pt2f.End(i); ++pos) {
+                const unsigned long* aiV = rFacets[pt2f.Facet(pos)]._aulPoints;
+                int j = pt2f.Corner(pos);
+                unsigned long aiN[2] = {aiV[(j+1)%3], aiV[(j+2)%3]};
+                for (int k = 0; k < 2; k++) {
+                    Wm4::Vector3<double> kE = vertex(aiN[k]) - kV0;
+                    Wm4::Vector3<double> kW = kE - (kE.Dot(kN))*kN;
+                    Wm4::Vector3<double> kD = aNormals[aiN[k]] - kN;
+                    for (int iRow = 0; iRow < 3; iRow++) {
+                        for (int iCol = 0; iCol < 3; iCol++) {
+                            kWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+                            kDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+                        }
+                    }
+                }
+            }
+
+            // Add in N*N^T to W*W^T for numerical stability and compute the
+            // matrix of normal derivatives.
+            for (int iRow = 0; iRow < 3; iRow++) {
+                for (int iCol = 0; iCol < 3; iCol++) {
+                    kWWTrn[iRow][iCol] = 0.5*kWWTrn[iRow][iCol] + kN[iRow]*kN[iCol];
+                    kDWTrn[iRow][iCol] *= 0.5;
+                }
+            }
+
+            Wm4::Matrix3<double> kDNormal = kDWTrn*kWWTrn.Inverse();
+
+            // compute U and V given N
+            Wm4::Vector3<double> kU, kV;
+            Wm4::Vector3<double>::GenerateComplementBasis(kU, kV, kN);
+
+            // Compute S = J^T * dN/dX * J with J = [U | V] and make sure that
+            // S is symmetric.
+            double fS01 = kU.Dot(kDNormal*kV);
+            double fS10 = kV.Dot(kDNormal*kU);
+            double fSAvr = 0.5*(fS01+fS10);
+            Wm4::Matrix2<double> kS(kU.Dot(kDNormal*kU), fSAvr,
+                                    fSAvr, kV.Dot(kDNormal*kV));
+
+            // compute the eigenvalues of S (min and max curvatures)
+            double fTrace = kS[0][0] + kS[1][1];
+            double fDet = kS[0][0]*kS[1][1] - kS[0][1]*kS[1][0];
+            double fDiscr = fTrace*fTrace - 4.0*fDet;
+            double fRootDiscr = Wm4::Math<double>::Sqrt(Wm4::Math<double>::FAbs(fDiscr));
+            double fMinCurv = 0.5*(fTrace - fRootDiscr);
+            double fMaxCurv = 0.5*(fTrace + fRootDiscr);
+
+            // compute the eigenvectors of S
+            auto direction = [&kS, &kU, &kV](double fCurv) {
+                Wm4::Vector2<double> kW0(kS[0][1], fCurv-kS[0][0]);
+                Wm4::Vector2<double> kW1(fCurv-kS[1][1], kS[1][0]);
+                if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                    kW0.Normalize();
+                    return Wm4::Vector3<double>(kW0.X()*kU + kW0.Y()*kV);
+                }
+                else {
+                    kW1.Normalize();
+                    return Wm4::Vector3<double>(kW1.X()*kU + kW1.Y()*kV);
+                }
+            };
 
-    // get curvature information now
-    const Wm4::Vector3<double>* aMaxCurvDir = meshCurv.GetMaxDirections();
-    const Wm4::Vector3<double>* aMinCurvDir = meshCurv.GetMinDirections();
-    const double* aMaxCurv = meshCurv.GetMaxCurvatures();
-    const double* aMinCurv = meshCurv.GetMinCurvatures();
+            Wm4::Vector3<double> kMinDir = direction(fMinCurv);
+            Wm4::Vector3<double> kMaxDir = direction(fMaxCurv);
 
-    myCurvature.reserve(myKernel.CountPoints());
-    for (unsigned long i=0; i<myKernel.CountPoints(); i++) {
-        CurvatureInfo ci;
-        ci.cMaxCurvDir = Base::Vector3f((float)aMaxCurvDir[i].X(), (float)aMaxCurvDir[i].Y(), (float)aMaxCurvDir[i].Z());
-        ci.cMinCurvDir = Base::Vector3f((float)aMinCurvDir[i].X(), (float)aMinCurvDir[i].Y(), (float)aMinCurvDir[i].Z());
-        ci.fMaxCurvature = (float)aMaxCurv[i];
-        ci.fMinCurvature = (float)aMinCurv[i];
-        myCurvature.push_back(ci);
-    }
+            CurvatureInfo& ci = myCurvature[i];
+            ci.cMaxCurvDir = Base::Vector3f((float)kMaxDir.X(), (float)kMaxDir.Y(), (float)kMaxDir.Z());
+            ci.cMinCurvDir = Base::Vector3f((float)kMinDir.X(), (float)kMinDir.Y(), (float)kMinDir.Z());
+            ci.fMaxCurvature = (float)fMaxCurv;
+            ci.fMinCurvature = (float)fMinCurv;
+        }
+    });
 }
 #endif // OPTIMIZE_CURVATURE
 
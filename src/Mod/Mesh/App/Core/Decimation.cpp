@@ -23,41 +23,103 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <climits>
+# include <thread>
 #endif
 
+#include <QtConcurrentMap>
+#include <QFuture>
+#include <QThread>
+
 #include "Decimation.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Iterator.h"
 #include "TopoAlgorithm.h"
+#include <Base/Sequencer.h>
 #include <Base/Tools.h>
 #include "Simplify.h"
 
 
 using namespace MeshCore;
 
-MeshSimplify::MeshSimplify(MeshKernel& mesh)
-  : myKernel(mesh)
-{
-}
+namespace MeshCore {
 
-MeshSimplify::~MeshSimplify()
+/*!
+  The SimplifyProgress class maps the number of removed facets to the steps
+  of a sequencer. It must only be used from the main thread.
+ */
+class SimplifyProgress
 {
-}
+public:
+    SimplifyProgress(Base::SequencerLauncher& seq, std::size_t toRemove)
+      : seq(seq), toRemove(toRemove), offset(0), steps(0)
+    {
+    }
+    /// Sets the number of facets removed by a previous step
+    void setOffset(std::size_t num)
+    {
+        offset = num;
+    }
+    void update(std::size_t removed)
+    {
+        removed += offset;
+        std::size_t percent = 100;
+        if (toRemove > 0)
+            percent = std::min<std::size_t>(100, (removed * 100) / toRemove);
+        while (steps < percent) {
+            steps++;
+            seq.next(true); // allow to cancel
+        }
 
-void MeshSimplify::simplify(float tolerance, float reduction)
+        // a nested launcher doesn't forward the steps to the sequencer
+        if (seq.wasCanceled())
+            throw Base::AbortException("Simplification aborted");
+    }
+
+private:
+    Base::SequencerLauncher& seq;
+    std::size_t toRemove;
+    std::size_t offset;
+    std::size_t steps;
+};
+
+/*!
+  A spatially coherent part of the mesh that is simplified by its own thread.
+ */
+struct SimplifyPartition
 {
+    std::vector<unsigned long> facets;
     Simplify alg;
+    int target;
+};
 
-    const MeshPointArray& points = myKernel.GetPoints();
+}
+
+namespace {
+
+// A minimum number of facets per partition, for smaller meshes the parallel
+// mode doesn't pay off
+const std::size_t MinFacetsPerPartition = 10000;
+
+void setupSimplify(Simplify& alg, const MeshKernel& kernel)
+{
+    const MeshPointArray& points = kernel.GetPoints();
+    alg.vertices.reserve(points.size());
     for (std::size_t i = 0; i < points.size(); i++) {
         Simplify::Vertex v;
         v.tstart = 0;
         v.p = points[i];
+        v.locked = 0;
+        v.id = static_cast<int>(i);
         alg.vertices.push_back(v);
     }
 
-    const MeshFacetArray& facets = myKernel.GetFacets();
+    const MeshFacetArray& facets = kernel.GetFacets();
+    alg.triangles.reserve(facets.size());
     for (std::size_t i = 0; i < facets.size(); i++) {
         Simplify::Triangle t;
         for (int j = 0; j < 4; j++)
@@ -66,11 +128,120 @@ void MeshSimplify::simplify(float tolerance, float reduction)
             t.v[j] = facets[i]._aulPoints[j];
         alg.triangles.push_back(t);
     }
+}
+
+/*
+ * Splits the facets recursively at the median of their centers along the
+ * longest side of the bounding box. This gives partitions of (almost) equal
+ * size with a short border.
+ */
+void splitFacets(std::vector<unsigned long>::iterator begin,
+                 std::vector<unsigned long>::iterator end,
+                 const std::vector<Base::Vector3f>& centers, int parts,
+                 std::vector<std::vector<unsigned long> >& result)
+{
+    if (parts < 2 || end - begin < 2) {
+        result.push_back(std::vector<unsigned long>(begin, end));
+        return;
+    }
+
+    Base::BoundBox3f box;
+    for (std::vector<unsigned long>::iterator it = begin; it != end; ++it)
+        box.Add(centers[*it]);
+
+    int axis = 0;
+    if (box.LengthY() > box.LengthX() && box.LengthY() >= box.LengthZ())
+        axis = 1;
+    else if (box.LengthZ() > box.LengthX() && box.LengthZ() > box.LengthY())
+        axis = 2;
+
+    int left = parts / 2;
+    std::vector<unsigned long>::iterator mid = begin + ((end - begin) * left) / parts;
+    std::nth_element(begin, mid, end, [&centers, axis](unsigned long a, unsigned long b) {
+        return centers[a][axis] < centers[b][axis];
+    });
+
+    splitFacets(begin, mid, centers, left, result);
+    splitFacets(mid, end, centers, parts - left, result);
+}
+
+}
+
+MeshSimplify::MeshSimplify(MeshKernel& mesh)
+  : myKernel(mesh), parallel(false)
+{
+}
+
+MeshSimplify::~MeshSimplify()
+{
+}
+
+void MeshSimplify::setParallel(bool on)
+{
+    parallel = on;
+}
+
+void MeshSimplify::simplify(float tolerance, float reduction)
+{
+    std::size_t numFacets = myKernel.CountFacets();
+    int target_count = static_cast<int>(static_cast<float>(numFacets) * (1.0f-reduction));
+    simplifyToTarget(target_count, tolerance);
+}
+
+void MeshSimplify::simplify(int targetSize)
+{
+    simplifyToTarget(targetSize, FLT_MAX);
+}
+
+void MeshSimplify::simplifyToTarget(int targetSize, double tolerance)
+{
+    std::size_t numFacets = myKernel.CountFacets();
+    std::size_t toRemove = 0;
+    if (targetSize >= 0 && numFacets > static_cast<std::size_t>(targetSize))
+        toRemove = numFacets - static_cast<std::size_t>(targetSize);
+
+    Base::SequencerLauncher seq("Simplify mesh...", 100);
+    SimplifyProgress progress(seq, toRemove);
+
+    int numParts = 1;
+    if (parallel) {
+        numParts = std::min<int>(QThread::idealThreadCount(),
+                                 static_cast<int>(numFacets / MinFacetsPerPartition));
+    }
+
+    if (numParts > 1) {
+        // the mesh is only replaced when all passes are done, so that it's
+        // left unchanged if the user aborts
+        MeshKernel merged;
+        simplifyPartitions(merged, targetSize, tolerance, numParts, progress);
+        // the vertices at the partition borders are still unchanged
+        if (merged.CountFacets() > static_cast<std::size_t>(std::max(targetSize, 0))) {
+            progress.setOffset(numFacets - merged.CountFacets());
+            simplifySequential(merged, targetSize, tolerance, progress);
+        }
+        myKernel.Swap(merged);
+    }
+    else {
+        simplifySequential(myKernel, targetSize, tolerance, progress);
+    }
+}
+
+/*!
+  Simplifies \a kernel which is only modified if the algorithm isn't aborted.
+ */
+void MeshSimplify::simplifySequential(MeshKernel& kernel, int targetSize, double tolerance,
+                                      SimplifyProgress& progress)
+{
+    Simplify alg;
+    setupSimplify(alg, kernel);
 
-    int target_count = static_cast<int>(static_cast<float>(facets.size()) * (1.0f-reduction));
+    alg.progress = [&progress](int deleted) {
+        progress.update(static_cast<std::size_t>(deleted));
+        return true;
+    };
 
     // Simplification starts
-    alg.simplify_mesh(target_count, tolerance);
+    alg.simplify_mesh(targetSize, tolerance);
 
     // Simplification done
     MeshPointArray new_points;
@@ -79,13 +250,13 @@ void MeshSimplify::simplify(float tolerance, float reduction)
         new_points.push_back(alg.vertices[i].p);
     }
 
-    std::size_t numFacets = 0;
+    std::size_t numNewFacets = 0;
     for (std::size_t i = 0; i < alg.triangles.size(); i++) {
         if (!alg.triangles[i].deleted)
-            numFacets++;
+            numNewFacets++;
     }
     MeshFacetArray new_facets;
-    new_facets.reserve(numFacets);
+    new_facets.reserve(numNewFacets);
     for (std::size_t i = 0; i < alg.triangles.size(); i++) {
         if (!alg.triangles[i].deleted) {
             MeshFacet face;
@@ -96,57 +267,158 @@ void MeshSimplify::simplify(float tolerance, float reduction)
         }
     }
 
-    myKernel.Adopt(new_points, new_facets, true);
+    kernel.Adopt(new_points, new_facets, true);
 }
 
-void MeshSimplify::simplify(int targetSize)
+/*!
+  Simplifies the partitions of the mesh concurrently and stores the merged
+  result in \a merged while the mesh itself is left unchanged.
+ */
+void MeshSimplify::simplifyPartitions(MeshKernel& merged, int targetSize, double tolerance, int numParts,
+                                      SimplifyProgress& progress)
 {
-    Simplify alg;
-
     const MeshPointArray& points = myKernel.GetPoints();
-    for (std::size_t i = 0; i < points.size(); i++) {
-        Simplify::Vertex v;
-        v.tstart = 0;
-        v.p = points[i];
-        alg.vertices.push_back(v);
-    }
-
     const MeshFacetArray& facets = myKernel.GetFacets();
-    for (std::size_t i = 0; i < facets.size(); i++) {
-        Simplify::Triangle t;
-        for (int j = 0; j < 4; j++)
-            t.err[j] = 0.0;
-        for (int j = 0; j < 3; j++)
-            t.v[j] = facets[i]._aulPoints[j];
-        alg.triangles.push_back(t);
+
+    // split the facets into spatially coherent partitions
+    std::vector<Base::Vector3f> centers;
+    centers.reserve(facets.size());
+    for (MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it) {
+        centers.push_back((points[it->_aulPoints[0]] +
+                           points[it->_aulPoints[1]] +
+                           points[it->_aulPoints[2]]) / 3.0f);
     }
 
-    // Simplification starts
-    alg.simplify_mesh(targetSize, FLT_MAX);
+    std::vector<unsigned long> indices(facets.size());
+    std::generate(indices.begin(), indices.end(), Base::iotaGen<unsigned long>(0));
+    std::vector<std::vector<unsigned long> > groups;
+    splitFacets(indices.begin(), indices.end(), centers, numParts, groups);
+    centers.clear();
+    indices.clear();
 
-    // Simplification done
-    MeshPointArray new_points;
-    new_points.reserve(alg.vertices.size());
-    for (std::size_t i = 0; i < alg.vertices.size(); i++) {
-        new_points.push_back(alg.vertices[i].p);
+    // a point that is used by several partitions is locked
+    const int Shared = -2;
+    std::vector<int> owner(points.size(), -1);
+    for (std::size_t i = 0; i < groups.size(); i++) {
+        int part = static_cast<int>(i);
+        for (std::vector<unsigned long>::iterator it = groups[i].begin(); it != groups[i].end(); ++it) {
+            const MeshFacet& face = facets[*it];
+            for (int j = 0; j < 3; j++) {
+                int& o = owner[face._aulPoints[j]];
+                if (o == -1)
+                    o = part;
+                else if (o != part)
+                    o = Shared;
+            }
+        }
     }
 
-    std::size_t numFacets = 0;
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted)
-            numFacets++;
+    double ratio = facets.empty() ? 1.0 : static_cast<double>(std::max(targetSize, 0)) / facets.size();
+    std::vector<SimplifyPartition> partitions(groups.size());
+    for (std::size_t i = 0; i < groups.size(); i++) {
+        partitions[i].facets.swap(groups[i]);
+        partitions[i].target = static_cast<int>(ratio * partitions[i].facets.size());
     }
+
+    std::atomic<bool> abort(false);
+    std::atomic<std::size_t> removed(0);
+
+    auto run = [&](SimplifyPartition& part) {
+        Simplify& alg = part.alg;
+
+        // points of this partition sorted by their global index
+        std::vector<unsigned long> pts;
+        pts.reserve(3 * part.facets.size());
+        for (std::vector<unsigned long>::iterator it = part.facets.begin(); it != part.facets.end(); ++it) {
+            const MeshFacet& face = facets[*it];
+            pts.insert(pts.end(), face._aulPoints, face._aulPoints + 3);
+        }
+        std::sort(pts.begin(), pts.end());
+        pts.erase(std::unique(pts.begin(), pts.end()), pts.end());
+
+        alg.vertices.reserve(pts.size());
+        for (std::vector<unsigned long>::iterator it = pts.begin(); it != pts.end(); ++it) {
+            Simplify::Vertex v;
+            v.tstart = 0;
+            v.p = points[*it];
+            v.locked = owner[*it] == Shared ? 1 : 0;
+            v.id = static_cast<int>(*it);
+            alg.vertices.push_back(v);
+        }
+
+        alg.triangles.reserve(part.facets.size());
+        for (std::vector<unsigned long>::iterator it = part.facets.begin(); it != part.facets.end(); ++it) {
+            const MeshFacet& face = facets[*it];
+            Simplify::Triangle t;
+            for (int j = 0; j < 4; j++)
+                t.err[j] = 0.0;
+            for (int j = 0; j < 3; j++)
+                t.v[j] = static_cast<int>(std::lower_bound(pts.begin(), pts.end(), face._aulPoints[j]) - pts.begin());
+            alg.triangles.push_back(t);
+        }
+
+        std::size_t last = 0;
+        alg.progress = [&abort, &removed, &last](int deleted) {
+            std::size_t num = static_cast<std::size_t>(deleted);
+            removed += num - last;
+            last = num;
+            return !abort;
+        };
+
+        alg.simplify_mesh(part.target, tolerance);
+        alg.progress = nullptr;
+    };
+
+    // the sequencer must only be accessed by the main thread
+    QFuture<void> future = QtConcurrent::map(partitions, run);
+    while (!future.isFinished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        try {
+            progress.update(removed);
+        }
+        catch (...) {
+            abort = true;
+            future.waitForFinished();
+            throw;
+        }
+    }
+
+    // merge the partitions, the locked points are shared by several partitions
+    MeshPointArray new_points;
     MeshFacetArray new_facets;
-    new_facets.reserve(numFacets);
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted) {
-            MeshFacet face;
-            face._aulPoints[0] = alg.triangles[i].v[0];
-            face._aulPoints[1] = alg.triangles[i].v[1];
-            face._aulPoints[2] = alg.triangles[i].v[2];
-            new_facets.push_back(face);
+    std::vector<unsigned long> shared(points.size(), ULONG_MAX);
+    for (std::vector<SimplifyPartition>::iterator it = partitions.begin(); it != partitions.end(); ++it) {
+        Simplify& alg = it->alg;
+        std::vector<unsigned long> localToGlobal(alg.vertices.size());
+        for (std::size_t i = 0; i < alg.vertices.size(); i++) {
+            const Simplify::Vertex& v = alg.vertices[i];
+            if (v.locked) {
+                unsigned long& index = shared[v.id];
+                if (index == ULONG_MAX) {
+                    index = new_points.size();
+                    new_points.push_back(v.p);
+                }
+                localToGlobal[i] = index;
+            }
+            else {
+                localToGlobal[i] = new_points.size();
+                new_points.push_back(v.p);
+            }
         }
+
+        for (std::vector<Simplify::Triangle>::iterator jt = alg.triangles.begin(); jt != alg.triangles.end(); ++jt) {
+            if (!jt->deleted) {
+                MeshFacet face;
+                face._aulPoints[0] = localToGlobal[jt->v[0]];
+                face._aulPoints[1] = localToGlobal[jt->v[1]];
+                face._aulPoints[2] = localToGlobal[jt->v[2]];
+                new_facets.push_back(face);
+            }
+        }
+
+        Simplify empty;
+        std::swap(alg, empty); // free memory
     }
 
-    myKernel.Adopt(new_points, new_facets, true);
+    merged.Adopt(new_points, new_facets, true);
 }
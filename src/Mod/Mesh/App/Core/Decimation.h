@@ -28,17 +28,42 @@
 namespace MeshCore
 {
 class MeshKernel;
+class SimplifyProgress;
 
 class MeshExport MeshSimplify
 {
 public:
     MeshSimplify(MeshKernel&);
     ~MeshSimplify();
+    /**
+     * Enables or disables the parallel mode. In parallel mode the mesh is split
+     * into spatially coherent partitions that are simplified concurrently while
+     * the vertices shared by different partitions are locked. If the target
+     * isn't reached afterwards the merged mesh is simplified once more to
+     * remove the remaining seams.
+     * The number of partitions depends on the number of available cores.
+     */
+    void setParallel(bool on);
+    /**
+     * Simplifies the mesh until the quadric error of all edges exceeds
+     * \a tolerance or the number of facets is reduced by \a reduction.
+     * The progress is reported by the sequencer and the user can abort the
+     * algorithm in which case the mesh is left unchanged.
+     */
     void simplify(float tolerance, float reduction);
+    /**
+     * Simplifies the mesh until it has \a targetSize facets.
+     */
     void simplify(int targetSize);
 
+private:
+    void simplifyToTarget(int targetSize, double tolerance);
+    void simplifySequential(MeshKernel&, int targetSize, double tolerance, SimplifyProgress&);
+    void simplifyPartitions(MeshKernel&, int targetSize, double tolerance, int numParts, SimplifyProgress&);
+
 private:
     MeshKernel& myKernel;
+    bool parallel;
 };
 
 } // namespace MeshCore
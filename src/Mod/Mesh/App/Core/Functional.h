@@ -25,6 +25,8 @@
 #define MESH_FUNCTIONAL_H
 
 #include <algorithm>
+#include <vector>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QThread>
@@ -58,6 +60,31 @@ namespace MeshCore
         }
     }
 
+    /*!
+      Calls \a func(begin, end) for consecutive blocks of the index range
+      [0, count) using the global thread pool. Every index is handled by
+      exactly one call so that \a func can write its results to separate
+      slots of an output array without any locking.
+     */
+    template <class Func>
+    static void parallel_for(std::size_t count, Func func, std::size_t minBlockSize = 1024)
+    {
+        std::size_t threads = static_cast<std::size_t>(std::max(QThread::idealThreadCount(), 1));
+        if (threads < 2 || count <= minBlockSize) {
+            func(std::size_t(0), count);
+            return;
+        }
+
+        // use more blocks than threads to balance the load
+        std::size_t blockSize = std::max(minBlockSize, (count + 4 * threads - 1) / (4 * threads));
+        std::vector<std::pair<std::size_t, std::size_t> > blocks;
+        for (std::size_t pos = 0; pos < count; pos += blockSize)
+            blocks.push_back(std::make_pair(pos, std::min(pos + blockSize, count)));
+        QtConcurrent::blockingMap(blocks, [&func](const std::pair<std::size_t, std::size_t>& block) {
+            func(block.first, block.second);
+        });
+    }
+
 } // namespace MeshCore
 
 
@@ -29,6 +29,7 @@
 #include "MeshIO.h"
 #include "Algorithm.h"
 #include "Builder.h"
+#include "StreamWriter.h"
 
 #include <Base/Builder3D.h>
 #include <Base/Console.h>
@@ -2065,101 +2066,107 @@ bool MeshOutput::SaveFormat(std::ostream &str, MeshIO::Format fmt) const
 /** Saves the mesh object into an ASCII file. */
 bool MeshOutput::SaveAsciiSTL (std::ostream &rstrOut) const
 {
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    clIter.Transform(this->_transform);
-    const MeshGeomFacet *pclFacet;
-    unsigned long i;
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
 
     if (!rstrOut || rstrOut.bad() == true || _rclMesh.CountFacets() == 0)
         return false;
 
-    rstrOut.precision(6);
-    rstrOut.setf(std::ios::fixed | std::ios::showpoint);
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountFacets() + 1);
+    MeshBlockWriter writer(rstrOut);
+    MeshAsciiFormatter formatter(writer);
+    MeshPointTransform transform(this->_transform, this->apply_transform);
+    Base::SequencerLauncher seq("saving...", formatter.countChunks(rFacets.size()) + 1);
 
     if (this->objectName.empty())
-        rstrOut << "solid Mesh\n";
+        writer.write(std::string("solid Mesh\n"));
     else
-        rstrOut << "solid " << this->objectName << '\n';
-
-    clIter.Begin();
-    clEnd.End();
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
+        writer.write("solid " + this->objectName + '\n');
 
-        // normal
-        rstrOut << "  facet normal " << pclFacet->GetNormal().x << " "
-                                     << pclFacet->GetNormal().y << " "
-                                     << pclFacet->GetNormal().z << '\n';
-        rstrOut << "    outer loop\n";
+    formatter.format(rFacets.size(), [&](std::size_t begin, std::size_t end, std::ostream& out) {
+        Base::Vector3f pts[3];
+        for (std::size_t index = begin; index < end; index++) {
+            const MeshFacet& face = rFacets[index];
+            for (int i = 0; i < 3; i++)
+                pts[i] = transform(rPoints[face._aulPoints[i]]);
+            Base::Vector3f normal = (pts[1] - pts[0]) % (pts[2] - pts[0]);
+            normal.Normalize();
+
+            // normal
+            out << "  facet normal " << normal.x << " "
+                                     << normal.y << " "
+                                     << normal.z << '\n';
+            out << "    outer loop\n";
+
+            // vertices
+            for (int i = 0; i < 3; i++) {
+                out << "      vertex "  << pts[i].x << " "
+                                        << pts[i].y << " "
+                                        << pts[i].z << '\n';
+            }
 
-        // vertices
-        for (i = 0; i < 3; i++) {
-            rstrOut << "      vertex "  << pclFacet->_aclPoints[i].x << " "
-                                        << pclFacet->_aclPoints[i].y << " "
-                                        << pclFacet->_aclPoints[i].z << '\n';
+            out << "    endloop\n";
+            out << "  endfacet\n";
         }
+    }, &seq);
 
-        rstrOut << "    endloop\n";
-        rstrOut << "  endfacet\n";
-
-        ++clIter;
-        seq.next(true);// allow to cancel
-    }
-
-    rstrOut << "endsolid Mesh\n";
+    writer.write(std::string("endsolid Mesh\n"));
 
-    return true;
+    return writer.flush();
 }
 
 /** Saves the mesh object into a binary file. */
 bool MeshOutput::SaveBinarySTL (std::ostream &rstrOut) const
 {
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    clIter.Transform(this->_transform);
-    const MeshGeomFacet *pclFacet;
-    uint32_t i;
-    uint16_t usAtt;
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
     char szInfo[81];
 
     if (!rstrOut || rstrOut.bad() == true /*|| _rclMesh.CountFacets() == 0*/)
         return false;
 
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountFacets() + 1);
+    // The facets are directly taken from the arrays and written in large
+    // blocks instead of going through MeshGeomFacet and single writes
+    MeshBlockWriter writer(rstrOut);
+    MeshPointTransform transform(this->_transform, this->apply_transform);
+    const std::size_t blockSize = 65536;
+    Base::SequencerLauncher seq("saving...", rFacets.size() / blockSize + 1);
 
     // stl_header has a length of 80
     strcpy(szInfo, stl_header.c_str());
-    rstrOut.write(szInfo, std::strlen(szInfo));
+    writer.write(szInfo, std::strlen(szInfo));
 
     uint32_t uCtFts = (uint32_t)_rclMesh.CountFacets();
-    rstrOut.write((const char*)&uCtFts, sizeof(uCtFts));
+    writer.put(uCtFts);
+
+    uint16_t usAtt = 0;
+    Base::Vector3f pts[3];
+    std::size_t index = 0;
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it, ++index) {
+        for (int i = 0; i < 3; i++)
+            pts[i] = transform(rPoints[it->_aulPoints[i]]);
 
-    usAtt = 0;
-    clIter.Begin();
-    clEnd.End();
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
         // normal
-        Base::Vector3f normal = pclFacet->GetNormal();
-        rstrOut.write((const char*)&(normal.x), sizeof(float));
-        rstrOut.write((const char*)&(normal.y), sizeof(float));
-        rstrOut.write((const char*)&(normal.z), sizeof(float));
+        Base::Vector3f normal = (pts[1] - pts[0]) % (pts[2] - pts[0]);
+        normal.Normalize();
+        writer.put(normal.x);
+        writer.put(normal.y);
+        writer.put(normal.z);
 
         // vertices
-        for (i = 0; i < 3; i++) {
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].x), sizeof(float));
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].y), sizeof(float));
-            rstrOut.write((const char*)&(pclFacet->_aclPoints[i].z), sizeof(float));
+        for (int i = 0; i < 3; i++) {
+            writer.put(pts[i].x);
+            writer.put(pts[i].y);
+            writer.put(pts[i].z);
         }
 
         // attribute
-        rstrOut.write((const char*)&usAtt, sizeof(usAtt));
+        writer.put(usAtt);
 
-        ++clIter;
-        seq.next(true); // allow to cancel
+        if ((index + 1) % blockSize == 0)
+            seq.next(true); // allow to cancel
     }
 
-    return true;
+    return writer.flush();
 }
 
 /** Saves an OBJ file. */
@@ -2171,7 +2178,6 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
     if (!out || out.bad() == true)
         return false;
 
-    Base::SequencerLauncher seq("saving...", _rclMesh.CountPoints() + _rclMesh.CountFacets());
     bool exportColorPerVertex = false;
     bool exportColorPerFace = false;
 
@@ -2202,62 +2208,81 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
         }
     }
 
+    // The vertex, normal and the plain facet records are formatted in parallel
+    // and written in large blocks. Facets with materials or groups are written
+    // sequentially afterwards.
+    bool formatFacets = _groups.empty() && !exportColorPerFace;
+    MeshBlockWriter writer(out);
+    MeshAsciiFormatter formatter(writer);
+    MeshPointTransform transform(this->_transform, this->apply_transform);
+    std::size_t numSteps = formatter.countChunks(rPoints.size()) + formatter.countChunks(rFacets.size());
+    numSteps += formatFacets ? formatter.countChunks(rFacets.size()) : rFacets.size();
+    Base::SequencerLauncher seq("saving...", numSteps);
+
     // Header
-    out << "# Created by FreeCAD <http://www.freecadweb.org>\n";
+    writer.write(std::string("# Created by FreeCAD <http://www.freecadweb.org>\n"));
     if (exportColorPerFace) {
-        out << "mtllib " << _material->library << '\n';
+        writer.write("mtllib " + _material->library + '\n');
     }
 
-    out.precision(6);
-    out.setf(std::ios::fixed | std::ios::showpoint);
-
     // vertices
-    Base::Vector3f pt;
-    std::size_t index = 0;
-    for (MeshPointArray::_TConstIterator it = rPoints.begin(); it != rPoints.end(); ++it, ++index) {
-        if (this->apply_transform) {
-            pt = this->_transform * *it;
-        }
-        else {
-            pt.Set(it->x, it->y, it->z);
-        }
+    formatter.format(rPoints.size(), [&](std::size_t begin, std::size_t end, std::ostream& str) {
+        for (std::size_t index = begin; index < end; index++) {
+            Base::Vector3f pt = transform(rPoints[index]);
 
-        if (exportColorPerVertex) {
-            App::Color c;
-            if (_material->binding == MeshIO::PER_VERTEX) {
-                c = _material->diffuseColor[index];
+            if (exportColorPerVertex) {
+                App::Color c;
+                if (_material->binding == MeshIO::PER_VERTEX) {
+                    c = _material->diffuseColor[index];
+                }
+                else {
+                    c = _material->diffuseColor.front();
+                }
+
+                int r = static_cast<int>(c.r * 255.0f);
+                int g = static_cast<int>(c.g * 255.0f);
+                int b = static_cast<int>(c.b * 255.0f);
+
+                str << "v " << pt.x << " " << pt.y << " " << pt.z << " " << r << " " << g << " " << b << '\n';
             }
             else {
-                c = _material->diffuseColor.front();
+                str << "v " << pt.x << " " << pt.y << " " << pt.z << '\n';
             }
-
-            int r = static_cast<int>(c.r * 255.0f);
-            int g = static_cast<int>(c.g * 255.0f);
-            int b = static_cast<int>(c.b * 255.0f);
-
-            out << "v " << pt.x << " " << pt.y << " " << pt.z << " " << r << " " << g << " " << b << '\n';
-        }
-        else {
-            out << "v " << pt.x << " " << pt.y << " " << pt.z << '\n';
         }
-        seq.next(true); // allow to cancel
-    }
-    // Export normals
-    MeshFacetIterator clIter(_rclMesh), clEnd(_rclMesh);
-    const MeshGeomFacet* pclFacet;
-
-    clIter.Begin();
-    clEnd.End();
+    }, &seq);
 
-    while (clIter < clEnd) {
-        pclFacet = &(*clIter);
-        out << "vn " << pclFacet->GetNormal().x << " "
-            << pclFacet->GetNormal().y << " "
-            << pclFacet->GetNormal().z << '\n';
-        ++clIter;
-        seq.next(true); // allow to cancel
+    // Export normals
+    formatter.format(rFacets.size(), [&](std::size_t begin, std::size_t end, std::ostream& str) {
+        for (std::size_t index = begin; index < end; index++) {
+            const MeshFacet& face = rFacets[index];
+            const Base::Vector3f& p0 = rPoints[face._aulPoints[0]];
+            const Base::Vector3f& p1 = rPoints[face._aulPoints[1]];
+            const Base::Vector3f& p2 = rPoints[face._aulPoints[2]];
+            Base::Vector3f normal = (p1 - p0) % (p2 - p0);
+            normal.Normalize();
+            str << "vn " << normal.x << " "
+                << normal.y << " "
+                << normal.z << '\n';
+        }
+    }, &seq);
+
+    if (formatFacets) {
+        // facet indices (no texture and normal indices)
+        formatter.format(rFacets.size(), [&](std::size_t begin, std::size_t end, std::ostream& str) {
+            for (std::size_t index = begin; index < end; index++) {
+                const MeshFacet& face = rFacets[index];
+                std::size_t faceIdx = index + 1;
+                str << "f " << face._aulPoints[0]+1 << "//" << faceIdx << " "
+                            << face._aulPoints[1]+1 << "//" << faceIdx << " "
+                            << face._aulPoints[2]+1 << "//" << faceIdx << '\n';
+            }
+        }, &seq);
+        return writer.flush();
     }
 
+    if (!writer.flush())
+        return false;
+
     if (_groups.empty()) {
         if (exportColorPerFace) {
             // facet indices (no texture and normal indices)
@@ -2286,17 +2311,6 @@ bool MeshOutput::SaveOBJ (std::ostream &out) const
                 faceIdx++;
             }
         }
-        else {
-            // facet indices (no texture and normal indices)
-            std::size_t faceIdx = 1;
-            for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
-                out << "f " << it->_aulPoints[0]+1 << "//" << faceIdx << " "
-                            << it->_aulPoints[1]+1 << "//" << faceIdx << " "
-                            << it->_aulPoints[2]+1 << "//" << faceIdx << '\n';
-                seq.next(true); // allow to cancel
-                faceIdx++;
-            }
-        }
     }
     else {
         if (exportColorPerFace) {
@@ -2643,38 +2657,39 @@ bool MeshOutput::SaveBinaryPLY (std::ostream &out) const
         << "property list uchar int vertex_index\n"
         << "end_header\n";
 
-    Base::OutputStream os(out);
-    os.setByteOrder(Base::Stream::LittleEndian);
+    MeshBlockWriter writer(out);
+    writer.setByteOrder(MeshBlockWriter::LittleEndian);
+    MeshPointTransform transform(this->_transform, this->apply_transform);
 
     for (std::size_t i = 0; i < v_count; i++) {
-        const MeshPoint& p = rPoints[i];
-        if (this->apply_transform) {
-            Base::Vector3f pt = this->_transform * p;
-            os << pt.x << pt.y << pt.z;
-        }
-        else {
-            os << p.x << p.y << p.z;
-        }
+        Base::Vector3f pt = transform(rPoints[i]);
+        writer.put(pt.x);
+        writer.put(pt.y);
+        writer.put(pt.z);
         if (saveVertexColor) {
             const App::Color& c = _material->diffuseColor[i];
             uint8_t r = uint8_t(255.0f * c.r);
             uint8_t g = uint8_t(255.0f * c.g);
             uint8_t b = uint8_t(255.0f * c.b);
-            os << r << g << b;
+            writer.put(r);
+            writer.put(g);
+            writer.put(b);
         }
     }
     unsigned char n = 3;
-    int f1, f2, f3;
+    int32_t f1, f2, f3;
     for (std::size_t i = 0; i < f_count; i++) {
         const MeshFacet& f = rFacets[i];
-        f1 = (int)f._aulPoints[0];
-        f2 = (int)f._aulPoints[1];
-        f3 = (int)f._aulPoints[2];
-        os << n;
-        os << f1 << f2 << f3;
+        f1 = (int32_t)f._aulPoints[0];
+        f2 = (int32_t)f._aulPoints[1];
+        f3 = (int32_t)f._aulPoints[2];
+        writer.put(n);
+        writer.put(f1);
+        writer.put(f2);
+        writer.put(f3);
     }
 
-    return true;
+    return writer.flush();
 }
 
 bool MeshOutput::SaveAsciiPLY (std::ostream &out) const
@@ -2704,50 +2719,38 @@ bool MeshOutput::SaveAsciiPLY (std::ostream &out) const
         << "property list uchar int vertex_index\n"
         << "end_header\n";
 
-    out.precision(6);
-    out.setf(std::ios::fixed | std::ios::showpoint);
-    if (saveVertexColor) {
-        for (std::size_t i = 0; i < v_count; i++) {
-            const MeshPoint& p = rPoints[i];
-            if (this->apply_transform) {
-                Base::Vector3f pt = this->_transform * p;
-                out << pt.x << " " << pt.y << " " << pt.z;
-            }
-            else {
-                out << p.x << " " << p.y << " " << p.z;
-            }
-
-            const App::Color& c = _material->diffuseColor[i];
-            int r = (int)(255.0f * c.r);
-            int g = (int)(255.0f * c.g);
-            int b = (int)(255.0f * c.b);
-            out << " " << r << " " << g << " " << b << '\n';
-        }
-    }
-    else {
-        for (std::size_t i = 0; i < v_count; i++) {
-            const MeshPoint& p = rPoints[i];
-            if (this->apply_transform) {
-                Base::Vector3f pt = this->_transform * p;
-                out << pt.x << " " << pt.y << " " << pt.z << '\n';
-            }
-            else {
-                out << p.x << " " << p.y << " " << p.z << '\n';
+    MeshBlockWriter writer(out);
+    MeshAsciiFormatter formatter(writer);
+    MeshPointTransform transform(this->_transform, this->apply_transform);
+
+    formatter.format(v_count, [&](std::size_t begin, std::size_t end, std::ostream& str) {
+        for (std::size_t i = begin; i < end; i++) {
+            Base::Vector3f pt = transform(rPoints[i]);
+            str << pt.x << " " << pt.y << " " << pt.z;
+            if (saveVertexColor) {
+                const App::Color& c = _material->diffuseColor[i];
+                int r = (int)(255.0f * c.r);
+                int g = (int)(255.0f * c.g);
+                int b = (int)(255.0f * c.b);
+                str << " " << r << " " << g << " " << b;
             }
+            str << '\n';
         }
-    }
+    });
 
-    unsigned int n = 3;
-    int f1, f2, f3;
-    for (std::size_t i = 0; i < f_count; i++) {
-        const MeshFacet& f = rFacets[i];
-        f1 = (int)f._aulPoints[0];
-        f2 = (int)f._aulPoints[1];
-        f3 = (int)f._aulPoints[2];
-        out << n << " " << f1 << " " << f2 << " " << f3 << '\n';
-    }
+    formatter.format(f_count, [&](std::size_t begin, std::size_t end, std::ostream& str) {
+        unsigned int n = 3;
+        int f1, f2, f3;
+        for (std::size_t i = begin; i < end; i++) {
+            const MeshFacet& f = rFacets[i];
+            f1 = (int)f._aulPoints[0];
+            f2 = (int)f._aulPoints[1];
+            f3 = (int)f._aulPoints[2];
+            str << n << " " << f1 << " " << f2 << " " << f3 << '\n';
+        }
+    });
 
-    return true;
+    return writer.flush();
 }
 
 bool MeshOutput::SaveMeshNode (std::ostream &rstrOut)
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+#endif
+
+#include "PointArrays.h"
+#include "MeshKernel.h"
+#include "Algorithm.h"
+
+using namespace MeshCore;
+
+MeshCompactPointToPoints::MeshCompactPointToPoints(const MeshKernel& kernel,
+                                                   const MeshCompactPointToFacets& pt2f)
+{
+    const MeshFacetArray& facets = kernel.GetFacets();
+    std::size_t numPoints = kernel.CountPoints();
+
+    offsets.resize(numPoints + 1);
+    offsets[0] = 0;
+    neighbours.reserve(2 * pt2f.End(numPoints > 0 ? numPoints - 1 : 0));
+
+    std::vector<unsigned long> points;
+    for (std::size_t i = 0; i < numPoints; i++) {
+        points.clear();
+        for (std::size_t pos = pt2f.Begin(i); pos != pt2f.End(i); ++pos) {
+            const MeshFacet& face = facets[pt2f.Facet(pos)];
+            int corner = pt2f.Corner(pos);
+            points.push_back(face._aulPoints[(corner+1)%3]);
+            points.push_back(face._aulPoints[(corner+2)%3]);
+        }
+
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        neighbours.insert(neighbours.end(), points.begin(), points.end());
+        offsets[i+1] = neighbours.size();
+    }
+}
+
+MeshCompactPointToFacets::MeshCompactPointToFacets(const MeshKernel& kernel)
+{
+    const MeshFacetArray& facets = kernel.GetFacets();
+    std::size_t numPoints = kernel.CountPoints();
+
+    // counting sort of the facet corners by their point index keeps
+    // the facets of a point in ascending order
+    offsets.resize(numPoints + 1, 0);
+    for (MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it) {
+        for (int i = 0; i < 3; i++)
+            offsets[it->_aulPoints[i] + 1]++;
+    }
+    for (std::size_t i = 0; i < numPoints; i++)
+        offsets[i+1] += offsets[i];
+
+    std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+    refs.resize(offsets[numPoints]);
+    unsigned long index = 0;
+    for (MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it, ++index) {
+        for (unsigned long i = 0; i < 3; i++)
+            refs[pos[it->_aulPoints[i]]++] = (index << 2) | i;
+    }
+}
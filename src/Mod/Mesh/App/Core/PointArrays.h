@@ -0,0 +1,139 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_POINTARRAYS_H
+#define MESH_POINTARRAYS_H
+
+#include <vector>
+#include "Elements.h"
+
+namespace MeshCore
+{
+class MeshKernel;
+class MeshCompactPointToFacets;
+
+/**
+ * The MeshPointSoA class keeps the coordinates of mesh points in three
+ * separate arrays (structure of arrays). Compared to an array of points this
+ * layout allows the compiler to vectorize loops over the coordinates and it
+ * is used as double buffer for algorithms that compute new point positions
+ * from the positions of the previous step.
+ */
+template <class Real>
+class MeshPointSoA
+{
+public:
+    MeshPointSoA() {}
+    explicit MeshPointSoA(const MeshPointArray& points)
+    { Assign(points); }
+
+    void Assign(const MeshPointArray& points)
+    {
+        std::size_t num = points.size();
+        x.resize(num);
+        y.resize(num);
+        z.resize(num);
+        for (std::size_t i = 0; i < num; i++) {
+            x[i] = static_cast<Real>(points[i].x);
+            y[i] = static_cast<Real>(points[i].y);
+            z[i] = static_cast<Real>(points[i].z);
+        }
+    }
+    void CopyTo(MeshPointArray& points) const
+    {
+        std::size_t num = std::min(points.size(), x.size());
+        for (std::size_t i = 0; i < num; i++) {
+            points[i].Set(static_cast<float>(x[i]),
+                          static_cast<float>(y[i]),
+                          static_cast<float>(z[i]));
+        }
+    }
+    std::size_t size() const
+    { return x.size(); }
+    void swap(MeshPointSoA& that)
+    {
+        x.swap(that.x);
+        y.swap(that.y);
+        z.swap(that.z);
+    }
+
+    std::vector<Real> x, y, z;
+};
+
+/**
+ * The MeshCompactPointToPoints class stores the neighbour points of all points
+ * in two flat arrays (compressed row storage). In contrast to
+ * MeshRefPointToPoints it doesn't need one heap allocation per point and the
+ * neighbours of a point are stored contiguously in ascending order. Once built
+ * the structure can be read by several threads.
+ */
+class MeshExport MeshCompactPointToPoints
+{
+public:
+    MeshCompactPointToPoints(const MeshKernel&, const MeshCompactPointToFacets&);
+
+    std::size_t Count(std::size_t index) const
+    { return offsets[index+1] - offsets[index]; }
+    const unsigned long* Begin(std::size_t index) const
+    { return neighbours.data() + offsets[index]; }
+    const unsigned long* End(std::size_t index) const
+    { return neighbours.data() + offsets[index+1]; }
+
+private:
+    std::vector<std::size_t> offsets;
+    std::vector<unsigned long> neighbours;
+};
+
+/**
+ * The MeshCompactPointToFacets class stores for each point the facets that
+ * reference it in two flat arrays. For every reference the facet index and the
+ * corner of the facet are kept so that degenerated facets referencing a point
+ * twice are handled correctly. The facets of a point are sorted by their index.
+ */
+class MeshExport MeshCompactPointToFacets
+{
+public:
+    MeshCompactPointToFacets(const MeshKernel&);
+
+    std::size_t Count(std::size_t index) const
+    { return offsets[index+1] - offsets[index]; }
+    /// Returns the facet index of the reference \a pos
+    unsigned long Facet(std::size_t pos) const
+    { return refs[pos] >> 2; }
+    /// Returns the corner of the reference \a pos
+    int Corner(std::size_t pos) const
+    { return static_cast<int>(refs[pos] & 3); }
+    std::size_t Begin(std::size_t index) const
+    { return offsets[index]; }
+    std::size_t End(std::size_t index) const
+    { return offsets[index+1]; }
+
+private:
+    std::vector<std::size_t> offsets;
+    std::vector<unsigned long> refs;
+};
+
+} // namespace MeshCore
+
+
+#endif  // MESH_POINTARRAYS_H
@@ -9,7 +9,10 @@
 // * Comment out printf statements
 // * Fix compiler warnings
 // * Remove macros loop,i,j,k
+// * Add a progress callback that allows to abort the algorithm
+// * Support of locked vertices that must not be moved or removed
 
+#include <functional>
 #include <vector>
 #include <Base/Vector3D.h>
 
@@ -84,13 +87,15 @@ class Simplify
 {
 public:
     struct Triangle { int v[3];double err[4];int deleted,dirty;vec3f n; };
-    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;};
+    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;int locked;int id;};
     struct Ref { int tid,tvertex; }; 
     std::vector<Triangle> triangles;
     std::vector<Vertex> vertices;
     std::vector<Ref> refs;
+    // Gets the number of deleted triangles, returning false aborts the algorithm
+    std::function<bool(int)> progress;
 
-    void simplify_mesh(int target_count, double tolerance, double aggressiveness=7);
+    bool simplify_mesh(int target_count, double tolerance, double aggressiveness=7);
 
 private:
     // Helper functions
@@ -115,8 +120,10 @@ private:
 // the quadratic error metric of all triangles. If none of them is below
 // the tolerance the algorithm will stop at this point. The number of the
 // remaining triangles usually will be higher than \a target_count
+// If the progress callback returns false the algorithm stops and
+// false is returned. In this case the mesh is not compacted.
 //
-void Simplify::simplify_mesh(int target_count, double tolerance, double aggressiveness)
+bool Simplify::simplify_mesh(int target_count, double tolerance, double aggressiveness)
 {
     // init
     //printf("%s - start\n",__FUNCTION__);
@@ -138,6 +145,9 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
         if (triangle_count-deleted_triangles<=target_count)
             break;
 
+        if (progress && !progress(deleted_triangles))
+            return false;
+
         // update mesh once in a while
         if (iteration%5==0) 
         {
@@ -186,6 +196,8 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
                 continue;
             if (t.dirty)
                 continue;
+            if ((i & 0xffff) == 0 && progress && !progress(deleted_triangles))
+                return false;
 
             for (std::size_t j=0;j<3;++j)
             {
@@ -198,6 +210,10 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
                     if (v0.border != v1.border)
                         continue;
 
+                    // Locked vertices must keep their position
+                    if (v0.locked || v1.locked)
+                        continue;
+
                     // Compute vertex to collapse to
                     vec3f p;
                     calculate_error(i0,i1,p);
@@ -254,6 +270,7 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
     //    triangle_count,deleted_triangles*100/triangle_count,
     //    timeEnd-timeStart);
 
+    return true;
 }
 
 // Check if a triangle flips when this edge is removed
@@ -480,6 +497,8 @@ void Simplify::compact_mesh()
         {
             vertices[i].tstart=dst;
             vertices[dst].p=vertices[i].p;
+            vertices[dst].locked=vertices[i].locked;
+            vertices[dst].id=vertices[i].id;
             dst++;
         }
     }
@@ -23,6 +23,7 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
 #endif
 
 #include "Smoothing.h"
@@ -31,6 +32,9 @@
 #include "Elements.h"
 #include "Iterator.h"
 #include "Approximation.h"
+#include "Functional.h"
+#include "PointArrays.h"
+#include <Base/Tools.h>
 
 
 using namespace MeshCore;
@@ -41,6 +45,7 @@ AbstractSmoothing::AbstractSmoothing(MeshKernel& m)
   , tolerance(0)
   , component(Normal)
   , continuity(C0)
+  , parallel(false)
 {
 }
 
@@ -65,6 +70,13 @@ PlaneFitSmoothing::~PlaneFitSmoothing()
 
 void PlaneFitSmoothing::Smooth(unsigned int iterations)
 {
+    if (parallel) {
+        std::vector<unsigned long> indices(kernel.CountPoints());
+        std::generate(indices.begin(), indices.end(), Base::iotaGen<unsigned long>(0));
+        SmoothPoints(iterations, indices);
+        return;
+    }
+
     MeshCore::MeshPoint center;
     MeshCore::MeshPointArray PointArray = kernel.GetPoints();
 
@@ -125,6 +137,58 @@ void PlaneFitSmoothing::SmoothPoints(unsigned int iterations, const std::vector<
     MeshCore::MeshRefPointToPoints vv_it(kernel);
     MeshCore::MeshPointArray::_TConstIterator v_beg = kernel.GetPoints().begin();
 
+    if (parallel) {
+        // The new positions only depend on the positions of the previous
+        // iteration, hence the points can be handled concurrently
+        const MeshCore::MeshPointArray& points = kernel.GetPoints();
+        for (unsigned int i=0; i<iterations; i++) {
+            parallel_for(point_indices.size(), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t j = begin; j < end; j++) {
+                    unsigned long index = point_indices[j];
+                    const MeshCore::MeshPoint& pnt = points[index];
+                    const std::set<unsigned long>& cv = vv_it[index];
+                    if (cv.size() < 3)
+                        continue;
+
+                    MeshCore::PlaneFit pf;
+                    pf.AddPoint(pnt);
+                    Base::Vector3f mid = pnt;
+                    std::set<unsigned long>::const_iterator cv_it;
+                    for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
+                        pf.AddPoint(points[*cv_it]);
+                        mid += points[*cv_it];
+                    }
+
+                    float scale = 1.0f/(static_cast<float>(cv.size())+1.0f);
+                    mid.Scale(scale,scale,scale);
+
+                    // get the mean plane of the current vertex with the surrounding vertices
+                    pf.Fit();
+                    Base::Vector3f N = pf.GetNormal();
+                    N.Normalize();
+
+                    // look in which direction we should move the vertex
+                    Base::Vector3f L(pnt.x - mid.x, pnt.y - mid.y, pnt.z - mid.z);
+                    if (N*L < 0.0f)
+                        N.Scale(-1.0, -1.0, -1.0);
+
+                    // maximum value to move is distance to mean plane
+                    float d = std::min<float>(fabs(this->tolerance),fabs(N*L));
+                    N.Scale(d,d,d);
+
+                    PointArray[index].Set(pnt.x - N.x, pnt.y - N.y, pnt.z - N.z);
+                }
+            });
+
+            // assign values without affecting iterators
+            unsigned long count = kernel.CountPoints();
+            for (unsigned long idx = 0; idx < count; idx++) {
+                kernel.SetPoint(idx, PointArray[idx]);
+            }
+        }
+        return;
+    }
+
     for (unsigned int i=0; i<iterations; i++) {
         Base::Vector3f N, L;
         for (std::vector<unsigned long>::const_iterator it = point_indices.begin(); it != point_indices.end(); ++it) {
@@ -250,8 +314,84 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
     }
 }
 
+void LaplaceSmoothing::UmbrellaParallel(unsigned int iterations, double stepsize1, double stepsize2,
+                                        const std::vector<unsigned long>* point_indices)
+{
+    // Use flat adjacency arrays and two point buffers so that all points of
+    // an iteration can be moved concurrently and independent of their order
+    MeshCore::MeshCompactPointToFacets vf_it(kernel);
+    MeshCore::MeshCompactPointToPoints vv_it(kernel, vf_it);
+    MeshCore::MeshPointSoA<float> cur(kernel.GetPoints());
+    MeshCore::MeshPointSoA<float> next(cur);
+
+    std::vector<unsigned long> indices;
+    if (point_indices) {
+        indices = *point_indices;
+    }
+    else {
+        indices.resize(kernel.CountPoints());
+        std::generate(indices.begin(), indices.end(), Base::iotaGen<unsigned long>(0));
+    }
+
+    // do nothing for border points
+    std::vector<unsigned long> inner;
+    inner.reserve(indices.size());
+    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+        std::size_t n_count = vv_it.Count(*it);
+        if (n_count >= 3 && n_count == vf_it.Count(*it))
+            inner.push_back(*it);
+    }
+
+    auto step = [&](double stepsize) {
+        const float* px = cur.x.data();
+        const float* py = cur.y.data();
+        const float* pz = cur.z.data();
+        float* qx = next.x.data();
+        float* qy = next.y.data();
+        float* qz = next.z.data();
+        parallel_for(inner.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                unsigned long pos = inner[i];
+                double w = 1.0/double(vv_it.Count(pos));
+
+                double delx=0.0,dely=0.0,delz=0.0;
+                for (const unsigned long* cv_it = vv_it.Begin(pos); cv_it != vv_it.End(pos); ++cv_it) {
+                    delx += w*static_cast<double>(px[*cv_it]-px[pos]);
+                    dely += w*static_cast<double>(py[*cv_it]-py[pos]);
+                    delz += w*static_cast<double>(pz[*cv_it]-pz[pos]);
+                }
+
+                qx[pos] = static_cast<float>(static_cast<double>(px[pos])+stepsize*delx);
+                qy[pos] = static_cast<float>(static_cast<double>(py[pos])+stepsize*dely);
+                qz[pos] = static_cast<float>(static_cast<double>(pz[pos])+stepsize*delz);
+            }
+        });
+
+        // the points that are not moved are equal in both buffers
+        cur.swap(next);
+    };
+
+    for (unsigned int i=0; i<iterations; i++) {
+        step(stepsize1);
+        if (stepsize2 != 0.0)
+            step(stepsize2);
+    }
+
+    MeshCore::MeshPointArray points = kernel.GetPoints();
+    cur.CopyTo(points);
+    unsigned long count = kernel.CountPoints();
+    for (unsigned long idx = 0; idx < count; idx++) {
+        kernel.SetPoint(idx, points[idx]);
+    }
+}
+
 void LaplaceSmoothing::Smooth(unsigned int iterations)
 {
+    if (parallel) {
+        UmbrellaParallel(iterations, lambda, 0.0, nullptr);
+        return;
+    }
+
     MeshCore::MeshRefPointToPoints vv_it(kernel);
     MeshCore::MeshRefPointToFacets vf_it(kernel);
 
@@ -262,6 +402,11 @@ void LaplaceSmoothing::Smooth(unsigned int iterations)
 
 void LaplaceSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
+    if (parallel) {
+        UmbrellaParallel(iterations, lambda, 0.0, &point_indices);
+        return;
+    }
+
     MeshCore::MeshRefPointToPoints vv_it(kernel);
     MeshCore::MeshRefPointToFacets vf_it(kernel);
 
@@ -281,6 +426,12 @@ TaubinSmoothing::~TaubinSmoothing()
 
 void TaubinSmoothing::Smooth(unsigned int iterations)
 {
+    if (parallel) {
+        // Theoretically Taubin does not shrink the surface
+        UmbrellaParallel((iterations+1)/2, lambda, -(lambda+micro), nullptr);
+        return;
+    }
+
     MeshCore::MeshRefPointToPoints vv_it(kernel);
     MeshCore::MeshRefPointToFacets vf_it(kernel);
 
@@ -294,6 +445,12 @@ void TaubinSmoothing::Smooth(unsigned int iterations)
 
 void TaubinSmoothing::SmoothPoints(unsigned int iterations, const std::vector<unsigned long>& point_indices)
 {
+    if (parallel) {
+        // Theoretically Taubin does not shrink the surface
+        UmbrellaParallel((iterations+1)/2, lambda, -(lambda+micro), &point_indices);
+        return;
+    }
+
     MeshCore::MeshRefPointToPoints vv_it(kernel);
     MeshCore::MeshRefPointToFacets vf_it(kernel);
 
@@ -51,6 +51,13 @@ public:
     AbstractSmoothing(MeshKernel&);
     virtual ~AbstractSmoothing();
     void initialize(Component comp, Continuity cont);
+    /** Enables or disables the parallel mode. In parallel mode the new point
+     * positions of an iteration are only computed from the positions of the
+     * previous iteration. So, the result doesn't depend on the number of
+     * threads but may slightly differ from the sequential mode where already
+     * moved points are taken into account.
+     */
+    void SetParallel(bool on) { parallel = on; }
 
     /** Smooth the triangle mesh. */
     virtual void Smooth(unsigned int) = 0;
@@ -62,6 +69,7 @@ protected:
     float tolerance;
     Component   component;
     Continuity  continuity;
+    bool        parallel;
 };
 
 class MeshExport PlaneFitSmoothing : public AbstractSmoothing
@@ -88,6 +96,8 @@ protected:
     void Umbrella(const MeshRefPointToPoints&,
                   const MeshRefPointToFacets&, double,
                   const std::vector<unsigned long>&);
+    void UmbrellaParallel(unsigned int, double, double,
+                          const std::vector<unsigned long>*);
 
 protected:
     double lambda;
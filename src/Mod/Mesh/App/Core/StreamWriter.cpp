@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cstring>
+# include <locale>
+# include <sstream>
+#endif
+
+#include <QtConcurrentMap>
+#include <QThread>
+
+#include "StreamWriter.h"
+#include <Base/Sequencer.h>
+
+using namespace MeshCore;
+
+MeshBlockWriter::MeshBlockWriter(std::ostream& out, std::size_t blockSize)
+  : out(out), used(0), swapBytes(false)
+{
+    buffer.resize(std::max<std::size_t>(blockSize, 1024));
+}
+
+MeshBlockWriter::~MeshBlockWriter()
+{
+    flush();
+}
+
+void MeshBlockWriter::setByteOrder(ByteOrder order)
+{
+    if (order == LittleEndian)
+        swapBytes = (Base::SwapOrder() == HIGH_ENDIAN);
+    else
+        swapBytes = false;
+}
+
+void MeshBlockWriter::write(const char* data, std::size_t len)
+{
+    // data that doesn't fit into an empty block is directly passed to the stream
+    if (used + len > buffer.size()) {
+        flush();
+        if (len > buffer.size()) {
+            out.write(data, len);
+            return;
+        }
+    }
+
+    std::memcpy(&buffer[used], data, len);
+    used += len;
+}
+
+bool MeshBlockWriter::flush()
+{
+    if (used > 0) {
+        out.write(&buffer[0], used);
+        used = 0;
+    }
+    return good();
+}
+
+bool MeshBlockWriter::good() const
+{
+    return !out.bad() && !out.fail();
+}
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+struct AsciiChunk
+{
+    std::size_t begin;
+    std::size_t end;
+    std::string text;
+};
+}
+
+MeshAsciiFormatter::MeshAsciiFormatter(MeshBlockWriter& writer)
+  : writer(writer), chunkSize(16384), threads(QThread::idealThreadCount())
+{
+}
+
+MeshAsciiFormatter::~MeshAsciiFormatter()
+{
+}
+
+void MeshAsciiFormatter::setChunkSize(std::size_t size)
+{
+    chunkSize = std::max<std::size_t>(size, 1);
+}
+
+void MeshAsciiFormatter::setThreads(int num)
+{
+    threads = num;
+}
+
+std::size_t MeshAsciiFormatter::countChunks(std::size_t count) const
+{
+    return (count + chunkSize - 1) / chunkSize;
+}
+
+void MeshAsciiFormatter::format(std::size_t count, const Formatter& func, Base::SequencerLauncher* seq)
+{
+    auto formatChunk = [&func](AsciiChunk& chunk) {
+        std::ostringstream str;
+        str.imbue(std::locale::classic());
+        str.precision(6);
+        str.setf(std::ios::fixed | std::ios::showpoint);
+        func(chunk.begin, chunk.end, str);
+        chunk.text = str.str();
+    };
+
+    // Only a limited number of chunks is kept in memory at a time so that the
+    // memory overhead doesn't depend on the mesh size
+    std::size_t numThreads = static_cast<std::size_t>(std::max(threads, 1));
+    std::size_t batchSize = numThreads > 1 ? 2 * numThreads : 1;
+    std::vector<AsciiChunk> batch;
+    batch.reserve(batchSize);
+
+    std::size_t pos = 0;
+    while (pos < count) {
+        batch.clear();
+        while (batch.size() < batchSize && pos < count) {
+            AsciiChunk chunk;
+            chunk.begin = pos;
+            chunk.end = std::min(pos + chunkSize, count);
+            batch.push_back(chunk);
+            pos = chunk.end;
+        }
+
+        if (numThreads > 1 && batch.size() > 1) {
+            QtConcurrent::blockingMap(batch, formatChunk);
+        }
+        else {
+            std::for_each(batch.begin(), batch.end(), formatChunk);
+        }
+
+        for (std::vector<AsciiChunk>::iterator it = batch.begin(); it != batch.end(); ++it) {
+            writer.write(it->text);
+            if (seq)
+                seq->next(true); // allow to cancel
+        }
+    }
+}
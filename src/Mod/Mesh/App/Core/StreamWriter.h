@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_STREAMWRITER_H
+#define MESH_STREAMWRITER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Base/Matrix.h>
+#include <Base/Swap.h>
+#include <Base/Vector3D.h>
+
+namespace Base {
+class SequencerLauncher;
+}
+
+namespace MeshCore
+{
+
+/**
+ * The MeshBlockWriter class collects the data to be written in a large memory
+ * block and passes it to the output stream only when the block is full. This
+ * avoids the overhead of the many small write operations the formatted
+ * stream operators would cause for huge meshes.
+ */
+class MeshExport MeshBlockWriter
+{
+public:
+    enum ByteOrder {
+        NativeEndian,
+        LittleEndian
+    };
+
+    MeshBlockWriter(std::ostream& out, std::size_t blockSize = DefaultBlockSize);
+    /// Flushes the pending data
+    ~MeshBlockWriter();
+
+    /// Sets the byte order used by \ref put()
+    void setByteOrder(ByteOrder);
+    /// Appends raw data
+    void write(const char* data, std::size_t len);
+    /// Appends the characters of a string
+    void write(const std::string& str)
+    { write(str.data(), str.size()); }
+    /// Appends a value of a built-in type in the configured byte order
+    template <typename T>
+    void put(T value)
+    {
+        if (swapBytes)
+            Base::SwapEndian(value);
+        write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    /// Passes the collected data to the stream
+    bool flush();
+    /// Returns true if no error occurred on the stream
+    bool good() const;
+
+    static const std::size_t DefaultBlockSize = 4 * 1024 * 1024;
+
+private:
+    MeshBlockWriter(const MeshBlockWriter&);
+    void operator = (const MeshBlockWriter&);
+
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+    std::size_t used;
+    bool swapBytes;
+};
+
+/**
+ * The MeshAsciiFormatter class converts a range of mesh elements into text
+ * using several threads. The range is split into chunks that are formatted
+ * concurrently and afterwards written in their original order to a
+ * \ref MeshBlockWriter. So, the output is identical to a sequential run.
+ *
+ * Every chunk is formatted to a stream with the classic locale and a fixed
+ * notation with six digits, i.e. the same settings the mesh writers use.
+ */
+class MeshExport MeshAsciiFormatter
+{
+public:
+    /// Formats the elements in the range [begin, end) to the given stream
+    typedef std::function<void (std::size_t begin, std::size_t end, std::ostream&)> Formatter;
+
+    MeshAsciiFormatter(MeshBlockWriter& writer);
+    ~MeshAsciiFormatter();
+
+    /// Sets the number of elements per chunk
+    void setChunkSize(std::size_t);
+    /// Sets the number of threads, a value less than 2 disables multi-threading
+    void setThreads(int);
+    /// Returns the number of chunks needed for the given number of elements
+    std::size_t countChunks(std::size_t count) const;
+    /**
+     * Formats \a count elements and writes the result. For every written chunk
+     * the sequencer is advanced by one step if given, i.e. it should be
+     * started with \ref countChunks() steps.
+     */
+    void format(std::size_t count, const Formatter& func, Base::SequencerLauncher* seq = nullptr);
+
+private:
+    MeshBlockWriter& writer;
+    std::size_t chunkSize;
+    int threads;
+};
+
+/**
+ * The MeshPointTransform class applies an optional transformation to points
+ * on the fly. This avoids to create a transformed copy of the point array.
+ */
+class MeshPointTransform
+{
+public:
+    MeshPointTransform(const Base::Matrix4D& m, bool apply)
+        : mat(m), apply(apply)
+    {
+    }
+    Base::Vector3f operator() (const Base::Vector3f& p) const
+    {
+        return apply ? mat * p : p;
+    }
+
+private:
+    const Base::Matrix4D& mat;
+    bool apply;
+};
+
+} // namespace MeshCore
+
+
+#endif  // MESH_STREAMWRITER_H
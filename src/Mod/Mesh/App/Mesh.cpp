@@ -985,15 +985,17 @@ void MeshObject::smooth(int iterations, float d_max)
     _kernel.Smooth(iterations, d_max);
 }
 
-void MeshObject::decimate(float fTolerance, float fReduction)
+void MeshObject::decimate(float fTolerance, float fReduction, bool parallel)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
+    dm.setParallel(parallel);
     dm.simplify(fTolerance, fReduction);
 }
 
-void MeshObject::decimate(int targetSize)
+void MeshObject::decimate(int targetSize, bool parallel)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
+    dm.setParallel(parallel);
     dm.simplify(targetSize);
 }
 
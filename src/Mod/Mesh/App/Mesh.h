@@ -216,8 +216,8 @@ public:
     void movePoint(unsigned long, const Base::Vector3d& v);
     void setPoint(unsigned long, const Base::Vector3d& v);
     void smooth(int iterations, float d_max);
-    void decimate(float fTolerance, float fReduction);
-    void decimate(int targetSize);
+    void decimate(float fTolerance, float fReduction, bool parallel = false);
+    void decimate(int targetSize, bool parallel = false);
     Base::Vector3d getPointNormal(unsigned long) const;
     std::vector<Base::Vector3d> getPointNormals() const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
@@ -1725,9 +1725,10 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
     int iter=1;
     double lambda = 0;
     double micro = 0;
-    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro",NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sidd",keywords_smooth,
-                                     &method, &iter, &lambda, &micro))
+    PyObject* parallel = Py_False;
+    static char* keywords_smooth[] = {"Method","Iteration","Lambda","Micro","Parallel",NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|siddO!",keywords_smooth,
+                                     &method, &iter, &lambda, &micro, &PyBool_Type, &parallel))
         return 0;
 
     PY_TRY {
@@ -1735,12 +1736,14 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
         MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
         if (strcmp(method, "Laplace") == 0) {
             MeshCore::LaplaceSmoothing smooth(kernel);
+            smooth.SetParallel(PyObject_IsTrue(parallel) ? true : false);
             if (lambda > 0)
                 smooth.SetLambda(lambda);
             smooth.Smooth(iter);
         }
         else if (strcmp(method, "Taubin") == 0) {
             MeshCore::TaubinSmoothing smooth(kernel);
+            smooth.SetParallel(PyObject_IsTrue(parallel) ? true : false);
             if (lambda > 0)
                 smooth.SetLambda(lambda);
             if (micro > 0)
@@ -1749,6 +1752,7 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
         }
         else if (strcmp(method, "PlaneFit") == 0) {
             MeshCore::PlaneFitSmoothing smooth(kernel);
+            smooth.SetParallel(PyObject_IsTrue(parallel) ? true : false);
             smooth.Smooth(iter);
         }
         else {
@@ -1761,26 +1765,31 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
 
 PyObject*  MeshPy::decimate(PyObject *args)
 {
-    float fTol, fRed;
-    if (PyArg_ParseTuple(args, "ff", &fTol,&fRed)) {
+    // The target size is tried first because 'f' also accepts an integer and
+    // a bool, i.e. decimate(targetSize, True) would be taken for a reduction.
+    int targetSize;
+    PyObject* parallel = Py_False;
+    if (PyTuple_Size(args) > 0 && !PyFloat_Check(PyTuple_GetItem(args, 0)) &&
+        PyArg_ParseTuple(args, "i|O!", &targetSize, &PyBool_Type, &parallel)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(fTol, fRed);
+            getMeshObjectPtr()->decimate(targetSize, PyObject_IsTrue(parallel) ? true : false);
         } PY_CATCH;
 
         Py_Return;
     }
 
     PyErr_Clear();
-    int targetSize;
-    if (PyArg_ParseTuple(args, "i", &targetSize)) {
+    float fTol, fRed;
+    parallel = Py_False;
+    if (PyArg_ParseTuple(args, "ff|O!", &fTol, &fRed, &PyBool_Type, &parallel)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(targetSize);
+            getMeshObjectPtr()->decimate(fTol, fRed, PyObject_IsTrue(parallel) ? true : false);
         } PY_CATCH;
 
         Py_Return;
     }
 
-    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float) or decimate(targetSize=int)");
+    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float, [parallel=bool]) or decimate(targetSize=int, [parallel=bool])");
     return nullptr;
 }
 
@@ -334,3 +334,95 @@ class PolynomialFitCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+class MeshExportTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 50)
+        self.mesh.translate(1.0, 2.0, 3.0)
+
+    def testWriteRead(self):
+        for ext in ["stl", "ast", "obj", "ply"]:
+            name = tempfile.gettempdir() + os.sep + "mesh_export." + ext
+            self.mesh.write(name)
+            mesh = Mesh.Mesh(name)
+            os.remove(name)
+            self.assertEqual(mesh.CountFacets, self.mesh.CountFacets, "Wrong number of facets in %s file" % ext)
+            self.assertAlmostEqual(mesh.BoundBox.XMin, self.mesh.BoundBox.XMin, 3)
+            self.assertAlmostEqual(mesh.BoundBox.ZMax, self.mesh.BoundBox.ZMax, 3)
+            self.assertAlmostEqual(mesh.Area, self.mesh.Area, 1)
+
+    def tearDown(self):
+        pass
+
+class MeshDecimateTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 200)
+
+    def testDecimateParallel(self):
+        count = self.mesh.CountFacets
+        mesh = self.mesh.copy()
+        mesh.decimate(count // 4, True)
+        # a reduction of 1.0 would leave almost nothing of the mesh
+        self.assertLessEqual(mesh.CountFacets, count // 4)
+        self.assertGreater(mesh.CountFacets, count // 4 - 100)
+        self.assertEqual(mesh.CountPoints, len(mesh.Points))
+        self.assertAlmostEqual(mesh.BoundBox.DiagonalLength, self.mesh.BoundBox.DiagonalLength, 0)
+
+        # the mesh is only split into partitions with several cores
+        import multiprocessing
+        if multiprocessing.cpu_count() > 1:
+            sequential = self.mesh.copy()
+            sequential.decimate(count // 4)
+            self.assertNotEqual([p.Vector for p in mesh.Points], [p.Vector for p in sequential.Points],
+                                "The partitions weren't simplified separately")
+
+    def testDecimateSequential(self):
+        count = self.mesh.CountFacets
+        mesh = self.mesh.copy()
+        mesh.decimate(count // 4)
+        self.assertLess(mesh.CountFacets, count // 2)
+
+    def testDecimateAbort(self):
+        count = self.mesh.CountFacets
+        mesh = self.mesh.copy()
+        progress = FreeCAD.Base.ProgressIndicator()
+        progress.start("Decimate", 0)
+        # the decimation aborts at its first progress report, after the
+        # partitions are merged if they are simplified fast enough
+        progress.cancel()
+        try:
+            with self.assertRaises(RuntimeError):
+                mesh.decimate(count // 4, True)
+        finally:
+            progress.stop()
+        self.assertEqual(mesh.CountFacets, count)
+        self.assertEqual(mesh.CountPoints, self.mesh.CountPoints)
+
+    def tearDown(self):
+        pass
+
+class MeshSmoothTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 100)
+
+    def testSmoothParallel(self):
+        for method in ["Laplace", "Taubin", "PlaneFit"]:
+            mesh1 = self.mesh.copy()
+            mesh1.smooth(Method=method, Iteration=3, Parallel=True)
+            mesh2 = self.mesh.copy()
+            mesh2.smooth(Method=method, Iteration=3, Parallel=True)
+            self.assertEqual(mesh1.CountPoints, self.mesh.CountPoints)
+            # the result must not depend on the scheduling of the threads
+            for p1, p2 in zip(mesh1.Points, mesh2.Points):
+                self.assertEqual(p1.Vector, p2.Vector, "Parallel %s smoothing is not deterministic" % method)
+            self.assertAlmostEqual(mesh1.BoundBox.DiagonalLength, self.mesh.BoundBox.DiagonalLength, 0)
+
+    def testCurvaturePerVertex(self):
+        curv = self.mesh.getCurvaturePerVertex()
+        self.assertEqual(len(curv), self.mesh.CountPoints)
+        for c in curv:
+            self.assertAlmostEqual(math.fabs(c[0]), 0.1, 2)
+            self.assertAlmostEqual(math.fabs(c[1]), 0.1, 2)
+
+    def tearDown(self):
+        pass
@@ -439,12 +439,10 @@ bool MeshRenderer::matchMaterial(SoState* state) const
 
 bool MeshRenderer::shouldRenderDirectly(bool direct)
 {
-#ifdef RENDER_GL_VAO
-    Q_UNUSED(direct);
-    return false;
-#else
+    // SoFCMeshObjectShape renders huge meshes with any material binding from
+    // vertex buffer objects, too, but avoids the copy of the mesh data in the
+    // Inventor fields
     return direct;
-#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -25,7 +25,9 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <array>
 # include <climits>
+# include <unordered_map>
 # ifdef FC_OS_WIN32
 # include <windows.h>
 # endif
@@ -43,6 +45,8 @@
 # include <Inventor/actions/SoPickAction.h>
 # include <Inventor/actions/SoWriteAction.h>
 # include <Inventor/details/SoFaceDetail.h>
+# include <Inventor/elements/SoGLLazyElement.h>
+# include <Inventor/errors/SoDebugError.h>
 # include <Inventor/errors/SoReadError.h>
 # include <Inventor/misc/SoState.h>
 #endif
@@ -53,6 +57,8 @@
 #include <Gui/SoFCInteractiveElement.h>
 #include <Gui/SoFCSelectionAction.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/Functional.h>
+#include <Mod/Mesh/App/Core/PointArrays.h>
 #include <Mod/Mesh/App/Core/MeshIO.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Elements.h>
@@ -592,10 +598,16 @@ void SoFCMeshObjectShape::initClass()
 
 SoFCMeshObjectShape::SoFCMeshObjectShape()
     : renderTriangleLimit(UINT_MAX)
+    , proxyTriangleLimit(1000000)
     , selectBuf(0)
     , updateGLArray(false)
+    , updateRender(false)
+    , updateProxy(false)
+    , renderCcw(true)
+    , proxyCcw(true)
 {
     SO_NODE_CONSTRUCTOR(SoFCMeshObjectShape);
+    SO_NODE_ADD_FIELD(updateColors, (false));
     setName(SoFCMeshObjectShape::getClassTypeId().getName());
 }
 
@@ -607,6 +619,7 @@ void SoFCMeshObjectShape::notify(SoNotList * node)
 {
     inherited::notify(node);
     updateGLArray = true;
+    updateRender = true;
 }
 
 #define RENDER_GLARRAYS
@@ -641,8 +654,17 @@ void SoFCMeshObjectShape::GLRender(SoGLRenderAction *action)
         if (SoShapeHintsElement::getVertexOrdering(state) == SoShapeHintsElement::CLOCKWISE) 
             ccw = false;
 
-        if (mode == false || mesh->countFacets() <= this->renderTriangleLimit) {
-            if (mbind != OVERALL) {
+        // use VBO for fast rendering if possible
+        SbBool useVBO = canRenderVBO(action);
+
+        if (mode && useVBO && mbind == OVERALL && proxyKernel.CountFacets() > 0) {
+            renderProxyVBO(action, ccw);
+        }
+        else if (mode == false || mesh->countFacets() <= this->renderTriangleLimit) {
+            if (useVBO) {
+                renderFacesVBO(action, mesh, mbind, ccw);
+            }
+            else if (mbind != OVERALL) {
                 drawFaces(mesh, &mb, mbind, needNormals, ccw);
             }
             else {
@@ -963,6 +985,290 @@ void SoFCMeshObjectShape::renderCoordsGLArray(SoGLRenderAction *action)
     glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+namespace MeshGui {
+
+/**
+ * Writes the points with their normals as interleaved array in GL_N3F_V3F format.
+ * The normal of a point is the area-weighted average of its adjacent facets.
+ */
+static void createInterleavedArray(const MeshCore::MeshPointArray& points,
+                                   const MeshCore::MeshFacetArray& facets,
+                                   const MeshCore::MeshCompactPointToFacets& pt2f,
+                                   SbBool ccw, std::vector<float>& vertex)
+{
+    vertex.resize(6 * points.size());
+    MeshCore::parallel_for(points.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            Base::Vector3f n;
+            for (std::size_t pos = pt2f.Begin(i); pos != pt2f.End(i); ++pos) {
+                const MeshCore::MeshFacet& face = facets[pt2f.Facet(pos)];
+                const MeshCore::MeshPoint& v0 = points[face._aulPoints[0]];
+                const MeshCore::MeshPoint& v1 = points[face._aulPoints[1]];
+                const MeshCore::MeshPoint& v2 = points[face._aulPoints[2]];
+                n += (v1 - v0) % (v2 - v0);
+            }
+            n.Normalize();
+            if (!ccw)
+                n = -n;
+
+            float* v = &vertex[6 * i];
+            v[0] = n.x; v[1] = n.y; v[2] = n.z;
+            v[3] = points[i].x; v[4] = points[i].y; v[5] = points[i].z;
+        }
+    });
+}
+
+static void createIndexArray(const MeshCore::MeshFacetArray& facets, std::vector<int32_t>& index)
+{
+    index.resize(3 * facets.size());
+    MeshCore::parallel_for(facets.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            for (int j = 0; j < 3; j++)
+                index[3 * i + j] = static_cast<int32_t>(facets[i]._aulPoints[j]);
+        }
+    });
+}
+
+/**
+ * Creates a coarse approximation of the mesh with roughly \a maxFacets triangles
+ * by vertex clustering. All points inside a cell of a regular grid are merged to
+ * their average and triangles that collapse or that are duplicated are removed.
+ * This needs a single pass over the mesh and is therefore fast enough for huge
+ * meshes.
+ */
+static void createProxyMesh(const MeshCore::MeshKernel& kernel, unsigned int maxFacets,
+                            MeshCore::MeshPointArray& proxyPoints,
+                            MeshCore::MeshFacetArray& proxyFacets)
+{
+    const MeshCore::MeshPointArray& points = kernel.GetPoints();
+    const MeshCore::MeshFacetArray& facets = kernel.GetFacets();
+
+    // A regular triangulation with a grid size of h has about 2*A/h^2 triangles
+    const Base::BoundBox3f& bbox = kernel.GetBoundBox();
+    float area = kernel.GetSurface();
+    float size = std::sqrt(2.0f * area / static_cast<float>(std::max<unsigned int>(maxFacets, 2)));
+    if (!(size > 0.0f))
+        size = std::max<float>(bbox.CalcDiagonalLength(), 1.0f);
+
+    uint64_t nx = static_cast<uint64_t>(bbox.LengthX() / size) + 1;
+    uint64_t ny = static_cast<uint64_t>(bbox.LengthY() / size) + 1;
+
+    std::unordered_map<uint64_t, unsigned long> cells;
+    std::vector<unsigned long> cluster(points.size());
+    std::vector<Base::Vector3d> sum;
+    std::vector<unsigned long> count;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        const MeshCore::MeshPoint& p = points[i];
+        uint64_t ix = static_cast<uint64_t>((p.x - bbox.MinX) / size);
+        uint64_t iy = static_cast<uint64_t>((p.y - bbox.MinY) / size);
+        uint64_t iz = static_cast<uint64_t>((p.z - bbox.MinZ) / size);
+        uint64_t key = ix + nx * (iy + ny * iz);
+        auto it = cells.insert(std::make_pair(key, static_cast<unsigned long>(sum.size())));
+        if (it.second) {
+            sum.emplace_back(0.0, 0.0, 0.0);
+            count.push_back(0);
+        }
+
+        unsigned long id = it.first->second;
+        cluster[i] = id;
+        sum[id] += Base::Vector3d(p.x, p.y, p.z);
+        count[id]++;
+    }
+
+    proxyPoints.resize(sum.size());
+    for (std::size_t i = 0; i < sum.size(); i++) {
+        Base::Vector3d p = sum[i] / static_cast<double>(count[i]);
+        proxyPoints[i].Set(static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z));
+    }
+
+    // Triangles that collapse are skipped and of all triangles that map to the
+    // same points only the first one is kept to preserve its orientation. Sorting
+    // the keys avoids an allocation per triangle as needed by a tree based set.
+    typedef std::pair<std::array<unsigned long, 3>, unsigned long> TriangleKey;
+    std::vector<TriangleKey> keys;
+    keys.reserve(facets.size());
+    for (std::size_t i = 0; i < facets.size(); i++) {
+        const MeshCore::MeshFacet& face = facets[i];
+        std::array<unsigned long, 3> key = {{
+            cluster[face._aulPoints[0]],
+            cluster[face._aulPoints[1]],
+            cluster[face._aulPoints[2]]
+        }};
+        if (key[0] == key[1] || key[1] == key[2] || key[2] == key[0])
+            continue;
+        std::sort(key.begin(), key.end());
+        keys.push_back(std::make_pair(key, static_cast<unsigned long>(i)));
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    proxyFacets.clear();
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (i > 0 && keys[i].first == keys[i-1].first)
+            continue;
+        const MeshCore::MeshFacet& face = facets[keys[i].second];
+        proxyFacets.push_back(MeshCore::MeshFacet(cluster[face._aulPoints[0]],
+                                                  cluster[face._aulPoints[1]],
+                                                  cluster[face._aulPoints[2]]));
+    }
+}
+
+/**
+ * Adds the diffuse colors of the current material to the interleaved array \a vertex
+ * in GL_N3F_V3F format and writes the result in GL_C4F_N3F_V3F format. With per-face
+ * colors the points are duplicated for each facet and \a index is rewritten.
+ */
+static void createColorArray(SoState* state, const MeshCore::MeshFacetArray& facets,
+                             bool perFace, const std::vector<float>& vertex,
+                             std::vector<float>& color, std::vector<int32_t>& index)
+{
+    const SbColor * pcolors = 0;
+    const float * transp = 0;
+    int numcolors = 0;
+    SoGLLazyElement* gl = SoGLLazyElement::getInstance(state);
+    if (gl) {
+        pcolors = gl->getDiffusePointer();
+        numcolors = gl->getNumDiffuse();
+        transp = gl->getTransparencyPointer();
+    }
+
+    float t = transp ? transp[0] : 0;
+    SbColor overall(1.0f, 1.0f, 1.0f);
+    if (pcolors && numcolors > 0)
+        overall = pcolors[0];
+    std::size_t numPts = vertex.size() / 6;
+    std::size_t numElements = perFace ? facets.size() : numPts;
+    if (!pcolors || numcolors < static_cast<int>(numElements)) {
+        SoDebugError::postWarning("SoFCMeshObjectShape::createColorArray",
+                                  "The number of elements (%d) doesn't match with the number of colors (%d).",
+                                  static_cast<int>(numElements), numcolors);
+        numcolors = 0;
+    }
+
+    auto writeVertex = [&](float* dst, std::size_t point, std::size_t colorIndex) {
+        const SbColor& c = numcolors > 0 ? pcolors[colorIndex] : overall;
+        dst[0] = c[0]; dst[1] = c[1]; dst[2] = c[2]; dst[3] = t;
+        std::copy(vertex.begin() + 6 * point, vertex.begin() + 6 * point + 6, dst + 4);
+    };
+
+    if (perFace) {
+        color.resize(30 * facets.size());
+        index.resize(3 * facets.size());
+        MeshCore::parallel_for(facets.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                for (int j = 0; j < 3; j++) {
+                    writeVertex(&color[10 * (3 * i + j)], facets[i]._aulPoints[j], i);
+                    index[3 * i + j] = static_cast<int32_t>(3 * i + j);
+                }
+            }
+        });
+    }
+    else {
+        color.resize(10 * numPts);
+        MeshCore::parallel_for(numPts, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++)
+                writeVertex(&color[10 * i], i, i);
+        });
+    }
+}
+
+}
+
+bool SoFCMeshObjectShape::canRenderVBO(SoGLRenderAction *action)
+{
+    // get the VBO status of the viewer
+    SbBool useVBO = true;
+    Gui::SoGLVBOActivatedElement::get(action->getState(), useVBO);
+    return useVBO && render.canRenderGLArray(action);
+}
+
+/**
+ * Renders the complete mesh from a vertex buffer object. The buffer is created
+ * once and only updated if the mesh, the material binding or the colors have changed.
+ */
+void SoFCMeshObjectShape::renderFacesVBO(SoGLRenderAction *action, const Mesh::MeshObject* mesh,
+                                         Binding mbind, SbBool ccw)
+{
+    SoState* state = action->getState();
+    bool create = false;
+    if (updateRender || renderCcw != ccw || !render.matchMaterial(state)) {
+        updateRender = false;
+        renderCcw = ccw;
+        render.update();
+        create = true;
+    }
+    else if (render.needUpdate(action)) {
+        create = true;
+    }
+
+    if (create) {
+        const MeshCore::MeshKernel& kernel = mesh->getKernel();
+        MeshCore::MeshCompactPointToFacets pt2f(kernel);
+
+        std::vector<float> vertex;
+        std::vector<int32_t> index;
+        createInterleavedArray(kernel.GetPoints(), kernel.GetFacets(), pt2f, ccw, vertex);
+        createIndexArray(kernel.GetFacets(), index);
+
+        SoMaterialBindingElement::Binding matbind = SoMaterialBindingElement::OVERALL;
+        if (mbind != OVERALL) {
+            std::vector<float> color;
+            createColorArray(state, kernel.GetFacets(), mbind == PER_FACE_INDEXED, vertex, color, index);
+            vertex.swap(color);
+            matbind = SoMaterialBindingElement::get(state);
+        }
+
+        render.generateGLArrays(action, matbind, vertex, index);
+    }
+
+    render.renderFacesGLArray(action);
+}
+
+/**
+ * Creates a coarse proxy of \a mesh with about \a proxyTriangleLimit triangles if the
+ * mesh exceeds this limit. The proxy is rendered in interactive mode instead of the
+ * complete mesh. This must be called whenever the mesh has changed.
+ */
+void SoFCMeshObjectShape::createProxy(const Mesh::MeshObject* mesh)
+{
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    if (mesh && mesh->countFacets() > this->proxyTriangleLimit)
+        createProxyMesh(mesh->getKernel(), this->proxyTriangleLimit, points, facets);
+    proxyKernel.Adopt(points, facets, false);
+    updateProxy = true;
+}
+
+/**
+ * Renders the coarse proxy of the mesh from a vertex buffer object. This is used
+ * for huge meshes in interactive mode, e.g. while rotating the camera.
+ */
+void SoFCMeshObjectShape::renderProxyVBO(SoGLRenderAction *action, SbBool ccw)
+{
+    bool create = false;
+    if (updateProxy || proxyCcw != ccw) {
+        updateProxy = false;
+        proxyCcw = ccw;
+        proxy.update();
+        create = true;
+    }
+    else if (proxy.needUpdate(action)) {
+        create = true;
+    }
+
+    if (create) {
+        MeshCore::MeshCompactPointToFacets pt2f(proxyKernel);
+
+        std::vector<float> vertex;
+        std::vector<int32_t> index;
+        createInterleavedArray(proxyKernel.GetPoints(), proxyKernel.GetFacets(), pt2f, ccw, vertex);
+        createIndexArray(proxyKernel.GetFacets(), index);
+        proxy.generateGLArrays(action, SoMaterialBindingElement::OVERALL, vertex, index);
+    }
+
+    proxy.renderFacesGLArray(action);
+}
+
 void SoFCMeshObjectShape::doAction(SoAction * action)
 {
     if (action->getTypeId() == Gui::SoGLSelectAction::getClassTypeId()) {
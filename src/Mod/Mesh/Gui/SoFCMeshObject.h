@@ -24,6 +24,7 @@
 #define MESHGUI_SOFCMESHOBJECT_H
 
 #include <Inventor/fields/SoSField.h>
+#include <Inventor/fields/SoSFBool.h>
 #include <Inventor/fields/SoSFUInt32.h>
 #include <Inventor/fields/SoSubField.h>
 #include <Inventor/fields/SoSFVec3f.h>
@@ -33,6 +34,7 @@
 #include <Inventor/elements/SoReplacedElement.h>
 #include <Mod/Mesh/App/Core/Elements.h>
 #include <Mod/Mesh/App/Mesh.h>
+#include "SoFCIndexedFaceSet.h"
 
 typedef unsigned int GLuint;
 typedef int GLint;
@@ -155,6 +157,14 @@ protected:
  * The limit of maximum allowed triangles can be specified in \a renderTriangleLimit, the
  * default value is set to 100.000.
  *
+ * If vertex buffer objects are supported the complete mesh is rendered from an interleaved
+ * buffer of points, cached vertex normals and optionally per-face or per-vertex colors that
+ * is only rebuilt when the mesh or the material changes. In interactive mode a mesh with an
+ * overall material that exceeds \a proxyTriangleLimit triangles is rendered from a coarse
+ * proxy with about \a proxyTriangleLimit triangles. The default value is set to 1.000.000.
+ * The proxy is created by vertex clustering in createProxy() which must be called when the
+ * mesh changes.
+ *
  * The GLRender() method checks the status of the SoFCInteractiveElement to decide to be in
  * interactive mode or not.
  * To take advantage of this facility the client programmer must set the status of the
@@ -171,8 +181,12 @@ class MeshGuiExport SoFCMeshObjectShape : public SoShape {
 public:
     static void initClass();
     SoFCMeshObjectShape();
+    void createProxy(const Mesh::MeshObject*);
 
     unsigned int renderTriangleLimit;
+    unsigned int proxyTriangleLimit;
+    /// Connected to SoFCMaterialEngine to rebuild the vertex buffer when the colors change
+    SoSFBool updateColors;
 
 protected:
     virtual void doAction(SoAction * action);
@@ -213,6 +227,9 @@ private:
     void generateGLArrays(SoState * state);
     void renderFacesGLArray(SoGLRenderAction *action);
     void renderCoordsGLArray(SoGLRenderAction *action);
+    bool canRenderVBO(SoGLRenderAction *action);
+    void renderFacesVBO(SoGLRenderAction *action, const Mesh::MeshObject*, Binding bind, SbBool ccw);
+    void renderProxyVBO(SoGLRenderAction *action, SbBool ccw);
 
 private:
     GLuint *selectBuf;
@@ -222,6 +239,14 @@ private:
     std::vector<int32_t> index_array;
     std::vector<float> vertex_array;
     SbBool updateGLArray;
+    // Vertex buffer handling
+    MeshRenderer render;
+    MeshRenderer proxy;
+    MeshCore::MeshKernel proxyKernel;
+    SbBool updateRender;
+    SbBool updateProxy;
+    SbBool renderCcw;
+    SbBool proxyCcw;
 };
 
 class MeshGuiExport SoFCMeshSegmentShape : public SoShape {
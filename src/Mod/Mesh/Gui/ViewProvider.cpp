@@ -2358,7 +2358,10 @@ void ViewProviderMeshObject::attach(App::DocumentObject *pcFeat)
     // read the threshold from the preferences
     Base::Reference<ParameterGrp> hGrp = Gui::WindowParameter::getDefaultParameter()->GetGroup("Mod/Mesh");
     int size = hGrp->GetInt("RenderTriangleLimit", -1);
-    if (size > 0) pcMeshShape->renderTriangleLimit = (unsigned int)(pow(10.0f,size));
+    if (size > 0) {
+        pcMeshShape->renderTriangleLimit = (unsigned int)(pow(10.0f,size));
+        pcMeshShape->proxyTriangleLimit = (unsigned int)(pow(10.0f,size));
+    }
 }
 
 void ViewProviderMeshObject::updateData(const App::Property* prop)
@@ -2369,6 +2372,7 @@ void ViewProviderMeshObject::updateData(const App::Property* prop)
         this->pcMeshNode->mesh.setValue(Base::Reference<const Mesh::MeshObject>(mesh->getValuePtr()));
         // Needs to update internal bounding box caches
         this->pcMeshShape->touch();
+        this->pcMeshShape->createProxy(mesh->getValuePtr());
     }
 }
 
@@ -101,11 +101,12 @@ ViewProviderMeshFaceSet::ViewProviderMeshFaceSet()
     pcMeshFaces = new SoFCIndexedFaceSet;
     pcMeshFaces->ref();
 
-    // setup engine to notify 'pcMeshFaces' node about material changes.
+    // setup engine to notify 'pcMeshFaces' and 'pcMeshShape' nodes about material changes.
     // When the affected nodes are deleted the engine will be deleted, too.
     SoFCMaterialEngine* engine = new SoFCMaterialEngine();
     engine->diffuseColor.connectFrom(&pcShapeMaterial->diffuseColor);
     pcMeshFaces->updateGLArray.connectFrom(&engine->trigger);
+    pcMeshShape->updateColors.connectFrom(&engine->trigger);
 }
 
 ViewProviderMeshFaceSet::~ViewProviderMeshFaceSet()
@@ -128,6 +129,7 @@ void ViewProviderMeshFaceSet::attach(App::DocumentObject *pcFeat)
     int size = hGrp->GetInt("RenderTriangleLimit", -1);
     if (size > 0) {
         pcMeshShape->renderTriangleLimit = (unsigned int)(pow(10.0f,size));
+        pcMeshShape->proxyTriangleLimit = (unsigned int)(pow(10.0f,size));
         static_cast<SoFCIndexedFaceSet*>(pcMeshFaces)->renderTriangleLimit = (unsigned int)(pow(10.0f,size));
     }
 }
@@ -143,6 +145,7 @@ void ViewProviderMeshFaceSet::updateData(const App::Property* prop)
             this->pcMeshNode->mesh.setValue(mesh);
             // Needs to update internal bounding box caches
             this->pcMeshShape->touch();
+            this->pcMeshShape->createProxy(mesh);
             pcMeshCoord->point.setNum(0);
             pcMeshFaces->coordIndex.setNum(0);
         }
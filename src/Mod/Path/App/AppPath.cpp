@@ -65,6 +65,7 @@ PyMOD_INIT_FUNC(Path)
     // load dependent module
     try {
         Base::Interpreter().runString("import Part");
+        Base::Interpreter().runString("import Mesh");
     }
     catch(const Base::Exception& e) {
         PyErr_SetString(PyExc_ImportError, e.what());
@@ -29,10 +29,12 @@
 #include <CXX/Extensions.hxx>
 #include <CXX/Objects.hxx>
 
+#include <Base/BoundBoxPy.h>
 #include <Base/Console.h>
 #include <Base/VectorPy.h>
 #include <Base/FileInfo.h>
 #include <Base/Interpreter.h>
+#include <Base/Stream.h>
 #include <App/Document.h>
 #include <App/DocumentObjectPy.h>
 #include <App/Application.h>
@@ -41,6 +43,8 @@
 #include <Mod/Part/App/TopoShape.h>
 #include <Mod/Part/App/TopoShapePy.h>
 #include <Mod/Part/App/PartPyCXX.h>
+#include <Mod/Mesh/App/Mesh.h>
+#include <Mod/Mesh/App/MeshPy.h>
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Edge.hxx>
@@ -60,6 +64,9 @@
 #include "FeaturePath.h"
 #include "FeaturePathCompound.h"
 #include "Area.h"
+#include "DropCutter.h"
+#include "PostFormatter.h"
+#include "ToolPy.h"
 
 #define PATH_CATCH catch (Standard_Failure &e)                      \
     {                                                               \
@@ -135,6 +142,70 @@ public:
             PARAM_PY_DOC(ARG, AREA_PARAMS_ARC_PLANE)
             PARAM_PY_DOC(ARG, AREA_PARAMS_SORT)
         );
+        add_keyword_method("dropCutter",&Module::dropCutter,
+            "dropCutter(mesh, tool, points, threads=0)\n"
+            "\nReturns the list of points where the tool touches the mesh when dropped along Z.\n"
+            "\n* mesh: the surface as Mesh.Mesh object.\n"
+            "\n* tool: Path.Tool. A BallEndMill is a ball, all other tools are flat end mills\n"
+            "  with the corner radius of the tool.\n"
+            "\n* points: list of Vectors, the z value is the lowest height of the tool tip.\n"
+            "\n* threads (0): number of threads, 0 means one per CPU core.\n"
+        );
+        add_keyword_method("surfaceScan",&Module::surfaceScan,
+            "surfaceScan(mesh, tool, stepover, sample_interval, bound=None, min_z=None, safe_height=None,\n"
+            "            zigzag=True, tolerance=0.01, feedrate=0.0, feedrate_v=0.0, threads=0)\n"
+            "\nReturns a Path object that scans the mesh along lines parallel to the X axis.\n"
+            "\n* mesh, tool: see dropCutter().\n"
+            "\n* stepover: distance between the lines.\n"
+            "\n* sample_interval: distance between the points the tool is dropped at.\n"
+            "\n* bound (None): BoundBox of the area to scan, defaults to the bounding box of the mesh.\n"
+            "\n* min_z (None): lowest height of the tool tip, defaults to the bottom of the mesh.\n"
+            "\n* safe_height (None): height for rapid moves, defaults to a tool diameter above the mesh.\n"
+            "\n* zigzag (True): run every other line backwards and link the lines over the surface.\n"
+            "\n* tolerance (0.01): points closer than this to the line through their neighbours are removed.\n"
+            "\n* feedrate, feedrate_v (0.0): horizontal and vertical feed rate, 0 means not written.\n"
+            "\n* threads (0): number of threads, 0 means one per CPU core.\n"
+        );
+        add_keyword_method("waterline",&Module::waterline,
+            "waterline(mesh, tool, heights, sample_interval, bound=None, safe_height=None,\n"
+            "          tolerance=0.01, feedrate=0.0, feedrate_v=0.0, threads=0)\n"
+            "\nReturns a Path object that follows the mesh at the given heights, from the top\n"
+            "level to the bottom one. The material is on the left side of the moves.\n"
+            "\n* mesh, tool: see dropCutter().\n"
+            "\n* heights: list of heights of the tool tip.\n"
+            "\n* sample_interval: spacing of the grid the tool is dropped at to find the lines.\n"
+            "\n* bound (None): BoundBox of the area, defaults to the bounding box of the mesh enlarged\n"
+            "  by the tool radius.\n"
+            "\n* safe_height, feedrate, feedrate_v, threads: see surfaceScan().\n"
+            "\n* tolerance (0.01): accuracy of the lines.\n"
+        );
+        add_keyword_method("post",&Module::post,
+            "post(items, filename=None, precision=3, word_precision=None, pad_zero=True, inches=False,\n"
+            "     feed_scale=1.0, words=None, modal_words=None, modal=False, rapid_feed=False,\n"
+            "     comments=True, line_numbers=False, line_start=10, line_increment=10, separator=' ',\n"
+            "     templates=None)\n"
+            "\nWrites the G-code of paths for a controller without creating a Command object per command.\n"
+            "Returns the G-code as string, or None if it's written to a file.\n"
+            "\n* items: a Path object, a string or a list of them. Strings are written as they are, e.g.\n"
+            "  the preamble. The modal state is reset at the start of each path.\n"
+            "\n* filename (None): the file to write to.\n"
+            "\n* precision (3): number of decimals.\n"
+            "\n* word_precision (None): dictionary with the number of decimals of single words, e.g. {'T':0}.\n"
+            "\n* pad_zero (True): write trailing zeros of the decimals.\n"
+            "\n* inches (False): convert the lengths and the feed rate to inches.\n"
+            "\n* feed_scale (1.0): factor for the feed rate, e.g. 60 for a feed rate per minute.\n"
+            "\n* words (None): list of the words in the order they are written, other words are dropped.\n"
+            "  By default all words are written in alphabetical order.\n"
+            "\n* modal_words (None): list of the words that are only written if their value changes.\n"
+            "\n* modal (False): omit the command name if it's the same as the one of the last command.\n"
+            "\n* rapid_feed (False): write the feed rate of rapid moves. Feed rates <= 0 are never written.\n"
+            "\n* comments (True): write the comments.\n"
+            "\n* line_numbers (False): number the lines, starting with line_start.\n"
+            "\n* separator (' '): the text between the words.\n"
+            "\n* templates (None): dictionary of command names and the text that replaces their line.\n"
+            "  In the text, {line} is replaced by the line of the command and {W} by the value of the\n"
+            "  word W, e.g. {'M6':'M5\\n{line}\\nG43 H{T}'}. Use {{ and }} for braces.\n"
+        );
         initialize("This module is the Path module."); // register with Python
     }
 
@@ -429,6 +500,238 @@ private:
             return ret;
         } PATH_CATCH
     }
+
+    static Base::BoundBox3d getArea(PyObject *bound, const DropCutter &cutter, double margin=0.0)
+    {
+        if (bound)
+            return *static_cast<Base::BoundBoxPy*>(bound)->getBoundBoxPtr();
+        Base::BoundBox3d box = cutter.getBoundBox();
+        box.Enlarge(margin);
+        return box;
+    }
+
+    static double getHeight(PyObject *height, double defaultValue)
+    {
+        if (!height || height == Py_None)
+            return defaultValue;
+        return static_cast<double>(Py::Float(height));
+    }
+
+    Py::Object dropCutter(const Py::Tuple& args, const Py::Dict &kwds)
+    {
+        PyObject *pMesh, *pTool, *pPoints;
+        int threads = 0;
+        static char* kwd_list[] = {"mesh", "tool", "points", "threads", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!O!O|i", kwd_list,
+                &(Mesh::MeshPy::Type), &pMesh, &(ToolPy::Type), &pTool, &pPoints, &threads))
+            throw Py::Exception();
+
+        std::vector<Base::Vector3d> points;
+        Py::Sequence list(pPoints);
+        points.reserve(list.size());
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it)
+            points.push_back(Py::Vector(*it).toVector());
+
+        try {
+            const Mesh::MeshObject *mesh = static_cast<Mesh::MeshPy*>(pMesh)->getMeshObjectPtr();
+            DropCutter cutter(mesh->getKernel(), mesh->getTransform(),
+                    *static_cast<ToolPy*>(pTool)->getToolPtr());
+            cutter.drop(points, threads);
+
+            Py::List result;
+            for (const auto &pt : points)
+                result.append(Py::Vector(pt));
+            return result;
+        } PATH_CATCH
+    }
+
+    Py::Object surfaceScan(const Py::Tuple& args, const Py::Dict &kwds)
+    {
+        PyObject *pMesh, *pTool;
+        PyObject *bound = NULL;
+        PyObject *min_z = NULL;
+        PyObject *safe_height = NULL;
+        PyObject *zigzag = Py_True;
+        double stepover, sample_interval;
+        double tolerance = 0.01;
+        double feedrate = 0.0;
+        double feedrate_v = 0.0;
+        int threads = 0;
+        static char* kwd_list[] = {"mesh", "tool", "stepover", "sample_interval", "bound", "min_z",
+                "safe_height", "zigzag", "tolerance", "feedrate", "feedrate_v", "threads", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!O!dd|O!OOOdddi", kwd_list,
+                &(Mesh::MeshPy::Type), &pMesh, &(ToolPy::Type), &pTool, &stepover, &sample_interval,
+                &(Base::BoundBoxPy::Type), &bound, &min_z, &safe_height, &zigzag,
+                &tolerance, &feedrate, &feedrate_v, &threads))
+            throw Py::Exception();
+
+        try {
+            const Mesh::MeshObject *mesh = static_cast<Mesh::MeshPy*>(pMesh)->getMeshObjectPtr();
+            const Tool &tool = *static_cast<ToolPy*>(pTool)->getToolPtr();
+            DropCutter cutter(mesh->getKernel(), mesh->getTransform(), tool);
+            const Base::BoundBox3d &box = cutter.getBoundBox();
+
+            std::unique_ptr<Toolpath> path(new Toolpath);
+            cutter.scan(*path, getArea(bound, cutter), stepover, sample_interval,
+                    getHeight(min_z, box.MinZ), getHeight(safe_height, box.MaxZ + tool.Diameter),
+                    PyObject_IsTrue(zigzag) ? true : false, tolerance, feedrate, feedrate_v, threads);
+            return Py::asObject(new PathPy(path.release()));
+        } PATH_CATCH
+    }
+
+    Py::Object waterline(const Py::Tuple& args, const Py::Dict &kwds)
+    {
+        PyObject *pMesh, *pTool, *pHeights;
+        PyObject *bound = NULL;
+        PyObject *safe_height = NULL;
+        double sample_interval;
+        double tolerance = 0.01;
+        double feedrate = 0.0;
+        double feedrate_v = 0.0;
+        int threads = 0;
+        static char* kwd_list[] = {"mesh", "tool", "heights", "sample_interval", "bound",
+                "safe_height", "tolerance", "feedrate", "feedrate_v", "threads", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!O!Od|O!Odddi", kwd_list,
+                &(Mesh::MeshPy::Type), &pMesh, &(ToolPy::Type), &pTool, &pHeights, &sample_interval,
+                &(Base::BoundBoxPy::Type), &bound, &safe_height,
+                &tolerance, &feedrate, &feedrate_v, &threads))
+            throw Py::Exception();
+
+        std::vector<double> heights;
+        Py::Sequence list(pHeights);
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it)
+            heights.push_back(static_cast<double>(Py::Float(*it)));
+
+        try {
+            const Mesh::MeshObject *mesh = static_cast<Mesh::MeshPy*>(pMesh)->getMeshObjectPtr();
+            const Tool &tool = *static_cast<ToolPy*>(pTool)->getToolPtr();
+            DropCutter cutter(mesh->getKernel(), mesh->getTransform(), tool);
+            const Base::BoundBox3d &box = cutter.getBoundBox();
+
+            std::unique_ptr<Toolpath> path(new Toolpath);
+            // the lines run around the mesh at the distance of the tool radius
+            double margin = tool.Diameter / 2.0 + sample_interval;
+            cutter.waterlines(*path, heights, getArea(bound, cutter, margin), sample_interval,
+                    getHeight(safe_height, box.MaxZ + tool.Diameter),
+                    tolerance, feedrate, feedrate_v, threads);
+            return Py::asObject(new PathPy(path.release()));
+        } PATH_CATCH
+    }
+
+    static std::vector<std::string> getWords(PyObject *list)
+    {
+        std::vector<std::string> words;
+        if (list && list != Py_None) {
+            Py::Sequence seq(list);
+            for (Py::Sequence::iterator it = seq.begin(); it != seq.end(); ++it)
+                words.push_back(Py::String(*it).as_std_string());
+        }
+        return words;
+    }
+
+    static void postItems(PyObject *items, PostFormatter &formatter, std::ostream &out)
+    {
+        if (PyObject_TypeCheck(items, &(PathPy::Type))) {
+            static_cast<PathPy*>(items)->getToolpathPtr()->post(out, formatter);
+        }
+        else if (PyUnicode_Check(items)) {
+            formatter.writeText(Py::String(items).as_std_string(), out);
+            formatter.flush(out);
+        }
+        else if (PySequence_Check(items)) {
+            Py::Sequence seq(items);
+            for (Py::Sequence::iterator it = seq.begin(); it != seq.end(); ++it)
+                postItems((*it).ptr(), formatter, out);
+        }
+        else {
+            throw Py::TypeError("Expects a Path, a string or a list of them");
+        }
+    }
+
+    Py::Object post(const Py::Tuple& args, const Py::Dict &kwds)
+    {
+        PyObject *items;
+        PyObject *pyFilename = Py_None;
+        int precision = 3;
+        PyObject *word_precision = NULL;
+        PyObject *pad_zero = Py_True;
+        PyObject *inches = Py_False;
+        double feed_scale = 1.0;
+        PyObject *words = NULL;
+        PyObject *modal_words = NULL;
+        PyObject *modal = Py_False;
+        PyObject *rapid_feed = Py_False;
+        PyObject *comments = Py_True;
+        PyObject *line_numbers = Py_False;
+        long line_start = 10;
+        long line_increment = 10;
+        const char *separator = " ";
+        PyObject *templates = NULL;
+        static char* kwd_list[] = {"items", "filename", "precision", "word_precision", "pad_zero",
+                "inches", "feed_scale", "words", "modal_words", "modal", "rapid_feed", "comments",
+                "line_numbers", "line_start", "line_increment", "separator", "templates", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O|OiOOOdOOOOOOllsO", kwd_list,
+                &items, &pyFilename, &precision, &word_precision, &pad_zero, &inches,
+                &feed_scale, &words, &modal_words, &modal, &rapid_feed, &comments, &line_numbers,
+                &line_start, &line_increment, &separator, &templates))
+            throw Py::Exception();
+
+        // None returns the output as string, anything else is the file name
+        std::string EncodedName;
+        if (pyFilename != Py_None) {
+            char *filename = NULL;
+            if (!PyArg_Parse(pyFilename, "et", "utf-8", &filename))
+                throw Py::Exception();
+            EncodedName = filename;
+            PyMem_Free(filename);
+        }
+
+        PostFormatter formatter;
+        formatter.setPrecision(precision);
+        if (word_precision && word_precision != Py_None) {
+            Py::Dict dict(word_precision);
+            for (auto it = dict.begin(); it != dict.end(); ++it) {
+                const auto &item = *it;
+                formatter.setWordPrecision(Py::String(item.first).as_std_string(),
+                        static_cast<int>(Py::Long(item.second)));
+            }
+        }
+        formatter.setPadZero(PyObject_IsTrue(pad_zero) ? true : false);
+        formatter.setInches(PyObject_IsTrue(inches) ? true : false);
+        formatter.setFeedScale(feed_scale);
+        formatter.setWordOrder(getWords(words));
+        formatter.setModalWords(getWords(modal_words));
+        formatter.setModalCommands(PyObject_IsTrue(modal) ? true : false);
+        formatter.setRapidFeed(PyObject_IsTrue(rapid_feed) ? true : false);
+        formatter.setComments(PyObject_IsTrue(comments) ? true : false);
+        formatter.setLineNumbers(PyObject_IsTrue(line_numbers) ? true : false, line_start, line_increment);
+        formatter.setSeparator(separator);
+
+        try {
+            if (templates && templates != Py_None) {
+                Py::Dict dict(templates);
+                for (auto it = dict.begin(); it != dict.end(); ++it) {
+                    const auto &item = *it;
+                    formatter.setTemplate(Py::String(item.first).as_std_string(),
+                            Py::String(item.second).as_std_string());
+                }
+            }
+
+            if (pyFilename != Py_None) {
+                Base::FileInfo fi(EncodedName.c_str());
+                Base::ofstream file(fi, std::ios::out);
+                if (!file)
+                    throw Py::RuntimeError("Cannot open file for writing");
+                postItems(items, formatter, file);
+                file.close();
+                return Py::None();
+            }
+
+            std::ostringstream str;
+            postItems(items, formatter, str);
+            return Py::String(str.str());
+        } PATH_CATCH
+    }
 };
 
 PyObject* initModule()
@@ -27,7 +27,11 @@
 #define BOOST_GEOMETRY_DISABLE_DEPRECATED_03_WARNING
 
 #ifndef _PreComp_
+# include <atomic>
 # include <cfloat>
+# include <future>
+# include <map>
+# include <thread>
 # include <boost/version.hpp>
 # include <boost/config.hpp>
 # if defined(BOOST_MSVC) && (BOOST_VERSION == 105500)
@@ -98,6 +102,7 @@
 #include <Mod/Part/App/FaceMakerBullseye.h>
 #include <Mod/Part/App/CrossSection.h>
 #include "Area.h"
+#include "ToolpathOptimizer.h"
 #include "../libarea/Area.h"
 
 //FIXME: ISO C++11 requires at least one argument for the "..." in a variadic macro
@@ -1316,6 +1321,168 @@ int Area::project(TopoDS_Shape &shape_out,
     return skips;
 }
 
+static bool isSameTrsf(const gp_Trsf &t1, const gp_Trsf &t2) {
+    for(int i=1;i<=3;++i) {
+        for(int j=1;j<=4;++j) {
+            if(fabs(t1.Value(i,j)-t2.Value(i,j))>Precision::Confusion())
+                return false;
+        }
+    }
+    return true;
+}
+
+/** The section of a children shape at one height
+ *
+ * The slices are cached across Area objects, because the Path operations
+ * create a new Area on each recompute. This way, changing only the step down
+ * or any of the offset and pocket settings doesn't slice the solids again at
+ * the heights that were already sliced.
+ *
+ * The cache doesn't keep the source shapes alive. Slices of sources that are
+ * no longer referenced anywhere else are dropped when new slices are added,
+ * and the whole cache is cleared when a document is closed.
+ */
+struct SectionSlice {
+    TopoDS_Shape source;
+    gp_Trsf trsf;
+    double z;
+    bool fill;
+    /// the sliced solids transformed by trsf
+    TopoDS_Shape section;
+};
+
+class SectionCache {
+public:
+    bool find(SectionSlice &slice) {
+        init();
+        for(auto it=slices.begin();it!=slices.end();++it) {
+            if(fabs(it->z-slice.z)>Precision::Confusion()
+                    || it->fill!=slice.fill
+                    || !it->source.IsEqual(slice.source)
+                    || !isSameTrsf(it->trsf,slice.trsf))
+                continue;
+            // move the slice to the front of the least recently used list
+            slices.splice(slices.begin(),slices,it);
+            slice.section = slices.front().section;
+            ++hits;
+            return true;
+        }
+        return false;
+    }
+
+    void add(const SectionSlice &slice) {
+        prune();
+        slices.push_front(slice);
+        if(slices.size()>MaxSlices)
+            slices.pop_back();
+    }
+
+    void clear() {
+        slices.clear();
+    }
+
+    std::size_t count() const {
+        return slices.size();
+    }
+
+    std::size_t hitCount() const {
+        return hits;
+    }
+
+private:
+    void init() {
+        if(inited)
+            return;
+        inited = true;
+        App::GetApplication().signalDeleteDocument.connect(
+                [this](const App::Document &) { clear(); });
+    }
+
+    /// Removes the slices whose source shape is only referenced by this cache
+    void prune() {
+        std::map<const Standard_Transient*,int> refs;
+        for(const SectionSlice &s : slices) {
+            if(!s.source.IsNull())
+                ++refs[s.source.TShape().operator->()];
+        }
+        slices.remove_if([&refs](const SectionSlice &s) {
+            if(s.source.IsNull())
+                return true;
+            const Standard_Transient *tshape = s.source.TShape().operator->();
+            return tshape->GetRefCount() <= refs[tshape];
+        });
+    }
+
+    static const std::size_t MaxSlices = 1024;
+    std::list<SectionSlice> slices;
+    std::size_t hits = 0;
+    bool inited = false;
+};
+
+static SectionCache s_sectionCache;
+
+/** Slice the solids of \c source at height \c z
+ *
+ * It is called from the worker threads of Area::makeSections(), so the
+ * warnings are collected in \c warnings and logged by the caller.
+ */
+static TopoDS_Shape sliceSolids(const TopoDS_Shape &source, double z, bool fill,
+        std::size_t index, bool show, std::vector<std::string> &warnings)
+{
+    gp_Pln pln(gp_Pnt(0,0,z),gp_Dir(0,0,1));
+    Standard_Real a,b,c,d;
+    pln.Coefficients(a,b,c,d);
+
+    BRep_Builder builder;
+    TopoDS_Compound comp;
+    builder.MakeCompound(comp);
+
+    for(TopExp_Explorer xp(source, TopAbs_SOLID); xp.More(); xp.Next()) {
+        if(show)
+            Area::showShape(xp.Current(),0,"section_%u_shape",index);
+        std::list<TopoDS_Wire> wires;
+        Part::CrossSection section(a,b,c,xp.Current());
+        wires = section.slice(-d);
+        if(show)
+            showShapes(wires,0,"section_%u_wire",index);
+        if(wires.empty())
+            continue;
+
+        // always try to make face to normalize wire orientation
+        Part::FaceMakerBullseye mkFace;
+        mkFace.setPlane(pln);
+        for(const TopoDS_Wire &wire : wires) {
+            if(BRep_Tool::IsClosed(wire))
+                mkFace.addWire(wire);
+        }
+        try {
+            mkFace.Build();
+            const TopoDS_Shape &shape = mkFace.Shape();
+            if (shape.IsNull())
+                warnings.push_back("FaceMakerBullseye return null shape on section");
+            else {
+                if(show)
+                    Area::showShape(shape,0,"section_%u_face",index);
+                for(auto it=wires.begin(),itNext=it;it!=wires.end();it=itNext) {
+                    ++itNext;
+                    if(BRep_Tool::IsClosed(*it))
+                        wires.erase(it);
+                }
+                for(TopExp_Explorer xp(shape,fill?TopAbs_FACE:TopAbs_WIRE);
+                        xp.More();xp.Next())
+                {
+                    builder.Add(comp,xp.Current());
+                }
+            }
+        }catch (Base::Exception &e){
+            warnings.push_back(std::string("FaceMakerBullseye failed on section: ") + e.what());
+        }
+        for(const TopoDS_Wire &wire : wires)
+            builder.Add(comp,wire);
+    }
+    return comp;
+}
+
 std::vector<shared_ptr<Area> > Area::makeSections(
         PARAM_ARGS(PARAM_FARG,AREA_PARAMS_SECTION_EXTRA),
         const std::vector<double> &_heights,
@@ -1447,98 +1614,125 @@ std::vector<shared_ptr<Area> > Area::makeSections(
     std::vector<shared_ptr<Area> > sections;
     sections.reserve(heights.size());
 
-    std::list<Shape> projectedShapes;
+    tolerance *= 2.0;
+    bool can_retry = fabs(tolerance)>Precision::Confusion();
+    TopLoc_Location locInverse(loc.Inverted());
+
+    auto makeSectionArea = [&](double z) {
+        gp_Pln pln(gp_Pnt(0,0,z),gp_Dir(0,0,1));
+        BRepLib_MakeFace mkFace(pln,xMin,xMax,yMin,yMax);
+        const TopoDS_Shape &face = mkFace.Face();
+
+        shared_ptr<Area> area(std::make_shared<Area>(&myParams));
+        area->myParams.Outline = false;
+        area->setPlane(face.Moved(locInverse));
+        return area;
+    };
+
     if(project) {
-        projectedShapes = getProjectedShapes(trsf,false);
+        std::list<Shape> projectedShapes = getProjectedShapes(trsf,false);
         if(projectedShapes.empty()) {
             AREA_ERR("empty projection");
             return sections;
         }
+        for(double z : heights) {
+            shared_ptr<Area> area = makeSectionArea(z);
+            gp_Trsf t;
+            t.SetTranslation(gp_Vec(0,0,z));
+            TopLoc_Location wloc(t);
+            for(const auto &s : projectedShapes)
+                area->add(s.shape.Moved(wloc).Moved(locInverse),s.op);
+            sections.push_back(area);
+        }
+        FC_TIME_LOG(t,"makeSection count: " << sections.size()<<", total");
+        return sections;
     }
 
-    tolerance *= 2.0;
-    bool can_retry = fabs(tolerance)>Precision::Confusion();
-    TopLoc_Location locInverse(loc.Inverted());
+    // One job per children shape and section height. The solids are sliced
+    // by the worker threads, while the section areas are built here, because
+    // neither Base::Console nor libarea (see CAreaConfig) is thread-safe.
+    struct SliceJob {
+        SectionSlice slice;
+        TopoDS_Shape shape;
+        std::size_t index;
+        std::vector<std::string> warnings;
+    };
 
-    for(size_t i=0;i<heights.size();++i) {
-        double z = heights[i];
-        bool retried = !can_retry;
-        while(true) {
-            gp_Pln pln(gp_Pnt(0,0,z),gp_Dir(0,0,1));
-            Standard_Real a,b,c,d;
-            pln.Coefficients(a,b,c,d);
-            BRepLib_MakeFace mkFace(pln,xMin,xMax,yMin,yMax);
-            const TopoDS_Shape &face = mkFace.Face();
-
-            shared_ptr<Area> area(std::make_shared<Area>(&myParams));
-            area->myParams.Outline = false;
-            area->setPlane(face.Moved(locInverse));
-
-            if(project) {
-                for(const auto &s : projectedShapes) {
-                    gp_Trsf t;
-                    t.SetTranslation(gp_Vec(0,0,-d));
-                    TopLoc_Location wloc(t);
-                    area->add(s.shape.Moved(wloc).Moved(locInverse),s.op);
-                }
-                sections.push_back(area);
-                break;
+    bool show = FC_LOG_INSTANCE.level()>FC_LOGLEVEL_TRACE;
+    bool fill = myParams.Fill!=FillNone;
+    std::vector<TopoDS_Shape> shapes;
+    shapes.reserve(myShapes.size());
+    for(const Shape &s : myShapes)
+        shapes.push_back(s.shape.Moved(loc));
+
+    std::vector<double> levels(heights);
+    std::vector<shared_ptr<Area> > levelSections(heights.size());
+    std::vector<std::size_t> pending(heights.size());
+    for(std::size_t i=0;i<pending.size();++i)
+        pending[i] = i;
+
+    bool retried = !can_retry;
+    while(true) {
+        std::vector<SliceJob> jobs(pending.size()*shapes.size());
+        std::vector<SliceJob*> todo;
+        for(std::size_t i=0,k=0;i<pending.size();++i) {
+            auto it = myShapes.begin();
+            for(std::size_t j=0;j<shapes.size();++j,++k,++it) {
+                SliceJob &job = jobs[k];
+                job.slice.source = it->shape;
+                job.slice.trsf = trsf;
+                job.slice.z = levels[pending[i]];
+                job.slice.fill = fill;
+                job.shape = shapes[j];
+                job.index = pending[i];
+                if(!s_sectionCache.find(job.slice))
+                    todo.push_back(&job);
             }
+        }
 
-            for(auto it=myShapes.begin();it!=myShapes.end();++it) {
-                const auto &s = *it;
-                BRep_Builder builder;
-                TopoDS_Compound comp;
-                builder.MakeCompound(comp);
-
-                for(TopExp_Explorer xp(s.shape.Moved(loc), TopAbs_SOLID); xp.More(); xp.Next()) {
-                    showShape(xp.Current(),0,"section_%u_shape",i);
-                    std::list<TopoDS_Wire> wires;
-                    Part::CrossSection section(a,b,c,xp.Current());
-                    wires = section.slice(-d);
-                    showShapes(wires,0,"section_%u_wire",i);
-                    if(wires.empty()) {
-                        AREA_LOG("Section returns no wires");
-                        continue;
-                    }
-
-                    // always try to make face to normalize wire orientation
-                    Part::FaceMakerBullseye mkFace;
-                    mkFace.setPlane(pln);
-                    for(const TopoDS_Wire &wire : wires) {
-                        if(BRep_Tool::IsClosed(wire))
-                            mkFace.addWire(wire);
-                    }
-                    try {
-                        mkFace.Build();
-                        const TopoDS_Shape &shape = mkFace.Shape();
-                        if (shape.IsNull())
-                            AREA_WARN("FaceMakerBullseye return null shape on section");
-                        else {
-                            showShape(shape,0,"section_%u_face",i);
-                            for(auto it=wires.begin(),itNext=it;it!=wires.end();it=itNext) {
-                                ++itNext;
-                                if(BRep_Tool::IsClosed(*it))
-                                    wires.erase(it);
-                            }
-                            for(TopExp_Explorer xp(shape,myParams.Fill==FillNone?TopAbs_WIRE:TopAbs_FACE);
-                                    xp.More();xp.Next())
-                            {
-                                builder.Add(comp,xp.Current());
-                            }
-                        }
-                    }catch (Base::Exception &e){
-                        AREA_WARN("FaceMakerBullseye failed on section: " << e.what());
-                    }
-                    for(const TopoDS_Wire &wire : wires)
-                        builder.Add(comp,wire);
+        if(!todo.empty()) {
+            int numThreads = 1;
+            if(!show) {
+                numThreads = (int)myParams.SectionThreads;
+                if(numThreads<=0)
+                    numThreads = std::max<int>(1,std::thread::hardware_concurrency());
+                numThreads = std::min<int>(numThreads,todo.size());
+            }
+            std::atomic<std::size_t> next(0);
+            auto worker = [&]() {
+                for(std::size_t i; (i=next++)<todo.size();) {
+                    SliceJob &job = *todo[i];
+                    job.slice.section = sliceSolids(job.shape,job.slice.z,
+                            job.slice.fill,job.index,show,job.warnings);
                 }
+            };
+            std::vector<std::future<void> > futures;
+            for(int i=1;i<numThreads;++i)
+                futures.push_back(std::async(std::launch::async,worker));
+            worker();
+            for(auto &future : futures)
+                future.get();
+
+            for(SliceJob *job : todo)
+                s_sectionCache.add(job->slice);
+        }
+        FC_TIME_LOG(t1,"slice " << todo.size() << ", cached " << jobs.size()-todo.size());
+
+        std::vector<std::size_t> empty;
+        for(std::size_t i=0,k=0;i<pending.size();++i,k+=shapes.size()) {
+            std::size_t index = pending[i];
+            shared_ptr<Area> area = makeSectionArea(levels[index]);
+            std::size_t j = 0;
+            for(auto it=myShapes.begin();it!=myShapes.end();++it,++j) {
+                SliceJob &job = jobs[k+j];
+                for(const std::string &msg : job.warnings)
+                    AREA_WARN(msg);
 
                 // Make sure the compound has at least one edge
-                if(TopExp_Explorer(comp,TopAbs_EDGE).More()) {
-                    const TopoDS_Shape &shape = comp.Moved(locInverse);
-                    showShape(shape,0,"section_%u_result",i);
-                    area->add(shape,s.op);
+                if(TopExp_Explorer(job.slice.section,TopAbs_EDGE).More()) {
+                    const TopoDS_Shape &shape = job.slice.section.Moved(locInverse);
+                    showShape(shape,0,"section_%u_result",index);
+                    area->add(shape,it->op);
                 }else if(area->myShapes.empty()){
                     auto itNext = it;
                     if(++itNext != myShapes.end() &&
@@ -1550,20 +1744,30 @@ std::vector<shared_ptr<Area> > Area::makeSections(
                 }
             }
             if(area->myShapes.size()){
-                sections.push_back(area);
-                FC_TIME_LOG(t1,"makeSection " << z);
-                showShape(area->getShape(),0,"section_%u_final",i);
-                break;
-            }
-            if(retried) {
+                levelSections[index] = area;
+                showShape(area->getShape(),0,"section_%u_final",index);
+            }else
+                empty.push_back(index);
+        }
+
+        if(empty.empty())
+            break;
+        if(retried) {
+            for(std::size_t i=0;i<empty.size();++i)
                 AREA_WARN("Discard empty section");
-                break;
-            }else{
-                AREA_TRACE("retry section " <<z<<"->"<<z+tolerance);
-                z += tolerance;
-                retried = true;
-            }
+            break;
         }
+        for(std::size_t index : empty) {
+            AREA_TRACE("retry section " <<levels[index]<<"->"<<levels[index]+tolerance);
+            levels[index] += tolerance;
+        }
+        pending.swap(empty);
+        retried = true;
+    }
+
+    for(auto &area : levelSections) {
+        if(area)
+            sections.push_back(area);
     }
     FC_TIME_LOG(t,"makeSection count: " << sections.size()<<", total");
     return sections;
@@ -1942,28 +2146,21 @@ void Area::makeOffset(list<shared_ptr<CArea> > &areas,
         }else
             last_stepover = 0;
     }
-    for(int i=0;count<0||i<count;++i,offset+=stepover) {
-        if(from_center)
-            areas.push_front(make_shared<CArea>());
-        else
-            areas.push_back(make_shared<CArea>());
-        CArea &area = from_center?(*areas.front()):(*areas.back());
-        CArea areaOpen;
 #ifdef AREA_OFFSET_ALGO
-        if(myParams.Algo == Area::Algolibarea) {
+    if(myParams.Algo == Area::Algolibarea) {
+        for(int i=0;count<0||i<count;++i,offset+=stepover) {
+            if(from_center)
+                areas.push_front(make_shared<CArea>());
+            else
+                areas.push_back(make_shared<CArea>());
+            CArea &area = from_center?(*areas.front()):(*areas.back());
+            CArea areaOpen;
             for(const CCurve &c : myArea->m_curves) {
                 if(c.IsClosed())
                     area.append(c);
                 else
                     areaOpen.append(c);
             }
-        }else
-#endif
-            area = *myArea;
-
-#ifdef AREA_OFFSET_ALGO
-        switch(myParams.Algo){
-        case Area::Algolibarea:
             // libarea somehow fails offset without Reorder, but ClipperOffset
             // works okay. Don't know why
             area.Reorder();
@@ -1972,32 +2169,75 @@ void Area::makeOffset(list<shared_ptr<CArea> > &areas,
                 areaOpen.Thicken(offset);
                 area.Clip(ClipperLib::ctUnion,&areaOpen,SubjectFill,ClipFill);
             }
-            break;
-        case Area::AlgoClipperOffset:
-#endif
-            area.OffsetWithClipper(offset,JoinType,EndType,
-                    myParams.MiterLimit,myParams.RoundPrecision);
-#ifdef AREA_OFFSET_ALGO
-            break;
+            if(count>1)
+                FC_TIME_LOG(t1,"makeOffset " << i << '/' << count);
+            if(area.m_curves.empty()) {
+                if(from_center)
+                    areas.pop_front();
+                else
+                    areas.pop_back();
+                if(areas.empty())
+                    break;
+                if(last_stepover && last_stepover>stepover) {
+                    offset -= stepover;
+                    stepover = last_stepover;
+                    --i;
+                    continue;
+                }
+                return;
+            }
         }
+        FC_TIME_LOG(t,"makeOffset count: " << count);
+        return;
+    }
 #endif
+
+    // The rings are offset from the original area in batches, one ring per
+    // thread. Without a count, a batch may go beyond the first empty ring,
+    // and the rings after it are dropped.
+    int numThreads = CArea::get_max_threads();
+    if(numThreads<=0)
+        numThreads = std::max<int>(1,std::thread::hardware_concurrency());
+
+    std::vector<double> offsets;
+    std::vector<CArea> rings;
+    for(int i=0;count<0||i<count;) {
+        offsets.clear();
+        int batch = count<0?numThreads:count-i;
+        for(int k=0;k<batch;++k)
+            offsets.push_back(offset+k*stepover);
+        myArea->OffsetWithClipper(offsets,rings,JoinType,EndType,
+                myParams.MiterLimit,myParams.RoundPrecision);
         if(count>1)
-            FC_TIME_LOG(t1,"makeOffset " << i << '/' << count);
-        if(area.m_curves.empty()) {
+            FC_TIME_LOG(t1,"makeOffset " << i+batch << '/' << count);
+
+        bool none = false;
+        for(CArea &ring : rings) {
+            if(ring.m_curves.empty()) {
+                if(areas.empty()) {
+                    none = true;
+                    break;
+                }
+                if(last_stepover && last_stepover>stepover) {
+                    // continue after the last ring with the last stepover
+                    offset -= stepover;
+                    stepover = last_stepover;
+                    offset += stepover;
+                    break;
+                }
+                return;
+            }
             if(from_center)
-                areas.pop_front();
+                areas.push_front(make_shared<CArea>());
             else
-                areas.pop_back();
-            if(areas.empty())
-                break;
-            if(last_stepover && last_stepover>stepover) {
-                offset -= stepover;
-                stepover = last_stepover;
-                --i;
-                continue;
-            }
-            return;
+                areas.push_back(make_shared<CArea>());
+            CArea &area = from_center?(*areas.front()):(*areas.back());
+            area.m_curves.swap(ring.m_curves);
+            ++i;
+            offset += stepover;
         }
+        if(none)
+            break;
     }
     FC_TIME_LOG(t,"makeOffset count: " << count);
 }
@@ -3132,14 +3372,20 @@ static inline void addParameter(bool verbose, Command &cmd, const char *name,
         cmd.Parameters[name] = relative?d:next;
 }
 
-static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
+static inline void setGCode(bool verbose, Command &cmd, const gp_Pnt &last,
         const gp_Pnt &next, const char *name)
 {
-    Command cmd;
     cmd.Name = name;
     addParameter(verbose,cmd,"X",last.X(),next.X());
     addParameter(verbose,cmd,"Y",last.Y(),next.Y());
     addParameter(verbose,cmd,"Z",last.Z(),next.Z());
+}
+
+static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
+        const gp_Pnt &next, const char *name)
+{
+    Command cmd;
+    setGCode(verbose,cmd,last,next,name);
     path.addCommand(cmd);
     return;
 }
@@ -3147,12 +3393,13 @@ static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
 static inline void addG1(bool verbose,Toolpath &path, const gp_Pnt &last,
         const gp_Pnt &next, double f, double &last_f)
 {
-    addGCode(verbose,path,last,next,"G1");
+    Command cmd;
+    setGCode(verbose,cmd,last,next,"G1");
     if(f>Precision::Confusion()) {
-        Command *cmd = path.getCommands().back();
-        addParameter(verbose,*cmd,"F",last_f,f);
+        addParameter(verbose,cmd,"F",last_f,f);
         last_f = f;
     }
+    path.addCommand(cmd);
     return;
 }
 
@@ -3445,6 +3692,22 @@ void Area::toPath(Toolpath &path, const std::list<TopoDS_Shape> &shapes,
             }}
         }
     }
+
+    // merging the moves would undo the segmentation
+    if(fit_tolerance>0 && segmentation<=0) {
+        ToolpathOptimizer optimizer;
+        optimizer.setTolerance(fit_tolerance);
+        path.optimize(optimizer);
+    }
+}
+
+void Area::clearSectionCache() {
+    s_sectionCache.clear();
+}
+
+void Area::getSectionCacheInfo(std::size_t &count, std::size_t &hits) {
+    count = s_sectionCache.count();
+    hits = s_sectionCache.hitCount();
 }
 
 void Area::abort(bool aborting) {
@@ -237,6 +237,10 @@ public:
      *
      * See #AREA_PARAMS_EXTRA for description of the arguments. Currently, there
      * is only one argument, namely \c mode for section mode.
+     *
+     * The solids are sliced by \c SectionThreads threads. The slices are
+     * cached by shape and height, so that a following call with a different
+     * step down or offset setting only slices the new heights.
      */
     std::vector<std::shared_ptr<Area> > makeSections(
             PARAM_ARGS_DEF(PARAM_FARG,AREA_PARAMS_SECTION_EXTRA),
@@ -381,6 +385,11 @@ public:
     static void abort(bool aborting);
     static bool aborting();
 
+    /// Clears the slices of the solids that are cached by makeSections()
+    static void clearSectionCache();
+    /// Returns the number of cached slices and how often a slice was reused
+    static void getSectionCacheInfo(std::size_t &count, std::size_t &hits);
+
     static void setDefaultParams(const AreaStaticParams &params);
     static const AreaStaticParams &getDefaultParams();
 
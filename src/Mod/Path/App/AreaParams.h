@@ -92,7 +92,9 @@
     ((short,max_arc_points,MaxArcPoints,100,"Maximum segments for arc discretization (ignored currently)"))\
     ((double,clipper_scale,ClipperScale,1e7,\
         "ClipperLib operate on integers. This is the scale factor to convert\n"\
-        "floating points.",App::PropertyFloat))
+        "floating points.",App::PropertyFloat))\
+    ((short,max_threads,Threads,0,"Number of threads used for offsets and pockets. 0 means one thread\n"\
+        "per CPU core, and 1 keeps the work in the calling thread."))
 
 /** Pocket parameters
  *
@@ -160,6 +162,8 @@
         "When the section hits or over the shape boundary, a section with the height of that boundary\n"\
         "will be created. A small offset is usually required to avoid the tangential cut.",\
         App::PropertyPrecision))\
+    ((long,threads,SectionThreads,0,"Number of threads used to slice the solids. 0 means one thread per\n"\
+        "CPU core, and 1 slices all sections in the calling thread."))\
      AREA_PARAMS_SECTION_EXTRA
 
 #ifdef AREA_OFFSET_ALGO
@@ -244,6 +248,9 @@
     ((bool,verbose,Verbose,true, "If true, each motion GCode will contain full coordinate and feedrate")) \
     ((bool,abs_center,AbsoluteArcCenter,false, "Use absolute arc center mode (G90.1)")) \
     ((bool,preamble,EmitPreamble,true,"Emit preambles")) \
+    ((double,fit_tolerance,FitTolerance,0.0,\
+        "If greater than zero, the moves along a line are merged and arcs are fitted to the\n"\
+        "moves within this tolerance. Not used together with Segmentation", App::PropertyLength)) \
     AREA_PARAMS_DEFLECTION
 
 /** Group of all Area configuration parameters except CArea's*/
@@ -43,6 +43,22 @@ static PyObject * areaAbort(PyObject *, PyObject *args, PyObject *kwd) {
     return Py_None;
 }
 
+static PyObject * areaClearSectionCache(PyObject *, PyObject *args) {
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+    Area::clearSectionCache();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject * areaGetSectionCacheInfo(PyObject *, PyObject *args) {
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+    std::size_t count, hits;
+    Area::getSectionCacheInfo(count, hits);
+    return Py::new_reference_to(Py::TupleN(Py::Long((long)count),Py::Long((long)hits)));
+}
+
 static PyObject * areaSetParams(PyObject *, PyObject *args, PyObject *kwd) {
 
     static char *kwlist[] = {PARAM_FIELD_STRINGS(NAME,AREA_PARAMS_STATIC_CONF),NULL};
@@ -167,6 +183,15 @@ static const PyMethodDef areaOverrides[] = {
         "\nTo ensure no stray abortion is left in the previous operation, it is advised to manually clear\n"
         "the aborting flag by calling abort(False) before starting a new operation.",
     },
+    {
+        "clearSectionCache",(PyCFunction)areaClearSectionCache, METH_VARARGS|METH_STATIC,
+        "clearSectionCache(): Static method to clear the slices of solids cached by makeSections()."
+    },
+    {
+        "getSectionCacheInfo",(PyCFunction)areaGetSectionCacheInfo, METH_VARARGS|METH_STATIC,
+        "getSectionCacheInfo(): Static method to return the number of cached slices of solids and\n"
+        "how often a cached slice was reused as tuple (count, hits)."
+    },
     {
         "getParamsDesc",reinterpret_cast<PyCFunction>(reinterpret_cast<void (*) (void)>(areaGetParamsDesc)), METH_VARARGS|METH_KEYWORDS|METH_STATIC,
         "getParamsDesc(as_string=False): Returns a list of supported parameters and their descriptions.\n"
@@ -439,6 +464,14 @@ PyObject* AreaPy::abort(PyObject *, PyObject *) {
     return 0;
 }
 
+PyObject* AreaPy::clearSectionCache(PyObject *) {
+    return 0;
+}
+
+PyObject* AreaPy::getSectionCacheInfo(PyObject *) {
+    return 0;
+}
+
 PyObject* AreaPy::getParamsDesc(PyObject *, PyObject *)
 {
     return 0;
@@ -0,0 +1,665 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cctype>
+# include <cmath>
+# include <cstdlib>
+# include <cstring>
+# include <boost/algorithm/string.hpp>
+#endif
+
+#include <Base/Exception.h>
+#include <Base/Rotation.h>
+
+#include "CommandStore.h"
+
+using namespace Path;
+
+namespace {
+
+const std::string &slotName(int slot)
+{
+    static const std::string slotNames[CommandStore::NumSlots] = {"X", "Y", "Z", "I", "J", "K", "F"};
+    return slotNames[slot];
+}
+
+Opcode opcodeFromName(const std::string &name)
+{
+    if (name == "G0" || name == "G00")
+        return Opcode::Rapid;
+    if (name == "G1" || name == "G01")
+        return Opcode::Feed;
+    if (name == "G2" || name == "G02")
+        return Opcode::ArcCW;
+    if (name == "G3" || name == "G03")
+        return Opcode::ArcCCW;
+    if (!name.empty() && name[0] == '(')
+        return Opcode::Comment;
+    return Opcode::Other;
+}
+
+// same as the switch in Command::scaleBy()
+bool isScaledByUnit(char key)
+{
+    switch (key) {
+    case 'X':
+    case 'Y':
+    case 'Z':
+    case 'I':
+    case 'J':
+    case 'R':
+    case 'Q':
+    case 'F':
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Converts a number like atof() does. Plain decimal numbers with at most 15
+ * digits are exactly representable as a quotient of two doubles, in this case
+ * the division gives the correctly rounded result without calling strtod().
+ */
+double parseNumber(const std::string &str)
+{
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    std::string::const_iterator it = str.begin();
+    bool negative = (it != str.end() && *it == '-');
+    if (negative)
+        ++it;
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    bool point = false;
+    for (; it != str.end(); ++it) {
+        if (*it >= '0' && *it <= '9') {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*it - '0');
+            ++digits;
+            if (point)
+                ++decimals;
+        }
+        else if (*it == '.' && !point) {
+            point = true;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (it != str.end() || digits == 0 || digits > 15)
+        return std::atof(str.c_str());
+    double value = static_cast<double>(mantissa) / powers[decimals];
+    return negative ? -value : value;
+}
+
+// appends the number with at least width digits
+void writeDigits(std::string &out, std::uint64_t value, int width)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *pos = end;
+    do {
+        *--pos = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (end - pos < width && pos != buf)
+        *--pos = '0';
+    out.append(pos, end);
+}
+
+const char *findFirstOf(const char *begin, const char *end, const char *chars)
+{
+    for (; begin != end; ++begin) {
+        if (std::strchr(chars, *begin) && *begin != '\0')
+            return begin;
+    }
+    return end;
+}
+
+} // namespace
+
+CommandStore::CommandStore()
+  : usedExtras(0)
+{
+}
+
+CommandStore::~CommandStore()
+{
+}
+
+void CommandStore::clear()
+{
+    nameIds.clear();
+    slotMasks.clear();
+    for (int i = 0; i < NumSlots; i++)
+        slotValues[i].clear();
+    extraBegin.clear();
+    extraCount.clear();
+    extras.clear();
+    usedExtras = 0;
+}
+
+void CommandStore::reserve(std::size_t count)
+{
+    nameIds.reserve(count);
+    slotMasks.reserve(count);
+    for (int i = 0; i < NumSlots; i++)
+        slotValues[i].reserve(count);
+    extraBegin.reserve(count);
+    extraCount.reserve(count);
+}
+
+std::uint32_t CommandStore::addName(const std::string &name)
+{
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = nameIndex.find(name);
+    if (it != nameIndex.end())
+        return it->second;
+
+    std::uint32_t id = static_cast<std::uint32_t>(names.size());
+    names.push_back(name);
+    opcodes.push_back(opcodeFromName(name));
+    nameIndex[name] = id;
+    return id;
+}
+
+std::uint32_t CommandStore::addParamName(const std::string &name)
+{
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = paramIndex.find(name);
+    if (it != paramIndex.end())
+        return it->second;
+
+    std::uint32_t id = static_cast<std::uint32_t>(paramNames.size());
+    paramNames.push_back(name);
+    paramIndex[name] = id;
+    return id;
+}
+
+int CommandStore::findSlot(const std::string &param) const
+{
+    if (param.size() != 1)
+        return -1;
+    switch (param[0]) {
+    case 'X': return X;
+    case 'Y': return Y;
+    case 'Z': return Z;
+    case 'I': return I;
+    case 'J': return J;
+    case 'K': return K;
+    case 'F': return F;
+    default: return -1;
+    }
+}
+
+int CommandStore::findExtra(std::size_t index, const std::string &param) const
+{
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = paramIndex.find(param);
+    if (it == paramIndex.end())
+        return -1;
+
+    std::uint32_t begin = extraBegin[index];
+    std::uint32_t end = begin + extraCount[index];
+    for (std::uint32_t i = begin; i < end; i++) {
+        if (extras[i].key == it->second)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool CommandStore::has(std::size_t index, const std::string &param) const
+{
+    int slot = findSlot(param);
+    if (slot >= 0)
+        return has(index, static_cast<Slot>(slot));
+    return findExtra(index, param) >= 0;
+}
+
+double CommandStore::get(std::size_t index, const std::string &param, double fallback) const
+{
+    int slot = findSlot(param);
+    if (slot >= 0)
+        return get(index, static_cast<Slot>(slot), fallback);
+    int extra = findExtra(index, param);
+    return extra >= 0 ? extras[extra].value : fallback;
+}
+
+void CommandStore::insertRow(std::size_t pos, std::uint32_t nameId, std::uint8_t mask, const double *values,
+                             const Param *extra, std::size_t extraNum)
+{
+    nameIds.insert(nameIds.begin() + pos, nameId);
+    slotMasks.insert(slotMasks.begin() + pos, mask);
+    for (int i = 0; i < NumSlots; i++)
+        slotValues[i].insert(slotValues[i].begin() + pos, values[i]);
+    extraBegin.insert(extraBegin.begin() + pos, static_cast<std::uint32_t>(extras.size()));
+    extraCount.insert(extraCount.begin() + pos, static_cast<std::uint32_t>(extraNum));
+    extras.insert(extras.end(), extra, extra + extraNum);
+    usedExtras += extraNum;
+}
+
+void CommandStore::append(const Command &cmd)
+{
+    insert(size(), cmd);
+}
+
+void CommandStore::insert(std::size_t pos, const Command &cmd)
+{
+    std::uint8_t mask = 0;
+    double values[NumSlots] = {};
+    paramBuf.clear();
+    for (std::map<std::string, double>::const_iterator it = cmd.Parameters.begin(); it != cmd.Parameters.end(); ++it) {
+        int slot = findSlot(it->first);
+        if (slot >= 0) {
+            mask |= 1 << slot;
+            values[slot] = it->second;
+        }
+        else {
+            Param param;
+            param.key = addParamName(it->first);
+            param.value = it->second;
+            paramBuf.push_back(param);
+        }
+    }
+
+    insertRow(pos, addName(cmd.Name), mask, values, paramBuf.data(), paramBuf.size());
+}
+
+void CommandStore::append(const CommandStore &store, std::size_t index)
+{
+    double values[NumSlots];
+    for (int i = 0; i < NumSlots; i++)
+        values[i] = store.slotValues[i][index];
+
+    // the parameter names of the other store have other ids
+    paramBuf.clear();
+    std::uint32_t begin = store.extraBegin[index];
+    std::uint32_t end = begin + store.extraCount[index];
+    for (std::uint32_t i = begin; i < end; i++) {
+        Param param;
+        param.key = addParamName(store.paramNames[store.extras[i].key]);
+        param.value = store.extras[i].value;
+        paramBuf.push_back(param);
+    }
+
+    insertRow(size(), addName(store.getName(index)), store.slotMasks[index], values,
+              paramBuf.data(), paramBuf.size());
+}
+
+void CommandStore::append(const std::string &name, std::uint8_t mask, const double *values)
+{
+    insertRow(size(), addName(name), mask, values, nullptr, 0);
+}
+
+void CommandStore::swap(CommandStore &store)
+{
+    nameIds.swap(store.nameIds);
+    slotMasks.swap(store.slotMasks);
+    for (int i = 0; i < NumSlots; i++)
+        slotValues[i].swap(store.slotValues[i]);
+    extraBegin.swap(store.extraBegin);
+    extraCount.swap(store.extraCount);
+    extras.swap(store.extras);
+    std::swap(usedExtras, store.usedExtras);
+    names.swap(store.names);
+    opcodes.swap(store.opcodes);
+    nameIndex.swap(store.nameIndex);
+    paramNames.swap(store.paramNames);
+    paramIndex.swap(store.paramIndex);
+}
+
+void CommandStore::erase(std::size_t pos)
+{
+    usedExtras -= extraCount[pos];
+    nameIds.erase(nameIds.begin() + pos);
+    slotMasks.erase(slotMasks.begin() + pos);
+    for (int i = 0; i < NumSlots; i++)
+        slotValues[i].erase(slotValues[i].begin() + pos);
+    extraBegin.erase(extraBegin.begin() + pos);
+    extraCount.erase(extraCount.begin() + pos);
+
+    // the entries of erased commands stay in the overflow table until it's compacted
+    if (extras.size() > 2 * usedExtras + 1024)
+        compactExtras();
+}
+
+void CommandStore::compactExtras()
+{
+    std::vector<Param> compact;
+    compact.reserve(usedExtras);
+    for (std::size_t i = 0; i < size(); i++) {
+        std::uint32_t begin = extraBegin[i];
+        extraBegin[i] = static_cast<std::uint32_t>(compact.size());
+        compact.insert(compact.end(), extras.begin() + begin, extras.begin() + begin + extraCount[i]);
+    }
+    extras.swap(compact);
+}
+
+Command CommandStore::getCommand(std::size_t index) const
+{
+    Command cmd;
+    cmd.Name = getName(index);
+    for (int i = 0; i < NumSlots; i++) {
+        if (has(index, static_cast<Slot>(i)))
+            cmd.Parameters[slotName(i)] = slotValues[i][index];
+    }
+    std::uint32_t begin = extraBegin[index];
+    std::uint32_t end = begin + extraCount[index];
+    for (std::uint32_t i = begin; i < end; i++)
+        cmd.Parameters[paramNames[extras[i].key]] = extras[i].value;
+    return cmd;
+}
+
+void CommandStore::appendGCode(const char *begin, const char *end)
+{
+    // Split the program in the same way as Toolpath did before, i.e. a command
+    // starts with G, M or a comment.
+    static const char *starts = "(gGmM";
+    bool inches = false;
+    bool comment = false;
+    const char *last = nullptr;
+    const char *found = findFirstOf(begin, end, starts);
+    while (found != end) {
+        if (*found == '(') {
+            // before opening a comment, add the last found command
+            if (last && !comment)
+                parseCommand(last, found, inches);
+            comment = true;
+            last = found;
+            found = std::find(found + 1, end, ')');
+        }
+        else if (*found == ')') {
+            parseCommand(last, found + 1, inches);
+            last = nullptr;
+            comment = false;
+            found = findFirstOf(found + 1, end, starts);
+        }
+        else {
+            if (last)
+                parseCommand(last, found, inches);
+            last = found;
+            found = findFirstOf(found + 1, end, starts);
+        }
+    }
+    // add the last command found, if any
+    if (last && !comment)
+        parseCommand(last, end, inches);
+}
+
+/**
+ * Parses a single command with the same rules as Command::setFromGCode() and
+ * appends it.
+ */
+void CommandStore::parseCommand(const char *begin, const char *end, bool &inches)
+{
+    enum Mode { None, CommandName, Argument, CommentText } mode = None;
+    char key = 0;
+    nameBuf.clear();
+    valueBuf.clear();
+    paramBuf.clear();
+    std::uint8_t mask = 0;
+    double values[NumSlots] = {};
+
+    auto setParam = [&]() {
+        double value = parseNumber(valueBuf);
+        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(key)));
+        keyBuf.assign(1, upper);
+        int slot = findSlot(keyBuf);
+        if (slot >= 0) {
+            mask |= 1 << slot;
+            values[slot] = value;
+            return;
+        }
+        std::uint32_t id = addParamName(keyBuf);
+        for (std::vector<Param>::iterator it = paramBuf.begin(); it != paramBuf.end(); ++it) {
+            if (it->key == id) {
+                it->value = value;
+                return;
+            }
+        }
+        Param param;
+        param.key = id;
+        param.value = value;
+        paramBuf.push_back(param);
+    };
+    auto setName = [&](bool upper) {
+        nameBuf.assign(1, key);
+        nameBuf += valueBuf;
+        if (upper) {
+            for (std::string::iterator it = nameBuf.begin(); it != nameBuf.end(); ++it)
+                *it = static_cast<char>(std::toupper(static_cast<unsigned char>(*it)));
+        }
+    };
+
+    for (const char *it = begin; it != end; ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (std::isdigit(c) || c == '-' || c == '.') {
+            valueBuf += *it;
+        }
+        else if (std::isalpha(c)) {
+            if (mode == CommandName) {
+                if (!key || valueBuf.empty())
+                    throw Base::BadFormatError("Badly formatted GCode command");
+                setName(true);
+                valueBuf.clear();
+                mode = Argument;
+            }
+            else if (mode == None) {
+                mode = CommandName;
+            }
+            else if (mode == Argument) {
+                if (!key || valueBuf.empty())
+                    throw Base::BadFormatError("Badly formatted GCode argument");
+                setParam();
+                valueBuf.clear();
+            }
+            else if (mode == CommentText) {
+                valueBuf += *it;
+            }
+            key = *it;
+        }
+        else if (c == '(') {
+            mode = CommentText;
+        }
+        else if (c == ')') {
+            key = '(';
+            valueBuf += ')';
+        }
+        else if (mode == CommentText) {
+            // add non-ascii characters only if this is a comment
+            valueBuf += *it;
+        }
+    }
+
+    if (!key || valueBuf.empty())
+        throw Base::BadFormatError("Badly formatted GCode argument");
+    if (mode == CommandName || mode == CommentText)
+        setName(mode == CommandName);
+    else
+        setParam();
+
+    if (nameBuf == "G20") {
+        inches = true;
+        return;
+    }
+    if (nameBuf == "G21") {
+        inches = false;
+        return;
+    }
+
+    if (inches) {
+        for (int i = 0; i < NumSlots; i++) {
+            if (isScaledByUnit(slotName(i)[0]))
+                values[i] *= 25.4;
+        }
+        for (std::vector<Param>::iterator it = paramBuf.begin(); it != paramBuf.end(); ++it) {
+            if (isScaledByUnit(paramNames[it->key][0]))
+                it->value *= 25.4;
+        }
+    }
+
+    insertRow(size(), addName(nameBuf), mask, values, paramBuf.data(), paramBuf.size());
+}
+
+void CommandStore::getParams(std::size_t index, ParamList &params) const
+{
+    params.clear();
+    for (int i = 0; i < NumSlots; i++) {
+        if (has(index, static_cast<Slot>(i)))
+            params.push_back(std::make_pair(&slotName(i), slotValues[i][index]));
+    }
+    std::uint32_t begin = extraBegin[index];
+    std::uint32_t end = begin + extraCount[index];
+    for (std::uint32_t i = begin; i < end; i++)
+        params.push_back(std::make_pair(&paramNames[extras[i].key], extras[i].value));
+}
+
+void CommandStore::writeNumber(std::string &out, double value, int precision, bool padzero,
+                               std::int64_t iscale)
+{
+    // same rounding as Command::toGCode()
+    std::int64_t v = static_cast<std::int64_t>(value * static_cast<double>(iscale * 10));
+    if (v < 0) {
+        v = -v;
+        out += '-';
+    }
+    v += 5;
+    v /= 10;
+    writeDigits(out, static_cast<std::uint64_t>(v / iscale), 1);
+    if (!precision)
+        return;
+
+    int width = precision;
+    std::int64_t digits = v % iscale;
+    if (!padzero) {
+        if (!digits)
+            return;
+        while (digits % 10 == 0) {
+            digits /= 10;
+            --width;
+        }
+    }
+    out += '.';
+    writeDigits(out, static_cast<std::uint64_t>(digits), width);
+}
+
+void CommandStore::writeRow(std::size_t index, std::string &out, int precision, bool padzero,
+                            ParamList &params) const
+{
+    out += getName(index);
+    if (precision < 0)
+        precision = 0;
+    std::int64_t iscale = static_cast<std::int64_t>(std::pow(10.0, precision + 1)) / 10;
+
+    // the parameters are written in the order of the map of a Command
+    getParams(index, params);
+    std::sort(params.begin(), params.end(), [](const ParamList::value_type &a, const ParamList::value_type &b) {
+        return *a.first < *b.first;
+    });
+
+    for (ParamList::const_iterator it = params.begin(); it != params.end(); ++it) {
+        if (*it->first == "N")
+            continue;
+        out += ' ';
+        out += *it->first;
+        writeNumber(out, it->second, precision, padzero, iscale);
+    }
+}
+
+void CommandStore::writeGCode(std::size_t index, std::string &out, int precision, bool padzero) const
+{
+    ParamList params;
+    writeRow(index, out, precision, padzero, params);
+}
+
+void CommandStore::writeGCode(std::string &out, int precision, bool padzero) const
+{
+    ParamList params;
+    for (std::size_t i = 0; i < size(); i++) {
+        writeRow(i, out, precision, padzero, params);
+        out += '\n';
+    }
+}
+
+unsigned int CommandStore::getMemSize() const
+{
+    std::size_t mem = nameIds.capacity() * sizeof(std::uint32_t);
+    mem += slotMasks.capacity() * sizeof(std::uint8_t);
+    for (int i = 0; i < NumSlots; i++)
+        mem += slotValues[i].capacity() * sizeof(double);
+    mem += (extraBegin.capacity() + extraCount.capacity()) * sizeof(std::uint32_t);
+    mem += extras.capacity() * sizeof(Param);
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+        mem += it->capacity();
+    for (std::vector<std::string>::const_iterator it = paramNames.begin(); it != paramNames.end(); ++it)
+        mem += it->capacity();
+    return static_cast<unsigned int>(mem);
+}
+
+// ----------------------------------------------------------------------------
+
+Base::Placement CommandView::getPlacement(const Base::Vector3d pos) const
+{
+    static const std::string a = "A";
+    static const std::string b = "B";
+    static const std::string c = "C";
+    Base::Vector3d vec(store.get(index, CommandStore::X, pos.x),
+                       store.get(index, CommandStore::Y, pos.y),
+                       store.get(index, CommandStore::Z, pos.z));
+    Base::Rotation rot;
+    rot.setYawPitchRoll(getParam(a), getParam(b), getParam(c));
+    return Base::Placement(vec, rot);
+}
+
+Base::Vector3d CommandView::getCenter() const
+{
+    return Base::Vector3d(store.get(index, CommandStore::I),
+                          store.get(index, CommandStore::J),
+                          store.get(index, CommandStore::K));
+}
+
+bool CommandView::has(const std::string &param) const
+{
+    std::string p(param);
+    boost::to_upper(p);
+    return store.has(index, p);
+}
+
+double CommandView::getValue(const std::string &param) const
+{
+    std::string p(param);
+    boost::to_upper(p);
+    return store.get(index, p);
+}
+
+std::string CommandView::toGCode(int precision, bool padzero) const
+{
+    std::string str;
+    store.writeGCode(index, str, precision, padzero);
+    return str;
+}
@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PATH_COMMANDSTORE_H
+#define PATH_COMMANDSTORE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Command.h"
+
+namespace Path
+{
+
+/// The kinds of commands the path algorithms handle specially
+enum class Opcode : std::uint8_t
+{
+    Other,
+    Rapid,      ///< G0, G00
+    Feed,       ///< G1, G01
+    ArcCW,      ///< G2, G02
+    ArcCCW,     ///< G3, G03
+    Comment     ///< (...)
+};
+
+/**
+ * The CommandStore class keeps the commands of a toolpath in columns instead of
+ * separate Command objects. The name of a command is an index into a table of
+ * the distinct names. The parameters X, Y, Z, I, J, K and F have a column of
+ * their own, all other parameters go to an overflow table.
+ *
+ * The G-code parser and writer work directly on the columns. Apart from new
+ * names and the growing columns they don't allocate any memory.
+ */
+class PathExport CommandStore
+{
+public:
+    /// The parameters that have a column of their own
+    enum Slot { X, Y, Z, I, J, K, F, NumSlots };
+
+    CommandStore();
+    ~CommandStore();
+
+    /** @name Modification */
+    //@{
+    void clear();
+    void reserve(std::size_t count);
+    void append(const Command &cmd);
+    /// Appends a copy of a command of another store
+    void append(const CommandStore &store, std::size_t index);
+    /// Appends a command with the parameters of the slots set in \a mask, a bit per Slot
+    void append(const std::string &name, std::uint8_t mask, const double *values);
+    void insert(std::size_t pos, const Command &cmd);
+    void erase(std::size_t pos);
+    void swap(CommandStore &store);
+    /**
+     * Parses the G-code program and appends its commands. A program may contain
+     * several commands per line. G20 and G21 switch between inches and mm and
+     * are not added, the coordinates and feeds given in inches are converted
+     * to mm. Throws Base::BadFormatError for a malformed command, the commands
+     * before it are kept.
+     */
+    void appendGCode(const char *begin, const char *end);
+    //@}
+
+    /** @name Access */
+    //@{
+    std::size_t size() const
+    { return nameIds.size(); }
+    bool empty() const
+    { return nameIds.empty(); }
+    const std::string &getName(std::size_t index) const
+    { return names[nameIds[index]]; }
+    Opcode getOpcode(std::size_t index) const
+    { return opcodes[nameIds[index]]; }
+    bool has(std::size_t index, Slot slot) const
+    { return (slotMasks[index] & (1 << slot)) != 0; }
+    double get(std::size_t index, Slot slot, double fallback = 0.0) const
+    { return has(index, slot) ? slotValues[slot][index] : fallback; }
+    /// Whether the command has parameters without a column of their own
+    bool hasExtras(std::size_t index) const
+    { return extraCount[index] != 0; }
+    /// Works for any parameter, the name is expected in upper case
+    bool has(std::size_t index, const std::string &param) const;
+    double get(std::size_t index, const std::string &param, double fallback = 0.0) const;
+    typedef std::vector<std::pair<const std::string*, double> > ParamList;
+    /**
+     * Replaces the content of \a params with the names and values of all
+     * parameters of a command. The names stay valid as long as the store.
+     */
+    void getParams(std::size_t index, ParamList &params) const;
+    /// Creates a Command object with the name and parameters of a command
+    Command getCommand(std::size_t index) const;
+    //@}
+
+    /** @name G-code output */
+    //@{
+    /// Appends the command in the same format as Command::toGCode()
+    void writeGCode(std::size_t index, std::string &out, int precision = 6, bool padzero = true) const;
+    /// Appends all commands, each one followed by a newline
+    void writeGCode(std::string &out, int precision = 6, bool padzero = true) const;
+    /// Appends a parameter value in the format of Command::toGCode(), \a iscale is 10^precision
+    static void writeNumber(std::string &out, double value, int precision, bool padzero,
+                            std::int64_t iscale);
+    //@}
+
+    /// The memory used by the columns and tables
+    unsigned int getMemSize() const;
+
+private:
+    struct Param
+    {
+        std::uint32_t key;
+        double value;
+    };
+
+    std::uint32_t addName(const std::string &name);
+    std::uint32_t addParamName(const std::string &name);
+    int findSlot(const std::string &param) const;
+    int findExtra(std::size_t index, const std::string &param) const;
+    void insertRow(std::size_t pos, std::uint32_t nameId, std::uint8_t mask, const double *values,
+                   const Param *extra, std::size_t extraNum);
+    void parseCommand(const char *begin, const char *end, bool &inches);
+    void compactExtras();
+    void writeRow(std::size_t index, std::string &out, int precision, bool padzero, ParamList &params) const;
+
+private:
+    // the columns, one entry per command
+    std::vector<std::uint32_t> nameIds;
+    std::vector<std::uint8_t> slotMasks;
+    std::vector<double> slotValues[NumSlots];
+    std::vector<std::uint32_t> extraBegin;
+    std::vector<std::uint32_t> extraCount;
+
+    // the parameters without a column, the entries of a command are contiguous
+    std::vector<Param> extras;
+    std::size_t usedExtras;
+
+    // the distinct command and parameter names
+    std::vector<std::string> names;
+    std::vector<Opcode> opcodes;
+    std::unordered_map<std::string, std::uint32_t> nameIndex;
+    std::vector<std::string> paramNames;
+    std::unordered_map<std::string, std::uint32_t> paramIndex;
+
+    // buffers of the parser, kept to reuse their memory
+    std::string nameBuf;
+    std::string keyBuf;
+    std::string valueBuf;
+    std::vector<Param> paramBuf;
+};
+
+/**
+ * A read-only view of a command in a CommandStore. It provides the interface of
+ * Command, so that algorithms can process a toolpath without creating Command
+ * objects.
+ */
+class PathExport CommandView
+{
+public:
+    CommandView(const CommandStore &store, std::size_t index)
+      : store(store), index(index)
+    {}
+
+    const std::string &getName() const
+    { return store.getName(index); }
+    Opcode getOpcode() const
+    { return store.getOpcode(index); }
+    Base::Placement getPlacement(const Base::Vector3d pos = Base::Vector3d()) const;
+    Base::Vector3d getCenter() const;
+    bool has(const std::string &param) const;
+    double getValue(const std::string &param) const;
+    double getParam(const std::string &param, double fallback = 0.0) const
+    { return store.get(index, param, fallback); }
+    std::string toGCode(int precision = 6, bool padzero = true) const;
+    Command toCommand() const
+    { return store.getCommand(index); }
+
+private:
+    const CommandStore &store;
+    std::size_t index;
+};
+
+} // namespace Path
+
+
+#endif // PATH_COMMANDSTORE_H
@@ -0,0 +1,712 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <functional>
+# include <future>
+# include <limits>
+# include <thread>
+# include <unordered_map>
+#endif
+
+#include <Base/Exception.h>
+#include <Mod/Mesh/App/Core/MeshKernel.h>
+
+#include "DropCutter.h"
+#include "Path.h"
+#include "Tool.h"
+
+using namespace Path;
+
+// the maximum number of triangles in a leaf of the hierarchy
+static const std::size_t LeafSize = 4;
+
+template<class Func>
+static void parallelFor(std::size_t count, int threads, Func func)
+{
+    std::size_t numThreads = threads > 0 ? threads : std::thread::hardware_concurrency();
+    numThreads = std::max<std::size_t>(1, std::min(numThreads, count));
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t i; (i = next++) < count;)
+            func(i);
+    };
+
+    std::vector<std::future<void> > futures;
+    for (std::size_t i = 1; i < numThreads; ++i)
+        futures.push_back(std::async(std::launch::async, worker));
+    worker();
+    for (auto &future : futures)
+        future.get();
+}
+
+static void addMove(Toolpath &path, const char *name, const Base::Vector3d &pt,
+        double feedRate, double &lastFeedRate)
+{
+    Command cmd;
+    cmd.Name = name;
+    cmd.Parameters["X"] = pt.x;
+    cmd.Parameters["Y"] = pt.y;
+    cmd.Parameters["Z"] = pt.z;
+    if (feedRate > 0.0 && feedRate != lastFeedRate) {
+        cmd.Parameters["F"] = feedRate;
+        lastFeedRate = feedRate;
+    }
+    path.addCommand(cmd);
+}
+
+DropCutter::DropCutter(const MeshCore::MeshKernel &mesh, const Base::Matrix4D &mat, const Tool &tool)
+{
+    radius = tool.Diameter / 2.0;
+    if (!(radius > 0.0))
+        throw Base::ValueError("The diameter of the tool must be positive");
+    if (tool.Type == Tool::BALLENDMILL)
+        cornerRadius = radius;
+    else
+        cornerRadius = std::min(std::max(tool.CornerRadius, 0.0), radius);
+    flatRadius = radius - cornerRadius;
+
+    const MeshCore::MeshPointArray &points = mesh.GetPoints();
+    const MeshCore::MeshFacetArray &facets = mesh.GetFacets();
+
+    std::vector<Triangle> input;
+    input.reserve(facets.size());
+    for (MeshCore::MeshFacetArray::_TConstIterator it = facets.begin(); it != facets.end(); ++it) {
+        Triangle tria;
+        for (int i = 0; i < 3; i++) {
+            const MeshCore::MeshPoint &pnt = points[it->_aulPoints[i]];
+            tria.v[i] = mat * Base::Vector3d(pnt.x, pnt.y, pnt.z);
+            bound.Add(tria.v[i]);
+        }
+
+        // vertical and degenerated triangles are only touched by their edges
+        Base::Vector3d normal = (tria.v[1] - tria.v[0]) % (tria.v[2] - tria.v[0]);
+        double len = normal.Length();
+        if (len > 0.0) {
+            normal /= len;
+            if (normal.z < 0.0)
+                normal = -normal;
+        }
+        tria.normal = normal;
+        input.push_back(tria);
+    }
+
+    if (input.empty())
+        return;
+
+    std::vector<std::size_t> order(input.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    nodes.reserve(2 * input.size() / LeafSize + 1);
+    triangles.reserve(input.size());
+    build(input, order, 0, input.size());
+}
+
+DropCutter::~DropCutter()
+{
+}
+
+void DropCutter::build(std::vector<Triangle> &input, std::vector<std::size_t> &order,
+                       std::size_t begin, std::size_t end)
+{
+    Node node;
+    node.bmin[0] = node.bmin[1] = std::numeric_limits<double>::max();
+    node.bmax[0] = node.bmax[1] = -std::numeric_limits<double>::max();
+    node.zmax = -std::numeric_limits<double>::max();
+    for (std::size_t i = begin; i < end; i++) {
+        const Triangle &tria = input[order[i]];
+        for (int j = 0; j < 3; j++) {
+            node.bmin[0] = std::min(node.bmin[0], tria.v[j].x);
+            node.bmin[1] = std::min(node.bmin[1], tria.v[j].y);
+            node.bmax[0] = std::max(node.bmax[0], tria.v[j].x);
+            node.bmax[1] = std::max(node.bmax[1], tria.v[j].y);
+            node.zmax = std::max(node.zmax, tria.v[j].z);
+        }
+    }
+
+    std::size_t index = nodes.size();
+    nodes.push_back(node);
+    if (end - begin <= LeafSize) {
+        nodes[index].offset = static_cast<uint32_t>(triangles.size());
+        nodes[index].count = static_cast<uint32_t>(end - begin);
+        for (std::size_t i = begin; i < end; i++)
+            triangles.push_back(input[order[i]]);
+        return;
+    }
+
+    // split at the median of the triangle centers along the longer side
+    int axis = (node.bmax[0] - node.bmin[0] >= node.bmax[1] - node.bmin[1]) ? 0 : 1;
+    std::size_t mid = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&input, axis](std::size_t a, std::size_t b) {
+            const Triangle &ta = input[a];
+            const Triangle &tb = input[b];
+            if (axis == 0)
+                return ta.v[0].x + ta.v[1].x + ta.v[2].x < tb.v[0].x + tb.v[1].x + tb.v[2].x;
+            return ta.v[0].y + ta.v[1].y + ta.v[2].y < tb.v[0].y + tb.v[1].y + tb.v[2].y;
+        });
+
+    nodes[index].count = 0;
+    build(input, order, begin, mid);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    build(input, order, mid, end);
+}
+
+double DropCutter::lift(double rho) const
+{
+    // the height of the cutting edge above the tool tip at the distance rho from the axis
+    if (rho <= flatRadius)
+        return 0.0;
+    double d = std::min(rho - flatRadius, cornerRadius);
+    return cornerRadius - std::sqrt(cornerRadius * cornerRadius - d * d);
+}
+
+double DropCutter::drop(double x, double y, double minZ) const
+{
+    double z = minZ;
+    if (nodes.empty())
+        return z;
+
+    // The highest point of a box can lift the tool at most by its height less
+    // the lift of the tool at the nearest point of the box.
+    auto bound = [this, x, y](double xmin, double ymin, double xmax, double ymax, double zmax) {
+        double dx = std::max(0.0, std::max(xmin - x, x - xmax));
+        double dy = std::max(0.0, std::max(ymin - y, y - ymax));
+        double rho = std::sqrt(dx * dx + dy * dy);
+        if (rho > radius * (1.0 + 1e-9))
+            return -std::numeric_limits<double>::max();
+        return zmax - lift(rho);
+    };
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node &node = nodes[stack[--top]];
+        if (bound(node.bmin[0], node.bmin[1], node.bmax[0], node.bmax[1], node.zmax) <= z)
+            continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                const Triangle &tria = triangles[i];
+                const Base::Vector3d *v = tria.v;
+                if (bound(std::min(v[0].x, std::min(v[1].x, v[2].x)),
+                          std::min(v[0].y, std::min(v[1].y, v[2].y)),
+                          std::max(v[0].x, std::max(v[1].x, v[2].x)),
+                          std::max(v[0].y, std::max(v[1].y, v[2].y)),
+                          std::max(v[0].z, std::max(v[1].z, v[2].z))) > z)
+                    z = dropTriangle(tria, x, y, z);
+            }
+        }
+        else {
+            // visit the higher child first so that the other one is more likely skipped
+            uint32_t first = static_cast<uint32_t>(&node - nodes.data()) + 1;
+            uint32_t second = node.offset;
+            if (nodes[first].zmax > nodes[second].zmax)
+                std::swap(first, second);
+            stack[top++] = first;
+            stack[top++] = second;
+        }
+    }
+
+    return z;
+}
+
+void DropCutter::drop(std::vector<Base::Vector3d> &points, int threads) const
+{
+    const std::size_t blockSize = 1024;
+    std::size_t blocks = (points.size() + blockSize - 1) / blockSize;
+    parallelFor(blocks, threads, [&](std::size_t block) {
+        std::size_t end = std::min(points.size(), (block + 1) * blockSize);
+        for (std::size_t i = block * blockSize; i < end; i++)
+            points[i].z = drop(points[i].x, points[i].y, points[i].z);
+    });
+}
+
+double DropCutter::dropTriangle(const Triangle &tria, double x, double y, double z) const
+{
+    const Base::Vector3d &n = tria.normal;
+    if (n.z > 1e-9) {
+        // The lowest point of the flat disk towards the plane of the triangle,
+        // the sphere around it touches the plane at the contact point.
+        double qx = x;
+        double qy = y;
+        double nxy = std::sqrt(n.x * n.x + n.y * n.y);
+        if (nxy > 1e-12) {
+            qx -= flatRadius * n.x / nxy;
+            qy -= flatRadius * n.y / nxy;
+        }
+        double cx = qx - cornerRadius * n.x;
+        double cy = qy - cornerRadius * n.y;
+
+        // check if the contact point is inside the triangle in the XY plane
+        bool inside = true;
+        double sign = 0.0;
+        for (int i = 0; i < 3 && inside; i++) {
+            const Base::Vector3d &a = tria.v[i];
+            const Base::Vector3d &b = tria.v[(i + 1) % 3];
+            double cross = (b.x - a.x) * (cy - a.y) - (b.y - a.y) * (cx - a.x);
+            if (cross * sign < 0.0)
+                inside = false;
+            else if (cross != 0.0)
+                sign = cross;
+        }
+
+        if (inside) {
+            // no edge or corner can lift the tool higher than its plane
+            double d = n * tria.v[0];
+            double h = (d + cornerRadius - n.x * qx - n.y * qy) / n.z;
+            return std::max(z, h - cornerRadius);
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+        z = dropEdge(tria.v[i], tria.v[(i + 1) % 3], x, y, z);
+    return z;
+}
+
+double DropCutter::dropEdge(const Base::Vector3d &p1, const Base::Vector3d &p2,
+                            double x, double y, double z) const
+{
+    double ex = p2.x - p1.x;
+    double ey = p2.y - p1.y;
+    double ez = p2.z - p1.z;
+    double dx = p1.x - x;
+    double dy = p1.y - y;
+    double len2 = ex * ex + ey * ey;
+
+    if (len2 < 1e-18) {
+        // vertical edge
+        double rho = std::sqrt(dx * dx + dy * dy);
+        if (rho > radius * (1.0 + 1e-9))
+            return z;
+        return std::max(z, std::max(p1.z, p2.z) - lift(rho));
+    }
+
+    // the part of the edge below the tool, an edge that just touches the
+    // tool counts as below so that rounding doesn't decide about the contact
+    double b = dx * ex + dy * ey;
+    double c = dx * dx + dy * dy - radius * radius * (1.0 + 1e-9);
+    double disc = b * b - len2 * c;
+    if (disc < 0.0)
+        return z;
+    double sq = std::sqrt(disc);
+    double ta = std::max(0.0, (-b - sq) / len2);
+    double tb = std::min(1.0, (-b + sq) / len2);
+    if (ta > tb)
+        return z;
+
+    // the edge can lift the tool at most by its highest point less the lift
+    // at its nearest point
+    double tn = std::min(tb, std::max(ta, -b / len2));
+    double nx = dx + tn * ex;
+    double ny = dy + tn * ey;
+    if (std::max(p1.z + ez * ta, p1.z + ez * tb) - lift(std::sqrt(nx * nx + ny * ny)) <= z)
+        return z;
+
+    // The height of the tip touching a point of the edge. Along the edge the
+    // distance to the axis is convex and so is the lift of the tool, thus
+    // the height has a single maximum.
+    auto height = [&](double t) {
+        double px = dx + t * ex;
+        double py = dy + t * ey;
+        return p1.z + t * ez - lift(std::sqrt(px * px + py * py));
+    };
+    double best = std::max(height(ta), height(tb));
+
+    if (cornerRadius == 0.0) {
+        // the flat disk touches the highest point below it
+    }
+    else if (flatRadius == 0.0) {
+        // the ball touches the edge where it is tangent to the edge in the
+        // vertical plane through the edge
+        double len = std::sqrt(len2);
+        double tp = -b / len2;
+        double px = dx + tp * ex;
+        double py = dy + tp * ey;
+        double r2 = cornerRadius * cornerRadius - (px * px + py * py);
+        if (r2 > 0.0) {
+            double m = ez / len;
+            double t = tp + std::sqrt(r2) * m / std::sqrt(1.0 + m * m) / len;
+            if (t > ta && t < tb)
+                best = std::max(best, height(t));
+        }
+    }
+    else {
+        // golden section search of the maximum
+        const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+        double lo = ta;
+        double hi = tb;
+        double t1 = hi - ratio * (hi - lo);
+        double t2 = lo + ratio * (hi - lo);
+        double h1 = height(t1);
+        double h2 = height(t2);
+        // the height error is quadratic in the error of the parameter
+        double eps = 1e-5 * radius / std::sqrt(len2);
+        for (int i = 0; i < 64 && hi - lo > eps; i++) {
+            if (h1 < h2) {
+                lo = t1;
+                t1 = t2;
+                h1 = h2;
+                t2 = lo + ratio * (hi - lo);
+                h2 = height(t2);
+            }
+            else {
+                hi = t2;
+                t2 = t1;
+                h2 = h1;
+                t1 = hi - ratio * (hi - lo);
+                h1 = height(t1);
+            }
+        }
+        best = std::max(best, std::max(h1, h2));
+    }
+
+    return std::max(z, best);
+}
+
+void DropCutter::simplify(Polyline &line, double tolerance) const
+{
+    // Douglas-Peucker
+    if (line.size() < 3 || tolerance <= 0.0)
+        return;
+
+    std::vector<char> keep(line.size(), 0);
+    keep.front() = keep.back() = 1;
+    std::vector<std::pair<std::size_t, std::size_t> > stack;
+    stack.push_back(std::make_pair(0, line.size() - 1));
+    while (!stack.empty()) {
+        std::size_t first = stack.back().first;
+        std::size_t last = stack.back().second;
+        stack.pop_back();
+
+        const Base::Vector3d &a = line[first];
+        Base::Vector3d dir = line[last] - a;
+        double len2 = dir.Sqr();
+        double dmax = 0.0;
+        std::size_t imax = first;
+        for (std::size_t i = first + 1; i < last; i++) {
+            Base::Vector3d v = line[i] - a;
+            double d2;
+            if (len2 > 0.0)
+                d2 = (v % dir).Sqr() / len2;
+            else
+                d2 = v.Sqr();
+            if (d2 > dmax) {
+                dmax = d2;
+                imax = i;
+            }
+        }
+
+        if (dmax > tolerance * tolerance) {
+            keep[imax] = 1;
+            stack.push_back(std::make_pair(first, imax));
+            stack.push_back(std::make_pair(imax, last));
+        }
+    }
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < line.size(); i++) {
+        if (keep[i])
+            line[count++] = line[i];
+    }
+    line.resize(count);
+}
+
+void DropCutter::scan(Toolpath &path, const Base::BoundBox3d &box, double stepOver,
+        double sampleInterval, double minZ, double safeHeight, bool zigzag,
+        double tolerance, double feedRate, double feedRateVertical, int threads) const
+{
+    if (!(stepOver > 0.0) || !(sampleInterval > 0.0))
+        throw Base::ValueError("Step over and sample interval must be positive");
+    if (!box.IsValid())
+        throw Base::ValueError("Invalid scan area");
+
+    double width = box.MaxX - box.MinX;
+    double height = box.MaxY - box.MinY;
+    std::size_t numLines = static_cast<std::size_t>(std::ceil(height / stepOver - 1e-9)) + 1;
+    std::size_t numSamples = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(width / sampleInterval - 1e-9)));
+    std::size_t numLinks = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(stepOver / sampleInterval - 1e-9)));
+
+    auto lineY = [&](std::size_t k) {
+        return std::min(box.MinY + k * stepOver, box.MaxY);
+    };
+    auto reversed = [zigzag](std::size_t k) {
+        return zigzag && (k % 2) == 1;
+    };
+
+    // The lines are computed in parallel, each one with the link over the
+    // surface to the start of the next line.
+    std::vector<Polyline> lines(numLines);
+    std::vector<Polyline> links(numLines);
+    parallelFor(numLines, threads, [&](std::size_t k) {
+        double y = lineY(k);
+        Polyline &line = lines[k];
+        line.reserve(numSamples + 1);
+        for (std::size_t i = 0; i <= numSamples; i++) {
+            double x = box.MinX + width * i / numSamples;
+            line.push_back(Base::Vector3d(x, y, drop(x, y, minZ)));
+        }
+        if (reversed(k))
+            std::reverse(line.begin(), line.end());
+        simplify(line, tolerance);
+
+        if (zigzag && k + 1 < numLines) {
+            Polyline &link = links[k];
+            double x = line.back().x;
+            double y2 = lineY(k + 1);
+            for (std::size_t i = 0; i <= numLinks; i++) {
+                double yi = y + (y2 - y) * i / numLinks;
+                link.push_back(Base::Vector3d(x, yi, drop(x, yi, minZ)));
+            }
+            simplify(link, tolerance);
+        }
+    });
+
+    double lastFeedRate = 0.0;
+    for (std::size_t k = 0; k < numLines; k++) {
+        const Polyline &line = lines[k];
+        std::size_t first = 1;
+        if (k == 0 || !zigzag) {
+            const Base::Vector3d &start = line.front();
+            addMove(path, "G0", Base::Vector3d(start.x, start.y, safeHeight), 0.0, lastFeedRate);
+            addMove(path, "G1", start, feedRateVertical, lastFeedRate);
+        }
+        else {
+            // the link ends at the start of this line
+            const Polyline &link = links[k - 1];
+            for (std::size_t i = 1; i + 1 < link.size(); i++)
+                addMove(path, "G1", link[i], feedRate, lastFeedRate);
+            first = 0;
+        }
+
+        for (std::size_t i = first; i < line.size(); i++)
+            addMove(path, "G1", line[i], feedRate, lastFeedRate);
+
+        if (k + 1 == numLines || !zigzag) {
+            const Base::Vector3d &end = line.back();
+            addMove(path, "G0", Base::Vector3d(end.x, end.y, safeHeight), 0.0, lastFeedRate);
+        }
+    }
+}
+
+std::vector<std::vector<DropCutter::Polyline> > DropCutter::waterlines(
+        const std::vector<double> &heights, const Base::BoundBox3d &box,
+        double sampleInterval, double tolerance, int threads) const
+{
+    if (!(sampleInterval > 0.0))
+        throw Base::ValueError("The sample interval must be positive");
+    if (!box.IsValid())
+        throw Base::ValueError("Invalid waterline area");
+
+    const double lowest = -std::numeric_limits<double>::max();
+    int nx = std::max(1, static_cast<int>(std::ceil((box.MaxX - box.MinX) / sampleInterval - 1e-9)));
+    int ny = std::max(1, static_cast<int>(std::ceil((box.MaxY - box.MinY) / sampleInterval - 1e-9)));
+    double sx = (box.MaxX - box.MinX) / nx;
+    double sy = (box.MaxY - box.MinY) / ny;
+
+    // the heights of the tool on the grid are shared by all levels
+    std::vector<double> grid((nx + 1) * (ny + 1));
+    parallelFor(ny + 1, threads, [&](std::size_t j) {
+        double y = box.MinY + sy * j;
+        for (int i = 0; i <= nx; i++)
+            grid[j * (nx + 1) + i] = drop(box.MinX + sx * i, y, lowest);
+    });
+
+    auto position = [&](int i, int j) {
+        return Base::Vector3d(box.MinX + sx * i, box.MinY + sy * j, 0.0);
+    };
+
+    // The grid is surrounded by a ring of nodes without material, so that
+    // all contours are closed. Edges are identified by their lower left node
+    // and their direction.
+    const int64_t stride = nx + 3;
+    auto edgeId = [stride](int i, int j, int dir) {
+        return (((j + 1) * stride) + (i + 1)) * 2 + dir;
+    };
+
+    struct Crossing
+    {
+        Base::Vector3d point;
+        bool border;
+    };
+
+    std::vector<std::vector<Polyline> > result;
+    for (double level : heights) {
+        auto inside = [&](int i, int j) {
+            if (i < 0 || j < 0 || i > nx || j > ny)
+                return false;
+            return grid[j * (nx + 1) + i] > level;
+        };
+
+        // Walk around each cell counter-clockwise. A contour segment starts
+        // where the walk leaves the material and ends where it enters it
+        // again, so the material is on the left of the segment.
+        std::unordered_map<int64_t, int64_t> next;
+        std::vector<int64_t> edges;
+        for (int j = -1; j <= ny; j++) {
+            for (int i = -1; i <= nx; i++) {
+                bool in[4] = { inside(i, j), inside(i + 1, j), inside(i + 1, j + 1), inside(i, j + 1) };
+                if (in[0] == in[1] && in[1] == in[2] && in[2] == in[3])
+                    continue;
+
+                int64_t ids[4] = { edgeId(i, j, 0), edgeId(i + 1, j, 1), edgeId(i, j + 1, 0), edgeId(i, j, 1) };
+                int starts[2], ends[2];
+                int numStarts = 0, numEnds = 0;
+                for (int k = 0; k < 4; k++) {
+                    if (in[k] && !in[(k + 1) % 4])
+                        starts[numStarts++] = k;
+                    else if (!in[k] && in[(k + 1) % 4])
+                        ends[numEnds++] = k;
+                }
+
+                if (numStarts == 1) {
+                    next[ids[starts[0]]] = ids[ends[0]];
+                }
+                else {
+                    // For a saddle the center decides whether the two corners
+                    // with material are connected.
+                    Base::Vector3d center = position(i, j) + Base::Vector3d(sx / 2, sy / 2, 0.0);
+                    bool connected = drop(center.x, center.y, lowest) > level;
+                    for (int s = 0; s < 2; s++) {
+                        int k = starts[s];
+                        int e = connected ? (k + 1) % 4 : (k + 3) % 4;
+                        next[ids[k]] = ids[e];
+                    }
+                }
+            }
+        }
+
+        // refine the crossings of the grid edges in parallel
+        edges.reserve(next.size());
+        for (const auto &it : next)
+            edges.push_back(it.first);
+        std::vector<Crossing> crossings(edges.size());
+        parallelFor(edges.size(), threads, [&](std::size_t k) {
+            int64_t id = edges[k];
+            int dir = static_cast<int>(id % 2);
+            int i = static_cast<int>((id / 2) % stride) - 1;
+            int j = static_cast<int>((id / 2) / stride) - 1;
+            int i2 = dir == 0 ? i + 1 : i;
+            int j2 = dir == 0 ? j : j + 1;
+
+            Crossing &crossing = crossings[k];
+            bool real1 = i >= 0 && j >= 0 && i <= nx && j <= ny;
+            bool real2 = i2 >= 0 && j2 >= 0 && i2 <= nx && j2 <= ny;
+            crossing.border = !real1 || !real2;
+            if (crossing.border) {
+                crossing.point = real1 ? position(i, j) : position(i2, j2);
+            }
+            else {
+                Base::Vector3d lo = position(i, j);
+                Base::Vector3d hi = position(i2, j2);
+                if (inside(i, j))
+                    std::swap(lo, hi);
+                for (int n = 0; n < 64 && (hi - lo).Length() > tolerance; n++) {
+                    Base::Vector3d mid = (lo + hi) / 2;
+                    if (drop(mid.x, mid.y, lowest) > level)
+                        hi = mid;
+                    else
+                        lo = mid;
+                }
+                crossing.point = (lo + hi) / 2;
+            }
+            crossing.point.z = level;
+        });
+
+        std::unordered_map<int64_t, std::size_t> index;
+        for (std::size_t k = 0; k < edges.size(); k++)
+            index[edges[k]] = k;
+
+        // chain the segments to loops and cut them where they leave the area
+        std::vector<Polyline> lines;
+        std::unordered_map<int64_t, bool> visited;
+        for (int64_t start : edges) {
+            if (visited[start])
+                continue;
+            std::vector<std::size_t> loop;
+            for (int64_t id = start; !visited[id]; id = next[id]) {
+                visited[id] = true;
+                loop.push_back(index[id]);
+            }
+
+            std::size_t first = 0;
+            while (first < loop.size() && !crossings[loop[first]].border)
+                ++first;
+            if (first == loop.size()) {
+                Polyline line;
+                for (std::size_t k : loop)
+                    line.push_back(crossings[k].point);
+                line.push_back(line.front());
+                simplify(line, tolerance);
+                if (line.size() > 3)
+                    lines.push_back(line);
+                continue;
+            }
+
+            Polyline line;
+            for (std::size_t n = 1; n <= loop.size(); n++) {
+                const Crossing &crossing = crossings[loop[(first + n) % loop.size()]];
+                if (!crossing.border) {
+                    line.push_back(crossing.point);
+                }
+                else if (!line.empty()) {
+                    simplify(line, tolerance);
+                    if (line.size() > 1)
+                        lines.push_back(line);
+                    line.clear();
+                }
+            }
+        }
+        result.push_back(lines);
+    }
+
+    return result;
+}
+
+void DropCutter::waterlines(Toolpath &path, const std::vector<double> &heights,
+        const Base::BoundBox3d &box, double sampleInterval, double safeHeight,
+        double tolerance, double feedRate, double feedRateVertical, int threads) const
+{
+    std::vector<double> levels(heights);
+    std::sort(levels.begin(), levels.end(), std::greater<double>());
+    std::vector<std::vector<Polyline> > result = waterlines(levels, box, sampleInterval, tolerance, threads);
+
+    double lastFeedRate = 0.0;
+    for (const auto &lines : result) {
+        for (const auto &line : lines) {
+            const Base::Vector3d &start = line.front();
+            const Base::Vector3d &end = line.back();
+            addMove(path, "G0", Base::Vector3d(start.x, start.y, safeHeight), 0.0, lastFeedRate);
+            addMove(path, "G1", start, feedRateVertical, lastFeedRate);
+            for (std::size_t i = 1; i < line.size(); i++)
+                addMove(path, "G1", line[i], feedRate, lastFeedRate);
+            addMove(path, "G0", Base::Vector3d(end.x, end.y, safeHeight), 0.0, lastFeedRate);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PATH_DROPCUTTER_H
+#define PATH_DROPCUTTER_H
+
+#include <cstdint>
+#include <vector>
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+namespace MeshCore {
+class MeshKernel;
+}
+
+namespace Path
+{
+
+class Tool;
+class Toolpath;
+
+/**
+ * The DropCutter class computes cutter locations of a tool on a triangulated
+ * surface for 3D surfacing. For a position in the XY plane the tool is dropped
+ * along Z until it touches the surface, which gives the lowest height of the
+ * tool tip without cutting into the model.
+ *
+ * The tool is described by a flat disk that is swept by a sphere, so ball end
+ * mills (no disk), flat end mills (no sphere) and bull nose mills are handled
+ * alike. The triangles are kept in a bounding volume hierarchy over their XY
+ * extent that also stores the highest point of each node, so that triangles
+ * which are too low to lift the tool any further are skipped.
+ *
+ * Once built the object is read-only, so the scanlines and the grid of the
+ * waterlines are computed by several threads.
+ */
+class PathExport DropCutter
+{
+public:
+    typedef std::vector<Base::Vector3d> Polyline;
+
+    /**
+     * Builds the hierarchy of the facets of \a mesh transformed by \a mat.
+     * A tool of type BallEndMill is a ball of half its diameter, all other
+     * tools are flat end mills with the corner radius of the tool.
+     */
+    DropCutter(const MeshCore::MeshKernel &mesh, const Base::Matrix4D &mat, const Tool &tool);
+    ~DropCutter();
+
+    /// The bounding box of the surface
+    const Base::BoundBox3d &getBoundBox() const
+    { return bound; }
+
+    /**
+     * Returns the height of the tool tip at \a x, \a y where the tool touches
+     * the surface, or \a minZ if the tool doesn't touch the surface above it.
+     */
+    double drop(double x, double y, double minZ) const;
+    /**
+     * Drops the tool at all \a points. The z value of a point is used as its
+     * minimum height. \a threads is the number of threads to use, 0 means one
+     * per CPU core.
+     */
+    void drop(std::vector<Base::Vector3d> &points, int threads=0) const;
+
+    /**
+     * Scans the area \a box along lines parallel to the X axis that are
+     * \a stepOver apart. The tool is dropped every \a sampleInterval and
+     * points which deviate less than \a tolerance from the line through their
+     * neighbours are removed.
+     *
+     * With \a zigzag every other line is run backwards and the lines are
+     * linked by feed moves over the surface, otherwise the tool retracts to
+     * \a safeHeight between the lines. A feed rate of zero isn't written.
+     */
+    void scan(Toolpath &path, const Base::BoundBox3d &box, double stepOver,
+            double sampleInterval, double minZ, double safeHeight, bool zigzag=true,
+            double tolerance=0.01, double feedRate=0.0, double feedRateVertical=0.0,
+            int threads=0) const;
+
+    /**
+     * Computes the waterlines of the surface at the given \a heights inside
+     * the area \a box. The heights of the tool are sampled on a grid with a
+     * spacing of \a sampleInterval, the crossings of the grid edges are
+     * refined to \a tolerance. The material is on the left side of the
+     * lines, which are closed unless they leave the area.
+     */
+    std::vector<std::vector<Polyline> > waterlines(const std::vector<double> &heights,
+            const Base::BoundBox3d &box, double sampleInterval, double tolerance=0.01,
+            int threads=0) const;
+    /// Adds the waterlines to \a path from the top to the bottom level
+    void waterlines(Toolpath &path, const std::vector<double> &heights,
+            const Base::BoundBox3d &box, double sampleInterval, double safeHeight,
+            double tolerance=0.01, double feedRate=0.0, double feedRateVertical=0.0,
+            int threads=0) const;
+
+private:
+    struct Node
+    {
+        double bmin[2];
+        double bmax[2];
+        /// The highest point of all triangles of the node
+        double zmax;
+        /// For leaves the first triangle, otherwise the index of the second child
+        uint32_t offset;
+        /// For leaves the number of triangles, zero for inner nodes
+        uint32_t count;
+    };
+    struct Triangle
+    {
+        Base::Vector3d v[3];
+        /// The unit normal pointing upwards
+        Base::Vector3d normal;
+    };
+
+    void build(std::vector<Triangle> &input, std::vector<std::size_t> &order,
+               std::size_t begin, std::size_t end);
+    double dropTriangle(const Triangle &, double x, double y, double z) const;
+    double dropEdge(const Base::Vector3d &p1, const Base::Vector3d &p2,
+                    double x, double y, double z) const;
+    double lift(double radius) const;
+    void simplify(Polyline &line, double tolerance) const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    Base::BoundBox3d bound;
+    /// The radius of the tool
+    double radius;
+    /// The radius of the sweeping sphere, i.e. the corner radius
+    double cornerRadius;
+    /// The radius of the flat disk
+    double flatRadius;
+};
+
+} // namespace Path
+
+
+#endif // PATH_DROPCUTTER_H
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <mutex>
 # include <boost/regex.hpp>
 #endif
 
@@ -42,6 +43,9 @@
 //#include "Mod/Robot/App/kdl_cp/utilities/error.h"
 
 #include "Path.h"
+#include "PostFormatter.h"
+#include "ToolpathCache.h"
+#include "ToolpathOptimizer.h"
 #include <Mod/Path/App/PathSegmentWalker.h>
 
 using namespace Path;
@@ -54,16 +58,14 @@ Toolpath::Toolpath()
 }
 
 Toolpath::Toolpath(const Toolpath& otherPath)
-    : vpcCommands(otherPath.vpcCommands.size())
+    : commands(otherPath.commands)
     , center(otherPath.center)
+    , cache(otherPath.cache)
 {
-    *this = otherPath;
-    recalculate();
 }
 
 Toolpath::~Toolpath()
 {
-    clear();
 }
 
 Toolpath &Toolpath::operator=(const Toolpath& otherPath)
@@ -71,85 +73,83 @@ Toolpath &Toolpath::operator=(const Toolpath& otherPath)
     if (this == &otherPath)
         return *this;
 
-    clear();
-    vpcCommands.resize(otherPath.vpcCommands.size());
-    int i = 0;
-    for (std::vector<Command*>::const_iterator it=otherPath.vpcCommands.begin();it!=otherPath.vpcCommands.end();++it,i++) {
-        vpcCommands[i] = new Command(**it);
-    }
+    commands = otherPath.commands;
     center = otherPath.center;
-    recalculate();
+    cache = otherPath.cache;
     return *this;
 }
 
 void Toolpath::clear(void)
 {
-    for(std::vector<Command*>::iterator it = vpcCommands.begin();it!=vpcCommands.end();++it)
-        delete ( *it );
-    vpcCommands.clear();
+    commands.clear();
     recalculate();
 }
 
 void Toolpath::addCommand(const Command &Cmd)
 {
-    Command *tmp = new Command(Cmd);
-    vpcCommands.push_back(tmp);
-    recalculate();
+    commands.append(Cmd);
+    invalidate(commands.size() - 1);
 }
 
 void Toolpath::insertCommand(const Command &Cmd, int pos)
 {
     if (pos == -1) {
         addCommand(Cmd);
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        Command *tmp = new Command(Cmd);
-        vpcCommands.insert(vpcCommands.begin()+pos,tmp);
+    } else if (pos <= static_cast<int>(commands.size())) {
+        commands.insert(pos, Cmd);
+        invalidate(pos);
     } else {
         throw Base::IndexError("Index not in range");
     }
-    recalculate();
 }
 
 void Toolpath::deleteCommand(int pos)
 {
-    if (pos == -1) {
-        //delete(*vpcCommands.rbegin()); // causes crash
-        vpcCommands.pop_back();
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        vpcCommands.erase (vpcCommands.begin()+pos);
+    if (pos == -1 && !commands.empty()) {
+        commands.erase(commands.size() - 1);
+        invalidate(commands.size());
+    } else if (pos >= 0 && pos < static_cast<int>(commands.size())) {
+        commands.erase(pos);
+        invalidate(pos);
     } else {
         throw Base::IndexError("Index not in range");
     }
-    recalculate();
 }
 
-double Toolpath::getLength()
+ToolpathCache &Toolpath::getCache() const
 {
-    if(vpcCommands.size()==0)
-        return 0;
-    double l = 0;
-    Vector3d last(0,0,0);
-    Vector3d next;
-    for(std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        next = (*it)->getPlacement(last).getPosition();
-        if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
-            // straight line
-            l += (next - last).Length();
-            last = next;
-        } else if ( (name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
-            // arc
-            Vector3d center = (*it)->getCenter();
-            double radius = (last - center).Length();
-            double angle = (next - center).GetAngle(last - center);
-            l += angle * radius;
-            last = next;
+    // the cache is created by the first query
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!cache)
+        cache = std::make_shared<ToolpathCache>();
+    return *cache;
+}
+
+void Toolpath::invalidate(std::size_t index)
+{
+    if (!cache)
+        return;
+
+    // a shared cache is still valid for the other copies
+    if (cache.use_count() > 1) {
+        if (index == 0) {
+            cache.reset();
+            return;
         }
+        cache = std::make_shared<ToolpathCache>(*cache);
     }
-    return l;
+    cache->invalidate(index);
 }
 
-double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double vRapid)
+double Toolpath::getLength() const
+{
+    if(commands.empty())
+        return 0;
+    return getCache().getLength(*this);
+}
+
+double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double vRapid) const
 {
     // check the feedrates are set
     if ((hFeed == 0) || (vFeed == 0)) {
@@ -168,209 +168,75 @@ double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double
         vRapid = vFeed;
     }
 
-    if (vpcCommands.size() == 0) {
+    if (commands.empty()) {
         return 0;
     }
-    double l = 0;
-    double time = 0;
-    bool verticalMove = false;
-    Vector3d last(0,0,0);
-    Vector3d next;
-    for (std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        float feedrate = (*it)->getParam("F");
-
-        l = 0;
-        verticalMove = false;
-        feedrate = hFeed;
-        next = (*it)->getPlacement(last).getPosition();
-
-        if (last.z != next.z){
-            verticalMove = true;
-            feedrate = vFeed;
-        }
-
-        if ((name == "G0") || (name == "G00")){
-            // Rapid Move
-            l += (next - last).Length();
-            feedrate = hRapid;
-            if(verticalMove){
-                feedrate = vRapid;
-            }
-        }else if ((name == "G1") || (name == "G01")) {
-            // Feed Move
-            l += (next - last).Length();
-        }else if ((name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
-            // Arc Move
-            Vector3d center = (*it)->getCenter();
-            double radius = (last - center).Length();
-            double angle = (next - center).GetAngle(last - center);
-            l += angle * radius;
-        }
-
-        time += l / feedrate;
-        last = next;
-    }
-    return time;
+    return getCache().getCycleTime(*this, hFeed, vFeed, hRapid, vRapid);
 }
 
-class BoundBoxSegmentVisitor : public PathSegmentVisitor
+Base::BoundBox3d Toolpath::getBoundBox() const
 {
-public:
-    BoundBoxSegmentVisitor()
-    { }
-
-    virtual void g0(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts)
-    {
-      (void)id;
-      processPt(last);
-      processPts(pts);
-      processPt(next);
-    }
-    virtual void g1(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts)
-    {
-      (void)id;
-      processPt(last);
-      processPts(pts);
-      processPt(next);
-    }
-    virtual void g23(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts, const Base::Vector3d &center)
-    {
-      (void)id;
-      (void)center;
-      processPt(last);
-      processPts(pts);
-      processPt(next);
-    }
-    virtual void g8x(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts,
-                     const std::deque<Base::Vector3d> &p, const std::deque<Base::Vector3d> &q)
-    {
-      (void)id;
-      (void)q; // always within the bounds of p
-      processPt(last);
-      processPts(pts);
-      processPts(p);
-      processPt(next);
-    }
-    virtual void g38(int id, const Base::Vector3d &last, const Base::Vector3d &next)
-    {
-      (void)id;
-      processPt(last);
-      processPt(next);
-    }
-
-    Base::BoundBox3d bb;
-
-private:
-    void processPts(const std::deque<Base::Vector3d> &pts) {
-        for (std::deque<Base::Vector3d>::const_iterator it=pts.begin(); pts.end() != it; ++it) {
-            processPt(*it);
-        }
-    }
-    void processPt(const Base::Vector3d &pt) {
-        bb.MaxX = std::max(bb.MaxX, pt.x);
-        bb.MinX = std::min(bb.MinX, pt.x);
-        bb.MaxY = std::max(bb.MaxY, pt.y);
-        bb.MinY = std::min(bb.MinY, pt.y);
-        bb.MaxZ = std::max(bb.MaxZ, pt.z);
-        bb.MinZ = std::min(bb.MinZ, pt.z);
-    }
-};
+    return getCache().getBoundBox(*this);
+}
 
-Base::BoundBox3d Toolpath::getBoundBox() const
+bool Toolpath::getPositionAt(double time, double hFeed, double vFeed, double hRapid, double vRapid,
+                             std::size_t &index, Base::Vector3d &pos) const
 {
-    BoundBoxSegmentVisitor visitor;
-    PathSegmentWalker walker(*this);
-    walker.walk(visitor, Vector3d(0, 0, 0));
-    
-    return visitor.bb;
+    if ((hFeed == 0) || (vFeed == 0))
+        return false;
+    if (hRapid == 0)
+        hRapid = hFeed;
+    if (vRapid == 0)
+        vRapid = vFeed;
+    return getCache().getPosition(*this, time, hFeed, vFeed, hRapid, vRapid, index, pos);
 }
 
-static void bulkAddCommand(const std::string &gcodestr, std::vector<Command*> &commands, bool &inches)
+std::vector<std::size_t> Toolpath::getCommandsInBox(const Base::BoundBox3d &box) const
 {
-    Command *cmd = new Command();
-    cmd->setFromGCode(gcodestr);
-    if ("G20" == cmd->Name) {
-        inches = true;
-        delete cmd;
-    } else if ("G21" == cmd->Name) {
-        inches = false;
-        delete cmd;
-    } else {
-        if (inches) {
-            cmd->scaleBy(25.4);
-        }
-        commands.push_back(cmd);
-    }
+    std::vector<std::size_t> indices;
+    getCache().getCommandsInBox(*this, box, indices);
+    return indices;
 }
 
 void Toolpath::setFromGCode(const std::string instr)
 {
     clear();
 
-    // remove comments
-    //boost::regex e("\\(.*?\\)");
-    //std::string str = boost::regex_replace(instr, e, "");
-    std::string str(instr);
-
-    // split input string by () or G or M commands
-    std::string mode = "command";
-    std::size_t found = str.find_first_of("(gGmM");
-    int last = -1;
-    bool inches = false;
-    while (found != std::string::npos)
-    {
-        if (str[found] == '(') {
-            // start of comment
-            if ( (last > -1) && (mode == "command") ) {
-                // before opening a comment, add the last found command
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
-            }
-            mode = "comment";
-            last = found;
-            found = str.find_first_of(')', found+1);
-        } else if (str[found] == ')') {
-            // end of comment
-            std::string gcodestr = str.substr(last, found-last+1);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
-            last = -1;
-            found = str.find_first_of("(gGmM", found+1);
-            mode = "command";
-        } else if (mode == "command") {
-            // command
-            if (last > -1) {
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
-            }
-            last = found;
-            found = str.find_first_of("(gGmM", found+1);
-        }
-    }
-    // add the last command found, if any
-    if (last > -1) {
-        if (mode == "command") {
-            std::string gcodestr = str.substr(last,std::string::npos);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
-        }
-    }
+    // the commands are split by () or G or M and parsed in a single pass
+    commands.reserve(instr.size() / 16);
+    commands.appendGCode(instr.data(), instr.data() + instr.size());
     recalculate();
 }
 
 std::string Toolpath::toGCode(void) const
 {
     std::string result;
-    for (std::vector<Command*>::const_iterator it=vpcCommands.begin();it!=vpcCommands.end();++it) {
-        result += (*it)->toGCode();
-        result += "\n";
-    }
+    commands.writeGCode(result);
     return result;
 }
 
+void Toolpath::post(std::ostream &out, PostFormatter &formatter) const
+{
+    // the modal state doesn't carry over from other paths
+    formatter.reset();
+    for (std::size_t i = 0; i < commands.size(); i++)
+        formatter.writeCommand(commands, i, out);
+    formatter.flush(out);
+}
+
+void Toolpath::optimize(ToolpathOptimizer &optimizer)
+{
+    CommandStore result;
+    optimizer.optimize(commands, result);
+    commands.swap(result);
+    invalidate(0);
+}
+
 void Toolpath::recalculate(void) // recalculates the path cache
 {
+    invalidate(0);
 
-    if(vpcCommands.size()==0)
+    if(commands.empty())
         return;
 
     // TODO recalculate the KDL stuff. At the moment, this is unused.
@@ -434,7 +300,7 @@ void Toolpath::recalculate(void) // recalculates the path cache
 
 unsigned int Toolpath::getMemSize (void) const
 {
-    return toGCode().size();
+    return commands.getMemSize();
 }
 
 void Toolpath::setCenter(const Base::Vector3d &c)
@@ -455,7 +321,7 @@ void Toolpath::Save (Writer &writer) const
         writer.incInd();
         saveCenter(writer, center);
         for(unsigned int i = 0; i < getSize(); i++) {
-            vpcCommands[i]->Save(writer);
+            getCommand(i).Save(writer);
         }
         writer.decInd();
     } else {
@@ -470,9 +336,10 @@ void Toolpath::Save (Writer &writer) const
 
 void Toolpath::SaveDocFile (Base::Writer &writer) const
 {
-    if (toGCode().empty())
+    std::string gcode = toGCode();
+    if (gcode.empty())
         return;
-    writer.Stream() << toGCode();
+    writer.Stream() << gcode;
 }
 
 void Toolpath::Restore(XMLReader &reader)
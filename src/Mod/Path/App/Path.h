@@ -25,8 +25,11 @@
 #define PATH_Path_H
 
 #include "Command.h"
+#include "CommandStore.h"
 //#include "Mod/Robot/App/kdl_cp/path_composite.hpp"
 //#include "Mod/Robot/App/kdl_cp/frames_io.hpp"
+#include <iosfwd>
+#include <memory>
 #include <Base/BoundBox.h>
 #include <Base/Persistence.h>
 #include <Base/Vector3D.h>
@@ -34,6 +37,10 @@
 namespace Path
 {
 
+    class PostFormatter;
+    class ToolpathCache;
+    class ToolpathOptimizer;
+
     /** The representation of a CNC Toolpath */
     
     class PathExport Toolpath : public Base::Persistence
@@ -59,17 +66,24 @@ namespace Path
             void addCommand(const Command &Cmd); // adds a command at the end
             void insertCommand(const Command &Cmd, int); // inserts a command
             void deleteCommand(int); // deletes a command
-            double getLength(void); // return the Length (mm) of the Path
-            double getCycleTime(double, double, double, double); // return the Cycle Time (s) of the Path
-            void recalculate(void); // recalculates the points
+            double getLength(void) const; // return the Length (mm) of the Path
+            double getCycleTime(double, double, double, double) const; // return the Cycle Time (s) of the Path
+            void recalculate(void); // drops the cached lengths and extents
             void setFromGCode(const std::string); // sets the path from the contents of the given GCode string
             std::string toGCode(void) const; // gets a gcode string representation from the Path
+            void post(std::ostream &out, PostFormatter &formatter) const; // writes the gcode for a controller
+            void optimize(ToolpathOptimizer &optimizer); // replaces the moves by fewer lines and arcs
             Base::BoundBox3d getBoundBox(void) const;
+            // returns the index of the command and the position at the given time for the feed rates of getCycleTime()
+            bool getPositionAt(double time, double hFeed, double vFeed, double hRapid, double vRapid,
+                               std::size_t &index, Base::Vector3d &pos) const;
+            // returns the indices of the commands whose extent intersects the box
+            std::vector<std::size_t> getCommandsInBox(const Base::BoundBox3d &box) const;
             
             // shortcut functions
-            unsigned int getSize(void) const { return vpcCommands.size(); }
-            const std::vector<Command*> &getCommands(void) const { return vpcCommands; }
-            const Command &getCommand(unsigned int pos)    const { return *vpcCommands[pos]; }
+            unsigned int getSize(void) const { return commands.size(); }
+            const CommandStore &getCommandStore(void) const { return commands; }
+            Command getCommand(unsigned int pos) const { return commands.getCommand(pos); }
         
             // support for rotation
             const Base::Vector3d& getCenter() const { return center; }
@@ -78,8 +92,14 @@ namespace Path
             static const int SchemaVersion = 2;
 
         protected:
-            std::vector<Command*> vpcCommands;
+            ToolpathCache &getCache(void) const;
+            void invalidate(std::size_t index); // the commands from the index on changed
+
+        protected:
+            CommandStore commands;
             Base::Vector3d center;
+            // the lengths and extents, shared by the copies of the path until they change
+            mutable std::shared_ptr<ToolpathCache> cache;
             //KDL::Path_Composite *pcPath;
             
         /*
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #include "Mod/Path/App/Path.h"
+#include "Mod/Path/App/ToolpathOptimizer.h"
 
 // inclusion of the generated files (generated out of PathPy.xml)
 #include "PathPy.h"
@@ -198,6 +199,56 @@ PyObject* PathPy::getCycleTime(PyObject * args)
     return 0;
 }
 
+PyObject* PathPy::getPositionAt(PyObject * args)
+{
+    double time, hFeed, vFeed, hRapid, vRapid;
+    if (!PyArg_ParseTuple(args, "ddddd", &time, &hFeed, &vFeed, &hRapid, &vRapid))
+        return 0;
+
+    std::size_t index;
+    Base::Vector3d pos;
+    if (!getToolpathPtr()->getPositionAt(time, hFeed, vFeed, hRapid, vRapid, index, pos))
+        Py_Return;
+
+    Py::Tuple tuple(2);
+    tuple.setItem(0, Py::Long(static_cast<long>(index)));
+    tuple.setItem(1, Py::Vector(pos));
+    return Py::new_reference_to(tuple);
+}
+
+PyObject* PathPy::getCommandsInBox(PyObject * args)
+{
+    PyObject *pcObj;
+    if (!PyArg_ParseTuple(args, "O!", &(Base::BoundBoxPy::Type), &pcObj))
+        return 0;
+
+    std::vector<std::size_t> indices = getToolpathPtr()->getCommandsInBox(
+            *static_cast<Base::BoundBoxPy*>(pcObj)->getBoundBoxPtr());
+    Py::List list;
+    for (std::size_t index : indices)
+        list.append(Py::Long(static_cast<long>(index)));
+    return Py::new_reference_to(list);
+}
+
+PyObject* PathPy::optimize(PyObject * args, PyObject * kwds)
+{
+    double tolerance = 0.01;
+    PyObject *lines = Py_True;
+    PyObject *arcs = Py_True;
+    PyObject *rapids = Py_True;
+    static char* kwd_list[] = {"tolerance", "lines", "arcs", "rapids", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|dOOO", kwd_list, &tolerance, &lines, &arcs, &rapids))
+        return 0;
+
+    Path::ToolpathOptimizer optimizer;
+    optimizer.setTolerance(tolerance);
+    optimizer.setMergeLines(PyObject_IsTrue(lines) ? true : false);
+    optimizer.setFitArcs(PyObject_IsTrue(arcs) ? true : false);
+    optimizer.setMergeRapids(PyObject_IsTrue(rapids) ? true : false);
+    getToolpathPtr()->optimize(optimizer);
+    Py_Return;
+}
+
 // GCode methods
 
 PyObject* PathPy::toGCode(PyObject * args)
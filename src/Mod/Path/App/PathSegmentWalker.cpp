@@ -114,35 +114,79 @@ PathSegmentWalker::PathSegmentWalker(const Toolpath &tp_)
 {}
 
 
+PathSegmentWalker::State::State(const Base::Vector3d &startPosition)
+    : last(startPosition)
+    , A(0.0)
+    , B(0.0)
+    , C(0.0)
+    , absolute(true)
+    , absolutecenter(false)
+    , pz(&Base::Vector3d::z)
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
+    deviation = hGrp->GetFloat("MeshDeviation",0.2);
+}
+
+double PathSegmentWalker::arcAngle(const Base::Vector3d &last, const Base::Vector3d &next,
+                                   const Base::Vector3d &center, bool clockwise, const State &state)
+{
+    double Base::Vector3d::*pz = state.pz;
+    Base::Vector3d next0(next);
+    next0.*pz = 0.0;
+    Base::Vector3d last0(last);
+    last0.*pz = 0.0;
+    Base::Vector3d center0(center);
+    center0.*pz = 0.0;
+    double angle = (next0 - center0).GetAngle(last0 - center0);
+    // GetAngle will always return the minor angle. Switch if needed
+    Base::Vector3d anorm = (last0 - center0) % (next0 - center0);
+    if (anorm.*pz < 0) {
+        if(!clockwise)
+            angle = M_PI * 2 - angle;
+    } else if(anorm.*pz > 0) {
+        if(clockwise)
+            angle = M_PI * 2 - angle;
+    } else if (angle == 0)
+        angle = M_PI * 2;
+    return angle;
+}
+
 void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &startPosition)
 {
     if(tp.getSize()==0) {
         return;
     }
 
-    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
-    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+    State state(startPosition);
+    cb.setup(state.last);
+    walk(cb, state, 0, tp.getSize());
+}
+
+void PathSegmentWalker::walk(PathSegmentVisitor &cb, State &state, std::size_t begin, std::size_t end)
+{
+    float deviation = state.deviation;
 
     Base::Vector3d rotCenter = tp.getCenter();
-    Base::Vector3d last(startPosition);
-    Base::Rotation lrot;
-    double A = 0.0;
-    double B = 0.0;
-    double C = 0.0;
+    Base::Vector3d &last = state.last;
+    Base::Rotation &lrot = state.lrot;
+    double &A = state.A;
+    double &B = state.B;
+    double &C = state.C;
 
-    bool absolute = true;
-    bool absolutecenter = false;
+    bool &absolute = state.absolute;
+    bool &absolutecenter = state.absolutecenter;
 
-    // for mapping the coordinates to XY plane
-    double Base::Vector3d::*pz = &Base::Vector3d::z;
+    double Base::Vector3d::*&pz = state.pz;
 
-    cb.setup(last);
+    // reused for all commands to save an allocation per command
+    std::deque<Base::Vector3d> points;
 
-    for (unsigned int  i = 0; i < tp.getSize(); i++) {
-        std::deque<Base::Vector3d> points;
+    for (std::size_t i = begin; i < end; i++) {
+        points.clear();
 
-        const Path::Command &cmd = tp.getCommand(i);
-        const std::string &name = cmd.Name;
+        Path::CommandView cmd(tp.getCommandStore(), i);
+        const std::string &name = cmd.getName();
+        Path::Opcode op = cmd.getOpcode();
         Base::Vector3d next = cmd.getPlacement().getPosition();
         double a = A;
         double b = B;
@@ -161,7 +205,7 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
 
         Base::Vector3d rnext = compensateRotation(next, nrot, rotCenter);
 
-        if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
+        if ( (op == Path::Opcode::Rapid) || (op == Path::Opcode::Feed) ) {
             // straight line
             if (nrot != lrot) {
                 double amax = std::max(fmod(fabs(a - A), 360), std::max(fmod(fabs(b - B), 360), fmod(fabs(c - C), 360)));
@@ -184,7 +228,7 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
                 }
             }
 
-            if ("G0" == name || "G00" == name) {
+            if (op == Path::Opcode::Rapid) {
                 cb.g0(i, last, rnext, points);
             } else {
                 cb.g1(i, last, rnext, points);
@@ -196,12 +240,12 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             C = c;
             lrot = nrot;
 
-        } else if ( (name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
+        } else if ( (op == Path::Opcode::ArcCW) || (op == Path::Opcode::ArcCCW) ) {
             // arc
             Base::Vector3d norm;
             Base::Vector3d center;
 
-            if ( (name == "G2") || (name == "G02") )
+            if (op == Path::Opcode::ArcCW)
                 norm.*pz = -1.0;
             else
                 norm.*pz = 1.0;
@@ -210,24 +254,11 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
                 center = cmd.getCenter();
             else
                 center = (last + cmd.getCenter());
-            Base::Vector3d next0(next);
-            next0.*pz = 0.0;
             Base::Vector3d last0(last);
             last0.*pz = 0.0;
             Base::Vector3d center0(center);
             center0.*pz = 0.0;
-            //double radius = (last - center).Length();
-            double angle = (next0 - center0).GetAngle(last0 - center0);
-            // GetAngle will always return the minor angle. Switch if needed
-            Base::Vector3d anorm = (last0 - center0) % (next0 - center0);
-            if (anorm.*pz < 0) {
-                if(name == "G3" || name == "G03")
-                    angle = M_PI * 2 - angle;
-            } else if(anorm.*pz > 0) {
-                if(name == "G2" || name == "G02")
-                    angle = M_PI * 2 - angle;
-            } else if (angle == 0)
-                angle = M_PI * 2;
+            double angle = arcAngle(last, next, center, op == Path::Opcode::ArcCW, state);
 
             double amax = std::max(fmod(fabs(a - A), 360), std::max(fmod(fabs(b - B), 360), fmod(fabs(c - C), 360)));
 
@@ -239,13 +270,26 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             double db = (b - B) / segments;
             double dc = (c - C) / segments;
 
+            // The radius is turned step by step around the arc normal, so an arc
+            // only needs one sine and cosine instead of a rotation per point. The
+            // orientation of the rotary axes is only interpolated if it changes.
+            Base::Vector3d radial = last0 - center0;
+            Base::Vector3d tangent = norm % radial;
+            double cosStep = cos(dangle);
+            double sinStep = sin(dangle);
+            double cosAngle = 1.0;
+            double sinAngle = 0.0;
+            bool rotary = (a != A || b != B || c != C);
+
             for (int j = 1; j < segments; j++) {
-                Base::Vector3d inter;
-                Base::Rotation rot(norm, dangle*j);
-                rot.multVec((last0 - center0), inter);
+                double cosNext = cosAngle * cosStep - sinAngle * sinStep;
+                sinAngle = sinAngle * cosStep + cosAngle * sinStep;
+                cosAngle = cosNext;
+
+                Base::Vector3d inter = radial * cosAngle + tangent * sinAngle;
                 inter.*pz = last.*pz + dZ * j; //Enable displaying helices
 
-                Base::Rotation arot = yawPitchRoll(A + da*j, B + db*j, C + dc*j);
+                Base::Rotation arot = rotary ? yawPitchRoll(A + da*j, B + db*j, C + dc*j) : nrot;
                 Base::Vector3d rinter = compensateRotation(center0 + inter, arot, rotCenter);
 
                 points.push_back(rinter);
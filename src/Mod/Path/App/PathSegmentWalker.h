@@ -57,10 +57,40 @@ class PathExport PathSegmentVisitor
 class PathExport PathSegmentWalker
 {
 public:
+    /**
+     * The modal state of the walk between two commands. It allows to continue
+     * a walk at any command, e.g. to process only the commands that changed.
+     */
+    struct PathExport State
+    {
+        explicit State(const Base::Vector3d &startPosition = Base::Vector3d());
+
+        Base::Vector3d last;
+        Base::Rotation lrot;
+        double A;
+        double B;
+        double C;
+        bool absolute;
+        bool absolutecenter;
+        // for mapping the coordinates to XY plane
+        double Base::Vector3d::*pz;
+        // the deviation of the arc segments
+        float deviation;
+    };
+
     PathSegmentWalker(const Toolpath &tp_);
 
 
     void walk(PathSegmentVisitor &cb, const Base::Vector3d &startPosition);
+    /// Walks the commands from \a begin to \a end, the state is updated
+    void walk(PathSegmentVisitor &cb, State &state, std::size_t begin, std::size_t end);
+
+    /**
+     * Returns the angle of an arc from \a last to \a next in the plane of
+     * \a state, i.e. between 0 and 2 pi in the direction of the arc.
+     */
+    static double arcAngle(const Base::Vector3d &last, const Base::Vector3d &next,
+                           const Base::Vector3d &center, bool clockwise, const State &state);
 
 private:
     const Toolpath &tp;
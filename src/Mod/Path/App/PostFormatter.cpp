@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+#endif
+
+#include <Base/Exception.h>
+
+#include "PostFormatter.h"
+
+using namespace Path;
+
+namespace {
+
+// the text is written to the stream in blocks of this size
+const std::size_t BufferSize = 1 << 16;
+
+// the words that are converted by setInches()
+bool isLength(const std::string &word)
+{
+    return word.size() == 1 && std::strchr("XYZIJKRQ", word[0]);
+}
+
+} // namespace
+
+PostFormatter::PostFormatter()
+  : precision(3)
+  , padZero(true)
+  , inches(false)
+  , feedScale(1.0)
+  , modalCommands(false)
+  , rapidFeed(false)
+  , comments(true)
+  , lineNumbers(false)
+  , lineIncrement(10)
+  , separator(" ")
+  , lineNumber(10)
+{
+    std::fill(shortWords, shortWords + 128, nullptr);
+}
+
+PostFormatter::~PostFormatter()
+{
+}
+
+void PostFormatter::setPrecision(int value)
+{
+    precision = std::max(0, value);
+    clearWords();
+}
+
+void PostFormatter::setWordPrecision(const std::string &word, int value)
+{
+    wordPrecisions[word] = std::max(0, value);
+    clearWords();
+}
+
+void PostFormatter::setPadZero(bool on)
+{
+    padZero = on;
+}
+
+void PostFormatter::setInches(bool on)
+{
+    inches = on;
+    clearWords();
+}
+
+void PostFormatter::setFeedScale(double value)
+{
+    feedScale = value;
+    clearWords();
+}
+
+void PostFormatter::setWordOrder(const std::vector<std::string> &value)
+{
+    order = value;
+    clearWords();
+}
+
+void PostFormatter::setModalWords(const std::vector<std::string> &value)
+{
+    modalWords = value;
+    clearWords();
+}
+
+void PostFormatter::setModalCommands(bool on)
+{
+    modalCommands = on;
+}
+
+void PostFormatter::setRapidFeed(bool on)
+{
+    rapidFeed = on;
+}
+
+void PostFormatter::setComments(bool on)
+{
+    comments = on;
+}
+
+void PostFormatter::setLineNumbers(bool on, long start, long increment)
+{
+    lineNumbers = on;
+    lineNumber = start;
+    lineIncrement = increment;
+}
+
+void PostFormatter::setSeparator(const std::string &value)
+{
+    separator = value;
+}
+
+void PostFormatter::setTemplate(const std::string &command, const std::string &value)
+{
+    if (value.empty()) {
+        templates.erase(command);
+        return;
+    }
+
+    std::vector<Piece> pieces;
+    Piece piece;
+    for (std::size_t i = 0; i < value.size(); i++) {
+        char c = value[i];
+        if ((c == '{' || c == '}') && i + 1 < value.size() && value[i + 1] == c) {
+            piece.text += c;
+            ++i;
+        }
+        else if (c == '{') {
+            std::size_t end = value.find_first_of("{}", i + 1);
+            if (end == std::string::npos || value[end] != '}' || end == i + 1)
+                throw Base::ValueError("Unbalanced brace in post template");
+            if (!piece.text.empty())
+                pieces.push_back(piece);
+            piece.text.clear();
+            Piece word;
+            word.word = value.substr(i + 1, end - i - 1);
+            pieces.push_back(word);
+            i = end;
+        }
+        else if (c == '}') {
+            throw Base::ValueError("Unbalanced brace in post template");
+        }
+        else {
+            piece.text += c;
+        }
+    }
+    if (!piece.text.empty())
+        pieces.push_back(piece);
+    templates[command] = pieces;
+}
+
+void PostFormatter::clearWords()
+{
+    words.clear();
+    std::fill(shortWords, shortWords + 128, nullptr);
+}
+
+PostFormatter::Word &PostFormatter::getWord(const std::string &name)
+{
+    unsigned char c = name.size() == 1 ? static_cast<unsigned char>(name[0]) : 0;
+    if (c && c < 128 && shortWords[c])
+        return *shortWords[c];
+
+    auto it = words.find(name);
+    if (it == words.end()) {
+        Word word;
+        word.name = name;
+        word.feed = (name == "F");
+        if (order.empty()) {
+            word.rank = 0;
+        }
+        else {
+            auto pos = std::find(order.begin(), order.end(), name);
+            word.rank = pos == order.end() ? -1 : static_cast<int>(pos - order.begin());
+        }
+
+        auto prec = wordPrecisions.find(name);
+        word.precision = prec == wordPrecisions.end() ? precision : prec->second;
+        word.iscale = static_cast<std::int64_t>(std::pow(10.0, word.precision + 1)) / 10;
+        word.scale = 1.0;
+        if (inches && (word.feed || isLength(name)))
+            word.scale /= 25.4;
+        if (word.feed)
+            word.scale *= feedScale;
+
+        word.modal = std::find(modalWords.begin(), modalWords.end(), name) != modalWords.end();
+        word.hasLast = false;
+        word.last = 0.0;
+        it = words.insert(std::make_pair(name, word)).first;
+    }
+
+    if (c && c < 128)
+        shortWords[c] = &it->second;
+    return it->second;
+}
+
+void PostFormatter::reset()
+{
+    lastName.clear();
+    for (auto &it : words)
+        it.second.hasLast = false;
+}
+
+void PostFormatter::writeValue(std::string &out, const Word &word, double value) const
+{
+    value *= word.scale;
+    // avoid a negative zero
+    if (std::fabs(value) * static_cast<double>(word.iscale) < 0.5)
+        value = 0.0;
+    CommandStore::writeNumber(out, value, word.precision, padZero, word.iscale);
+}
+
+void PostFormatter::writeCommand(const CommandStore &store, std::size_t index, std::ostream &out)
+{
+    const std::string &name = store.getName(index);
+    Opcode opcode = store.getOpcode(index);
+    if (opcode == Opcode::Comment) {
+        if (comments)
+            writeLines(name, false, out);
+        return;
+    }
+
+    // collect the words to write, the modal ones only if their value changed
+    store.getParams(index, params);
+    values.clear();
+    for (const auto &param : params) {
+        if (*param.first == "N")
+            continue;
+        Word &word = getWord(*param.first);
+        if (word.rank < 0)
+            continue;
+        if (word.feed && (param.second <= 0.0 || (opcode == Opcode::Rapid && !rapidFeed)))
+            continue;
+        if (word.modal) {
+            if (word.hasLast && word.last == param.second)
+                continue;
+            word.hasLast = true;
+            word.last = param.second;
+        }
+        values.push_back(std::make_pair(&word, param.second));
+    }
+
+    if (order.empty()) {
+        std::sort(values.begin(), values.end(), [](const std::pair<const Word*, double> &a,
+                                                   const std::pair<const Word*, double> &b) {
+            return a.first->name < b.first->name;
+        });
+    }
+    else {
+        std::sort(values.begin(), values.end(), [](const std::pair<const Word*, double> &a,
+                                                   const std::pair<const Word*, double> &b) {
+            return a.first->rank < b.first->rank;
+        });
+    }
+
+    line.clear();
+    if (!modalCommands || name != lastName)
+        line += name;
+    for (const auto &value : values) {
+        if (!line.empty())
+            line += separator;
+        line += value.first->name;
+        writeValue(line, *value.first, value.second);
+    }
+    if (name != lastName)
+        lastName = name;
+
+    auto it = templates.find(name);
+    if (it == templates.end()) {
+        if (!line.empty())
+            writeLines(line, false, out);
+        return;
+    }
+
+    text.clear();
+    for (const Piece &piece : it->second) {
+        if (piece.word.empty()) {
+            text += piece.text;
+        }
+        else if (piece.word == "line") {
+            text += line;
+        }
+        else {
+            for (const auto &param : params) {
+                if (*param.first == piece.word) {
+                    writeValue(text, getWord(piece.word), param.second);
+                    break;
+                }
+            }
+        }
+    }
+    writeLines(text, false, out);
+}
+
+void PostFormatter::writeText(const std::string &value, std::ostream &out)
+{
+    writeLines(value, true, out);
+}
+
+void PostFormatter::writeLines(const std::string &value, bool keepEmpty, std::ostream &out)
+{
+    std::size_t begin = 0;
+    while (begin < value.size()) {
+        std::size_t end = value.find('\n', begin);
+        if (end == std::string::npos)
+            end = value.size();
+
+        if (end > begin) {
+            if (lineNumbers) {
+                buffer += 'N';
+                buffer += std::to_string(lineNumber);
+                buffer += separator;
+                lineNumber += lineIncrement;
+            }
+            buffer.append(value, begin, end - begin);
+            buffer += '\n';
+        }
+        else if (keepEmpty) {
+            buffer += '\n';
+        }
+        begin = end + 1;
+    }
+
+    if (buffer.size() >= BufferSize)
+        flush(out);
+}
+
+void PostFormatter::flush(std::ostream &out)
+{
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
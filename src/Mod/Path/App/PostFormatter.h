@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PATH_POSTFORMATTER_H
+#define PATH_POSTFORMATTER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CommandStore.h"
+
+namespace Path
+{
+
+class Toolpath;
+
+/**
+ * The PostFormatter class writes toolpaths as G-code for a controller. It
+ * works directly on the columns of the CommandStore and writes the text
+ * through a buffer to a stream, so that posting a toolpath doesn't create a
+ * Command or Python object per command.
+ *
+ * The output is controlled by a few settings: the order of the words and
+ * the number of decimals of each word, the conversion to inches and of the
+ * feed rate, modal command names and words, line numbers and templates that
+ * replace the line of a command, e.g. to add the tool length offset after
+ * a tool change.
+ *
+ * The modal state is kept between the commands until reset() is called,
+ * Toolpath::post() resets it at the start of each toolpath.
+ */
+class PathExport PostFormatter
+{
+public:
+    PostFormatter();
+    ~PostFormatter();
+
+    /** @name Settings */
+    //@{
+    /// The number of decimals of the words without a precision of their own
+    void setPrecision(int);
+    /// Sets the number of decimals of a single word, e.g. 0 for T or S
+    void setWordPrecision(const std::string &word, int precision);
+    /// Writes trailing zeros of the decimals, on by default
+    void setPadZero(bool);
+    /// Converts the lengths and the feed rate from mm to inches
+    void setInches(bool);
+    /// An additional factor for the feed rate, e.g. 60 to write it per minute
+    void setFeedScale(double);
+    /**
+     * The words in the order they are written, the parameters of a command
+     * that aren't in the list are dropped. An empty list, the default, writes
+     * all parameters in alphabetical order like Command::toGCode().
+     */
+    void setWordOrder(const std::vector<std::string> &words);
+    /// The words that are only written when their value changes
+    void setModalWords(const std::vector<std::string> &words);
+    /// Omits the name of a command if it's the same as the one of the last command
+    void setModalCommands(bool);
+    /// Writes the feed rate of rapid moves, off by default
+    void setRapidFeed(bool);
+    /// Writes the comments, on by default
+    void setComments(bool);
+    /// Numbers the lines starting with \a start
+    void setLineNumbers(bool on, long start = 10, long increment = 10);
+    /// The text between the words, a space by default
+    void setSeparator(const std::string &);
+    /**
+     * Replaces the line of the commands with the name \a command by \a text.
+     * In the text, {line} is replaced by the line of the command and {W} by
+     * the value of the word W of the command, e.g. "{line}\nG43 H{T}". Use
+     * {{ and }} for braces. Each line of the result gets its own line number.
+     * An empty text removes the template. Throws Base::ValueError for an
+     * unbalanced brace.
+     */
+    void setTemplate(const std::string &command, const std::string &text);
+    //@}
+
+    /** @name Output */
+    //@{
+    /// Forgets the last command name and the values of the modal words
+    void reset();
+    /// Writes a command of the store, the modal state is updated
+    void writeCommand(const CommandStore &store, std::size_t index, std::ostream &out);
+    /// Writes text as it is, only the line numbers are added
+    void writeText(const std::string &text, std::ostream &out);
+    /// Writes the buffered text to \a out
+    void flush(std::ostream &out);
+    /// The number of the next line
+    long getLineNumber() const
+    { return lineNumber; }
+    //@}
+
+private:
+    struct Word
+    {
+        std::string name;
+        int rank;           ///< position in the word order, -1 if the word is dropped
+        bool feed;
+        int precision;
+        std::int64_t iscale;
+        double scale;
+        bool modal;
+        bool hasLast;
+        double last;
+    };
+    struct Piece
+    {
+        std::string text;
+        std::string word;   ///< empty for literal text, "line" for the line of the command
+    };
+
+    Word &getWord(const std::string &name);
+    void clearWords();
+    void writeValue(std::string &out, const Word &word, double value) const;
+    void writeLines(const std::string &text, bool keepEmpty, std::ostream &out);
+
+private:
+    // settings
+    int precision;
+    bool padZero;
+    bool inches;
+    double feedScale;
+    bool modalCommands;
+    bool rapidFeed;
+    bool comments;
+    bool lineNumbers;
+    long lineIncrement;
+    std::string separator;
+    std::vector<std::string> order;
+    std::unordered_map<std::string, int> wordPrecisions;
+    std::vector<std::string> modalWords;
+    std::unordered_map<std::string, std::vector<Piece> > templates;
+
+    // state
+    long lineNumber;
+    std::string lastName;
+    std::unordered_map<std::string, Word> words;
+    /// the words with a single character name, for a fast lookup
+    Word *shortWords[128];
+
+    // buffers
+    std::string buffer;
+    std::string line;
+    std::string text;
+    CommandStore::ParamList params;
+    std::vector<std::pair<const Word*, double> > values;
+};
+
+} // namespace Path
+
+
+#endif // PATH_POSTFORMATTER_H
@@ -55,6 +55,9 @@
 
 #include <cinttypes>
 #include <iomanip>
+#include <atomic>
+#include <future>
+#include <thread>
 
 // Python
 #include <Python.h>
@@ -0,0 +1,364 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+#endif
+
+#include "ToolpathCache.h"
+#include "Path.h"
+
+using namespace Path;
+
+namespace {
+
+enum StepType { NoMove, Line, Arc, Cycle, Probe };
+
+// collects the bounding box of a command in the same way as the extent of a path was computed before
+class StepVisitor : public PathSegmentVisitor
+{
+public:
+    StepVisitor(Base::BoundBox3d &bb, Base::Vector3d &center, int &type)
+        : bb(bb), center(center), type(type)
+    {
+        type = NoMove;
+    }
+
+    virtual void g0(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts)
+    {
+        (void)id;
+        type = Line;
+        processPt(last);
+        processPts(pts);
+        processPt(next);
+    }
+    virtual void g1(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts)
+    {
+        (void)id;
+        type = Line;
+        processPt(last);
+        processPts(pts);
+        processPt(next);
+    }
+    virtual void g23(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts, const Base::Vector3d &c)
+    {
+        (void)id;
+        type = Arc;
+        center = c;
+        processPt(last);
+        processPts(pts);
+        processPt(next);
+    }
+    virtual void g8x(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts,
+                     const std::deque<Base::Vector3d> &p, const std::deque<Base::Vector3d> &q)
+    {
+        (void)id;
+        (void)q; // always within the bounds of p
+        type = Cycle;
+        processPt(last);
+        processPts(pts);
+        processPts(p);
+        processPt(next);
+    }
+    virtual void g38(int id, const Base::Vector3d &last, const Base::Vector3d &next)
+    {
+        (void)id;
+        type = Probe;
+        processPt(last);
+        processPt(next);
+    }
+
+private:
+    void processPts(const std::deque<Base::Vector3d> &pts) {
+        for (std::deque<Base::Vector3d>::const_iterator it=pts.begin(); pts.end() != it; ++it)
+            processPt(*it);
+    }
+    void processPt(const Base::Vector3d &pt) {
+        bb.Add(pt);
+    }
+
+private:
+    Base::BoundBox3d &bb;
+    Base::Vector3d &center;
+    int &type;
+};
+
+} // namespace
+
+ToolpathCache::ToolpathCache()
+    : count(0)
+    , levelsValid(0)
+{
+    sums.length = 0.0;
+    std::fill(sums.kinds, sums.kinds + NumKinds, 0.0);
+}
+
+ToolpathCache::ToolpathCache(const ToolpathCache &other)
+{
+    std::lock_guard<std::mutex> lock(other.mutex);
+    chunks = other.chunks;
+    count = other.count;
+    state = other.state;
+    sums = other.sums;
+    levels = other.levels;
+    levelsValid = other.levelsValid;
+}
+
+ToolpathCache::~ToolpathCache()
+{
+}
+
+void ToolpathCache::invalidate(std::size_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    truncate(index);
+}
+
+void ToolpathCache::truncate(std::size_t index)
+{
+    if (index >= count)
+        return;
+
+    // continue with the state at the start of the chunk
+    std::size_t chunk = index / ChunkSize;
+    count = chunk * ChunkSize;
+    state = chunks[chunk].state;
+    sums = chunks[chunk].sums;
+    chunks.erase(chunks.begin() + chunk, chunks.end());
+    levelsValid = std::min(levelsValid, chunk);
+}
+
+void ToolpathCache::step(const Toolpath &path, PathSegmentWalker &walker, PathSegmentWalker::State &st,
+                         std::size_t index, Step &result) const
+{
+    result.start = st.last;
+    result.box = Base::BoundBox3d();
+    StepVisitor visitor(result.box, result.center, result.type);
+    walker.walk(visitor, st, index, index + 1);
+    result.end = st.last;
+
+    result.length = 0.0;
+    result.angle = 0.0;
+    if (result.type == Line) {
+        result.length = (result.end - result.start).Length();
+    }
+    else if (result.type == Arc) {
+        bool clockwise = path.getCommandStore().getOpcode(index) == Opcode::ArcCW;
+        result.angle = PathSegmentWalker::arcAngle(result.start, result.end, result.center, clockwise, st);
+
+        // the length of the helix around the axis of the plane
+        Base::Vector3d radius = result.start - result.center;
+        double height = result.end.*st.pz - result.start.*st.pz;
+        radius.*st.pz = 0.0;
+        double arc = result.angle * radius.Length();
+        result.length = std::sqrt(arc * arc + height * height);
+    }
+
+    bool rapid = path.getCommandStore().getOpcode(index) == Opcode::Rapid;
+    if (result.start.z != result.end.z)
+        result.kind = rapid ? VerticalRapid : VerticalFeed;
+    else
+        result.kind = rapid ? HorizontalRapid : HorizontalFeed;
+}
+
+void ToolpathCache::update(const Toolpath &path)
+{
+    std::size_t size = path.getSize();
+    if (count > size)
+        truncate(size);
+    if (count == size && levelsValid == chunks.size())
+        return;
+
+    levelsValid = std::min(levelsValid, count / ChunkSize);
+
+    PathSegmentWalker walker(path);
+    Step result;
+    for (; count < size; count++) {
+        if (count % ChunkSize == 0) {
+            Chunk chunk;
+            chunk.state = state;
+            chunk.sums = sums;
+            chunks.push_back(chunk);
+        }
+
+        step(path, walker, state, count, result);
+        chunks.back().box.Add(result.box);
+        sums.length += result.length;
+        sums.kinds[result.kind] += result.length;
+    }
+
+    // update the boxes of the groups of eight chunks, and of eight groups, ...
+    std::size_t first = levelsValid;
+    std::size_t num = chunks.size();
+    std::size_t level = 0;
+    while (num > 1) {
+        if (levels.size() <= level)
+            levels.resize(level + 1);
+        std::vector<Base::BoundBox3d> &boxes = levels[level];
+        std::size_t groups = (num + 7) / 8;
+        first /= 8;
+        boxes.resize(groups);
+        for (std::size_t i = first; i < groups; i++) {
+            Base::BoundBox3d bb;
+            std::size_t end = std::min(num, (i + 1) * 8);
+            for (std::size_t j = i * 8; j < end; j++)
+                bb.Add(level == 0 ? chunks[j].box : levels[level - 1][j]);
+            boxes[i] = bb;
+        }
+        num = groups;
+        ++level;
+    }
+    levels.resize(level);
+    levelsValid = chunks.size();
+}
+
+double ToolpathCache::getTime(const Sums &s, const double feeds[NumKinds])
+{
+    double time = 0.0;
+    for (int i = 0; i < NumKinds; i++)
+        time += s.kinds[i] / feeds[i];
+    return time;
+}
+
+double ToolpathCache::getLength(const Toolpath &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    update(path);
+    return sums.length;
+}
+
+double ToolpathCache::getCycleTime(const Toolpath &path, double hFeed, double vFeed, double hRapid, double vRapid)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    update(path);
+    const double feeds[NumKinds] = {hFeed, vFeed, hRapid, vRapid};
+    return getTime(sums, feeds);
+}
+
+Base::BoundBox3d ToolpathCache::getBoundBox(const Toolpath &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    update(path);
+    Base::BoundBox3d bb;
+    if (!levels.empty())
+        bb = levels.back().front();
+    else if (!chunks.empty())
+        bb = chunks.front().box;
+    return bb;
+}
+
+bool ToolpathCache::getPosition(const Toolpath &path, double time, double hFeed, double vFeed,
+                                double hRapid, double vRapid, std::size_t &index, Base::Vector3d &position)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    update(path);
+    if (count == 0)
+        return false;
+
+    // the last chunk that starts before the time
+    const double feeds[NumKinds] = {hFeed, vFeed, hRapid, vRapid};
+    auto it = std::upper_bound(chunks.begin() + 1, chunks.end(), time, [&feeds](double t, const Chunk &chunk) {
+        return t < getTime(chunk.sums, feeds);
+    });
+    std::size_t chunk = (it - chunks.begin()) - 1;
+
+    PathSegmentWalker walker(path);
+    PathSegmentWalker::State st(chunks[chunk].state);
+    double start = getTime(chunks[chunk].sums, feeds);
+    Step result;
+    for (std::size_t i = chunk * ChunkSize; i < count; i++) {
+        step(path, walker, st, i, result);
+        double duration = result.length / feeds[result.kind];
+        if ((duration > 0.0 && start + duration >= time) || i + 1 == count) {
+            double f = duration > 0.0 ? std::max(0.0, std::min(1.0, (time - start) / duration)) : 1.0;
+            index = i;
+            if (result.type == Line) {
+                position = result.start + (result.end - result.start) * f;
+            }
+            else if (result.type == Arc) {
+                // turn the radius around the axis of the plane like PathSegmentWalker
+                bool clockwise = path.getCommandStore().getOpcode(i) == Opcode::ArcCW;
+                Base::Vector3d norm;
+                norm.*st.pz = clockwise ? -1.0 : 1.0;
+                Base::Vector3d radial = result.start - result.center;
+                radial.*st.pz = 0.0;
+                Base::Vector3d tangent = norm % radial;
+                double angle = result.angle * f;
+                position = result.center + radial * std::cos(angle) + tangent * std::sin(angle);
+                position.*st.pz = result.start.*st.pz + (result.end.*st.pz - result.start.*st.pz) * f;
+            }
+            else {
+                position = result.end;
+            }
+            return true;
+        }
+        start += duration;
+    }
+    return false;
+}
+
+void ToolpathCache::getCommandsInBox(const Toolpath &path, const Base::BoundBox3d &box,
+                                     std::vector<std::size_t> &indices)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    update(path);
+    if (chunks.empty())
+        return;
+
+    // descend from the root to the chunks, a node on level 0 is a chunk and a
+    // node on level k > 0 is an entry of levels[k - 1]
+    std::vector<std::pair<std::size_t, std::size_t> > stack;
+    stack.push_back(std::make_pair(levels.size(), static_cast<std::size_t>(0)));
+    PathSegmentWalker walker(path);
+    Step result;
+    while (!stack.empty()) {
+        std::size_t level = stack.back().first;
+        std::size_t index = stack.back().second;
+        stack.pop_back();
+
+        if (level > 0) {
+            if (!levels[level - 1][index].Intersect(box))
+                continue;
+            std::size_t num = level == 1 ? chunks.size() : levels[level - 2].size();
+            std::size_t end = std::min(num, (index + 1) * 8);
+            for (std::size_t j = end; j-- > index * 8;)
+                stack.push_back(std::make_pair(level - 1, j));
+            continue;
+        }
+
+        const Chunk &chunk = chunks[index];
+        if (!chunk.box.Intersect(box))
+            continue;
+        PathSegmentWalker::State st(chunk.state);
+        std::size_t end = std::min(count, (index + 1) * ChunkSize);
+        for (std::size_t i = index * ChunkSize; i < end; i++) {
+            step(path, walker, st, i, result);
+            if (result.box.Intersect(box))
+                indices.push_back(i);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PATH_TOOLPATHCACHE_H
+#define PATH_TOOLPATHCACHE_H
+
+#include <mutex>
+#include <vector>
+
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+#include "PathSegmentWalker.h"
+
+namespace Path
+{
+
+class Toolpath;
+
+/**
+ * The ToolpathCache class keeps the length, the cycle time and the extent of
+ * the commands of a toolpath, so that they aren't computed from scratch on
+ * every call.
+ *
+ * The commands are processed in chunks of a fixed number of commands. A chunk
+ * keeps the state of the PathSegmentWalker at its first command, the sums
+ * of the lengths before it and the bounding box of its commands. The values
+ * of single commands are computed again from the state of their chunk when
+ * they're needed. The boxes of the chunks form a bounding volume hierarchy in
+ * the order of the commands for box queries.
+ *
+ * Adding commands at the end only processes the new commands. Inserting or
+ * deleting a command processes the commands from its chunk to the end again
+ * because the following positions may change. The work is done on the first
+ * query after a change.
+ *
+ * The cache may be shared by copies of a toolpath and is thread-safe.
+ */
+class PathExport ToolpathCache
+{
+public:
+    ToolpathCache();
+    ToolpathCache(const ToolpathCache&);
+    ~ToolpathCache();
+
+    /// Marks the commands from \a index on as changed
+    void invalidate(std::size_t index);
+
+    /** @name Queries */
+    //@{
+    /// The length of the moves and arcs in mm
+    double getLength(const Toolpath &path);
+    /// The cycle time in s for the given feed rates in mm/s, all of them must not be 0
+    double getCycleTime(const Toolpath &path, double hFeed, double vFeed, double hRapid, double vRapid);
+    /// The bounding box in the same way as PathSegmentWalker shows the path
+    Base::BoundBox3d getBoundBox(const Toolpath &path);
+    /**
+     * Computes the position of the tool at \a time for the feed rates of
+     * getCycleTime(). \a index is set to the command that is executed at that
+     * time. Returns false if the path is empty.
+     */
+    bool getPosition(const Toolpath &path, double time, double hFeed, double vFeed,
+                     double hRapid, double vRapid, std::size_t &index, Base::Vector3d &position);
+    /// Appends the indices of the commands whose bounding box intersects \a box
+    void getCommandsInBox(const Toolpath &path, const Base::BoundBox3d &box,
+                          std::vector<std::size_t> &indices);
+    //@}
+
+    /// The number of commands in a chunk
+    static const std::size_t ChunkSize = 64;
+
+private:
+    /// The lengths of the moves by the feed rate they're done with
+    enum Kind { HorizontalFeed, VerticalFeed, HorizontalRapid, VerticalRapid, NumKinds };
+
+    struct Sums
+    {
+        double length;
+        double kinds[NumKinds];
+    };
+
+    struct Chunk
+    {
+        PathSegmentWalker::State state;
+        Sums sums;
+        Base::BoundBox3d box;
+    };
+
+    /// The result of processing a single command
+    struct Step
+    {
+        Base::Vector3d start;
+        Base::Vector3d end;
+        Base::Vector3d center;
+        int type;
+        Kind kind;
+        double length;
+        double angle;
+        Base::BoundBox3d box;
+    };
+
+    void truncate(std::size_t index);
+    void update(const Toolpath &path);
+    void step(const Toolpath &path, PathSegmentWalker &walker, PathSegmentWalker::State &state,
+              std::size_t index, Step &result) const;
+    static double getTime(const Sums &sums, const double feeds[NumKinds]);
+
+private:
+    mutable std::mutex mutex;
+    std::vector<Chunk> chunks;
+    /// the number of processed commands
+    std::size_t count;
+    /// the state and the sums after the processed commands
+    PathSegmentWalker::State state;
+    Sums sums;
+    /// the boxes of groups of chunks, the first level groups the chunks
+    std::vector<std::vector<Base::BoundBox3d> > levels;
+    /// the chunks from this one on aren't in the levels
+    std::size_t levelsValid;
+};
+
+} // namespace Path
+
+
+#endif // PATH_TOOLPATHCACHE_H
@@ -0,0 +1,398 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+#endif
+
+#include "ToolpathOptimizer.h"
+
+using namespace Path;
+
+namespace {
+
+// the distance below which two positions are the same
+const double Confusion = 1e-7;
+// the maximum number of moves replaced by a single move
+const std::size_t MaxMoves = 256;
+// the minimum number of moves replaced by an arc
+const std::size_t MinArcMoves = 3;
+
+const std::uint8_t PositionMask = (1 << CommandStore::X) | (1 << CommandStore::Y) | (1 << CommandStore::Z);
+const std::uint8_t FeedMask = 1 << CommandStore::F;
+
+// the commands that neither move the tool nor change the coordinate system
+bool keepsPosition(const std::string &name)
+{
+    static const char *names[] = {"G4", "G04", "G17", "G18", "G19", "G20", "G21", "G40", "G43", "G49",
+                                  "G61", "G64", "G90", "G91", "G90.1", "G91.1", "G94",
+                                  "M3", "M03", "M4", "M04", "M5", "M05", "M7", "M07", "M8", "M08",
+                                  "M9", "M09"};
+    for (const char *n : names) {
+        if (name == n)
+            return true;
+    }
+    return false;
+}
+
+// the center of the circle through three points in the XY plane
+bool circleCenter(const Base::Vector3d &a, const Base::Vector3d &b, const Base::Vector3d &c,
+                  Base::Vector3d &center)
+{
+    double bx = b.x - a.x, by = b.y - a.y;
+    double cx = c.x - a.x, cy = c.y - a.y;
+    double d = 2.0 * (bx * cy - by * cx);
+    if (std::fabs(d) < Confusion * Confusion)
+        return false;
+    double b2 = bx * bx + by * by;
+    double c2 = cx * cx + cy * cy;
+    center.x = a.x + (cy * b2 - by * c2) / d;
+    center.y = a.y + (bx * c2 - cx * b2) / d;
+    center.z = a.z;
+    return true;
+}
+
+} // namespace
+
+ToolpathOptimizer::ToolpathOptimizer()
+  : tolerance(0.01)
+  , mergeLines(true)
+  , fitArcs(true)
+  , mergeRapids(true)
+  , absoluteCenter(false)
+  , planeXY(true)
+  , feed(0.0)
+  , rapid(false)
+{
+}
+
+ToolpathOptimizer::~ToolpathOptimizer()
+{
+}
+
+void ToolpathOptimizer::setTolerance(double value)
+{
+    tolerance = std::max(value, 0.0);
+}
+
+void ToolpathOptimizer::setMergeLines(bool on)
+{
+    mergeLines = on;
+}
+
+void ToolpathOptimizer::setFitArcs(bool on)
+{
+    fitArcs = on;
+}
+
+void ToolpathOptimizer::setMergeRapids(bool on)
+{
+    mergeRapids = on;
+}
+
+void ToolpathOptimizer::optimize(const CommandStore &in, CommandStore &out)
+{
+    // the same defaults as PathSegmentWalker, except that the start position isn't known.
+    // The position is known once each axis was set by an absolute command, e.g. by the
+    // separate Z and XY rapid moves at the start of Area::toPath().
+    bool absolute = true;
+    absoluteCenter = false;
+    planeXY = true;
+    std::uint8_t knownMask = 0;
+    bool feedKnown = false;
+    feed = 0.0;
+    Base::Vector3d last;
+    points.clear();
+
+    for (std::size_t i = 0; i < in.size(); i++) {
+        Opcode op = in.getOpcode(i);
+        bool hasFeed = in.has(i, CommandStore::F);
+        double value = in.get(i, CommandStore::F);
+        bool sameFeed = !hasFeed || (feedKnown && value == feed);
+
+        std::uint8_t mask = 0;
+        Base::Vector3d next(last);
+        for (int slot = CommandStore::X; slot <= CommandStore::Z; slot++) {
+            if (in.has(i, static_cast<CommandStore::Slot>(slot))) {
+                mask |= 1 << slot;
+                double v = in.get(i, static_cast<CommandStore::Slot>(slot));
+                next[slot] = absolute ? v : next[slot] + v;
+            }
+        }
+
+        if (op == Opcode::Rapid || op == Opcode::Feed) {
+            bool isRapid = (op == Opcode::Rapid);
+            bool usable = absolute && knownMask == PositionMask && !in.hasExtras(i)
+                && !in.has(i, CommandStore::I) && !in.has(i, CommandStore::J) && !in.has(i, CommandStore::K)
+                && (isRapid ? mergeRapids : (mergeLines || fitArcs));
+
+            bool moves = Base::DistanceP2(next, last) >= Confusion * Confusion;
+
+            // a move that doesn't move is dropped unless it changes the feed rate
+            if (!usable || (!moves && !sameFeed)) {
+                flush(out, true);
+                out.append(in, i);
+            }
+            else if (moves) {
+                if (!points.empty() && (isRapid != rapid || !sameFeed || name != in.getName(i)))
+                    flush(out, true);
+                if (points.empty()) {
+                    Point start = {last, 0};
+                    points.push_back(start);
+                    name = in.getName(i);
+                    rapid = isRapid;
+                }
+                Point point = {next, static_cast<std::uint8_t>(mask | (hasFeed ? FeedMask : 0))};
+                points.push_back(point);
+                // keep the memory bounded for long runs
+                if (points.size() > 4 * MaxMoves)
+                    flush(out, false);
+            }
+
+            if (absolute)
+                knownMask |= mask;
+        }
+        else {
+            flush(out, true);
+            out.append(in, i);
+
+            const std::string &cmd = in.getName(i);
+            if (op == Opcode::ArcCW || op == Opcode::ArcCCW) {
+                if (absolute)
+                    knownMask |= mask;
+            }
+            else if (op == Opcode::Other) {
+                if (cmd == "G90")
+                    absolute = true;
+                else if (cmd == "G91")
+                    absolute = false;
+                else if (cmd == "G90.1")
+                    absoluteCenter = true;
+                else if (cmd == "G91.1")
+                    absoluteCenter = false;
+                else if (cmd == "G17")
+                    planeXY = true;
+                else if (cmd == "G18" || cmd == "G19")
+                    planeXY = false;
+
+                // e.g. canned cycles, probing and tool changes
+                if (mask || !keepsPosition(cmd))
+                    knownMask = 0;
+                next = last;
+            }
+        }
+
+        last = next;
+        if (hasFeed) {
+            feed = value;
+            feedKnown = true;
+        }
+    }
+    flush(out, true);
+}
+
+/**
+ * Replaces the moves of the current run by as few moves as possible. Unless
+ * \a all is set, the last moves are kept, so that the moves replacing them can
+ * still be merged with the following ones.
+ */
+void ToolpathOptimizer::flush(CommandStore &out, bool all)
+{
+    if (points.empty())
+        return;
+
+    std::size_t begin = 0;
+    std::size_t back = points.size() - 1;
+    while (begin < back && (all || back - begin > MaxMoves)) {
+        std::size_t end = begin + 1;
+        if (rapid || mergeLines)
+            end = fitLine(begin, rapid ? Confusion : tolerance);
+
+        Base::Vector3d center;
+        bool clockwise = false;
+        if (!rapid && fitArcs && planeXY) {
+            std::size_t arcEnd = fitArc(begin, center, clockwise);
+            if (arcEnd > end) {
+                addArc(out, begin, arcEnd, center, clockwise);
+                begin = arcEnd;
+                continue;
+            }
+        }
+
+        addMove(out, begin, end);
+        begin = end;
+    }
+
+    if (all)
+        points.clear();
+    else
+        points.erase(points.begin(), points.begin() + begin);
+}
+
+/**
+ * Returns the last end in [\a first, \a last] for which \a fits() is true, or
+ * first - 1 if it isn't true for \a first. The step grows while the ends fit
+ * and is halved after the first end that doesn't fit, so that only a few ends
+ * are tested.
+ */
+template<class Fits>
+static std::size_t searchEnd(std::size_t first, std::size_t last, Fits fits)
+{
+    if (first > last || !fits(first))
+        return first - 1;
+
+    std::size_t good = first;
+    std::size_t bad = last + 1;
+    for (std::size_t step = 1; good < last; step *= 2) {
+        std::size_t next = std::min(last, good + step);
+        if (!fits(next)) {
+            bad = next;
+            break;
+        }
+        good = next;
+    }
+    while (bad - good > 1) {
+        std::size_t mid = good + (bad - good) / 2;
+        if (fits(mid))
+            good = mid;
+        else
+            bad = mid;
+    }
+    return good;
+}
+
+/// Returns the last point that can be reached by a line from \a begin
+std::size_t ToolpathOptimizer::fitLine(std::size_t begin, double tol) const
+{
+    const Base::Vector3d &start = points[begin].pos;
+    std::size_t back = std::min(points.size() - 1, begin + MaxMoves);
+    std::size_t end = searchEnd(begin + 2, back, [&](std::size_t j) {
+        Base::Vector3d dir = points[j].pos - start;
+        double length = dir.Length();
+        if (length < Confusion)
+            return false;
+        dir /= length;
+
+        // the points in between must be close to the line and in order
+        double prev = 0.0;
+        for (std::size_t k = begin + 1; k < j; k++) {
+            Base::Vector3d v = points[k].pos - start;
+            double t = v * dir;
+            if (t < prev - Confusion || t > length + Confusion || Base::DistanceP2(v, dir * t) > tol * tol)
+                return false;
+            prev = t;
+        }
+        return true;
+    });
+    return end;
+}
+
+/**
+ * Returns the last point that can be reached by an arc from \a begin through
+ * the points in between, or \a begin if there's no such arc.
+ */
+std::size_t ToolpathOptimizer::fitArc(std::size_t begin, Base::Vector3d &center, bool &clockwise) const
+{
+    const Base::Vector3d &start = points[begin].pos;
+    std::size_t back = std::min(points.size() - 1, begin + MaxMoves);
+    std::size_t end = searchEnd(begin + MinArcMoves, back, [&](std::size_t j) {
+        Base::Vector3d c;
+        if (!circleCenter(start, points[(begin + j) / 2].pos, points[j].pos, c))
+            return false;
+
+        // The points must turn around the center in one direction, less than a
+        // full turn and at a constant height. A chord of the original moves is
+        // away from the arc by its sagitta plus the distances of its ends from
+        // the circle.
+        double radius = std::hypot(start.x - c.x, start.y - c.y);
+        double sign = 0.0;
+        double sweep = 0.0;
+        double dev0 = 0.0;
+        for (std::size_t k = begin; k < j; k++) {
+            const Base::Vector3d &a = points[k].pos;
+            const Base::Vector3d &b = points[k + 1].pos;
+            if (std::fabs(b.z - start.z) > Confusion)
+                return false;
+            double ax = a.x - c.x, ay = a.y - c.y;
+            double bx = b.x - c.x, by = b.y - c.y;
+            double cross = ax * by - ay * bx;
+            if (k == begin)
+                sign = cross > 0.0 ? 1.0 : -1.0;
+            if (cross * sign <= 0.0)
+                return false;
+            sweep += std::atan2(cross * sign, ax * bx + ay * by);
+            if (sweep >= 2.0 * M_PI - 1e-6)
+                return false;
+            double dev1 = std::fabs(std::hypot(bx, by) - radius);
+            double half = std::hypot(b.x - a.x, b.y - a.y) / 2.0;
+            double sagitta = radius - std::sqrt(std::max(radius * radius - half * half, 0.0));
+            if (std::max(dev0, dev1) + sagitta > tolerance)
+                return false;
+            dev0 = dev1;
+        }
+        center = c;
+        clockwise = sign < 0.0;
+        return true;
+    });
+    return end < begin + MinArcMoves ? begin : end;
+}
+
+void ToolpathOptimizer::addMove(CommandStore &out, std::size_t begin, std::size_t end)
+{
+    // the axes and the feed rate are written if one of the replaced moves has them
+    std::uint8_t mask = 0;
+    for (std::size_t k = begin + 1; k <= end; k++)
+        mask |= points[k].mask;
+
+    const Base::Vector3d &pos = points[end].pos;
+    double values[CommandStore::NumSlots] = {};
+    values[CommandStore::X] = pos.x;
+    values[CommandStore::Y] = pos.y;
+    values[CommandStore::Z] = pos.z;
+    values[CommandStore::F] = feed;
+    out.append(name, mask, values);
+}
+
+void ToolpathOptimizer::addArc(CommandStore &out, std::size_t begin, std::size_t end,
+                               const Base::Vector3d &center, bool clockwise)
+{
+    std::uint8_t mask = (1 << CommandStore::X) | (1 << CommandStore::Y)
+                      | (1 << CommandStore::I) | (1 << CommandStore::J);
+    for (std::size_t k = begin + 1; k <= end; k++)
+        mask |= points[k].mask & ((1 << CommandStore::Z) | FeedMask);
+
+    const Base::Vector3d &start = points[begin].pos;
+    const Base::Vector3d &pos = points[end].pos;
+    double values[CommandStore::NumSlots] = {};
+    values[CommandStore::X] = pos.x;
+    values[CommandStore::Y] = pos.y;
+    values[CommandStore::Z] = pos.z;
+    values[CommandStore::I] = absoluteCenter ? center.x : center.x - start.x;
+    values[CommandStore::J] = absoluteCenter ? center.y : center.y - start.y;
+    values[CommandStore::F] = feed;
+    out.append(clockwise ? "G2" : "G3", mask, values);
+}
@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PATH_TOOLPATHOPTIMIZER_H
+#define PATH_TOOLPATHOPTIMIZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Base/Vector3D.h>
+
+#include "CommandStore.h"
+
+namespace Path
+{
+
+/**
+ * The ToolpathOptimizer class reduces the number of moves of a toolpath. The
+ * paths generated from shapes and meshes often consist of many short G1
+ * moves, which makes them big and slows down the display and the look-ahead
+ * of the controller.
+ *
+ * Consecutive moves of the same kind are collected and replaced from the
+ * front: by a single move to the farthest point for which all points in
+ * between are within the tolerance of the line, or by an arc through these
+ * points, whichever covers more moves. Arcs are only fitted to feed moves in
+ * the XY plane at a constant height. Rapid moves are only merged if they're
+ * on a line and rapid moves that don't move are removed.
+ *
+ * A run of moves is broken by any other command, by a change of the feed
+ * rate and by parameters other than X, Y, Z and F. Moves are left as they are
+ * in relative mode and as long as the position isn't known, e.g. at the start
+ * of the path and after a canned cycle. Each output move covers at most a
+ * fixed number of input moves, which keeps the time linear in the number of
+ * commands.
+ */
+class PathExport ToolpathOptimizer
+{
+public:
+    ToolpathOptimizer();
+    ~ToolpathOptimizer();
+
+    /** @name Settings */
+    //@{
+    /// The maximum distance of the result from the original moves, 0.01 by default
+    void setTolerance(double);
+    /// Merges feed moves along a line, on by default
+    void setMergeLines(bool);
+    /// Replaces feed moves along an arc by G2 and G3, on by default
+    void setFitArcs(bool);
+    /// Merges rapid moves along a line and removes rapid moves that don't move, on by default
+    void setMergeRapids(bool);
+    //@}
+
+    /// Appends the optimized commands of \a in to \a out
+    void optimize(const CommandStore &in, CommandStore &out);
+
+private:
+    struct Point
+    {
+        Base::Vector3d pos;
+        std::uint8_t mask;  ///< the slots of X, Y, Z and F given by the moves up to this point
+    };
+
+    void flush(CommandStore &out, bool all);
+    std::size_t fitLine(std::size_t begin, double tol) const;
+    std::size_t fitArc(std::size_t begin, Base::Vector3d &center, bool &clockwise) const;
+    void addMove(CommandStore &out, std::size_t begin, std::size_t end);
+    void addArc(CommandStore &out, std::size_t begin, std::size_t end, const Base::Vector3d &center,
+                bool clockwise);
+
+private:
+    // settings
+    double tolerance;
+    bool mergeLines;
+    bool fitArcs;
+    bool mergeRapids;
+
+    // modal state
+    bool absoluteCenter;
+    bool planeXY;
+    double feed;
+
+    // the current run of moves, the first point is the start position
+    std::vector<Point> points;
+    std::string name;
+    bool rapid;
+};
+
+} // namespace Path
+
+
+#endif // PATH_TOOLPATHOPTIMIZER_H
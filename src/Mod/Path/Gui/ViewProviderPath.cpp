@@ -24,9 +24,15 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 # include <Python.h>
 # include <Inventor/SbVec3f.h>
+# include <Inventor/SoPickedPoint.h>
+# include <Inventor/SoFullPath.h>
 # include <Inventor/nodes/SoSeparator.h>
+# include <Inventor/nodes/SoGroup.h>
+# include <Inventor/nodes/SoLevelOfDetail.h>
+# include <Inventor/nodes/SoPickStyle.h>
 # include <Inventor/nodes/SoTransform.h>
 # include <Inventor/nodes/SoRotation.h>
 # include <Inventor/nodes/SoBaseColor.h>
@@ -139,10 +145,18 @@ public:
 
 //////////////////////////////////////////////////////////////////////////////
 
+// the number of coordinates after which the shown edges are split into a new chunk
+static const int ChunkCoords = 16384;
+// the number of points of the overview of a large path
+static const int OverviewCoords = 65536;
+// the screen area in pixels below which the overview replaces the chunks
+static const float OverviewScreenArea = 250000.0f;
+
 PROPERTY_SOURCE(PathGui::ViewProviderPath, Gui::ViewProviderGeometryObject)
 
 ViewProviderPath::ViewProviderPath()
-    :pt0Index(-1),blockPropertyChange(false),edgeStart(-1),coordStart(-1),coordEnd(-1)
+    :pcPathRoot(0),pcLineSep(0)
+    ,pt0Index(-1),blockPropertyChange(false),edgeStart(-1),coordStart(-1),coordEnd(-1)
 {
     ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
     unsigned long lcol = hGrp->GetUnsigned("DefaultNormalPathColor",11141375UL); // dark green (0,170,0)
@@ -190,9 +204,15 @@ ViewProviderPath::ViewProviderPath()
     pcDrawStyle->style = SoDrawStyle::LINES;
     pcDrawStyle->lineWidth = LineWidth.getValue();
 
-    pcLines = new PartGui::SoBrepEdgeSet();
-    pcLines->ref();
-    pcLines->coordIndex.setNum(0);
+    pcLineChunks = new SoGroup();
+    pcLineChunks->ref();
+
+    pcOverview = new SoIndexedLineSet();
+    pcOverview->ref();
+
+    pcLineDetail = new SoLevelOfDetail();
+    pcLineDetail->ref();
+    pcLineDetail->screenArea.setValue(0.0f);
 
     pcLineColor = new SoMaterial;
     pcLineColor->ref();
@@ -246,7 +266,9 @@ ViewProviderPath::~ViewProviderPath()
     pcMarkerSwitch->unref();
     pcDrawStyle->unref();
     pcMarkerStyle->unref();
-    pcLines->unref();
+    pcLineChunks->unref();
+    pcOverview->unref();
+    pcLineDetail->unref();
     pcLineColor->unref();
     pcMatBind->unref();
     pcMarkerColor->unref();
@@ -257,13 +279,26 @@ void ViewProviderPath::attach(App::DocumentObject *pcObj)
 {
     inherited::attach(pcObj);
 
+    // Draw the overview of large paths in the normal color, it is only
+    // shown while the path covers a small part of the screen
+    SoSeparator* overviewsep = new SoSeparator;
+    SoMaterialBinding* overviewBind = new SoMaterialBinding;
+    overviewBind->value = SoMaterialBinding::OVERALL;
+    SoPickStyle* overviewPick = new SoPickStyle;
+    overviewPick->style = SoPickStyle::UNPICKABLE;
+    overviewsep->addChild(overviewBind);
+    overviewsep->addChild(overviewPick);
+    overviewsep->addChild(pcOverview);
+    pcLineDetail->addChild(pcLineChunks);
+    pcLineDetail->addChild(overviewsep);
+
     // Draw trajectory lines
-    SoSeparator* linesep = new SoSeparator;
-    linesep->addChild(pcLineColor);
-    linesep->addChild(pcMatBind);
-    linesep->addChild(pcDrawStyle);
-    linesep->addChild(pcLineCoords);
-    linesep->addChild(pcLines);
+    pcLineSep = new SoSeparator;
+    pcLineSep->addChild(pcLineColor);
+    pcLineSep->addChild(pcMatBind);
+    pcLineSep->addChild(pcDrawStyle);
+    pcLineSep->addChild(pcLineCoords);
+    pcLineSep->addChild(pcLineDetail);
 
     // Draw markers
     SoSeparator* markersep = new SoSeparator;
@@ -274,9 +309,9 @@ void ViewProviderPath::attach(App::DocumentObject *pcObj)
     markersep->addChild(marker);
     pcMarkerSwitch->addChild(markersep);
 
-    SoSeparator* pcPathRoot = new SoSeparator();
+    pcPathRoot = new SoSeparator();
     pcPathRoot->addChild(pcMarkerSwitch);
-    pcPathRoot->addChild(linesep);
+    pcPathRoot->addChild(pcLineSep);
     pcPathRoot->addChild(pcArrowSwitch);
 
     addDisplayMaskMode(pcPathRoot, "Waypoints");
@@ -338,6 +373,70 @@ SoDetail* ViewProviderPath::getDetail(const char* subelement) const
     return detail;
 }
 
+bool ViewProviderPath::getElementPicked(const SoPickedPoint *pp, std::string &subname) const
+{
+    const SoDetail *detail = pp?pp->getDetail():0;
+    if(!detail || detail->getTypeId() != SoLineDetail::getClassTypeId())
+        return inherited::getElementPicked(pp,subname);
+    if(!isSelectable())
+        return false;
+
+    // the line index of the detail is counted within the picked chunk
+    SoPath *path = pp->getPath();
+    int idx = path->findNode(pcLineChunks);
+    if(idx<0 || idx+1>=path->getLength())
+        return inherited::getElementPicked(pp,subname);
+    int index = path->getIndex(idx+1);
+    if(index<0 || index>=(int)chunks.size())
+        return inherited::getElementPicked(pp,subname);
+
+    SoLineDetail line;
+    line = *static_cast<const SoLineDetail*>(detail);
+    line.setLineIndex(line.getLineIndex()+chunks[index].edgeStart-edgeStart);
+    subname = getElement(&line);
+    return true;
+}
+
+bool ViewProviderPath::getDetailPath(
+            const char *subname, SoFullPath *pPath, bool append, SoDetail *&det) const
+{
+    int length = pPath->getLength();
+    if(!inherited::getDetailPath(subname,pPath,append,det))
+        return false;
+    if(!det || det->getTypeId() != SoLineDetail::getClassTypeId())
+        return true;
+
+    // extend the path down to the line set of the chunk holding the edge
+    SoLineDetail *line = static_cast<SoLineDetail*>(det);
+    int index = pcPathRoot?findChunk(line->getLineIndex()+edgeStart):-1;
+    if(index<0) {
+        delete det;
+        det = 0;
+        pPath->truncate(length);
+        return false;
+    }
+    line->setLineIndex(line->getLineIndex()+edgeStart-chunks[index].edgeStart);
+    pPath->append(pcPathRoot);
+    pPath->append(pcLineSep);
+    pPath->append(pcLineDetail);
+    pPath->append(pcLineChunks);
+    pPath->append(pcLineChunks->getChild(index));
+    pPath->append(chunks[index].pcLines);
+    return true;
+}
+
+int ViewProviderPath::findChunk(int edge) const
+{
+    auto it = std::upper_bound(chunks.begin(), chunks.end(), edge,
+            [](int edge, const Chunk &chunk) { return edge < chunk.edgeStart; });
+    if(it == chunks.begin())
+        return -1;
+    --it;
+    if(edge >= it->edgeEnd)
+        return -1;
+    return it - chunks.begin();
+}
+
 void ViewProviderPath::onChanged(const App::Property* prop)
 {
     if(blockPropertyChange) return;
@@ -357,25 +456,29 @@ void ViewProviderPath::onChanged(const App::Property* prop)
             pr = ((pcol >> 24) & 0xff) / 255.0; pg = ((pcol >> 16) & 0xff) / 255.0; pb = ((pcol >> 8) & 0xff) / 255.0;
 
             pcMatBind->value = SoMaterialBinding::PER_PART;
-            // resizing and writing the color vector:
-
-            int count = coordEnd-coordStart;
-            if(count > (int)colorindex.size()-coordStart) count = colorindex.size()-coordStart;
-            pcLineColor->diffuseColor.setNum(count);
-            SbColor* colors = pcLineColor->diffuseColor.startEditing();
-            for(int i=0;i<count;i++) {
-                switch(colorindex[i+coordStart]){
-                case 0:
-                    colors[i] = SbColor(rr,rg,rb);
-                    break;
-                case 1:
-                    colors[i] = SbColor(c.r,c.g,c.b);
-                    break;
-                default:
-                    colors[i] = SbColor(pr,pg,pb);
+            // the overview is drawn in the normal color only
+            pcLineColor->diffuseColor.setValue(c.r,c.g,c.b);
+
+            // resizing and writing the color vector of each chunk:
+            for(auto &chunk : chunks) {
+                int count = chunk.coordEnd-chunk.coordStart;
+                if(count > (int)colorindex.size()-chunk.coordStart) count = colorindex.size()-chunk.coordStart;
+                chunk.pcColor->diffuseColor.setNum(count);
+                SbColor* colors = chunk.pcColor->diffuseColor.startEditing();
+                for(int i=0;i<count;i++) {
+                    switch(colorindex[i+chunk.coordStart]){
+                    case 0:
+                        colors[i] = SbColor(rr,rg,rb);
+                        break;
+                    case 1:
+                        colors[i] = SbColor(c.r,c.g,c.b);
+                        break;
+                    default:
+                        colors[i] = SbColor(pr,pg,pb);
+                    }
                 }
+                chunk.pcColor->diffuseColor.finishEditing();
             }
-            pcLineColor->diffuseColor.finishEditing();
         }
     } else if (prop == &MarkerColor) {
         const App::Color& c = MarkerColor.getValue();
@@ -448,11 +551,11 @@ void ViewProviderPath::updateData(const App::Property* prop)
 void ViewProviderPath::hideSelection() {
     // Clear selection
     SoSelectionElementAction saction(Gui::SoSelectionElementAction::None);
-    saction.apply(pcLines);
+    saction.apply(pcLineChunks);
 
     // Clear highlighting
     SoHighlightElementAction haction;
-    haction.apply(pcLines);
+    haction.apply(pcLineChunks);
 
     // Hide arrow
     pcArrowSwitch->whichChild = -1;
@@ -605,7 +708,10 @@ void ViewProviderPath::updateVisual(bool rebuild) {
 
     updateShowConstraints();
 
-    pcLines->coordIndex.deleteValues(0);
+    chunks.clear();
+    pcLineChunks->removeAllChildren();
+    pcOverview->coordIndex.deleteValues(0);
+    pcLineDetail->screenArea.setValue(0.0f);
 
     if(rebuild) {
         Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
@@ -637,8 +743,11 @@ void ViewProviderPath::updateVisual(bool rebuild) {
             pcLineCoords->point.finishEditing();
 
             pcMarkerCoords->point.setNum(markers.size());
-            for(unsigned int i=0;i<markers.size();i++)
-                pcMarkerCoords->point.set1Value(i,markers[i].x,markers[i].y,markers[i].z);
+            verts = pcMarkerCoords->point.startEditing();
+            i=0;
+            for(const auto &pt : markers)
+                verts[i++].setValue(pt.x,pt.y,pt.z);
+            pcMarkerCoords->point.finishEditing();
 
             recomputeBoundingBox();
         }
@@ -667,25 +776,77 @@ void ViewProviderPath::updateVisual(bool rebuild) {
     coordStart = edgeStart==0?0:(edgeIndices[edgeStart-1]-1);
     coordEnd = edgeIndices[edgeEnd-1];
 
-    // count = coord indices + index separators
-    int count = coordEnd-coordStart+2*(edgeEnd-edgeStart-1)+1;
-
-    pcLines->coordIndex.setNum(count);
-    int32_t *idx = pcLines->coordIndex.startEditing();
-    i=0;
-    int start = coordStart;
-    for(int e=edgeStart;e!=edgeEnd;++e) {
-        for(int end=edgeIndices[e];start<end;++start)
-            idx[i++] = start;
-        idx[i++]=-1;
-        --start;
-    }
-    pcLines->coordIndex.finishEditing();
-    assert(i==count);
+    buildChunks(edgeEnd);
+    buildOverview();
 
     NormalColor.touch();
 }
 
+void ViewProviderPath::buildChunks(int edgeEnd)
+{
+    int e = edgeStart;
+    while(e < edgeEnd) {
+        Chunk chunk;
+        chunk.edgeStart = e;
+        chunk.coordStart = e==0?0:(edgeIndices[e-1]-1);
+        // take whole edges until the chunk has enough coordinates
+        for(++e; e<edgeEnd && edgeIndices[e-1]-chunk.coordStart<ChunkCoords; ++e);
+        chunk.edgeEnd = e;
+        chunk.coordEnd = edgeIndices[e-1];
+
+        // count = coord indices + index separators
+        int count = chunk.coordEnd-chunk.coordStart+2*(chunk.edgeEnd-chunk.edgeStart-1)+1;
+
+        chunk.pcLines = new PartGui::SoBrepEdgeSet();
+        chunk.pcLines->coordIndex.setNum(count);
+        int32_t *idx = chunk.pcLines->coordIndex.startEditing();
+        int i=0;
+        int start = chunk.coordStart;
+        for(int edge=chunk.edgeStart;edge!=chunk.edgeEnd;++edge) {
+            for(int end=edgeIndices[edge];start<end;++start)
+                idx[i++] = start;
+            idx[i++]=-1;
+            --start;
+        }
+        chunk.pcLines->coordIndex.finishEditing();
+        assert(i==count);
+
+        chunk.pcColor = new SoMaterial();
+
+        SoSeparator *sep = new SoSeparator();
+        sep->renderCulling = SoSeparator::ON;
+        sep->addChild(chunk.pcColor);
+        sep->addChild(chunk.pcLines);
+        pcLineChunks->addChild(sep);
+
+        chunks.push_back(chunk);
+    }
+}
+
+void ViewProviderPath::buildOverview()
+{
+    // A large path gets a coarse polyline through every n-th point, which
+    // is drawn instead of the chunks while the path is small on the screen,
+    // e.g. when zoomed out to navigate around the job.
+    int count = coordEnd-coordStart;
+    if(count <= 4*OverviewCoords)
+        return;
+
+    int step = (count+OverviewCoords-1)/OverviewCoords;
+    pcOverview->coordIndex.setNum(count/step+3);
+    int32_t *idx = pcOverview->coordIndex.startEditing();
+    int i=0;
+    for(int c=coordStart;c<coordEnd;c+=step)
+        idx[i++] = c;
+    if(idx[i-1] != coordEnd-1)
+        idx[i++] = coordEnd-1;
+    idx[i++] = -1;
+    pcOverview->coordIndex.finishEditing();
+    pcOverview->coordIndex.setNum(i);
+
+    pcLineDetail->screenArea.setValue(OverviewScreenArea);
+}
+
 void ViewProviderPath::recomputeBoundingBox()
 {
     // update the boundbox
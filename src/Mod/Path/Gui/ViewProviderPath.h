@@ -38,6 +38,9 @@ class SoBaseColor;
 class SoMaterialBinding;
 class SoTransform;
 class SoSwitch;
+class SoGroup;
+class SoLevelOfDetail;
+class SoIndexedLineSet;
 
 namespace PathGui
 {
@@ -78,6 +81,8 @@ public:
     virtual bool useNewSelectionModel(void) const;
     virtual std::string getElement(const SoDetail *) const;
     SoDetail* getDetail(const char* subelement) const;
+    virtual bool getElementPicked(const SoPickedPoint *, std::string &subname) const;
+    virtual bool getDetailPath(const char *subname, SoFullPath *pPath, bool append, SoDetail *&det) const;
 
     void updateShowConstraints();
     void updateVisual(bool rebuild = false);
@@ -92,11 +97,33 @@ protected:
     virtual void onChanged(const App::Property* prop);
     virtual unsigned long getBoundColor() const;
 
+    void buildChunks(int edgeEnd);
+    void buildOverview();
+    int findChunk(int edge) const;
+
+    /** A part of the shown edges with its own line set. Each chunk is put
+     * in a separator with render culling, so that only the chunks inside
+     * the view are sent to OpenGL.
+     */
+    struct Chunk {
+        int edgeStart;
+        int edgeEnd;
+        int coordStart;
+        int coordEnd;
+        PartGui::SoBrepEdgeSet *pcLines;
+        SoMaterial *pcColor;
+    };
+    std::vector<Chunk>      chunks;
+
     SoCoordinate3         * pcLineCoords;
     SoCoordinate3         * pcMarkerCoords;
     SoDrawStyle           * pcDrawStyle;
     SoDrawStyle           * pcMarkerStyle;
-    PartGui::SoBrepEdgeSet         * pcLines;
+    SoGroup               * pcLineChunks;
+    SoLevelOfDetail       * pcLineDetail;
+    SoIndexedLineSet      * pcOverview;
+    SoSeparator           * pcPathRoot;
+    SoSeparator           * pcLineSep;
     SoMaterial            * pcLineColor;
     SoBaseColor           * pcMarkerColor;
     SoMaterialBinding     * pcMatBind;
@@ -23,6 +23,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <memory>
 # include <boost/regex.hpp>
 #endif
 
@@ -52,10 +53,10 @@ PathSim::~PathSim()
 		delete m_tool;
 }
 
-void PathSim::BeginSimulation(Part::TopoShape * stock, float resolution)
+void PathSim::BeginSimulation(Part::TopoShape * stock, float resolution, int tileSize)
 {
 	Base::BoundBox3d bbox = stock->getBoundBox();
-	m_stock = new cStock(bbox.MinX, bbox.MinY, bbox.MinZ, bbox.LengthX(), bbox.LengthY(), bbox.LengthZ(), resolution);
+	m_stock = new cStock(bbox.MinX, bbox.MinY, bbox.MinZ, bbox.LengthX(), bbox.LengthY(), bbox.LengthZ(), resolution, tileSize);
 }
 
 void PathSim::SetToolShape(const TopoDS_Shape& toolShape, float resolution)
@@ -94,6 +95,67 @@ Base::Placement * PathSim::ApplyCommand(Base::Placement * pos, Command * cmd)
 	return plc;
 }
 
+Base::Placement PathSim::SimulatePath(const Toolpath & path, const Base::Placement & pos, std::vector<int> & gouges)
+{
+	if (m_stock == nullptr)
+		throw Base::RuntimeError("Simulation has no stock object");
+
+	Base::Placement curPos(pos);
+	bool firstDrill = true;
+	for (unsigned int i = 0; i < path.getSize(); i++)
+	{
+		Command cmd = path.getCommand(i);
+		std::vector<Command> moves;
+		if (cmd.Name == "G0" || cmd.Name == "G1" || cmd.Name == "G2" || cmd.Name == "G3")
+		{
+			firstDrill = true;
+			moves.push_back(cmd);
+		}
+		else if (cmd.Name == "G80")
+		{
+			firstDrill = true;
+		}
+		else if (cmd.Name == "G81" || cmd.Name == "G82" || cmd.Name == "G83")
+		{
+			// same expansion of the drill cycles as the simulator task panel
+			const Vector3d & cur = curPos.getPosition();
+			double x = cmd.getParam("X", cur.x);
+			double y = cmd.getParam("Y", cur.y);
+			double r = cmd.getParam("R", cur.z);
+			double z = cmd.getParam("Z", cur.z);
+			Command move;
+			move.Name = "G0";
+			if (firstDrill)
+			{
+				move.Parameters["Z"] = r;
+				moves.push_back(move);
+				firstDrill = false;
+			}
+			move.Parameters["X"] = x;
+			move.Parameters["Y"] = y;
+			moves.push_back(move);
+			move.Name = "G1";
+			move.Parameters["Z"] = z;
+			moves.push_back(move);
+			move.Parameters["Z"] = r;
+			moves.push_back(move);
+		}
+
+		bool gouged = false;
+		for (std::vector<Command>::iterator it = moves.begin(); it != moves.end(); ++it)
+		{
+			unsigned long cuts = m_stock->GetCutCount();
+			std::unique_ptr<Base::Placement> newPos(ApplyCommand(&curPos, &(*it)));
+			curPos = *newPos;
+			if (it->Name == "G0" && m_stock->GetCutCount() != cuts)
+				gouged = true;
+		}
+		if (gouged)
+			gouges.push_back(i);
+	}
+	return curPos;
+}
+
 
 
 
@@ -31,6 +31,7 @@
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
 #include <Mod/Path/App/Command.h>
+#include <Mod/Path/App/Path.h>
 #include <Mod/Part/App/TopoShape.h>
 #include "VolSim.h"
 
@@ -49,9 +50,13 @@ namespace PathSimulator
 			PathSim();
 			~PathSim();
 
-			void BeginSimulation(Part::TopoShape * stock, float resolution);
+			void BeginSimulation(Part::TopoShape * stock, float resolution, int tileSize = SIM_TILE_SIZE);
 			void SetToolShape(const TopoDS_Shape& toolShape, float resolution);
 			Base::Placement * ApplyCommand(Base::Placement * pos, Command * cmd);
+			/** Simulates all commands of \a path without tessellating the stock and
+			 * returns the end position. The indices of the rapid moves that cut the
+			 * stock are added to \a gouges. */
+			Base::Placement SimulatePath(const Toolpath & path, const Base::Placement & pos, std::vector<int> & gouges);
 
 		public:
 			cStock * m_stock;
@@ -26,7 +26,9 @@
 #include <Base/PlacementPy.h>
 #include <Base/VectorPy.h>
 #include <Mod/Part/App/TopoShapePy.h>
+#include <Mod/Part/App/OCCError.h>
 #include <Mod/Path/App/CommandPy.h>
+#include <Mod/Path/App/PathPy.h>
 #include <Mod/Mesh/App/MeshPy.h>
 #include "Mod/Path/PathSimulator/App/PathSim.h"
 
@@ -57,14 +59,15 @@ int PathSimPy::PyInit(PyObject* /*args*/, PyObject* /*kwd*/)
 
 PyObject* PathSimPy::BeginSimulation(PyObject * args, PyObject * kwds)
 {
-	static char *kwlist[] = { "stock", "resolution", NULL };
+	static char *kwlist[] = { "stock", "resolution", "tileSize", NULL };
 	PyObject *pObjStock;
 	float resolution;
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!f", kwlist, &(Part::TopoShapePy::Type), &pObjStock, &resolution))
+	int tileSize = SIM_TILE_SIZE;
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!f|i", kwlist, &(Part::TopoShapePy::Type), &pObjStock, &resolution, &tileSize))
 		return 0;
 	PathSim *sim = getPathSimPtr();
 	Part::TopoShape *stock = static_cast<Part::TopoShapePy*>(pObjStock)->getTopoShapePtr();
-	sim->BeginSimulation(stock, resolution);
+	sim->BeginSimulation(stock, resolution, tileSize);
 	Py_IncRef(Py_None);
 	return Py_None;
 }
@@ -122,6 +125,38 @@ PyObject* PathSimPy::ApplyCommand(PyObject * args, PyObject * kwds)
 	return newposPy;
 }
 
+PyObject* PathSimPy::SimulatePath(PyObject * args, PyObject * kwds)
+{
+	static char *kwlist[] = { "path", "position", NULL };
+	PyObject *pObjPath;
+	PyObject *pObjPlace;
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O!", kwlist, &(Path::PathPy::Type), &pObjPath, &(Base::PlacementPy::Type), &pObjPlace))
+		return 0;
+	PathSim *sim = getPathSimPtr();
+	if (sim->m_stock == NULL)
+	{
+		PyErr_SetString(PyExc_RuntimeError, "Simulation has no stock object");
+		return 0;
+	}
+
+	const Path::Toolpath *path = static_cast<Path::PathPy*>(pObjPath)->getToolpathPtr();
+	Base::Placement *pos = static_cast<Base::PlacementPy*>(pObjPlace)->getPlacementPtr();
+	std::vector<int> gouges;
+	Base::Placement newpos;
+	PY_TRY {
+		newpos = sim->SimulatePath(*path, *pos, gouges);
+	} PY_CATCH_OCC;
+
+	Py::List gougeList;
+	for (std::vector<int>::iterator it = gouges.begin(); it != gouges.end(); ++it)
+		gougeList.append(Py::Long(*it));
+	Py::Tuple tuple(3);
+	tuple.setItem(0, Py::asObject(new Base::PlacementPy(new Base::Placement(newpos))));
+	tuple.setItem(1, Py::Float(sim->m_stock->GetRemovedVolume()));
+	tuple.setItem(2, gougeList);
+	return Py::new_reference_to(tuple);
+}
+
 Py::Object PathSimPy::getTool(void) const
 {
     //return Py::Object();
@@ -48,14 +48,18 @@
 
 // STL
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <sstream>
 #include <stack>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Boost
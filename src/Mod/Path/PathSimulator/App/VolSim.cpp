@@ -29,6 +29,9 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <atomic>
+# include <future>
+# include <thread>
 #endif
 
 #include "VolSim.h"
@@ -36,8 +39,8 @@
 //************************************************************************************************************
 // stock
 //************************************************************************************************************
-cStock::cStock(float px, float py, float pz, float lx, float ly, float lz, float res)
-	: m_px(px), m_py(py), m_pz(pz), m_lx(lx), m_ly(ly), m_lz(lz), m_res(res)
+cStock::cStock(float px, float py, float pz, float lx, float ly, float lz, float res, int tileSize)
+	: m_px(px), m_py(py), m_pz(pz), m_lx(lx), m_ly(ly), m_lz(lz), m_res(res), m_cutCount(0)
 {
 	m_x = (int)(m_lx / res) + 1;
 	m_y = (int)(m_ly / res) + 1;
@@ -50,6 +53,27 @@ cStock::cStock(float px, float py, float pz, float lx, float ly, float lz, float
 			m_stock[x][y] = m_plane;
 			m_attr[x][y] = 0;
 		}
+
+	if (tileSize <= 0)
+		tileSize = std::max(m_x, m_y);
+	m_tileShift = 0;
+	while ((1 << m_tileShift) < tileSize)
+		m_tileShift++;
+	m_tileMask = (1 << m_tileShift) - 1;
+
+	m_tx = (m_x + m_tileMask) >> m_tileShift;
+	m_ty = (m_y + m_tileMask) >> m_tileShift;
+	m_tiles.resize(m_tx * m_ty);
+	for (int ty = 0; ty < m_ty; ty++)
+		for (int tx = 0; tx < m_tx; tx++)
+		{
+			cStockTile & tile = m_tiles[ty * m_tx + tx];
+			tile.x0 = tx << m_tileShift;
+			tile.y0 = ty << m_tileShift;
+			tile.x1 = std::min(m_x, tile.x0 + m_tileMask + 1);
+			tile.y1 = std::min(m_y, tile.y0 + m_tileMask + 1);
+			tile.dirty = true;
+		}
 }
 
 cStock::~cStock()
@@ -57,7 +81,7 @@ cStock::~cStock()
 }
 
 
-float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz)
+float cStock::FindRectTop(const cStockTile & tile, int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz)
 {
 	float z = m_stock[xp][yp];
 	bool xr_ok = true;
@@ -71,7 +95,7 @@ float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool s
 		if (xr_ok)
 		{
 			int tx = xp + x_size;
-			if (tx >= m_x)
+			if (tx >= tile.x1)
 				xr_ok = false;
 			else
 			{
@@ -92,7 +116,7 @@ float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool s
 		if (xl_ok)
 		{
 			int tx = xp - 1;
-			if (tx < 0)
+			if (tx < tile.x0)
 				xl_ok = false;
 			else
 			{
@@ -116,7 +140,7 @@ float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool s
 		if (yu_ok)
 		{
 			int ty = yp + y_size;
-			if (ty >= m_y)
+			if (ty >= tile.y1)
 				yu_ok = false;
 			else
 			{
@@ -137,7 +161,7 @@ float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool s
 		if (yd_ok)
 		{
 			int ty = yp - 1;
-			if (ty < 0)
+			if (ty < tile.y0)
 				yd_ok = false;
 			else
 			{
@@ -160,23 +184,23 @@ float cStock::FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool s
 	return z;
 }
 
-int cStock::TesselTop(int xp, int yp)
+int cStock::TesselTop(cStockTile & tile, int xp, int yp)
 {
 	int x_size, y_size;
-	float z = FindRectTop(xp, yp, x_size, y_size, true);
+	float z = FindRectTop(tile, xp, yp, x_size, y_size, true);
 	bool farRect = false;
 	while (y_size / x_size > 5)
 	{
 		farRect = true;
 		yp += x_size * 5;
-		z = FindRectTop(xp, yp, x_size, y_size, true);
+		z = FindRectTop(tile, xp, yp, x_size, y_size, true);
 	}
 
 	while (x_size / y_size > 5)
 	{
 		farRect = true;
 		xp += y_size * 5;
-		z = FindRectTop(xp, yp, x_size, y_size, false);
+		z = FindRectTop(tile, xp, yp, x_size, y_size, false);
 	}
 
 	// mark all points inside
@@ -192,9 +216,9 @@ int cStock::TesselTop(int xp, int yp)
 		Point3D ptl(xp, yp + y_size, z);
 		Point3D ptr(xp + x_size, yp + y_size, z);
 		if (fabs(m_pz + m_lz - z) < SIM_EPSILON)
-			AddQuad(pbl, pbr, ptr, ptl, facetsOuter);
+			AddQuad(pbl, pbr, ptr, ptl, tile.facetsOuter);
 		else
-			AddQuad(pbl, pbr, ptr, ptl, facetsInner);
+			AddQuad(pbl, pbr, ptr, ptl, tile.facetsInner);
 	}
 
 	if (farRect)
@@ -204,7 +228,7 @@ int cStock::TesselTop(int xp, int yp)
 }
 
 
-void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz)
+void cStock::FindRectBot(const cStockTile & tile, int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz)
 {
 	bool xr_ok = true;
 	bool xl_ok = scanHoriz;
@@ -217,7 +241,7 @@ void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool sc
 		if (xr_ok)
 		{
 			int tx = xp + x_size;
-			if (tx >= m_x)
+			if (tx >= tile.x1)
 				xr_ok = false;
 			else
 			{
@@ -238,7 +262,7 @@ void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool sc
 		if (xl_ok)
 		{
 			int tx = xp - 1;
-			if (tx < 0)
+			if (tx < tile.x0)
 				xl_ok = false;
 			else
 			{
@@ -262,7 +286,7 @@ void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool sc
 		if (yu_ok)
 		{
 			int ty = yp + y_size;
-			if (ty >= m_y)
+			if (ty >= tile.y1)
 				yu_ok = false;
 			else
 			{
@@ -283,7 +307,7 @@ void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool sc
 		if (yd_ok)
 		{
 			int ty = yp - 1;
-			if (ty < 0)
+			if (ty < tile.y0)
 				yd_ok = false;
 			else
 			{
@@ -306,23 +330,23 @@ void cStock::FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool sc
 }
 
 
-int cStock::TesselBot(int xp, int yp)
+int cStock::TesselBot(cStockTile & tile, int xp, int yp)
 {
 	int x_size, y_size;
-	FindRectBot(xp, yp, x_size, y_size, true);
+	FindRectBot(tile, xp, yp, x_size, y_size, true);
 	bool farRect = false;
 	while (y_size / x_size > 5)
 	{
 		farRect = true;
 		yp += x_size * 5;
-		FindRectTop(xp, yp, x_size, y_size, true);
+		FindRectTop(tile, xp, yp, x_size, y_size, true);
 	}
 
 	while (x_size / y_size > 5)
 	{
 		farRect = true;
 		xp += y_size * 5;
-		FindRectTop(xp, yp, x_size, y_size, false);
+		FindRectTop(tile, xp, yp, x_size, y_size, false);
 	}
 
 	// mark all points inside
@@ -335,7 +359,7 @@ int cStock::TesselBot(int xp, int yp)
 	Point3D pbr(xp + x_size, yp, m_pz);
 	Point3D ptl(xp, yp + y_size, m_pz);
 	Point3D ptr(xp + x_size, yp + y_size, m_pz);
-	AddQuad(pbl, ptl, ptr, pbr, facetsOuter);
+	AddQuad(pbl, ptl, ptr, pbr, tile.facetsOuter);
 
 	if (farRect)
 		return -1;
@@ -344,22 +368,22 @@ int cStock::TesselBot(int xp, int yp)
 }
 
 
-int cStock::TesselSidesX(int yp)
+int cStock::TesselSidesX(cStockTile & tile, int yp)
 {
 	float lastz1 = m_pz;
 	if (yp < m_y)
-		lastz1 = std::max(m_stock[0][yp], m_pz);
+		lastz1 = std::max(m_stock[tile.x0][yp], m_pz);
 	float lastz2 = m_pz;
 	if (yp > 0)
-		lastz2 = std::max(m_stock[0][yp - 1], m_pz);
+		lastz2 = std::max(m_stock[tile.x0][yp - 1], m_pz);
 
-	std::vector<MeshCore::MeshGeomFacet> *facets = &facetsInner;
+	std::vector<MeshCore::MeshGeomFacet> *facets = &tile.facetsInner;
 	if (yp == 0 || yp == m_y)
-		facets = &facetsOuter;
+		facets = &tile.facetsOuter;
 
 	//bool lastzclip = (lastz - m_pz) < m_res;
-	int lastpoint = 0;
-	for (int x = 1; x <= m_x; x++)
+	int lastpoint = tile.x0;
+	for (int x = tile.x0 + 1; x <= tile.x1; x++)
 	{
 		float newz1 = m_pz;
 		if (yp < m_y && x < m_x)
@@ -370,7 +394,8 @@ int cStock::TesselSidesX(int yp)
 
 		if (fabs(lastz1 - lastz2) > m_res)
 		{
-			if (fabs(newz1 - lastz1) < m_res && fabs(newz2 - lastz2) < m_res)
+			// the side is closed at the tile border
+			if (x < tile.x1 && fabs(newz1 - lastz1) < m_res && fabs(newz2 - lastz2) < m_res)
 				continue;
 			Point3D pbl(lastpoint, yp, lastz1);
 			Point3D pbr(x, yp, lastz1);
@@ -385,22 +410,22 @@ int cStock::TesselSidesX(int yp)
 	return 0;
 }
 
-int cStock::TesselSidesY(int xp)
+int cStock::TesselSidesY(cStockTile & tile, int xp)
 {
 	float lastz1 = m_pz;
 	if (xp < m_x)
-		lastz1 = std::max(m_stock[xp][0], m_pz);
+		lastz1 = std::max(m_stock[xp][tile.y0], m_pz);
 	float lastz2 = m_pz;
 	if (xp > 0)
-		lastz2 = std::max(m_stock[xp - 1][0], m_pz);
+		lastz2 = std::max(m_stock[xp - 1][tile.y0], m_pz);
 
-	std::vector<MeshCore::MeshGeomFacet> *facets = &facetsInner;
+	std::vector<MeshCore::MeshGeomFacet> *facets = &tile.facetsInner;
 	if (xp == 0 || xp == m_x)
-		facets = &facetsOuter;
+		facets = &tile.facetsOuter;
 
 	//bool lastzclip = (lastz - m_pz) < m_res;
-	int lastpoint = 0;
-	for (int y = 1; y <= m_y; y++)
+	int lastpoint = tile.y0;
+	for (int y = tile.y0 + 1; y <= tile.y1; y++)
 	{
 		float newz1 = m_pz;
 		if (xp < m_x && y < m_y)
@@ -411,7 +436,8 @@ int cStock::TesselSidesY(int xp)
 
 		if (fabs(lastz1 - lastz2) > m_res)
 		{
-			if (fabs(newz1 - lastz1) < m_res && fabs(newz2 - lastz2) < m_res)
+			// the side is closed at the tile border
+			if (y < tile.y1 && fabs(newz1 - lastz1) < m_res && fabs(newz2 - lastz2) < m_res)
 				continue;
 			Point3D pbr(xp, lastpoint, lastz1);
 			Point3D pbl(xp, y, lastz1);
@@ -449,43 +475,113 @@ void cStock::AddQuad(Point3D & p1, Point3D & p2, Point3D & p3, Point3D & p4, std
 	facets.push_back(facet);
 }
 
-void cStock::Tessellate(Mesh::MeshObject & meshOuter, Mesh::MeshObject & meshInner)
+void cStock::SetDirty(int x, int y)
+{
+	int tx = x >> m_tileShift;
+	int ty = y >> m_tileShift;
+	m_tiles[ty * m_tx + tx].dirty = true;
+
+	// the sides to the upper and right neighbor pixels belong to the next tile
+	// if the pixel is on the tile border
+	if (((y + 1) & m_tileMask) == 0 && y + 1 < m_y)
+		m_tiles[(ty + 1) * m_tx + tx].dirty = true;
+	if (((x + 1) & m_tileMask) == 0 && x + 1 < m_x)
+		m_tiles[ty * m_tx + tx + 1].dirty = true;
+}
+
+void cStock::TessellateTile(cStockTile & tile)
 {
 	// reset attribs
-	for (int y = 0; y < m_y; y++)
-	for (int x = 0; x < m_x; x++)
+	for (int y = tile.y0; y < tile.y1; y++)
+	for (int x = tile.x0; x < tile.x1; x++)
 		m_attr[x][y] = 0;
 
-	facetsOuter.clear();
-	facetsInner.clear();
+	tile.facetsOuter.clear();
+	tile.facetsInner.clear();
 
-	for (int y = 0; y < m_y; y++)
+	for (int y = tile.y0; y < tile.y1; y++)
 	{
-		for (int x = 0; x < m_x; x++)
+		for (int x = tile.x0; x < tile.x1; x++)
 		{
 			int attr = m_attr[x][y];
 			if ((attr & SIM_TESSEL_TOP) == 0)
-				x += TesselTop(x, y);
+				x += TesselTop(tile, x, y);
 		}
 	}
-	for (int y = 0; y < m_y; y++)
+	for (int y = tile.y0; y < tile.y1; y++)
 	{
-		for (int x = 0; x < m_x; x++)
+		for (int x = tile.x0; x < tile.x1; x++)
 		{
 			if ((m_stock[x][y] - m_pz) < m_res)
 				m_attr[x][y] |= SIM_TESSEL_BOT;
 			if ((m_attr[x][y] & SIM_TESSEL_BOT) == 0)
-				x += TesselBot(x, y);
+				x += TesselBot(tile, x, y);
 		}
 	}
-	for (int y = 0; y <= m_y; y++)
-		TesselSidesX(y);
-	for (int x = 0; x <= m_x; x++)
-		TesselSidesY(x);
+
+	// a tile owns the sides in front of its pixels, and the last tiles the stock border
+	int ye = tile.y1 == m_y ? m_y : tile.y1 - 1;
+	for (int y = tile.y0; y <= ye; y++)
+		TesselSidesX(tile, y);
+	int xe = tile.x1 == m_x ? m_x : tile.x1 - 1;
+	for (int x = tile.x0; x <= xe; x++)
+		TesselSidesY(tile, x);
+	tile.dirty = false;
+}
+
+void cStock::Tessellate(Mesh::MeshObject & meshOuter, Mesh::MeshObject & meshInner)
+{
+	std::vector<cStockTile*> dirty;
+	for (std::vector<cStockTile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+	{
+		if (it->dirty)
+			dirty.push_back(&(*it));
+	}
+
+	// the tiles only write their own pixel attributes and facets, so they
+	// are tessellated concurrently
+	if (!dirty.empty())
+	{
+		int numThreads = std::min<int>(dirty.size(), std::max<int>(1, std::thread::hardware_concurrency()));
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			for (size_t i; (i = next++) < dirty.size();)
+				TessellateTile(*dirty[i]);
+		};
+		std::vector<std::future<void> > futures;
+		for (int i = 1; i < numThreads; i++)
+			futures.push_back(std::async(std::launch::async, worker));
+		worker();
+		for (std::vector<std::future<void> >::iterator it = futures.begin(); it != futures.end(); ++it)
+			it->get();
+	}
+
+	size_t numOuter = 0, numInner = 0;
+	for (std::vector<cStockTile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+	{
+		numOuter += it->facetsOuter.size();
+		numInner += it->facetsInner.size();
+	}
+	std::vector<MeshCore::MeshGeomFacet> facetsOuter;
+	std::vector<MeshCore::MeshGeomFacet> facetsInner;
+	facetsOuter.reserve(numOuter);
+	facetsInner.reserve(numInner);
+	for (std::vector<cStockTile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+	{
+		facetsOuter.insert(facetsOuter.end(), it->facetsOuter.begin(), it->facetsOuter.end());
+		facetsInner.insert(facetsInner.end(), it->facetsInner.begin(), it->facetsInner.end());
+	}
 	meshOuter.addFacets(facetsOuter);
 	meshInner.addFacets(facetsInner);
-	facetsOuter.clear();
-	facetsInner.clear();
+}
+
+double cStock::GetRemovedVolume()
+{
+	double height = 0;
+	for (int y = 0; y < m_y; y++)
+		for (int x = 0; x < m_x; x++)
+			height += m_plane - std::max(m_stock[x][y], m_pz);
+	return height * m_res * m_res;
 }
 
 
@@ -504,7 +600,7 @@ void cStock::CreatePocket(float cxf, float cyf, float radf, float height)
 		for (int x = xs; x < xe; x++)
 		{
 			if (((x - cx)*(x - cx) + (y - cy) * (y - cy)) < drad)
-				if (m_stock[x][y] > height) m_stock[x][y] = height;
+				CutAt(x, y, height);
 		}
 	}
 }
@@ -540,13 +636,7 @@ void cStock::ApplyLinearTool(Point3D & p1, Point3D & p2, cSimTool & tool)
 			Point3D p = start;
 			for (int i = 0; i < lenSteps; i++)
 			{
-				int x = (int)p.x;
-				int y = (int)p.y;
-				if (x >= 0 && y >= 0 && x < m_x && y < m_y)
-				{
-					if (m_stock[x][y] > z)
-						m_stock[x][y] = z;
-				}
+				CutAt((int)p.x, (int)p.y, z);
 				p.Add(mainWay);
 				z += zstep;
 			}
@@ -566,13 +656,7 @@ void cStock::ApplyLinearTool(Point3D & p1, Point3D & p2, cSimTool & tool)
 		float z = pi2.z + tool.GetToolProfileAt(r / rad);
 		for (float a = 0; a < cupAngle; a += rotang)
 		{
-			int x = (int)(pi2.x + cupCirc.x);
-			int y = (int)(pi2.y + cupCirc.y);
-			if (x >= 0 && y >= 0 && x < m_x && y < m_y)
-			{
-				if (m_stock[x][y] > z)
-					m_stock[x][y] = z;
-			}
+			CutAt((int)(pi2.x + cupCirc.x), (int)(pi2.y + cupCirc.y), z);
 			cupCirc.Rotate();
 		}
 	}
@@ -627,13 +711,7 @@ void cStock::ApplyCircularTool(Point3D & p1, Point3D & p2, Point3D & cent, cSimT
 		float zstep = (pi2.z - pi1.z) / ndivs;
 		for (int i = 0; i< ndivs; i++)
 		{
-			int x = (int)(cpx + cupCirc.x);
-			int y = (int)(cpy + cupCirc.y);
-			if (x >= 0 && y >= 0 && x < m_x && y < m_y)
-			{
-				if (m_stock[x][y] > z)
-					m_stock[x][y] = z;
-			}
+			CutAt((int)(cpx + cupCirc.x), (int)(cpy + cupCirc.y), z);
 			z += zstep;
 			cupCirc.Rotate();
 		}
@@ -654,13 +732,7 @@ void cStock::ApplyCircularTool(Point3D & p1, Point3D & p2, Point3D & cent, cSimT
 		float z = pi2.z + tool.GetToolProfileAt(r / rad);
 		for (int i = 0; i < ndivs; i++)
 		{
-			int x = (int)(pi2.x + cupCirc.x);
-			int y = (int)(pi2.y + cupCirc.y);
-			if (x >= 0 && y >= 0 && x < m_x && y < m_y)
-			{
-				if (m_stock[x][y] > z)
-					m_stock[x][y] = z;
-			}
+			CutAt((int)(pi2.x + cupCirc.x), (int)(pi2.y + cupCirc.y), z);
 			cupCirc.Rotate();
 		}
 	}
@@ -34,6 +34,7 @@
 #define SIM_TESSEL_TOP		1
 #define SIM_TESSEL_BOT		2
 #define SIM_WALK_RES		0.6   // step size in pixel units (to make sure all pixels in the path are visited)
+#define SIM_TILE_SIZE		64    // default size of the tiles in pixels that are tessellated separately
 
 struct toolShapePoint {
   float radiusPos;
@@ -136,10 +137,21 @@ private:
 	int height;
 };
 
+// A part of the stock that keeps its own facets, so that only the tiles
+// touched by the tool need to be tessellated again
+struct cStockTile
+{
+	int x0, y0, x1, y1;  // pixel range [x0, x1) x [y0, y1)
+	bool dirty;
+	std::vector<MeshCore::MeshGeomFacet> facetsOuter;
+	std::vector<MeshCore::MeshGeomFacet> facetsInner;
+};
+
 class cStock
 {
 public:
-	cStock(float px, float py, float pz, float lx, float ly, float lz, float res);
+	// tileSize is rounded up to a power of two, a size <= 0 tessellates the stock as a single tile
+	cStock(float px, float py, float pz, float lx, float ly, float lz, float res, int tileSize = SIM_TILE_SIZE);
 	~cStock();
 	void Tessellate(Mesh::MeshObject & meshOuter, Mesh::MeshObject & meshInner);
     void CreatePocket(float x, float y, float rad, float height);
@@ -148,16 +160,30 @@ public:
     inline Point3D ToInner(Point3D & p) {
 		return Point3D((p.x - m_px) / m_res, (p.y - m_py) / m_res, p.z);
 	}
+	// number of pixels lowered so far, used to tell whether a move touched the stock
+	unsigned long GetCutCount() const { return m_cutCount; }
+	double GetRemovedVolume();
 
 private:
-	float FindRectTop(int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz);
-	void FindRectBot(int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz);
+	inline void CutAt(int x, int y, float z)
+	{
+		if (x < 0 || y < 0 || x >= m_x || y >= m_y || m_stock[x][y] <= z)
+			return;
+		if (m_stock[x][y] > m_pz)
+			m_cutCount++;
+		m_stock[x][y] = z;
+		SetDirty(x, y);
+	}
+	void SetDirty(int x, int y);
+	void TessellateTile(cStockTile & tile);
+	float FindRectTop(const cStockTile & tile, int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz);
+	void FindRectBot(const cStockTile & tile, int & xp, int & yp, int & x_size, int & y_size, bool scanHoriz);
 	void SetFacetPoints(MeshCore::MeshGeomFacet & facet, Point3D & p1, Point3D & p2, Point3D & p3);
 	void AddQuad(Point3D & p1, Point3D & p2, Point3D & p3, Point3D & p4, std::vector<MeshCore::MeshGeomFacet> & facets);
-	int TesselTop(int x, int y);
-	int TesselBot(int x, int y);
-	int TesselSidesX(int yp);
-	int TesselSidesY(int xp);
+	int TesselTop(cStockTile & tile, int x, int y);
+	int TesselBot(cStockTile & tile, int x, int y);
+	int TesselSidesX(cStockTile & tile, int yp);
+	int TesselSidesY(cStockTile & tile, int xp);
 	Array2D<float>  m_stock;
 	Array2D<char> m_attr;
 	float m_px, m_py, m_pz;  // stock zero position
@@ -165,8 +191,10 @@ private:
 	float m_res;        // resoulution
 	float m_plane;		// stock plane height
 	int m_x, m_y;            // stock array size
-	std::vector<MeshCore::MeshGeomFacet> facetsOuter;
-	std::vector<MeshCore::MeshGeomFacet> facetsInner;
+	int m_tx, m_ty;          // number of tiles
+	int m_tileShift, m_tileMask;
+	std::vector<cStockTile> m_tiles;
+	unsigned long m_cutCount;
 };
 
 class cVolSim
@@ -124,6 +124,43 @@ G0 Z0.500000
         p.setFromGCode(lines)
         self.assertEqual (p.toGCode(), output)
 
+    def test15(self):
+        """Test Path G-code parsing and editing of the commands"""
+
+        lines = '''
+(Profile)G21 G0 X1 Y2.5 Z-3
+G1 x4 a90 S12000 F100.5 (no space)G2 X0 Y0 I-2 J0 K1.5
+G20 G1 X1 Y-0.5 R0.1 K1 F10
+M6 T2 G21
+'''
+
+        p = Path.Path()
+        p.setFromGCode(lines)
+        self.assertEqual(p.Size, 7)
+        self.assertEqual(p.Commands[0].Name, '(Profile)')
+        self.assertEqual(p.Commands[2].Parameters, {'X': 4, 'A': 90, 'S': 12000, 'F': 100.5})
+        self.assertEqual(p.Commands[3].Name, '(no space)')
+        self.assertEqual(p.Commands[4].Parameters, {'X': 0, 'Y': 0, 'I': -2, 'J': 0, 'K': 1.5})
+        # inch values are converted to mm, except for K
+        self.assertEqual(p.Commands[5].Parameters, {'X': 25.4, 'Y': -12.7, 'R': 2.54, 'K': 1, 'F': 254})
+        self.assertEqual(p.Commands[6].Parameters, {'T': 2})
+        self.assertEqual(p.toGCode(), '(Profile)\nG0 X1.000000 Y2.500000 Z-3.000000\n'
+                'G1 A90.000000 F100.500000 S12000.000000 X4.000000\n(no space)\n'
+                'G2 I-2.000000 J0.000000 K1.500000 X0.000000 Y0.000000\n'
+                'G1 F254.000000 K1.000000 R2.540000 X25.400000 Y-12.700000\nM6 T2.000000\n')
+
+        # the commands are copied when a path is created from them
+        p2 = Path.Path(p.Commands)
+        self.assertEqual(p2.toGCode(), p.toGCode())
+
+        p.insertCommand(Path.Command('G1', {'X': 1, 'Q': 2}), 1)
+        p.deleteCommand(0)
+        p.deleteCommand()
+        self.assertEqual(p.Size, 6)
+        self.assertEqual(str(p.Commands[0]), 'Command G1 [ Q:2 X:1 ]')
+        self.assertEqual(p.Commands[-1].Name, 'G1')
+        self.assertRaises(IndexError, p.deleteCommand, 6)
+
     def test20(self):
         """Test Path Tool and ToolTable object core functionality"""
 
@@ -164,3 +201,219 @@ G0 Z0.500000
         path = Path.Path(commands)
 
         self.assertEqual(path.Length, 2)
+
+    def test60(self):
+        """Test Path.Area sections computed concurrently and from the cache"""
+        import math
+        import Part
+        solid = Part.makeBox(10, 10, 10).cut(Part.makeCylinder(2, 10, FreeCAD.Vector(5, 5, 0)))
+
+        def sections(shape, stepdown=2, threads=0):
+            area = Path.Area()
+            area.add(shape)
+            area.setParams(SectionCount=-1, Stepdown=stepdown, SectionThreads=threads)
+            return [area.getShape(i) for i in range(area.getSectionCount())]
+
+        Path.Area.clearSectionCache()
+        self.assertEqual(Path.Area.getSectionCacheInfo()[0], 0)
+
+        single = sections(solid, threads=1)
+        self.assertEqual(len(single), 6)
+        for shape in single:
+            self.assertRoughly(shape.Area, 100 - 4 * math.pi, 0.5)
+        (count, hits) = Path.Area.getSectionCacheInfo()
+        self.assertEqual(count, 6)
+
+        # a copy of the solid isn't found in the section cache
+        for threads in (0, 4):
+            self.assertEqual([s.BoundBox.ZMin for s in sections(solid.copy(), threads=threads)],
+                             [s.BoundBox.ZMin for s in single])
+        self.assertEqual(Path.Area.getSectionCacheInfo()[1], hits)
+
+        # every other section of the half step down comes from the cache,
+        # the slices of the deleted copies are dropped
+        half = sections(solid, stepdown=1)
+        self.assertEqual(len(half), 11)
+        self.assertEqual([s.BoundBox.ZMin for s in half[::2]],
+                         [s.BoundBox.ZMin for s in single])
+        self.assertEqual(Path.Area.getSectionCacheInfo(), (11, hits + 6))
+
+        # closing a document clears the cache
+        doc = FreeCAD.newDocument("SectionCache")
+        FreeCAD.closeDocument(doc.Name)
+        self.assertEqual(Path.Area.getSectionCacheInfo()[0], 0)
+
+    def test65(self):
+        """Test Path.Area offsets and pockets computed concurrently"""
+        import Part
+        holes = [Part.Wire(Part.makeCircle(1, FreeCAD.Vector(5 + 6 * i, 5 + 6 * j, 0)))
+                 for i in range(5) for j in range(3)]
+        face = Part.Face([Part.Wire(Part.makePolygon([FreeCAD.Vector(0, 0, 0), FreeCAD.Vector(34, 0, 0),
+                                                      FreeCAD.Vector(34, 22, 0), FreeCAD.Vector(0, 22, 0),
+                                                      FreeCAD.Vector(0, 0, 0)]))] + holes)
+
+        def results(threads):
+            area = Path.Area()
+            area.add(face)
+            area.setParams(Threads=threads)
+            offset = area.makeOffset(offset=-0.5, extra_pass=-1, stepover=0.5)
+            pocket = area.makePocket(mode=3, tool_radius=0.5)  # Spiral
+            return (len(offset.Wires), round(sum(w.Length for w in offset.Wires), 6),
+                    len(pocket.Wires), round(sum(w.Length for w in pocket.Wires), 6))
+
+        single = results(1)
+        self.assertTrue(single[0] > 16)
+        self.assertTrue(single[2] > 0)
+        for threads in (0, 4):
+            self.assertEqual(results(threads), single)
+
+    def test70(self):
+        """Test the drop cutter and waterline functions on meshes"""
+        import Mesh
+        box = Mesh.createBox(10, 10, 10)
+        tool = Path.Tool("flat", tooltype="EndMill", diameter=2)
+
+        points = Path.dropCutter(box, tool, [FreeCAD.Vector(0, 0, -10), FreeCAD.Vector(5.5, 0, -10),
+                                             FreeCAD.Vector(10, 0, -10)])
+        self.assertRoughly(points[0].z, 5)
+        self.assertRoughly(points[1].z, 5)
+        self.assertRoughly(points[2].z, -10)
+
+        # the ball touches the edge of the top face
+        top = Mesh.Mesh([FreeCAD.Vector(0, 0, 5), FreeCAD.Vector(10, 0, 5), FreeCAD.Vector(10, 10, 5),
+                         FreeCAD.Vector(0, 0, 5), FreeCAD.Vector(10, 10, 5), FreeCAD.Vector(0, 10, 5)])
+        ball = Path.Tool("ball", tooltype="BallEndMill", diameter=2)
+        points = Path.dropCutter(top, ball, [FreeCAD.Vector(10.5, 5, 0)])
+        self.assertRoughly(points[0].z, 5 - (1 - 0.75 ** 0.5), 0.001)
+
+        path = Path.waterline(box, tool, [0], 0.5, tolerance=0.001)
+        bb = path.BoundBox
+        for v in (bb.XMin, bb.YMin):
+            self.assertRoughly(v, -6, 0.01)
+        for v in (bb.XMax, bb.YMax):
+            self.assertRoughly(v, 6, 0.01)
+
+        path = Path.surfaceScan(box, tool, 2, 0.5, safe_height=10)
+        self.assertTrue(path.Size > 0)
+        self.assertRoughly(min(c.Parameters['Z'] for c in path.Commands if 'Z' in c.Parameters), 5)
+
+    def test80(self):
+        """Test the native post processing of paths"""
+        path = Path.Path([Path.Command('(begin)'),
+                          Path.Command('G0', {'Z': 5, 'F': 100}),
+                          Path.Command('G1', {'X': 1, 'Y': 2, 'Z': -0.0001, 'F': 10}),
+                          Path.Command('G1', {'X': 1, 'Y': 3, 'F': 10}),
+                          Path.Command('M6', {'T': 2})])
+
+        self.assertEqual(Path.post(path),
+                         "(begin)\nG0 Z5.000\nG1 F10.000 X1.000 Y2.000 Z0.000\nG1 F10.000 X1.000 Y3.000\nM6 T2.000\n")
+
+        gcode = Path.post(['G21', path], precision=2, word_precision={'T': 0}, feed_scale=60,
+                          words=['X', 'Y', 'Z', 'F', 'T'], modal_words=['X', 'Y', 'Z', 'F'], modal=True,
+                          comments=False, line_numbers=True, line_start=100, line_increment=5,
+                          templates={'M6': '{line}\nG43 H{T}'})
+        self.assertEqual(gcode, "N100 G21\nN105 G0 Z5.00\nN110 G1 X1.00 Y2.00 Z0.00 F600.00\nN115 Y3.00\n"
+                                "N120 M6 T2\nN125 G43 H2\n")
+
+        gcode = Path.post(path, precision=4, pad_zero=False, inches=True, comments=False)
+        self.assertEqual(gcode, "G0 Z0.1969\nG1 F0.3937 X0.0394 Y0.0787 Z0\nG1 F0.3937 X0.0394 Y0.1181\nM6 T2\n")
+
+        self.assertRaises(Exception, Path.post, path, templates={'M6': '{line'})
+
+        # None returns the output as string, otherwise it's written to the file
+        self.assertEqual(Path.post(path, None), Path.post(path))
+        self.assertEqual(Path.post(path, filename=None, comments=False), Path.post(path, comments=False))
+
+        import os
+        import tempfile
+        handle, filename = tempfile.mkstemp(suffix='.nc')
+        os.close(handle)
+        try:
+            self.assertEqual(Path.post(path, filename), None)
+            with open(filename) as f:
+                self.assertEqual(f.read(), Path.post(path))
+        finally:
+            os.remove(filename)
+
+    def test90(self):
+        """Test the cached length, cycle time and extent of paths"""
+        import math
+        path = Path.Path([Path.Command('G0', {'Z': 5}),
+                          Path.Command('G1', {'X': 10}),
+                          Path.Command('G2', {'X': 20, 'I': 5, 'J': 0})])
+        self.assertRoughly(path.Length, 15 + 5 * math.pi)
+        self.assertRoughly(path.getCycleTime(10, 1, 100, 50), 0.1 + 1 + math.pi / 2)
+        self.assertRoughly(path.BoundBox.XMax, 20)
+        self.assertRoughly(path.BoundBox.YMax, 5, 0.01)
+
+        (index, pos) = path.getPositionAt(0.05, 10, 1, 100, 50)
+        self.assertEqual(index, 0)
+        self.assertCoincide(pos, FreeCAD.Vector(0, 0, 2.5))
+        (index, pos) = path.getPositionAt(0.6, 10, 1, 100, 50)
+        self.assertEqual(index, 1)
+        self.assertCoincide(pos, FreeCAD.Vector(5, 0, 5))
+        (index, pos) = path.getPositionAt(1.1 + math.pi / 4, 10, 1, 100, 50)
+        self.assertEqual(index, 2)
+        self.assertCoincide(pos, FreeCAD.Vector(15, 5, 5))
+        self.assertEqual(path.getCommandsInBox(FreeCAD.BoundBox(4, -1, 4, 6, 1, 6)), [1])
+        self.assertEqual(path.getCommandsInBox(FreeCAD.BoundBox(12, 1, 4, 13, 6, 6)), [2])
+
+        # a copy keeps its values when the original changes
+        copy = path.copy()
+        path.deleteCommand(0)
+        self.assertRoughly(path.Length, 10 + 5 * math.pi)
+        self.assertRoughly(copy.Length, 15 + 5 * math.pi)
+
+        # enough commands for several levels of boxes
+        path = Path.Path([Path.Command('G1', {'X': i + 1, 'Y': (i + 1) % 2}) for i in range(1000)])
+        self.assertRoughly(path.Length, 1000 * math.sqrt(2))
+        self.assertEqual(path.getCommandsInBox(FreeCAD.BoundBox(600.2, -1, -1, 600.3, 2, 1)), [600])
+        path.insertCommand(Path.Command('G1', {'X': 500, 'Y': 10}), 500)
+        self.assertRoughly(path.Length, 999 * math.sqrt(2) + 10 + math.sqrt(82))
+        self.assertEqual(path.getCommandsInBox(FreeCAD.BoundBox(600.2, -1, -1, 600.3, 2, 1)), [601])
+        path.addCommand(Path.Command('G1', {'X': 1000, 'Y': 10}))
+        self.assertRoughly(path.BoundBox.YMax, 10)
+        self.assertEqual(path.getCommandsInBox(FreeCAD.BoundBox(999, 5, -1, 1001, 11, 1)), [1001])
+
+    def test95(self):
+        """Test the optimization of the moves of paths"""
+        import math
+        commands = [Path.Command('G0', {'X': 10, 'Y': 0, 'Z': 5}),
+                    Path.Command('G0', {'Z': 5}),
+                    Path.Command('G1', {'Z': -1, 'F': 100})]
+        # a half circle and a line back to its start
+        commands += [Path.Command('G1', {'X': 10 * math.cos(math.pi * i / 100),
+                                         'Y': 10 * math.sin(math.pi * i / 100)}) for i in range(1, 101)]
+        commands += [Path.Command('G1', {'X': -10 + i * 0.5, 'Y': 0}) for i in range(1, 41)]
+        commands.append(Path.Command('G0', {'Z': 5}))
+        path = Path.Path(commands)
+        length = path.Length
+
+        path.optimize(lines=False, arcs=False, rapids=False)
+        self.assertEqual(path.Size, 144)
+
+        path.optimize(tolerance=0.01)
+        self.assertEqual([c.Name for c in path.Commands], ['G0', 'G1', 'G3', 'G1', 'G0'])
+        arc = path.Commands[2]
+        self.assertRoughly(arc.Parameters['X'], -10)
+        self.assertRoughly(arc.Parameters['Y'], 0)
+        self.assertRoughly(arc.Parameters['I'], -10)
+        self.assertRoughly(arc.Parameters['J'], 0)
+        self.assertEqual(path.Commands[3].Parameters, {'X': 10, 'Y': 0})
+        self.assertRoughly(path.Length, length, 0.01)
+
+        # Area.toPath() starts with separate rapid moves along Z and in XY
+        path = Path.Path([Path.Command('G0', {'Z': 5}), Path.Command('G0', {'X': 10, 'Y': 0})] + commands[1:])
+        self.assertEqual(path.Size, 145)
+        path.optimize(tolerance=0.01)
+        self.assertEqual([c.Name for c in path.Commands], ['G0', 'G0', 'G1', 'G3', 'G1', 'G0'])
+
+        import Part
+        points = [FreeCAD.Vector(10 * math.cos(math.pi * i / 50), 10 * math.sin(math.pi * i / 50), 0)
+                  for i in range(100)]
+        wire = Part.makePolygon(points + points[:1])
+        plain = Path.fromShapes(wire)
+        fitted = Path.fromShapes(wire, fit_tolerance=0.01)
+        self.assertTrue(plain.Size > 100)
+        self.assertTrue(fitted.Size < 15)
+        self.assertTrue(any(c.Name in ('G2', 'G3') for c in fitted.Commands))
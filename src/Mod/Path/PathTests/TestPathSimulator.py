@@ -0,0 +1,98 @@
+# -*- coding: utf-8 -*-
+# ***************************************************************************
+# *   Copyright (c) 2021 FreeCAD Developers                                 *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   This program is distributed in the hope that it will be useful,       *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with this program; if not, write to the Free Software   *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************
+
+import FreeCAD
+import Part
+import Path
+import PathSimulator
+import math
+
+from FreeCAD import Vector
+from PathTests.PathTestUtils import PathTestBase
+
+
+class TestPathSimulator(PathTestBase):
+    """Unit tests for the volume simulation of PathSimulator."""
+
+    def setUp(self):
+        # a 20 x 20 x 10 stock with a resolution of 0.1 has 4 x 4 tiles of 64 pixels
+        self.stock = Part.makeBox(20, 20, 10)
+        self.tool = Part.makeCylinder(2, 10)
+        self.start = FreeCAD.Placement(Vector(0, 0, 15), FreeCAD.Rotation())
+
+        # a slot 2 deep from X5 to X15, which crosses two tile borders
+        self.pocket = Path.Path([Path.Command('G0', {'X': 5, 'Y': 10, 'Z': 15}),
+                                 Path.Command('G1', {'Z': 8}),
+                                 Path.Command('G1', {'X': 15}),
+                                 Path.Command('G0', {'Z': 15})])
+        # the second rapid move plunges 1 into the stock
+        self.gouge = Path.Path([Path.Command('G0', {'X': 10, 'Y': 3}),
+                                Path.Command('G0', {'Z': 9}),
+                                Path.Command('G0', {'Z': 15})])
+
+    def createSimulator(self, tileSize=64):
+        sim = PathSimulator.PathSim()
+        sim.BeginSimulation(self.stock, 0.1, tileSize)
+        sim.SetToolShape(self.tool, 0.05)
+        return sim
+
+    def meshStats(self, sim):
+        (outer, inner) = sim.GetResultMesh()
+        mesh = outer.copy()
+        mesh.addMesh(inner)
+        return (mesh.Area, mesh.Volume)
+
+    def test00(self):
+        """Verify the removed volume of a pocket."""
+        sim = self.createSimulator()
+        (pos, volume, gouges) = sim.SimulatePath(self.pocket, self.start)
+        self.assertCoincide(pos.Base, Vector(15, 10, 15))
+        # the slot is a few pixels wider than the tool
+        self.assertRoughly(volume, 10 * 4 * 2 + math.pi * 2 * 2 * 2, 5)
+        self.assertEqual(gouges, [])
+
+    def test10(self):
+        """Verify that rapid moves into the stock are reported as gouges."""
+        sim = self.createSimulator()
+        (pos, volume, gouges) = sim.SimulatePath(self.pocket, self.start)
+        (pos, total, gouges) = sim.SimulatePath(self.gouge, pos)
+        self.assertCoincide(pos.Base, Vector(10, 3, 15))
+        self.assertEqual(gouges, [1])
+        self.assertRoughly(total - volume, math.pi * 2 * 2 * 1, 1)
+
+    def test20(self):
+        """Verify that tiled and single tile tessellation give the same mesh."""
+        tiled = self.createSimulator()
+        # tessellate in between, so that only the cut tiles are rebuilt later on
+        tiled.GetResultMesh()
+        (pos, volume, gouges) = tiled.SimulatePath(self.pocket, self.start)
+        tiled.GetResultMesh()
+        tiled.SimulatePath(self.gouge, pos)
+        (area, volume) = self.meshStats(tiled)
+
+        single = self.createSimulator(0)
+        (pos, _, _) = single.SimulatePath(self.pocket, self.start)
+        single.SimulatePath(self.gouge, pos)
+        (singleArea, singleVolume) = self.meshStats(single)
+
+        self.assertRoughly(area, singleArea, 0.001)
+        self.assertRoughly(volume, singleVolume, 0.001)
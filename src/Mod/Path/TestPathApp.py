@@ -39,6 +39,7 @@ from PathTests.TestPathToolBit  import TestPathToolBit
 from PathTests.TestPathTooltable import TestPathTooltable
 from PathTests.TestPathToolController import TestPathToolController
 from PathTests.TestPathSetupSheet import TestPathSetupSheet
+from PathTests.TestPathSimulator import TestPathSimulator
 from PathTests.TestPathDeburr  import TestPathDeburr
 from PathTests.TestPathHelix  import TestPathHelix
 from PathTests.TestPathVoronoi  import TestPathVoronoi
@@ -60,6 +61,7 @@ False if TestPathTool.__name__ else True
 False if TestPathTooltable.__name__ else True
 False if TestPathToolController.__name__ else True
 False if TestPathSetupSheet.__name__ else True
+False if TestPathSimulator.__name__ else True
 False if TestPathDeburr.__name__ else True
 False if TestPathHelix.__name__ else True
 False if TestPathPreferences.__name__ else True
@@ -26,6 +26,10 @@
 #include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <random>
 
 namespace ClipperLib
 {
@@ -1114,7 +1118,7 @@ class Interpolation
 
 	double getRandomAngle()
 	{
-		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(rand()) / double(RAND_MAX);
+		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(random() - random.min()) / double(random.max() - random.min());
 	}
 	size_t getPointCount()
 	{
@@ -1124,6 +1128,8 @@ class Interpolation
   private:
 	vector<double> angles;
 	vector<double> areas;
+	// own generator per instance, rand() would make the result depend on the order the regions are processed
+	minstd_rand random;
 };
 
 //***************************************
@@ -1687,7 +1693,6 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 		scaleFactor = maxScaleFactor;
 	//scaleFactor = round(scaleFactor);
 
-	current_region=0;
 	cout << "Tool Diameter: " << toolDiameter << endl;
 	cout << "Accuracy: " << round(10000.0/scaleFactor)/10 << " um" << endl;
 	cout << flush;
@@ -1695,7 +1700,6 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	toolRadiusScaled = long(toolDiameter * scaleFactor / 2);
 	stepOverScaled = toolRadiusScaled * stepOverFactor;
 	progressCallback = &progressCallbackFn;
-	lastProgressTime = clock();
 	stopProcessing = false;
 
 	if(helixRampDiameter<NTOL)
@@ -1778,6 +1782,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	//	Resolve hierarchy and run processing
 	//***************************************
 	double cornerRoundingOffset = 0.15 * toolRadiusScaled / 2;
+	std::vector<RegionTask> tasks;
 	if (opType == OperationType::otClearingInside || opType == OperationType::otClearingOutside)
 	{
 
@@ -1830,7 +1835,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 				clipof.Clear();
 				clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 				clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
-				ProcessPolyNode(boundPaths, toolBoundPaths);
+				tasks.push_back(RegionTask{boundPaths, toolBoundPaths});
 			}
 		}
 	}
@@ -1889,14 +1894,101 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 					clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 					clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
 
-					ProcessPolyNode(boundPaths, toolBoundPaths);
+					tasks.push_back(RegionTask{boundPaths, toolBoundPaths});
 				}
 			}
 		}
 	}
+
+	ProcessRegions(tasks);
 	return results;
 }
 
+//********************************************
+// Adaptive2d - region processing
+//********************************************
+
+void Adaptive2d::ProcessRegions(const std::vector<RegionTask> &tasks)
+{
+	// the regions don't depend on each other, each one has its own cleared area and output
+	std::vector<AdaptiveOutput> outputs(tasks.size());
+	std::vector<char> valid(tasks.size(), 0);
+	std::atomic<size_t> nextTask(0);
+	auto worker = [&]() {
+		for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+		{
+			if (stopProcessing)
+				break;
+			try
+			{
+				valid[i] = ProcessPolyNode(i + 1, tasks[i].boundPaths, tasks[i].toolBoundPaths, outputs[i]);
+			}
+			catch (...)
+			{
+				stopProcessing = true;
+				throw;
+			}
+		}
+	};
+
+	size_t numThreads = 1;
+#ifndef DEV_MODE // perf counters and debug drawing are not thread-safe
+	numThreads = std::min<size_t>(tasks.size(), std::max(1u, std::thread::hardware_concurrency()));
+#endif
+
+	callerThread = std::this_thread::get_id();
+	pendingProgress.clear();
+	std::vector<std::future<void>> futures;
+	for (size_t t = 1; t < numThreads; t++)
+		futures.push_back(std::async(std::launch::async, worker));
+
+	// the calling thread processes regions as well and reports the progress of all of them
+	std::exception_ptr error;
+	try
+	{
+		worker();
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+	for (auto &future : futures)
+	{
+		while (future.wait_for(std::chrono::milliseconds(1000 * PROGRESS_TICKS / CLOCKS_PER_SEC)) != std::future_status::ready)
+		{
+			try
+			{
+				ReportProgress();
+			}
+			catch (...)
+			{
+				stopProcessing = true;
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+		try
+		{
+			future.get();
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+	ReportProgress();
+
+	// keep the order of the regions
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		if (valid[i])
+			results.push_back(outputs[i]);
+	}
+}
+
 bool Adaptive2d::FindEntryPoint(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &boundPaths,
 								ClearedArea &clearedArea /*output-initial cleared area by helix*/,
 								IntPoint &entryPoint /*output*/,
@@ -2549,16 +2641,20 @@ void Adaptive2d::AppendToolPath(TPaths &progressPaths, AdaptiveOutput &output,
 	Perf_AppendToolPath.Stop();
 }
 
-void Adaptive2d::CheckReportProgress(TPaths &progressPaths, bool force)
+void Adaptive2d::CheckReportProgress(TPaths &progressPaths, clock_t &lastProgressTime, bool force)
 {
 	if (!force && (clock() - lastProgressTime < PROGRESS_TICKS))
 		return; // not yet
 	lastProgressTime = clock();
 	if (progressPaths.size() == 0)
 		return;
-	if (progressCallback)
-		if ((*progressCallback)(progressPaths))
-			stopProcessing = true; // call python function, if returns true signal stop processing
+	{
+		std::lock_guard<std::mutex> lock(progressMutex);
+		pendingProgress.insert(pendingProgress.end(), progressPaths.begin(), progressPaths.end());
+	}
+	// other threads leave the reporting to the calling thread
+	if (std::this_thread::get_id() == callerThread)
+		ReportProgress();
 	// clean the paths - keep the last point
 	if (progressPaths.back().second.size() == 0)
 		return;
@@ -2573,6 +2669,20 @@ void Adaptive2d::CheckReportProgress(TPaths &progressPaths, bool force)
 	progressPaths.front().second.push_back(next);
 }
 
+void Adaptive2d::ReportProgress()
+{
+	TPaths progressPaths;
+	{
+		std::lock_guard<std::mutex> lock(progressMutex);
+		progressPaths.swap(pendingProgress);
+	}
+	if (progressPaths.size() == 0)
+		return;
+	if (progressCallback)
+		if ((*progressCallback)(progressPaths))
+			stopProcessing = true; // call python function, if returns true signal stop processing
+}
+
 void Adaptive2d::AddPathsToProgress(TPaths &progressPaths, Paths paths, MotionType mt)
 {
 	for (const auto &pth : paths)
@@ -2599,11 +2709,11 @@ void Adaptive2d::AddPathToProgress(TPaths &progressPaths, const Path pth, Motion
 	}
 }
 
-void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
+bool Adaptive2d::ProcessPolyNode(size_t region, Paths boundPaths, Paths toolBoundPaths, AdaptiveOutput &output)
 {
 	Perf_ProcessPolyNode.Start();
-	current_region++;
-	cout << "** Processing region: " << current_region << endl;
+	cout << "** Processing region: " << region << endl;
+	clock_t lastProgressTime = clock();
 
 	// node paths are already constrained to tool boundary path for adaptive path before finishing pass
 	Clipper clip;
@@ -2648,7 +2758,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		if (!FindEntryPoint(progressPaths, toolBoundPaths, boundPaths, cleared, entryPoint, toolPos, toolDir))
 		{
 			Perf_ProcessPolyNode.Stop();
-			return;
+			return false;
 		}
 	}
 
@@ -2665,7 +2775,6 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 
 	//cout << "Entry point:" << double(entryPoint.X)/scaleFactor << "," << double(entryPoint.Y)/scaleFactor << endl;
 
-	AdaptiveOutput output;
 	output.HelixCenterPoint.first = double(entryPoint.X) / scaleFactor;
 	output.HelixCenterPoint.second = double(entryPoint.Y) / scaleFactor;
 
@@ -2675,7 +2784,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	IntPoint newToolPos;
 	DoublePoint newToolDir;
 
-	CheckReportProgress(progressPaths, true);
+	CheckReportProgress(progressPaths, lastProgressTime, true);
 
 	IntPoint startPoint = toolPos;
 	output.StartPoint = DPoint(double(startPoint.X) / scaleFactor, double(startPoint.Y) / scaleFactor);
@@ -2929,7 +3038,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 				// append gyro
 				gyro.push_back(newToolDir);
 				gyro.erase(gyro.begin());
-				CheckReportProgress(progressPaths);
+				CheckReportProgress(progressPaths, lastProgressTime);
 			}
 			else
 			{
@@ -2956,7 +3065,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 			CleanPath(passToolPath, cleaned, CLEAN_PATH_TOLERANCE);
 			total_output_points += long(cleaned.size());
 			AppendToolPath(progressPaths, output, cleaned, clearedBeforePass, cleared, toolBoundPaths);
-			CheckReportProgress(progressPaths);
+			CheckReportProgress(progressPaths, lastProgressTime);
 			bad_engage_count = 0;
 			engage.ResetPasses();
 		}
@@ -3113,7 +3222,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		Perf_IsAllowedToCutTrough.DumpResults();
 		Perf_IsClearPath.DumpResults();
 #endif
-		CheckReportProgress(progressPaths, true);
+		CheckReportProgress(progressPaths, lastProgressTime, true);
 #ifdef DEV_MODE
 		double duration = ((double) (clock() - start_clock)) / CLOCKS_PER_SEC;
 		cout << "PolyNode perf:" << perf_total_len / double(scaleFactor) / duration << " mm/sec"
@@ -3131,7 +3240,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 				<< "Hint: try to modify accuracy and/or step-over." << endl;
 		}
 	}
-	results.push_back(output);
+	return true;
 }
 
 } // namespace AdaptivePath
@@ -21,6 +21,10 @@
 ***************************************************************************/
 
 #include "clipper.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <list>
 #include <time.h>
@@ -81,7 +85,7 @@ struct AdaptiveOutput
 	int ReturnMotionType; // MotionType enum, problem with serialization if enum is used
 };
 
-// used to isolate state -> enable potential adding of multi-threaded processing of separate regions
+// used to isolate state -> separate regions are processed by multiple threads
 
 class Adaptive2d
 {
@@ -118,14 +122,24 @@ class Adaptive2d
 	long helixRampRadiusScaled = 0;
 	double referenceCutArea = 0;
 	double optimalCutAreaPD = 0;
-	bool stopProcessing = false;
-	int current_region=0;
-	clock_t lastProgressTime = 0;
+	std::atomic<bool> stopProcessing{false};
 
 	std::function<bool(TPaths)> *progressCallback = NULL;
 	Path toolGeometry; // tool geometry at coord 0,0, should not be modified
 
-	void ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths);
+	// progress of all regions, reported by the calling thread only (the callback calls into python)
+	std::mutex progressMutex;
+	TPaths pendingProgress;
+	std::thread::id callerThread;
+
+	struct RegionTask
+	{
+		Paths boundPaths;
+		Paths toolBoundPaths;
+	};
+
+	void ProcessRegions(const std::vector<RegionTask> &tasks);
+	bool ProcessPolyNode(size_t region, Paths boundPaths, Paths toolBoundPaths, AdaptiveOutput &output /*output*/);
 	bool FindEntryPoint(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
 						IntPoint &entryPoint /*output*/, IntPoint &toolPos, DoublePoint &toolDir);
 	bool FindEntryPointOutside(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
@@ -142,7 +156,8 @@ class Adaptive2d
 
 	friend class EngagePoint; // for CalcCutArea
 
-	void CheckReportProgress(TPaths &progressPaths, bool force = false);
+	void CheckReportProgress(TPaths &progressPaths, clock_t &lastProgressTime, bool force = false);
+	void ReportProgress();
 	void AddPathsToProgress(TPaths &progressPaths, const Paths paths, MotionType mt = MotionType::mtCutting);
 	void AddPathToProgress(TPaths &progressPaths, const Path pth, MotionType mt = MotionType::mtCutting);
 	void ApplyStockToLeave(Paths &inputPaths);
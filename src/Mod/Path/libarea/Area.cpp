@@ -6,7 +6,12 @@
 #include "Area.h"
 #include "AreaOrderer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
 #include <map>
+#include <thread>
 
 double CArea::m_accuracy = 0.01;
 double CArea::m_units = 1.0;
@@ -15,13 +20,14 @@ double CArea::m_clipper_clean_distance = 0.0;
 bool CArea::m_fit_arcs = true;
 int CArea::m_min_arc_points = 4;
 int CArea::m_max_arc_points = 100;
-double CArea::m_single_area_processing_length = 0.0;
-double CArea::m_processing_done = 0.0;
+thread_local double CArea::m_single_area_processing_length = 0.0;
+thread_local double CArea::m_processing_done = 0.0;
 bool CArea::m_please_abort = false;
-double CArea::m_MakeOffsets_increment = 0.0;
-double CArea::m_split_processing_length = 0.0;
-bool CArea::m_set_processing_length_in_split = false;
-double CArea::m_after_MakeOffsets_length = 0.0;
+thread_local double CArea::m_MakeOffsets_increment = 0.0;
+thread_local double CArea::m_split_processing_length = 0.0;
+thread_local bool CArea::m_set_processing_length_in_split = false;
+thread_local double CArea::m_after_MakeOffsets_length = 0.0;
+int CArea::m_max_threads = 0;
 //static const double PI = 3.1415926535897932;
 
 #define _CAREA_PARAM_DEFINE(_class,_type,_name) \
@@ -41,6 +47,77 @@ CAREA_PARAM_DEFINE(double,units)
 CAREA_PARAM_DEFINE(short,min_arc_points)
 CAREA_PARAM_DEFINE(short,max_arc_points)
 CAREA_PARAM_DEFINE(double,clipper_scale)
+CAREA_PARAM_DEFINE(short,max_threads)
+
+// set while a thread works for RunParallel, nested calls don't start more threads
+static thread_local bool running_in_parallel = false;
+
+// static
+void CArea::RunParallel(std::size_t count, const std::function<void(std::size_t)> &func)
+{
+	std::size_t numThreads = 1;
+	if(!running_in_parallel)
+	{
+		if(m_max_threads > 0)
+			numThreads = m_max_threads;
+		else
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		numThreads = std::min(numThreads, count);
+	}
+	if(numThreads <= 1)
+	{
+		for(std::size_t i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+
+	std::atomic<std::size_t> next(0);
+	std::atomic<bool> failed(false);
+	auto worker = [&]() {
+		running_in_parallel = true;
+		try
+		{
+			for(std::size_t i = next++; i < count && !failed; i = next++)
+				func(i);
+		}
+		catch(...)
+		{
+			running_in_parallel = false;
+			failed = true;
+			throw;
+		}
+		running_in_parallel = false;
+	};
+
+	std::vector<std::future<void> > futures;
+	for(std::size_t t = 1; t < numThreads; t++)
+		futures.push_back(std::async(std::launch::async, worker));
+
+	// the calling thread takes its share, exceptions are passed on after all threads finished
+	std::exception_ptr error;
+	try
+	{
+		worker();
+	}
+	catch(...)
+	{
+		error = std::current_exception();
+	}
+	for(std::future<void> &future : futures)
+	{
+		try
+		{
+			future.get();
+		}
+		catch(...)
+		{
+			if(!error)
+				error = std::current_exception();
+		}
+	}
+	if(error)
+		std::rethrow_exception(error);
+}
 
 void CArea::append(const CCurve& curve)
 {
@@ -192,15 +269,16 @@ public:
 	ZigZag(const CCurve& Zig, const CCurve& Zag):zig(Zig), zag(Zag){}
 };
 
-static double stepover_for_pocket = 0.0;
-static std::list<ZigZag> zigzag_list_for_zigs;
-static std::list<CCurve> *curve_list_for_zigs = NULL;
-static bool rightward_for_zigs = true;
-static double sin_angle_for_zigs = 0.0;
-static double cos_angle_for_zigs = 0.0;
-static double sin_minus_angle_for_zigs = 0.0;
-static double cos_minus_angle_for_zigs = 0.0;
-static double one_over_units = 0.0;
+// the state of the zig zag pocketing, per thread because areas are pocketed in parallel
+static thread_local double stepover_for_pocket = 0.0;
+static thread_local std::list<ZigZag> zigzag_list_for_zigs;
+static thread_local std::list<CCurve> *curve_list_for_zigs = NULL;
+static thread_local bool rightward_for_zigs = true;
+static thread_local double sin_angle_for_zigs = 0.0;
+static thread_local double cos_angle_for_zigs = 0.0;
+static thread_local double sin_minus_angle_for_zigs = 0.0;
+static thread_local double cos_minus_angle_for_zigs = 0.0;
+static thread_local double one_over_units = 0.0;
 
 static Point rotated_point(const Point &p)
 {
@@ -404,7 +482,7 @@ void make_zig(const CArea &a, double y0, double y)
 	}
 }
         
-std::list< std::list<ZigZag> > reorder_zig_list_list;
+static thread_local std::list< std::list<ZigZag> > reorder_zig_list_list;
         
 void add_reorder_zig(ZigZag &zigzag)
 {
@@ -552,6 +630,34 @@ static void zigzag(const CArea &input_a)
 	CArea::m_processing_done += 0.2 * CArea::m_single_area_processing_length;
 }
 
+// The separate areas don't depend on each other. Their curves are appended in the
+// order of the areas, and the progress of all threads is added to the calling thread.
+static void MakePocketsInParallel(const std::list<CArea> &areas, std::list<CCurve> &curve_list, double single_area_length,
+	const std::function<void(const CArea&, std::list<CCurve>&)> &func)
+{
+	std::vector<const CArea*> items;
+	for(std::list<CArea>::const_iterator It = areas.begin(); It != areas.end(); It++)
+		items.push_back(&(*It));
+
+	std::vector< std::list<CCurve> > curves(items.size());
+	std::vector<double> progress(items.size(), 0.0);
+	double processing_done = CArea::m_processing_done;
+	CArea::RunParallel(items.size(), [&](std::size_t i) {
+		CArea::m_single_area_processing_length = single_area_length;
+		double before = CArea::m_processing_done;
+		func(*items[i], curves[i]);
+		progress[i] = CArea::m_processing_done - before;
+	});
+
+	CArea::m_processing_done = processing_done;
+	CArea::m_single_area_processing_length = single_area_length;
+	for(std::size_t i = 0; i < items.size(); i++)
+	{
+		CArea::m_processing_done += progress[i];
+		curve_list.splice(curve_list.end(), curves[i]);
+	}
+}
+
 void CArea::SplitAndMakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const
 {
 	CArea::m_processing_done = 0.0;
@@ -570,12 +676,10 @@ void CArea::SplitAndMakePocketToolpath(std::list<CCurve> &curve_list, const CAre
 
 	double single_area_length = 50.0 / areas.size();
 
-	for(std::list<CArea>::iterator It = areas.begin(); It != areas.end(); It++)
-	{
-		CArea::m_single_area_processing_length = single_area_length;
-		CArea &ar = *It;
-		ar.MakePocketToolpath(curve_list, params);
-	}
+	MakePocketsInParallel(areas, curve_list, single_area_length,
+		[&params](const CArea &ar, std::list<CCurve> &curves) {
+			ar.MakePocketToolpath(curves, params);
+		});
 }
 
 void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const
@@ -608,13 +712,10 @@ void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketP
 			return;
 		}
 
-		CArea::m_single_area_processing_length /= m_areas.size();
-
-		for(std::list<CArea>::iterator It = m_areas.begin(); It != m_areas.end(); It++)
-		{
-			CArea &a2 = *It;
-			a2.MakeOnePocketCurve(curve_list, params);
-		}
+		MakePocketsInParallel(m_areas, curve_list, CArea::m_single_area_processing_length / m_areas.size(),
+			[&params](const CArea &a2, std::list<CCurve> &curves) {
+				a2.MakeOnePocketCurve(curves, params);
+			});
 	}
 
 	if(params.mode == SingleOffsetPocketMode || params.mode == ZigZagThenSingleOffsetPocketMode)
@@ -6,6 +6,9 @@
 #ifndef AREA_HEADER
 #define AREA_HEADER
 
+#include <functional>
+#include <vector>
+
 #include "Curve.h"
 #include "clipper.hpp"
 
@@ -49,14 +52,16 @@ public:
 	static bool m_fit_arcs;
     static int m_min_arc_points;
     static int m_max_arc_points;
-	static double m_processing_done; // 0.0 to 100.0, set inside MakeOnePocketCurve
-	static double m_single_area_processing_length;
-	static double m_after_MakeOffsets_length;
-	static double m_MakeOffsets_increment;
-	static double m_split_processing_length;
-	static bool m_set_processing_length_in_split;
+	// the progress is kept per thread, because separate areas are pocketed in parallel
+	static thread_local double m_processing_done; // 0.0 to 100.0, set inside MakeOnePocketCurve
+	static thread_local double m_single_area_processing_length;
+	static thread_local double m_after_MakeOffsets_length;
+	static thread_local double m_MakeOffsets_increment;
+	static thread_local double m_split_processing_length;
+	static thread_local bool m_set_processing_length_in_split;
 	static bool m_please_abort; // the user sets this from another thread, to tell MakeOnePocketCurve to finish with no result.
     static double m_clipper_scale;
+    static int m_max_threads; // the number of threads for offsets and pockets, 0 for one per core
 
 	void append(const CCurve& curve);
 	void move(CCurve&& curve);
@@ -71,6 +76,13 @@ public:
                             ClipperLib::EndType endType=ClipperLib::etOpenRound,
                             double miterLimit = 5.0, 
                             double roundPrecision = 0.0);
+    // offsets a copy of the area by each value, the input is converted to clipper paths only once
+    void OffsetWithClipper(const std::vector<double> &offsets,
+                            std::vector<CArea> &areas,
+                            ClipperLib::JoinType joinType=ClipperLib::jtRound,
+                            ClipperLib::EndType endType=ClipperLib::etOpenRound,
+                            double miterLimit = 5.0,
+                            double roundPrecision = 0.0) const;
 	void Thicken(double value);
 	void FitArcs();
 	unsigned int num_curves(){return static_cast<int>(m_curves.size());}
@@ -103,6 +115,10 @@ public:
     CAREA_PARAM_DECLARE(short,min_arc_points)
     CAREA_PARAM_DECLARE(short,max_arc_points)
     CAREA_PARAM_DECLARE(double,clipper_scale)
+    CAREA_PARAM_DECLARE(short,max_threads)
+
+    // calls func(0) ... func(count-1) on up to m_max_threads threads, the calling thread included
+    static void RunParallel(std::size_t count, const std::function<void(std::size_t)> &func);
 
     // Following functions is add to operate on possible open curves
 	void PopulateClipper(ClipperLib::Clipper &c, ClipperLib::PolyType type) const;
@@ -24,18 +24,19 @@ public:
 	IntPoint int_point(){return IntPoint((long64)(X * CArea::m_clipper_scale), (long64)(Y * CArea::m_clipper_scale));}
 };
 
-static std::list<DoubleAreaPoint> pts_for_AddVertex;
+// per thread, because offsets and pockets run in parallel
+static thread_local std::list<DoubleAreaPoint> pts_for_AddVertex;
 
 static void AddPoint(const DoubleAreaPoint& p)
 {
 	pts_for_AddVertex.push_back(p);
 }
 
-static void AddVertex(const CVertex& vertex, const CVertex* prev_vertex)
+static void AddVertex(const CVertex& vertex, const CVertex* prev_vertex, double units = CArea::m_units)
 {
 	if(vertex.m_type == 0 || prev_vertex == NULL)
 	{
-		AddPoint(DoubleAreaPoint(vertex.m_p.x * CArea::m_units, vertex.m_p.y * CArea::m_units));
+		AddPoint(DoubleAreaPoint(vertex.m_p.x * units, vertex.m_p.y * units));
 	}
 	else
 	{
@@ -46,13 +47,13 @@ static void AddVertex(const CVertex& vertex, const CVertex* prev_vertex)
 		int i;
 		double ang1,ang2,phit;
 
-		dx = (prev_vertex->m_p.x - vertex.m_c.x) * CArea::m_units;
-		dy = (prev_vertex->m_p.y - vertex.m_c.y) * CArea::m_units;
+		dx = (prev_vertex->m_p.x - vertex.m_c.x) * units;
+		dy = (prev_vertex->m_p.y - vertex.m_c.y) * units;
 
 		ang1=atan2(dy,dx);
 		if (ang1<0) ang1+=2.0*PI;
-		dx = (vertex.m_p.x - vertex.m_c.x) * CArea::m_units;
-		dy = (vertex.m_p.y - vertex.m_c.y) * CArea::m_units;
+		dx = (vertex.m_p.x - vertex.m_c.x) * units;
+		dy = (vertex.m_p.y - vertex.m_c.y) * units;
 		ang2=atan2(dy,dx);
 		if (ang2<0) ang2+=2.0*PI;
 
@@ -88,17 +89,17 @@ static void AddVertex(const CVertex& vertex, const CVertex* prev_vertex)
 
 		dphi=phit/(Segments);
 
-		double px = prev_vertex->m_p.x * CArea::m_units;
-		double py = prev_vertex->m_p.y * CArea::m_units;
+		double px = prev_vertex->m_p.x * units;
+		double py = prev_vertex->m_p.y * units;
 
 		for (i=1; i<=Segments; i++)
 		{
-			dx = px - vertex.m_c.x * CArea::m_units;
-			dy = py - vertex.m_c.y * CArea::m_units;
+			dx = px - vertex.m_c.x * units;
+			dy = py - vertex.m_c.y * units;
 			phi=atan2(dy,dx);
 
-			double nx = vertex.m_c.x * CArea::m_units + radius * cos(phi-dphi);
-			double ny = vertex.m_c.y * CArea::m_units + radius * sin(phi-dphi);
+			double nx = vertex.m_c.x * units + radius * cos(phi-dphi);
+			double ny = vertex.m_c.y * units + radius * sin(phi-dphi);
 
 			AddPoint(DoubleAreaPoint(nx, ny));
 
@@ -127,13 +128,9 @@ static void MakeLoop(const DoubleAreaPoint &pt0, const DoubleAreaPoint &pt1, con
 	CVertex v1(arc_dir, p1 + right1 * radius, p1);
 	CVertex v2(0, p2 + right1 * radius, Point(0, 0));
 
-	double save_units = CArea::m_units;
-	CArea::m_units = 1.0;
-
-	AddVertex(v1, &v0);
-	AddVertex(v2, &v1);
-
-	CArea::m_units = save_units;
+	// the points are scaled already
+	AddVertex(v1, &v0, 1.0);
+	AddVertex(v2, &v1, 1.0);
 }
 
 static void OffsetWithLoops(const TPolyPolygon &pp, TPolyPolygon &pp_new, double inwards_value)
@@ -237,16 +234,12 @@ static void MakeObround(const Point &pt0, const CVertex &vt1, double radius)
 	CVertex v3(-vt1.m_type, pt0 + right0 * -radius, vt1.m_c);
 	CVertex v4(1, pt0 + right0 * radius, pt0);
 
-	double save_units = CArea::m_units;
-	CArea::m_units = 1.0;
-
-	AddVertex(v0, NULL);
-	AddVertex(v1, &v0);
-	AddVertex(v2, &v1);
-	AddVertex(v3, &v2);
-	AddVertex(v4, &v3);
-
-	CArea::m_units = save_units;
+	// the vertices are used without the unit scaling
+	AddVertex(v0, NULL, 1.0);
+	AddVertex(v1, &v0, 1.0);
+	AddVertex(v2, &v1, 1.0);
+	AddVertex(v3, &v2, 1.0);
+	AddVertex(v4, &v3, 1.0);
 }
 
 static void OffsetSpansWithObrounds(const CArea& area, TPolyPolygon &pp_new, double radius)
@@ -380,6 +373,41 @@ static void SetFromResult( CArea& area, TPolyPolygon& pp, bool reverse=true, boo
     }
 }
 
+// Adds an outer polygon of a clipper tree and what is inside of it in the same
+// order and directions as CArea::Reorder(): the outer curve anti-clockwise, its
+// holes clockwise, then the islands in the holes.
+static void SetFromTree( CArea& area, PolyNode& outer )
+{
+    if(!Orientation(outer.Contour))
+        ReversePath(outer.Contour);
+    area.m_curves.emplace_back();
+    SetFromResult(area.m_curves.back(), outer.Contour, false);
+
+    for(PolyNode *hole : outer.Childs) {
+        if(Orientation(hole->Contour))
+            ReversePath(hole->Contour);
+        area.m_curves.emplace_back();
+        SetFromResult(area.m_curves.back(), hole->Contour, false);
+    }
+    for(PolyNode *hole : outer.Childs) {
+        for(PolyNode *island : hole->Childs)
+            SetFromTree(area, *island);
+    }
+}
+
+// Sets the area from an offset result. The tree already knows which curves are
+// inside of which, so the result doesn't need to be reordered with the costly
+// pairwise tests of CArea::Reorder().
+static void SetFromTree( CArea& area, PolyTree& tree )
+{
+    area.m_curves.clear();
+
+    // don't use PolyNode::IsHole(), the parents of the top level nodes are
+    // left wrong by ClipperOffset for negative offsets
+    for(PolyNode *node : tree.Childs)
+        SetFromTree(area, *node);
+}
+
 void CArea::Subtract(const CArea& a2)
 {
 	Clipper c;
@@ -508,35 +536,67 @@ void CArea::Clip(ClipType op, const CArea *a,
 	SetFromResult(*this, solution, false, false, false);
 }
 
-void CArea::OffsetWithClipper(double offset, 
-                              JoinType joinType/* =jtRound */,
-                              EndType endType/* =etOpenRound */,
-                              double miterLimit/*  = 5.0 */,
-                              double roundPrecision/*  = 0.0 */)
+// returns the clipper arc tolerance for an offset in clipper units
+static double GetRoundPrecision(double offset, double roundPrecision)
 {
-    offset *= m_units*m_clipper_scale;
     if(roundPrecision == 0.0) {
         // Clipper roundPrecision definition: https://goo.gl/4odfQh
-		double dphi=acos(1.0-m_accuracy*m_clipper_scale/fabs(offset));
+		double dphi=acos(1.0-CArea::m_accuracy*CArea::m_clipper_scale/fabs(offset));
         int Segments=(int)ceil(PI/dphi);
         if (Segments < 2*CArea::m_min_arc_points)
             Segments = 2*CArea::m_min_arc_points;
         // if (Segments > CArea::m_max_arc_points)
         //     Segments=CArea::m_max_arc_points;
         dphi = PI/Segments;
-        roundPrecision = (1.0-cos(dphi))*fabs(offset);
-    }else
-        roundPrecision *= m_clipper_scale;
+        return (1.0-cos(dphi))*fabs(offset);
+    }
+    return roundPrecision * CArea::m_clipper_scale;
+}
 
-    ClipperOffset clipper(miterLimit,roundPrecision);
-	TPolyPolygon pp, pp2;
+void CArea::OffsetWithClipper(double offset, 
+                              JoinType joinType/* =jtRound */,
+                              EndType endType/* =etOpenRound */,
+                              double miterLimit/*  = 5.0 */,
+                              double roundPrecision/*  = 0.0 */)
+{
+    offset *= m_units*m_clipper_scale;
+    ClipperOffset clipper(miterLimit,GetRoundPrecision(offset,roundPrecision));
+	TPolyPolygon pp;
 	MakePolyPoly(*this, pp, false);
     int i=0;
     for(const CCurve &c : m_curves) 
         clipper.AddPath(pp[i++],joinType,c.IsClosed()?etClosedPolygon:endType);
-    clipper.Execute(pp2,(long64)(offset));
-	SetFromResult(*this, pp2, false);
-    this->Reorder();
+    PolyTree tree;
+    clipper.Execute(tree,(long64)(offset));
+    SetFromTree(*this, tree);
+}
+
+void CArea::OffsetWithClipper(const std::vector<double> &offsets,
+                              std::vector<CArea> &areas,
+                              JoinType joinType/* =jtRound */,
+                              EndType endType/* =etOpenRound */,
+                              double miterLimit/*  = 5.0 */,
+                              double roundPrecision/*  = 0.0 */) const
+{
+    // all offsets start from the same clipper paths
+	TPolyPolygon pp;
+	MakePolyPoly(*this, pp, false);
+    std::vector<EndType> endTypes;
+    endTypes.reserve(m_curves.size());
+    for(const CCurve &c : m_curves)
+        endTypes.push_back(c.IsClosed()?etClosedPolygon:endType);
+
+    areas.clear();
+    areas.resize(offsets.size());
+    RunParallel(offsets.size(), [&](std::size_t i) {
+        double offset = offsets[i]*m_units*m_clipper_scale;
+        ClipperOffset clipper(miterLimit,GetRoundPrecision(offset,roundPrecision));
+        for(std::size_t j=0;j<pp.size();++j)
+            clipper.AddPath(pp[j],joinType,endTypes[j]);
+        PolyTree tree;
+        clipper.Execute(tree,(long64)(offset));
+        SetFromTree(areas[i], tree);
+    });
 }
 
 void CArea::Thicken(double value)
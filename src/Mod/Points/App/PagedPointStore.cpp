@@ -0,0 +1,365 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <fstream>
+# include <list>
+# include <mutex>
+#endif
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+
+#include "PagedPointStore.h"
+
+using namespace Points;
+
+namespace Points {
+
+/**
+ * The shared data of a paged store: the page file, the bounding boxes of the
+ * pages and the page cache.
+ */
+class PagedPointData
+{
+public:
+    typedef PagedPointStore::value_type value_type;
+    typedef std::shared_ptr<const std::vector<value_type> > PagePtr;
+
+    struct PageInfo
+    {
+        Base::BoundBox3f bounds;
+        std::size_t valid;
+    };
+
+    PagedPointData(std::size_t pageSize, std::size_t cacheSize)
+      : pageSize(std::max<std::size_t>(pageSize, 1))
+      , cacheSize(std::max<std::size_t>(cacheSize, 1))
+      , numPoints(0)
+    {
+    }
+    ~PagedPointData()
+    {
+        if (file.is_open()) {
+            file.close();
+            Base::FileInfo fi(fileName);
+            fi.deleteFile();
+        }
+    }
+
+    void append(const value_type* points, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            if (tail.empty()) {
+                tail.reserve(pageSize);
+                PageInfo info;
+                info.valid = 0;
+                pages.push_back(info);
+            }
+
+            const value_type& pnt = points[i];
+            tail.push_back(pnt);
+            if (!boost::math::isnan(pnt.x) && !boost::math::isnan(pnt.y) && !boost::math::isnan(pnt.z)) {
+                pages.back().bounds.Add(pnt);
+                pages.back().valid++;
+            }
+
+            if (tail.size() == pageSize) {
+                writePage(pages.size() - 1, tail);
+                tail.clear();
+                tail.shrink_to_fit();
+            }
+        }
+
+        numPoints += count;
+    }
+    std::size_t countPoints(std::size_t page) const
+    {
+        if (page + 1 == pages.size() && !tail.empty())
+            return tail.size();
+        return pageSize;
+    }
+    /**
+     * Returns the points of a page. \a holder keeps a cached page alive while the
+     * caller uses it, even if another thread drops it from the cache meanwhile.
+     */
+    const value_type* readPage(std::size_t page, PagePtr& holder)
+    {
+        if (page + 1 == pages.size() && !tail.empty())
+            return tail.data();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // move a cached page to the front
+        for (std::list<CachedPage>::iterator it = cache.begin(); it != cache.end(); ++it) {
+            if (it->index == page) {
+                cache.splice(cache.begin(), cache, it);
+                holder = cache.front().points;
+                return holder->data();
+            }
+        }
+
+        // reuse the memory of the least recently used page if nobody reads it any more
+        CachedPage entry;
+        if (cache.size() >= cacheSize) {
+            if (cache.back().points.use_count() == 1)
+                entry.points = cache.back().points;
+            cache.pop_back();
+        }
+        if (!entry.points)
+            entry.points = std::make_shared<std::vector<value_type> >();
+
+        entry.index = page;
+        entry.points->resize(pageSize);
+        file.seekg(static_cast<std::streamoff>(page * pageSize * sizeof(value_type)));
+        file.read(reinterpret_cast<char*>(entry.points->data()),
+                  static_cast<std::streamsize>(pageSize * sizeof(value_type)));
+        if (!file)
+            throw Base::FileException("Failed to read page file", fileName.c_str());
+
+        cache.push_front(entry);
+        holder = entry.points;
+        return holder->data();
+    }
+    unsigned int getMemSize() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t size = pages.size() * sizeof(PageInfo);
+        size += tail.capacity() * sizeof(value_type);
+        size += cache.size() * pageSize * sizeof(value_type);
+        return static_cast<unsigned int>(size);
+    }
+
+private:
+    void writePage(std::size_t page, const std::vector<value_type>& points)
+    {
+        if (!file.is_open()) {
+            fileName = Base::FileInfo::getTempFileName("FCPoints");
+            Base::FileInfo fi(fileName);
+            std::ios::openmode mode = std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary;
+#ifdef _MSC_VER
+            file.open(fi.toStdWString().c_str(), mode);
+#else
+            file.open(fi.filePath().c_str(), mode);
+#endif
+            if (!file.is_open())
+                throw Base::FileException("Cannot create page file", fi);
+        }
+
+        file.seekp(static_cast<std::streamoff>(page * pageSize * sizeof(value_type)));
+        file.write(reinterpret_cast<const char*>(points.data()),
+                   static_cast<std::streamsize>(points.size() * sizeof(value_type)));
+        file.flush();
+        if (!file)
+            throw Base::FileException("Failed to write page file", fileName.c_str());
+    }
+
+public:
+    std::size_t pageSize;
+    std::size_t cacheSize;
+    std::size_t numPoints;
+    std::vector<PageInfo> pages;
+
+private:
+    struct CachedPage
+    {
+        std::size_t index;
+        std::shared_ptr<std::vector<value_type> > points;
+    };
+
+    /// the points of the last page that is not yet full
+    std::vector<value_type> tail;
+    /// the recently used pages, the most recent one first
+    std::list<CachedPage> cache;
+    /// guards the cache and the file position, the pages are shared by copies of a store
+    mutable std::mutex mutex;
+    std::string fileName;
+    std::fstream file;
+};
+
+}
+
+// ----------------------------------------------------------------------------
+
+PagedPointStore::PagedPointStore(std::size_t pageSize, std::size_t cacheSize)
+  : d(std::make_shared<PagedPointData>(pageSize, cacheSize))
+  , identity(true)
+{
+}
+
+PagedPointStore::PagedPointStore(const PagedPointStore& store)
+  : d(store.d)
+  , transform(store.transform)
+  , identity(store.identity)
+{
+}
+
+PagedPointStore::~PagedPointStore()
+{
+}
+
+PagedPointStore& PagedPointStore::operator = (const PagedPointStore& store)
+{
+    d = store.d;
+    transform = store.transform;
+    identity = store.identity;
+    return *this;
+}
+
+void PagedPointStore::append(const value_type* points, std::size_t count)
+{
+    if (d.use_count() > 1)
+        throw Base::RuntimeError("Cannot extend a shared point store");
+
+    if (identity) {
+        d->append(points, count);
+    }
+    else {
+        // the pages hold the points untransformed
+        Base::Matrix4D inverse(transform);
+        inverse.inverseGauss();
+        std::vector<value_type> block(points, points + count);
+        for (std::vector<value_type>::iterator it = block.begin(); it != block.end(); ++it)
+            inverse.multVec(*it, *it);
+        d->append(block.data(), block.size());
+    }
+}
+
+std::size_t PagedPointStore::size() const
+{
+    return d->numPoints;
+}
+
+std::size_t PagedPointStore::countValid() const
+{
+    std::size_t num = 0;
+    for (std::vector<PagedPointData::PageInfo>::const_iterator it = d->pages.begin(); it != d->pages.end(); ++it)
+        num += it->valid;
+    return num;
+}
+
+std::size_t PagedPointStore::countPages() const
+{
+    return d->pages.size();
+}
+
+std::size_t PagedPointStore::getPageSize() const
+{
+    return d->pageSize;
+}
+
+unsigned int PagedPointStore::getMemSize() const
+{
+    return d->getMemSize();
+}
+
+void PagedPointStore::transformGeometry(const Base::Matrix4D& mat)
+{
+    transform = mat * transform;
+    identity = (transform == Base::Matrix4D());
+}
+
+const PagedPointStore::value_type* PagedPointStore::getPage(std::size_t index, std::vector<value_type>& buffer,
+                                                            std::shared_ptr<const std::vector<value_type> >& holder) const
+{
+    const value_type* points = d->readPage(index, holder);
+    if (identity)
+        return points;
+
+    std::size_t count = d->countPoints(index);
+    buffer.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+        transform.multVec(points[i], buffer[i]);
+    return buffer.data();
+}
+
+Base::BoundBox3d PagedPointStore::getBoundBox(const Base::Matrix4D& outer) const
+{
+    Base::Matrix4D mat = outer * transform;
+    bool transformed = (mat != Base::Matrix4D());
+
+    Base::BoundBox3d bnd;
+    for (std::vector<PagedPointData::PageInfo>::const_iterator it = d->pages.begin(); it != d->pages.end(); ++it) {
+        if (it->valid == 0)
+            continue;
+        const Base::BoundBox3f& bb = it->bounds;
+        Base::BoundBox3d box(bb.MinX, bb.MinY, bb.MinZ, bb.MaxX, bb.MaxY, bb.MaxZ);
+        if (transformed)
+            bnd.Add(box.Transformed(mat));
+        else
+            bnd.Add(box);
+    }
+    return bnd;
+}
+
+void PagedPointStore::visit(const PageVisitor& func) const
+{
+    std::vector<value_type> buffer;
+    for (std::size_t i = 0; i < d->pages.size(); i++) {
+        std::shared_ptr<const std::vector<value_type> > holder;
+        const value_type* points = getPage(i, buffer, holder);
+        func(i * d->pageSize, points, d->countPoints(i));
+    }
+}
+
+void PagedPointStore::query(const Base::BoundBox3d& box, const PointVisitor& func,
+                            const Base::Matrix4D& outer) const
+{
+    Base::Matrix4D mat = outer * transform;
+    for (std::size_t i = 0; i < d->pages.size(); i++) {
+        const PagedPointData::PageInfo& info = d->pages[i];
+        if (info.valid == 0)
+            continue;
+
+        // skip pages that cannot contain a point of the box
+        const Base::BoundBox3f& bb = info.bounds;
+        Base::BoundBox3d pageBox(bb.MinX, bb.MinY, bb.MinZ, bb.MaxX, bb.MaxY, bb.MaxZ);
+        if (!box.Intersect(pageBox.Transformed(mat)))
+            continue;
+
+        PagedPointData::PagePtr holder;
+        const value_type* points = d->readPage(i, holder);
+        std::size_t count = d->countPoints(i);
+        std::size_t first = i * d->pageSize;
+        for (std::size_t j = 0; j < count; j++) {
+            const value_type& p = points[j];
+            if (boost::math::isnan(p.x) || boost::math::isnan(p.y) || boost::math::isnan(p.z))
+                continue;
+            Base::Vector3d pnt = mat * Base::Vector3d(p.x, p.y, p.z);
+            if (box.IsInBox(pnt))
+                func(first + j, pnt);
+        }
+    }
+}
+
+void PagedPointStore::copyTo(std::vector<value_type>& points) const
+{
+    points.resize(size());
+    visit([&points](std::size_t first, const value_type* page, std::size_t count) {
+        std::copy(page, page + count, points.begin() + first);
+    });
+}
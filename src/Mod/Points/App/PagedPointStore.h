@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_PAGEDPOINTSTORE_H
+#define POINTS_PAGEDPOINTSTORE_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+namespace Points
+{
+
+class PagedPointData;
+
+/**
+ * The PagedPointStore class keeps a point cloud in pages of a fixed number of
+ * points in a temporary file on disk. Only the page that is currently filled
+ * and a limited number of recently used pages are held in memory, so that the
+ * size of a cloud isn't limited by the available RAM.
+ *
+ * The pages keep the original order of the points because the properties of a
+ * point cloud (colors, normals, ...) refer to the points by their index. For
+ * each page the bounding box of its points is kept in memory, so that box
+ * queries only need to load the pages that intersect the box.
+ *
+ * Copies of a store share the pages on disk and only have their own
+ * transformation. Thus, copying or transforming a store doesn't touch the
+ * points. A store whose pages are shared cannot be extended any more.
+ *
+ * @note The page cache is guarded by a mutex, so copies of a store that share
+ * the pages can be read from different threads. Building or transforming a
+ * store is not thread-safe.
+ */
+class PointsExport PagedPointStore
+{
+public:
+    typedef Base::Vector3f value_type;
+    /// Handles \a count consecutive points where \a first is the index of the first point
+    typedef std::function<void (std::size_t first, const value_type* points, std::size_t count)> PageVisitor;
+    /// Handles a point found by a box query
+    typedef std::function<void (std::size_t index, const Base::Vector3d& point)> PointVisitor;
+
+    /**
+     * Creates an empty store where each page holds \a pageSize points and at
+     * most \a cacheSize pages are kept in memory.
+     */
+    explicit PagedPointStore(std::size_t pageSize = DefaultPageSize,
+                             std::size_t cacheSize = DefaultCacheSize);
+    PagedPointStore(const PagedPointStore&);
+    ~PagedPointStore();
+
+    PagedPointStore& operator = (const PagedPointStore&);
+
+    /** @name Building */
+    //@{
+    /// Appends points, full pages are written to disk
+    void append(const value_type* points, std::size_t count);
+    void append(const std::vector<value_type>& points)
+    { append(points.data(), points.size()); }
+    //@}
+
+    /** @name Information */
+    //@{
+    /// The number of points
+    std::size_t size() const;
+    /// The number of points that are not NaN
+    std::size_t countValid() const;
+    /// The number of pages
+    std::size_t countPages() const;
+    std::size_t getPageSize() const;
+    /// The memory used by the page cache and the page information
+    unsigned int getMemSize() const;
+    //@}
+
+    /** @name Transformation */
+    //@{
+    const Base::Matrix4D& getTransform() const
+    { return transform; }
+    /// Only combines the matrix with the current transformation of the store
+    void transformGeometry(const Base::Matrix4D&);
+    //@}
+
+    /** @name Access */
+    //@{
+    /**
+     * Returns the bounding box of the transformed points. The box is computed
+     * from the boxes of the pages and \a outer is applied additionally.
+     */
+    Base::BoundBox3d getBoundBox(const Base::Matrix4D& outer = Base::Matrix4D()) const;
+    /// Passes the transformed points page by page in the original order
+    void visit(const PageVisitor&) const;
+    /**
+     * Passes all transformed points inside \a box to the visitor. The box
+     * refers to the coordinate system defined by \a outer.
+     */
+    void query(const Base::BoundBox3d& box, const PointVisitor&,
+               const Base::Matrix4D& outer = Base::Matrix4D()) const;
+    /// Copies all transformed points
+    void copyTo(std::vector<value_type>& points) const;
+    //@}
+
+    static const std::size_t DefaultPageSize = 1 << 20;
+    static const std::size_t DefaultCacheSize = 16;
+
+private:
+    /// \a holder keeps the page alive while it's used
+    const value_type* getPage(std::size_t index, std::vector<value_type>& buffer,
+                              std::shared_ptr<const std::vector<value_type> >& holder) const;
+
+private:
+    std::shared_ptr<PagedPointData> d;
+    Base::Matrix4D transform;
+    bool identity;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_PAGEDPOINTSTORE_H
@@ -25,6 +25,7 @@
 #ifndef _PreComp_
 # include <cmath>
 # include <iostream>
+# include <memory>
 #endif
 
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -35,6 +36,7 @@
 #include <Base/Persistence.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
+#include <App/Application.h>
 
 #include "Points.h"
 #include "PointsAlgos.h"
@@ -52,6 +54,7 @@ TYPESYSTEM_SOURCE(Points::PointKernel, Data::ComplexGeoData)
 PointKernel::PointKernel(const PointKernel& pts)
   : _Mtrx(pts._Mtrx)
   , _Points(pts._Points)
+  , _Store(pts._Store ? new PagedPointStore(*pts._Store) : nullptr)
 {
 
 }
@@ -84,6 +87,12 @@ Data::Segment* PointKernel::getSubElement(const char* /*Type*/, unsigned long /*
 
 void PointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    // the paged points are transformed when they are read
+    if (_Store) {
+        _Store->transformGeometry(rclMat);
+        return;
+    }
+
     std::vector<value_type>& kernel = getBasicPoints();
 #ifdef _WIN32
     // Win32-only at the moment since ppl.h is a Microsoft library. Points is not using Qt so we cannot use QtConcurrent
@@ -101,6 +110,9 @@ void PointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 
 Base::BoundBox3d PointKernel::getBoundBox(void)const
 {
+    if (_Store)
+        return _Store->getBoundBox(_Mtrx);
+
     Base::BoundBox3d bnd;
 
 #ifdef _WIN32
@@ -128,16 +140,22 @@ void PointKernel::operator = (const PointKernel& Kernel)
         // copy the mesh structure
         setTransform(Kernel._Mtrx);
         this->_Points = Kernel._Points;
+        this->_Store.reset(Kernel._Store ? new PagedPointStore(*Kernel._Store) : nullptr);
     }
 }
 
 unsigned int PointKernel::getMemSize (void) const
 {
+    if (_Store)
+        return _Store->getMemSize();
     return _Points.size() * sizeof(value_type);
 }
 
 PointKernel::size_type PointKernel::countValid(void) const
 {
+    if (_Store)
+        return _Store->countValid();
+
     size_type num = 0;
     for (const_point_iterator it = begin(); it != end(); ++it) {
         if (!(boost::math::isnan(it->x) || 
@@ -179,6 +197,14 @@ void PointKernel::SaveDocFile (Base::Writer &writer) const
     uint32_t uCt = (uint32_t)size();
     str << uCt;
     // store the data without transforming it
+    if (_Store) {
+        _Store->visit([&str](std::size_t, const value_type* points, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++)
+                str << points[i].x << points[i].y << points[i].z;
+        });
+        return;
+    }
+
     for (std::vector<value_type>::const_iterator it = _Points.begin(); it != _Points.end(); ++it) {
         str << it->x << it->y << it->z;
     }
@@ -206,6 +232,33 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
     Base::InputStream str(reader);
     uint32_t uCt = 0;
     str >> uCt;
+    _Store.reset();
+
+    // huge clouds are directly read into a paged store if enabled
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+    unsigned long threshold = hGrp->GetUnsigned("PagingThreshold", 0);
+    if (threshold > 0 && uCt > threshold) {
+        std::unique_ptr<PagedPointStore> store(new PagedPointStore());
+        std::vector<value_type> block;
+        block.reserve(store->getPageSize());
+        for (unsigned long i=0; i < uCt; i++) {
+            float x, y, z;
+            str >> x >> y >> z;
+            block.emplace_back(x,y,z);
+            if (block.size() == store->getPageSize()) {
+                store->append(block);
+                block.clear();
+            }
+        }
+        store->append(block);
+
+        _Points.clear();
+        _Points.shrink_to_fit();
+        _Store = std::move(store);
+        return;
+    }
+
     _Points.resize(uCt);
     for (unsigned long i=0; i < uCt; i++) {
         float x, y, z;
@@ -214,6 +267,49 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
     }
 }
 
+void PointKernel::swapOut(std::size_t pageSize)
+{
+    if (_Store)
+        return;
+
+    std::unique_ptr<PagedPointStore> store(new PagedPointStore(pageSize));
+    store->append(_Points);
+    _Points.clear();
+    _Points.shrink_to_fit();
+    _Store = std::move(store);
+}
+
+void PointKernel::setPagedStore(const PagedPointStore& store)
+{
+    _Points.clear();
+    _Points.shrink_to_fit();
+    _Store.reset(new PagedPointStore(store));
+}
+
+void PointKernel::readPages() const
+{
+    std::vector<value_type> points;
+    _Store->copyTo(points);
+    _Points.swap(points);
+    _Store.reset();
+}
+
+void PointKernel::getPointsInBox(const Base::BoundBox3d& box, std::vector<unsigned long>& indices) const
+{
+    if (_Store) {
+        _Store->query(box, [&indices](std::size_t index, const Base::Vector3d&) {
+            indices.push_back(static_cast<unsigned long>(index));
+        }, _Mtrx);
+        return;
+    }
+
+    unsigned long index = 0;
+    for (const_point_iterator it = begin(); it != end(); ++it, ++index) {
+        if (box.IsInBox(*it))
+            indices.push_back(index);
+    }
+}
+
 void PointKernel::save(const char* file) const
 {
     Base::ofstream out(file, std::ios::out);
@@ -228,6 +324,15 @@ void PointKernel::load(const char* file)
 void PointKernel::save(std::ostream& out) const
 {
     out << "# ASCII" << std::endl;
+    if (_Store) {
+        _Store->visit([&out](std::size_t, const value_type* points, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                out << points[i].x << " " << points[i].y << " " << points[i].z << std::endl;
+            }
+        });
+        return;
+    }
+
     for (std::vector<value_type>::const_iterator it = _Points.begin(); it != _Points.end(); ++it) {
         out << it->x << " " << it->y << " " << it->z << std::endl;
     }
@@ -237,6 +342,18 @@ void PointKernel::getPoints(std::vector<Base::Vector3d> &Points,
                             std::vector<Base::Vector3d> &/*Normals*/,
                             float /*Accuracy*/, uint16_t /*flags*/) const
 {
+    if (_Store) {
+        Points.reserve(_Store->size());
+        const Base::Matrix4D& mat = _Mtrx;
+        _Store->visit([&Points, &mat](std::size_t, const value_type* points, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                const value_type& p = points[i];
+                Points.push_back(mat * Base::Vector3d(p.x, p.y, p.z));
+            }
+        });
+        return;
+    }
+
     unsigned long ctpoints = _Points.size();
     Points.reserve(ctpoints);
     for (unsigned long i=0; i<ctpoints; i++) {
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <iterator>
+#include <memory>
 
 #include <Base/Vector3D.h>
 #include <Base/Matrix.h>
@@ -35,6 +36,8 @@
 #include <App/PropertyStandard.h>
 #include <App/PropertyGeo.h>
 
+#include "PagedPointStore.h"
+
 namespace Points
 {
 
@@ -80,13 +83,13 @@ public:
     inline void setTransform(const Base::Matrix4D& rclTrf){_Mtrx = rclTrf;}
     inline Base::Matrix4D getTransform(void) const{return _Mtrx;}
     std::vector<value_type>& getBasicPoints()
-    { return this->_Points; }
+    { loadPages(); return this->_Points; }
     const std::vector<value_type>& getBasicPoints() const
-    { return this->_Points; }
+    { loadPages(); return this->_Points; }
     void setBasicPoints(const std::vector<value_type>& pts)
-    { this->_Points = pts; }
+    { this->_Store.reset(); this->_Points = pts; }
     void swap(std::vector<value_type>& pts)
-    { this->_Points.swap(pts); }
+    { loadPages(); this->_Points.swap(pts); }
 
     virtual void getPoints(std::vector<Base::Vector3d> &Points,
         std::vector<Base::Vector3d> &Normals,
@@ -108,34 +111,66 @@ public:
     void load(std::istream&);
     //@}
 
+    /** @name Out-of-core storage
+     * The points can be kept in a PagedPointStore on disk instead of memory.
+     * Querying the size, the bounding box or points inside a box, transforming
+     * and saving the points work directly on the store. All other methods that
+     * access the points load them into memory first and release the store.
+     */
+    //@{
+    /// Moves the points into a paged store
+    void swapOut(std::size_t pageSize = PagedPointStore::DefaultPageSize);
+    /// Replaces the points by the points of the store
+    void setPagedStore(const PagedPointStore&);
+    /// Returns the paged store or null if the points are kept in memory
+    const PagedPointStore* getPagedStore() const
+    { return this->_Store.get(); }
+    bool isPaged() const
+    { return this->_Store != nullptr; }
+    /// Gets the indices of the points inside the box
+    void getPointsInBox(const Base::BoundBox3d&, std::vector<unsigned long>& indices) const;
+    //@}
+
+private:
+    inline void loadPages() const {
+        if (_Store)
+            readPages();
+    }
+    void readPages() const;
+
 private:
     Base::Matrix4D _Mtrx;
-    std::vector<value_type> _Points;
+    mutable std::vector<value_type> _Points;
+    mutable std::unique_ptr<PagedPointStore> _Store;
 
 public:
     /// number of points stored 
-    size_type size(void) const {return this->_Points.size();}
+    size_type size(void) const {return _Store ? _Store->size() : this->_Points.size();}
     size_type countValid(void) const;
     std::vector<value_type> getValidPoints() const;
-    void resize(size_type n){_Points.resize(n);}
-    void reserve(size_type n){_Points.reserve(n);}
+    void resize(size_type n){loadPages(); _Points.resize(n);}
+    void reserve(size_type n){loadPages(); _Points.reserve(n);}
     inline void erase(size_type first, size_type last) {
+        loadPages();
         _Points.erase(_Points.begin()+first,_Points.begin()+last);
     }
 
-    void clear(void){_Points.clear();}
+    void clear(void){_Store.reset(); _Points.clear();}
 
 
     /// get the points
     inline const Base::Vector3d getPoint(const int idx) const {
+        loadPages();
         return transformToOutside(_Points[idx]);
     }
     /// set the points
     inline void setPoint(const int idx,const Base::Vector3d& point) {
+        loadPages();
         _Points[idx] = transformToInside(point);
     }
     /// insert the points
     inline void push_back(const Base::Vector3d& point) {
+        loadPages();
         _Points.push_back(transformToInside(point));
     }
 
@@ -181,9 +216,9 @@ public:
     /** @name Iterator */
     //@{
     const_point_iterator begin() const
-    { return const_point_iterator(this, _Points.begin()); }
+    { loadPages(); return const_point_iterator(this, _Points.begin()); }
     const_point_iterator end() const
-    { return const_point_iterator(this, _Points.end()); }
+    { loadPages(); return const_point_iterator(this, _Points.end()); }
     const_reverse_iterator rbegin() const
     { return const_reverse_iterator(end()); }
     const_reverse_iterator rend() const
@@ -26,9 +26,17 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <atomic>
+# include <cstdlib>
+# include <cstring>
+# include <functional>
+# include <limits>
 # include <sstream>
 #endif
 
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "PointsAlgos.h"
 #include "Points.h"
@@ -39,15 +47,613 @@
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 
 #include <memory>
-#include <boost/regex.hpp>
+#include <Eigen/Core>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 using namespace Points;
 
+namespace Points {
+
+/**
+ * The MappedFile class maps a file into memory for reading. Compared to a
+ * stream this avoids to copy the data into intermediate buffers and several
+ * threads can access the data at the same time.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename)
+      : file(QString::fromUtf8(filename.c_str())), data(nullptr), length(0)
+    {
+        if (!file.open(QIODevice::ReadOnly))
+            throw Base::FileException("File to load not existing or not readable", filename.c_str());
+        length = static_cast<std::size_t>(file.size());
+        if (length > 0) {
+            data = reinterpret_cast<const char*>(file.map(0, file.size()));
+            if (!data)
+                throw Base::FileException("Failed to map file into memory", filename.c_str());
+        }
+    }
+    ~MappedFile()
+    {
+        if (data)
+            file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+    }
+    const char* begin() const
+    {
+        return data;
+    }
+    const char* end() const
+    {
+        return data + length;
+    }
+    std::size_t size() const
+    {
+        return length;
+    }
+
+private:
+    QFile file;
+    const char* data;
+    std::size_t length;
+};
+
+/**
+ * Stream buffer to read from a memory block, used to parse the file headers.
+ */
+class MemoryStreambuf : public std::streambuf
+{
+public:
+    MemoryStreambuf(const char* begin, const char* end) {
+        char* b = const_cast<char*>(begin);
+        char* e = const_cast<char*>(end);
+        setg(b, b, e);
+    }
+
+protected:
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                             std::ios_base::openmode = std::ios::in | std::ios::out) {
+        char* pos = gptr();
+        if (way == std::ios_base::beg)
+            pos = eback();
+        else if (way == std::ios_base::end)
+            pos = egptr();
+        if (off < eback() - pos || off > egptr() - pos)
+            return pos_type(off_type(-1));
+
+        pos += off;
+        setg(eback(), pos, egptr());
+        return pos_type(pos - eback());
+    }
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios::in | std::ios::out) {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+/// Handles the \a count values of the record with index \a row, returns false for an invalid record
+typedef std::function<bool (std::size_t row, const double* values, std::size_t count)> RecordHandler;
+
+/**
+ * Applies \a func to all chunks using several threads. The chunks are handled
+ * in batches so that the sequencer advances by one step per chunk and the user
+ * can cancel the operation.
+ */
+template <typename Chunk, typename Func>
+void processChunks(std::vector<Chunk>& chunks, Func func, Base::SequencerLauncher& seq)
+{
+    std::size_t batchSize = static_cast<std::size_t>(std::max(2 * QThread::idealThreadCount(), 1));
+    std::size_t pos = 0;
+    while (pos < chunks.size()) {
+        std::size_t next = std::min(pos + batchSize, chunks.size());
+        QtConcurrent::blockingMap(chunks.begin() + pos, chunks.begin() + next, func);
+        for (; pos < next; pos++)
+            seq.next(true); // allow to cancel
+    }
+}
+
+/**
+ * The AsciiRecordParser class parses a text with one record per line. The text
+ * is split into chunks on line boundaries which are handled by several threads.
+ * In a first pass the non-empty lines of all chunks are counted so that in the
+ * second pass each chunk knows the row index of its first record.
+ */
+class AsciiRecordParser
+{
+public:
+    AsciiRecordParser(const char* begin, const char* end, std::size_t numFields)
+      : numFields(numFields)
+    {
+        const char* pos = begin;
+        while (pos < end) {
+            std::size_t len = static_cast<std::size_t>(end - pos);
+            const char* next = pos + (len > ChunkSize ? ChunkSize : len);
+            if (next < end) {
+                next = static_cast<const char*>(std::memchr(next, '\n', end - next));
+                next = next ? next + 1 : end;
+            }
+
+            Chunk chunk;
+            chunk.begin = pos;
+            chunk.end = next;
+            chunk.first = 0;
+            chunk.lines = 0;
+            chunk.failed = false;
+            chunks.push_back(chunk);
+            pos = next;
+        }
+    }
+    /// The number of sequencer steps needed by countLines() and parse()
+    std::size_t countSteps() const
+    {
+        return 2 * chunks.size();
+    }
+    /// Counts the non-empty lines
+    std::size_t countLines(Base::SequencerLauncher& seq)
+    {
+        processChunks(chunks, [](Chunk& chunk) {
+            forEachLine(chunk.begin, chunk.end, [&chunk](const char* begin, const char* end) {
+                if (!isEmptyLine(begin, end))
+                    chunk.lines++;
+            });
+        }, seq);
+
+        std::size_t count = 0;
+        for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            it->first = count;
+            count += it->lines;
+        }
+        return count;
+    }
+    /**
+     * Skips the first \a skip non-empty lines and passes the values of the next
+     * \a numRows lines to the handler. Returns false if the handler rejected
+     * a record. countLines() must be called first.
+     */
+    bool parse(std::size_t skip, std::size_t numRows, const RecordHandler& handler,
+               Base::SequencerLauncher& seq)
+    {
+        std::size_t numFields = this->numFields;
+        processChunks(chunks, [skip, numRows, numFields, &handler](Chunk& chunk) {
+            if (chunk.first + chunk.lines <= skip || chunk.first >= skip + numRows)
+                return;
+
+            std::vector<double> values(numFields);
+            std::size_t index = chunk.first;
+            forEachLine(chunk.begin, chunk.end, [&](const char* begin, const char* end) {
+                if (isEmptyLine(begin, end))
+                    return;
+                if (index >= skip && index < skip + numRows) {
+                    std::size_t count = parseValues(begin, end, values);
+                    if (!handler(index - skip, values.data(), count))
+                        chunk.failed = true;
+                }
+                index++;
+            });
+        }, seq);
+
+        for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            if (it->failed)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    struct Chunk
+    {
+        const char* begin;
+        const char* end;
+        std::size_t first;
+        std::size_t lines;
+        bool failed;
+    };
+
+    static bool isBlank(char c)
+    {
+        return (c == ' ' || c == '\t' || c == '\r');
+    }
+    static bool isEmptyLine(const char* begin, const char* end)
+    {
+        for (; begin != end; ++begin) {
+            if (!isBlank(*begin))
+                return false;
+        }
+        return true;
+    }
+    template <typename Func>
+    static void forEachLine(const char* begin, const char* end, Func func)
+    {
+        while (begin < end) {
+            const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (!eol)
+                eol = end;
+            func(begin, eol);
+            begin = (eol < end ? eol + 1 : end);
+        }
+    }
+    /// Converts the values of a line until the first invalid token, returns the number of values
+    static std::size_t parseValues(const char* begin, const char* end, std::vector<double>& values)
+    {
+        // the mapped data is not null-terminated, so copy each token before converting it
+        char token[64];
+        std::size_t count = 0;
+        const char* pos = begin;
+        while (count < values.size()) {
+            while (pos < end && isBlank(*pos))
+                pos++;
+            if (pos == end)
+                break;
+
+            const char* start = pos;
+            while (pos < end && !isBlank(*pos))
+                pos++;
+            std::size_t len = pos - start;
+            if (len >= sizeof(token))
+                break;
+            std::memcpy(token, start, len);
+            token[len] = '\0';
+
+            char* last;
+            double value = std::strtod(token, &last);
+            if (last != token + len)
+                break;
+            values[count++] = value;
+        }
+        return count;
+    }
+
+private:
+    std::vector<Chunk> chunks;
+    std::size_t numFields;
+    static const std::size_t ChunkSize = 4 * 1024 * 1024;
+};
+
+/**
+ * The BinaryRecordDecoder class converts binary records of numbers. The
+ * records are either stored one after another or, as for compressed PCD
+ * data, field by field.
+ */
+class BinaryRecordDecoder
+{
+public:
+    enum FieldType {
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64
+    };
+
+    BinaryRecordDecoder(const std::vector<FieldType>& types, bool bigEndian, bool columnMajor)
+      : types(types), recordLength(0), columnMajor(columnMajor)
+    {
+        swapBytes = (bigEndian != (Base::SwapOrder() == HIGH_ENDIAN));
+        for (std::vector<FieldType>::const_iterator it = types.begin(); it != types.end(); ++it) {
+            offsets.push_back(recordLength);
+            recordLength += sizeOf(*it);
+        }
+    }
+    std::size_t recordSize() const
+    {
+        return recordLength;
+    }
+    /// The number of sequencer steps needed by decode()
+    std::size_t countSteps(std::size_t numRecords) const
+    {
+        return (numRecords + ChunkSize - 1) / ChunkSize;
+    }
+    /// Passes the values of \a numRecords records to the handler
+    void decode(const char* data, std::size_t numRecords, const RecordHandler& handler,
+                Base::SequencerLauncher& seq) const
+    {
+        std::vector<std::pair<std::size_t, std::size_t> > chunks;
+        for (std::size_t i = 0; i < numRecords; i += ChunkSize)
+            chunks.emplace_back(i, std::min(i + ChunkSize, numRecords));
+
+        processChunks(chunks, [this, data, numRecords, &handler](const std::pair<std::size_t, std::size_t>& chunk) {
+            std::size_t numFields = types.size();
+            std::vector<double> values(numFields);
+            for (std::size_t i = chunk.first; i < chunk.second; i++) {
+                for (std::size_t j = 0; j < numFields; j++) {
+                    const char* ptr = columnMajor
+                        ? data + offsets[j] * numRecords + i * sizeOf(types[j])
+                        : data + i * recordLength + offsets[j];
+                    values[j] = decodeValue(types[j], ptr);
+                }
+                handler(i, values.data(), numFields);
+            }
+        }, seq);
+    }
+
+    static std::size_t sizeOf(FieldType type)
+    {
+        switch (type) {
+        case Int8:
+        case UInt8:
+            return 1;
+        case Int16:
+        case UInt16:
+            return 2;
+        case Int32:
+        case UInt32:
+        case Float32:
+            return 4;
+        case Float64:
+            return 8;
+        }
+        return 0;
+    }
+    /// Converts a PLY property type
+    static FieldType fromPly(const std::string& t)
+    {
+        if (t == "char" || t == "int8")
+            return Int8;
+        else if (t == "uchar" || t == "uint8")
+            return UInt8;
+        else if (t == "short" || t == "int16")
+            return Int16;
+        else if (t == "ushort" || t == "uint16")
+            return UInt16;
+        else if (t == "int" || t == "int32")
+            return Int32;
+        else if (t == "uint" || t == "uint32")
+            return UInt32;
+        else if (t == "float" || t == "float32")
+            return Float32;
+        else if (t == "double" || t == "float64")
+            return Float64;
+        throw Base::BadFormatError("Unexpected type");
+    }
+    /// Converts a PCD field type and size
+    static FieldType fromPcd(const std::string& type, int size)
+    {
+        char t = type.empty() ? ' ' : type[0];
+        switch (size) {
+        case 1:
+            if (t == 'I')
+                return Int8;
+            else if (t == 'U')
+                return UInt8;
+            break;
+        case 2:
+            if (t == 'I')
+                return Int16;
+            else if (t == 'U')
+                return UInt16;
+            break;
+        case 4:
+            if (t == 'I')
+                return Int32;
+            else if (t == 'U')
+                return UInt32;
+            else if (t == 'F')
+                return Float32;
+            break;
+        case 8:
+            if (t == 'F')
+                return Float64;
+            break;
+        }
+        throw Base::BadFormatError("Unexpected type");
+    }
+
+private:
+    template <typename T>
+    double decodeValue(const char* ptr) const
+    {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        if (swapBytes)
+            Base::SwapEndian(value);
+        return static_cast<double>(value);
+    }
+    double decodeValue(FieldType type, const char* ptr) const
+    {
+        switch (type) {
+        case Int8:
+            return decodeValue<int8_t>(ptr);
+        case UInt8:
+            return decodeValue<uint8_t>(ptr);
+        case Int16:
+            return decodeValue<int16_t>(ptr);
+        case UInt16:
+            return decodeValue<uint16_t>(ptr);
+        case Int32:
+            return decodeValue<int32_t>(ptr);
+        case UInt32:
+            return decodeValue<uint32_t>(ptr);
+        case Float32:
+            return decodeValue<float>(ptr);
+        case Float64:
+            return decodeValue<double>(ptr);
+        }
+        return 0.0;
+    }
+
+private:
+    std::vector<FieldType> types;
+    std::vector<std::size_t> offsets;
+    std::size_t recordLength;
+    bool swapBytes;
+    bool columnMajor;
+    static const std::size_t ChunkSize = 65536;
+};
+
+/**
+ * The RecordStore class writes the fields of a record directly into the point
+ * kernel and the property arrays of a reader. Each record is written to its own
+ * position, so several threads can store records at the same time.
+ */
+class RecordStore
+{
+public:
+    enum ColorType {
+        NoColor,
+        /// separate red, green, blue and alpha fields in the range [0, 255]
+        ColorUChar,
+        /// separate red, green, blue and alpha fields in the range [0, 1]
+        ColorFloat,
+        /// a single field with the packed ARGB components
+        PackedUInt,
+        /// a single field with the packed ARGB components stored as float
+        PackedFloat
+    };
+
+    RecordStore(const std::vector<std::string>& fields, PointKernel& kernel,
+                std::vector<Base::Vector3f>& normals, std::vector<float>& intensity,
+                std::vector<App::Color>& colors)
+      : kernel(kernel), normals(normals), intensity(intensity), colors(colors)
+    {
+        x = findField(fields, "x");
+        y = findField(fields, "y");
+        z = findField(fields, "z");
+        normal_x = findField(fields, "normal_x", "nx");
+        normal_y = findField(fields, "normal_y", "ny");
+        normal_z = findField(fields, "normal_z", "nz");
+        greyvalue = findField(fields, "intensity");
+        red = green = blue = alpha = NoField;
+        colorType = NoColor;
+        updateLastField();
+    }
+    static std::size_t findField(const std::vector<std::string>& fields, const char* name,
+                                 const char* alias = nullptr)
+    {
+        std::vector<std::string>::const_iterator it = std::find(fields.begin(), fields.end(), name);
+        if (it == fields.end() && alias)
+            it = std::find(fields.begin(), fields.end(), alias);
+        if (it != fields.end())
+            return std::distance(fields.begin(), it);
+        return NoField;
+    }
+    void setColors(ColorType type, std::size_t r, std::size_t g, std::size_t b, std::size_t a)
+    {
+        colorType = type;
+        red = r;
+        green = g;
+        blue = b;
+        alpha = a;
+        updateLastField();
+    }
+    bool hasPoints() const
+    {
+        return (x != NoField && y != NoField && z != NoField);
+    }
+    bool hasNormals() const
+    {
+        return (normal_x != NoField && normal_y != NoField && normal_z != NoField);
+    }
+    bool hasIntensities() const
+    {
+        return (greyvalue != NoField);
+    }
+    /// Allocates the arrays for the available fields
+    void resize(std::size_t numPoints)
+    {
+        kernel.clear();
+        kernel.resize(numPoints);
+        if (hasNormals())
+            normals.resize(numPoints);
+        if (hasIntensities())
+            intensity.resize(numPoints);
+        if (colorType != NoColor)
+            colors.resize(numPoints);
+    }
+    /// Stores a record, returns false if it has too few values
+    bool store(std::size_t row, const double* values, std::size_t count) const
+    {
+        if (count <= lastField)
+            return false;
+
+        kernel.getBasicPoints()[row].Set(static_cast<float>(values[x]),
+                                         static_cast<float>(values[y]),
+                                         static_cast<float>(values[z]));
+        if (hasNormals()) {
+            normals[row].Set(static_cast<float>(values[normal_x]),
+                             static_cast<float>(values[normal_y]),
+                             static_cast<float>(values[normal_z]));
+        }
+        if (hasIntensities()) {
+            intensity[row] = static_cast<float>(values[greyvalue]);
+        }
+
+        switch (colorType) {
+        case ColorUChar:
+            {
+                float a = alpha != NoField ? static_cast<float>(values[alpha]) : 1.0f;
+                colors[row].set(static_cast<float>(values[red])/255.0f,
+                                static_cast<float>(values[green])/255.0f,
+                                static_cast<float>(values[blue])/255.0f,
+                                a/255.0f);
+            }   break;
+        case ColorFloat:
+            {
+                float a = alpha != NoField ? static_cast<float>(values[alpha]) : 1.0f;
+                colors[row].set(static_cast<float>(values[red]),
+                                static_cast<float>(values[green]),
+                                static_cast<float>(values[blue]),
+                                a);
+            }   break;
+        case PackedUInt:
+            setPackedColor(row, static_cast<uint32_t>(values[red]));
+            break;
+        case PackedFloat:
+            {
+                float f = static_cast<float>(values[red]);
+                uint32_t packed;
+                std::memcpy(&packed, &f, sizeof(packed));
+                setPackedColor(row, packed);
+            }   break;
+        default:
+            break;
+        }
+
+        return true;
+    }
+
+private:
+    void updateLastField()
+    {
+        lastField = std::max(x, std::max(y, z));
+        if (hasNormals())
+            lastField = std::max(lastField, std::max(normal_x, std::max(normal_y, normal_z)));
+        if (hasIntensities())
+            lastField = std::max(lastField, greyvalue);
+        if (colorType != NoColor)
+            lastField = std::max(lastField, std::max(red, std::max(green, blue)));
+        if (colorType != NoColor && alpha != NoField)
+            lastField = std::max(lastField, alpha);
+    }
+    void setPackedColor(std::size_t row, uint32_t packed) const
+    {
+        uint32_t a = (packed >> 24) & 0xff;
+        uint32_t r = (packed >> 16) & 0xff;
+        uint32_t g = (packed >> 8) & 0xff;
+        uint32_t b = packed & 0xff;
+        colors[row].set(static_cast<float>(r)/255.0f,
+                        static_cast<float>(g)/255.0f,
+                        static_cast<float>(b)/255.0f,
+                        static_cast<float>(a)/255.0f);
+    }
+
+public:
+    static const std::size_t NoField = static_cast<std::size_t>(-1);
+
+private:
+    PointKernel& kernel;
+    std::vector<Base::Vector3f>& normals;
+    std::vector<float>& intensity;
+    std::vector<App::Color>& colors;
+    std::size_t x, y, z;
+    std::size_t normal_x, normal_y, normal_z;
+    std::size_t greyvalue;
+    std::size_t red, green, blue, alpha;
+    std::size_t lastField;
+    ColorType colorType;
+};
+
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -64,57 +670,40 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
 
 void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
-
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
-    Base::FileInfo fi(FileName);
-
-    Base::ifstream tmp_str(fi, std::ios::in);
-
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
-
-    // resize the PointKernel
-    points.resize(LineCnt);
-
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
-
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
-
-    try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
-            }
+    MappedFile file(FileName);
+    AsciiRecordParser parser(file.begin(), file.end(), 3);
+    Base::SequencerLauncher seq("Loading points...", parser.countSteps());
+
+    // allocate memory for all non-empty lines at once
+    std::size_t numLines = parser.countLines(seq);
+    points.clear();
+    points.resize(numLines);
+
+    Base::Matrix4D mat = points.getTransform();
+    mat.inverse();
+
+    // lines that don't start with three numbers, e.g. comments, are marked
+    // as invalid and removed afterwards
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<PointKernel::value_type>& kernel = points.getBasicPoints();
+    std::atomic<bool> invalid(false);
+    parser.parse(0, numLines, [&](std::size_t row, const double* values, std::size_t count) {
+        if (count == 3) {
+            Base::Vector3d pt = mat * Base::Vector3d(values[0], values[1], values[2]);
+            kernel[row].Set(static_cast<float>(pt.x), static_cast<float>(pt.y), static_cast<float>(pt.z));
         }
-    }
-    catch (...) {
-        points.clear();
-        throw Base::BadFormatError("Reading in points failed.");
-    }
+        else {
+            kernel[row].Set(nan, nan, nan);
+            invalid = true;
+        }
+        return true;
+    }, seq);
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    if (invalid) {
+        kernel.erase(std::remove_if(kernel.begin(), kernel.end(), [](const PointKernel::value_type& p) {
+            return boost::math::isnan(p.x);
+        }), kernel.end());
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -214,8 +803,6 @@ public:
     virtual ~Converter() {
     }
     virtual std::string toString(float) const = 0;
-    virtual double toDouble(Base::InputStream&) const = 0;
-    virtual int getSizeOf() const = 0;
 };
 template <typename T>
 class ConverterT : public Converter {
@@ -228,85 +815,10 @@ public:
         oss << c;
         return oss.str();
     }
-    virtual double toDouble(Base::InputStream& str) const {
-        T c;
-        str >> c;
-        return static_cast<double>(c);
-    }
-    virtual int getSizeOf() const {
-        return sizeof(T);
-    }
 };
 
 typedef std::shared_ptr<Converter> ConverterPtr;
 
-class DataStreambuf : public std::streambuf
-{
-public:
-    explicit DataStreambuf(const std::vector<char>& data) : _buffer(data) {
-        _beg = 0;
-        _end = data.size();
-        _cur = 0;
-    }
-    ~DataStreambuf() {
-    }
-
-protected:
-    virtual int_type uflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur++]) & 0x000000ff;
-    }
-    virtual int_type underflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur]) & 0x000000ff;
-    }
-    virtual int_type pbackfail(int_type ch) {
-        if (_cur == _beg || (ch != traits_type::eof() && ch != _buffer[_cur-1]))
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[--_cur]) & 0x000000ff;
-    }
-    virtual std::streamsize showmanyc() {
-        return _end - _cur;
-    }
-    virtual pos_type seekoff(std::streambuf::off_type off,
-        std::ios_base::seekdir way,
-        std::ios_base::openmode = 
-            std::ios::in | std::ios::out) {
-        int p_pos=-1;
-        if (way == std::ios_base::beg)
-            p_pos = _beg;
-        else if (way == std::ios_base::end)
-            p_pos = _end;
-        else if (way == std::ios_base::cur)
-            p_pos = _cur;
-
-        if (p_pos > _end)
-            return traits_type::eof();
-
-        if (((p_pos + off) > _end) || ((p_pos + off) < _beg))
-            return traits_type::eof();
-
-        _cur = p_pos+ off;
-
-        return ((p_pos+off) - _beg);
-    }
-    virtual pos_type seekpos(std::streambuf::pos_type pos,
-        std::ios_base::openmode which =
-        std::ios::in | std::ios::out) {
-        (void)which;
-        return seekoff(pos, std::ios_base::beg);
-    }
-
-private:
-    const std::vector<char>& _buffer;
-    int _beg, _end, _cur;
-};
-
 //Taken from https://github.com/PointCloudLibrary/pcl/blob/master/io/src/lzf.cpp
 unsigned int 
 lzfDecompress (const void *const in_data,  unsigned int in_len,
@@ -507,8 +1019,9 @@ void PlyReader::read(const std::string& filename)
     this->width = 1;
     this->height = 0;
 
-    Base::FileInfo fi(filename);
-    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+    MappedFile file(filename);
+    MemoryStreambuf buf(file.begin(), file.end());
+    std::istream inp(&buf);
 
     std::string format;
     std::vector<std::string> fields;
@@ -516,140 +1029,53 @@ void PlyReader::read(const std::string& filename)
     std::vector<int> sizes;
     std::size_t offset = 0;
     std::size_t numPoints = readHeader(inp, format, offset, fields, types, sizes);
+    std::streamoff header = inp.tellg();
+    if (header < 0)
+        throw Base::BadFormatError("Unexpected end of file");
 
-    Eigen::MatrixXd data(numPoints, fields.size());
-    if (format == "ascii") {
-        readAscii(inp, offset, data);
-    }
-    else if (format == "binary_little_endian") {
-        readBinary(false, inp, offset, types, sizes, data);
-    }
-    else if (format == "binary_big_endian") {
-        readBinary(true, inp, offset, types, sizes, data);
-    }
-
-    std::vector<std::string>::iterator it;
-    std::size_t max_size = std::numeric_limits<std::size_t>::max();
-
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
+    RecordStore store(fields, points, normals, intensity, colors);
+    if (!store.hasPoints())
+        return;
 
     // rgb(a) field
-    std::size_t red = max_size, green = max_size, blue = max_size, alpha = max_size;
-    it = std::find(fields.begin(), fields.end(), "red");
-    if (it != fields.end())
-        red = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "green");
-    if (it != fields.end())
-        green = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "blue");
-    if (it != fields.end())
-        blue = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "alpha");
-    if (it != fields.end())
-        alpha = std::distance(fields.begin(), it);
-
-    // transfer the data
-    bool hasData = (x != max_size && y != max_size && z != max_size);
-    bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
-    bool hasIntensity = (greyvalue != max_size);
-    bool hasColor = (red != max_size && green != max_size && blue != max_size);
-
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
-    }
-
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
+    std::size_t red = RecordStore::findField(fields, "red");
+    std::size_t green = RecordStore::findField(fields, "green");
+    std::size_t blue = RecordStore::findField(fields, "blue");
+    std::size_t alpha = RecordStore::findField(fields, "alpha");
+    if (red != RecordStore::NoField && green != RecordStore::NoField && blue != RecordStore::NoField) {
+        if (types[red] == "uchar")
+            store.setColors(RecordStore::ColorUChar, red, green, blue, alpha);
+        else if (types[red] == "float")
+            store.setColors(RecordStore::ColorFloat, red, green, blue, alpha);
+    }
+
+    // the records are directly decoded into the final arrays
+    store.resize(numPoints);
+    RecordHandler handler = [&store](std::size_t row, const double* values, std::size_t count) {
+        return store.store(row, values, count);
+    };
+
+    const char* data = file.begin() + header;
+    if (format == "ascii") {
+        AsciiRecordParser parser(data, file.end(), fields.size());
+        Base::SequencerLauncher seq("Reading points...", parser.countSteps());
+        if (parser.countLines(seq) < offset + numPoints)
+            throw Base::BadFormatError("File expects too many elements");
+        if (!parser.parse(offset, numPoints, handler, seq))
+            throw Base::BadFormatError("Invalid vertex data");
     }
+    else if (format == "binary_little_endian" || format == "binary_big_endian") {
+        std::vector<BinaryRecordDecoder::FieldType> fieldTypes;
+        for (std::vector<std::string>::iterator it = types.begin(); it != types.end(); ++it)
+            fieldTypes.push_back(BinaryRecordDecoder::fromPly(*it));
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
-    }
+        BinaryRecordDecoder decoder(fieldTypes, format == "binary_big_endian", false);
+        std::size_t available = static_cast<std::size_t>(file.end() - data);
+        if (offset > available || decoder.recordSize() * numPoints > available - offset)
+            throw Base::BadFormatError("File expects too many elements");
 
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        float a = 1.0;
-        if (types[red] == "uchar") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
-            }
-        }
-        else if (types[red] == "float") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(r, g, b, a);
-            }
-        }
+        Base::SequencerLauncher seq("Reading points...", decoder.countSteps(numPoints));
+        decoder.decode(data + offset, numPoints, handler, seq);
     }
 }
 
@@ -821,121 +1247,6 @@ std::size_t PlyReader::readHeader(std::istream& in,
     return numPoints;
 }
 
-void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        if (offset > 0) {
-            offset--;
-            continue;
-        }
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PlyReader::readBinary(bool swapByteOrder,
-                           std::istream& inp,
-                           std::size_t offset,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        std::string t = types[j];
-        switch (sizes[j]) {
-        case 1:
-            if (t == "char" || t == "int8")
-                converters.push_back(convert_int8);
-            else if (t == "uchar" || t == "uint8")
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == "short" || t == "int16")
-                converters.push_back(convert_int16);
-            else if (t == "ushort" || t == "uint16")
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == "int" || t == "int32")
-                converters.push_back(convert_int32);
-            else if (t == "uint" || t == "uint32")
-                converters.push_back(convert_uint32);
-            else if (t == "float" || t == "float32")
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == "double" || t == "float64")
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(static_cast<std::streamoff>(offset), std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    str.setByteOrder(swapByteOrder ? Base::Stream::BigEndian : Base::Stream::LittleEndian);
-    for (std::size_t i=0; i<numPoints; i++) {
-        for (std::size_t j=0; j<numFields; j++) {
-            double value = converters[j]->toDouble(str);
-            data(i, j) = value;
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 PcdReader::PcdReader()
@@ -952,161 +1263,85 @@ void PcdReader::read(const std::string& filename)
     this->width = -1;
     this->height = -1;
 
-    Base::FileInfo fi(filename);
-    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+    MappedFile file(filename);
+    MemoryStreambuf buf(file.begin(), file.end());
+    std::istream inp(&buf);
 
     std::string format;
     std::vector<std::string> fields;
     std::vector<std::string> types;
     std::vector<int> sizes;
     std::size_t numPoints = readHeader(inp, format, fields, types, sizes);
+    std::streamoff header = inp.tellg();
+    if (header < 0)
+        throw Base::BadFormatError("Unexpected end of file");
 
-    Eigen::MatrixXd data(numPoints, fields.size());
-    if (format == "ascii") {
-        readAscii(inp, data);
-    }
-    else if (format == "binary") {
-        readBinary(false, inp, types, sizes, data);
-    }
-    else if (format == "binary_compressed") {
-        unsigned int c, u;
-        Base::InputStream str(inp);
-        str >> c >> u;
-
-        std::vector<char> compressed(c);
-        inp.read(&compressed[0], c);
-        std::vector<char> uncompressed(u);
-        if (lzfDecompress(&compressed[0], c, &uncompressed[0], u) == u) {
-            DataStreambuf ibuf(uncompressed);
-            std::istream istr(0);
-            istr.rdbuf(&ibuf);
-            readBinary(true, istr, types, sizes, data);
-        }
-        else {
-            throw Base::BadFormatError("Failed to decompress binary data");
-        }
-    }
-
-    std::vector<std::string>::iterator it;
-    std::size_t max_size = std::numeric_limits<std::size_t>::max();
-
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
+    RecordStore store(fields, points, normals, intensity, colors);
+    if (!store.hasPoints())
+        return;
 
     // rgb(a) field
-    std::size_t rgba = max_size;
-    it = std::find(fields.begin(), fields.end(), "rgb");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "rgba");
-    if (it != fields.end())
-        rgba = std::distance(fields.begin(), it);
-
-    // transfer the data
-    bool hasData = (x != max_size && y != max_size && z != max_size);
-    bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
-    bool hasIntensity = (greyvalue != max_size);
-    bool hasColor = (rgba != max_size);
-
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+    std::size_t rgba = RecordStore::findField(fields, "rgb", "rgba");
+    if (rgba != RecordStore::NoField) {
+        if (types[rgba] == "U")
+            store.setColors(RecordStore::PackedUInt, rgba, rgba, rgba, RecordStore::NoField);
+        else if (types[rgba] == "F")
+            store.setColors(RecordStore::PackedFloat, rgba, rgba, rgba, RecordStore::NoField);
+    }
+
+    // the records are directly decoded into the final arrays
+    store.resize(numPoints);
+    RecordHandler handler = [&store](std::size_t row, const double* values, std::size_t count) {
+        return store.store(row, values, count);
+    };
+
+    const char* data = file.begin() + header;
+    std::size_t available = static_cast<std::size_t>(file.end() - data);
+    if (format == "ascii") {
+        AsciiRecordParser parser(data, file.end(), fields.size());
+        Base::SequencerLauncher seq("Reading points...", parser.countSteps());
+        if (parser.countLines(seq) < numPoints)
+            throw Base::BadFormatError("File expects too many elements");
+        if (!parser.parse(0, numPoints, handler, seq))
+            throw Base::BadFormatError("Invalid point data");
     }
+    else if (format == "binary" || format == "binary_compressed") {
+        std::vector<BinaryRecordDecoder::FieldType> fieldTypes;
+        for (std::size_t i = 0; i < types.size(); i++)
+            fieldTypes.push_back(BinaryRecordDecoder::fromPcd(types[i], sizes[i]));
 
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
-    }
+        if (format == "binary") {
+            BinaryRecordDecoder decoder(fieldTypes, false, false);
+            if (decoder.recordSize() * numPoints > available)
+                throw Base::BadFormatError("File expects too many elements");
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
+            Base::SequencerLauncher seq("Reading points...", decoder.countSteps(numPoints));
+            decoder.decode(data, numPoints, handler, seq);
         }
-    }
-
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        if (types[rgba] == "U") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                uint32_t packed = static_cast<uint32_t>(data(i,rgba));
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
+        else {
+            // the compressed data stores the values field by field
+            uint32_t c = 0, u = 0;
+            if (available < sizeof(c) + sizeof(u))
+                throw Base::BadFormatError("Unexpected end of file");
+            std::memcpy(&c, data, sizeof(c));
+            std::memcpy(&u, data + sizeof(c), sizeof(u));
+            if (Base::SwapOrder() == HIGH_ENDIAN) {
+                Base::SwapEndian(c);
+                Base::SwapEndian(u);
             }
-        }
-        else if (types[rgba] == "F") {
-            union RGBA {
-                uint32_t u;
-                float f;
-            };
+            if (c > available - sizeof(c) - sizeof(u))
+                throw Base::BadFormatError("File expects too many elements");
 
-            union RGBA v;
-            for (std::size_t i=0; i<numPoints; i++) {
-                v.f = static_cast<float>(data(i,rgba));
-                uint32_t packed = v.u;
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
-            }
+            BinaryRecordDecoder decoder(fieldTypes, false, true);
+            if (decoder.recordSize() * numPoints > u)
+                throw Base::BadFormatError("File expects too many elements");
+
+            std::vector<char> uncompressed(u);
+            if (u == 0 || lzfDecompress(data + sizeof(c) + sizeof(u), c, &uncompressed[0], u) != u)
+                throw Base::BadFormatError("Failed to decompress binary data");
+
+            Base::SequencerLauncher seq("Reading points...", decoder.countSteps(numPoints));
+            decoder.decode(&uncompressed[0], numPoints, handler, seq);
         }
     }
 }
@@ -1183,124 +1418,6 @@ std::size_t PcdReader::readHeader(std::istream& in,
     return points;
 }
 
-void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PcdReader::readBinary(bool transpose,
-                           std::istream& inp,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        char t = types[j][0];
-        switch (sizes[j]) {
-        case 1:
-            if (t == 'I')
-                converters.push_back(convert_int8);
-            else if (t == 'U')
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == 'I')
-                converters.push_back(convert_int16);
-            else if (t == 'U')
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == 'I')
-                converters.push_back(convert_int32);
-            else if (t == 'U')
-                converters.push_back(convert_uint32);
-            else if (t == 'F')
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == 'F')
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    if (transpose) {
-        for (std::size_t j=0; j<numFields; j++) {
-            for (std::size_t i=0; i<numPoints; i++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-    else {
-        for (std::size_t i=0; i<numPoints; i++) {
-            for (std::size_t j=0; j<numFields; j++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 Writer::Writer(const PointKernel& p) : points(p)
@@ -26,7 +26,6 @@
 
 #include "Points.h"
 #include "Properties.h"
-#include <Eigen/Core>
 
 namespace Points
 {
@@ -39,11 +38,17 @@ public:
     /** Load a point cloud
      */
     static void Load(PointKernel&, const char *FileName);
-    /** Load a point cloud
+    /** Load a point cloud from an ASCII file. The file is memory-mapped and
+     * split on line boundaries so that its lines are parsed by several threads.
      */
     static void LoadAscii(PointKernel&, const char *FileName);
 };
 
+/** Base class of the point cloud readers.
+ * The readers memory-map the file and decode the records in parallel directly
+ * into the point kernel and the property arrays. So, apart from the final data
+ * no further copy of the point cloud is kept in memory.
+ */
 class Reader
 {
 public:
@@ -91,11 +96,6 @@ private:
     std::size_t readHeader(std::istream&, std::string& format, std::size_t& offset,
         std::vector<std::string>& fields, std::vector<std::string>& types,
         std::vector<int>& sizes);
-    void readAscii(std::istream&, std::size_t offset, Eigen::MatrixXd& data);
-    void readBinary(bool swapByteOrder, std::istream&, std::size_t offset,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class PcdReader : public Reader
@@ -108,11 +108,6 @@ public:
 private:
     std::size_t readHeader(std::istream&, std::string& format, std::vector<std::string>& fields,
         std::vector<std::string>& types, std::vector<int>& sizes);
-    void readAscii(std::istream&, Eigen::MatrixXd& data);
-    void readBinary(bool transpose, std::istream&,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class Writer
@@ -25,6 +25,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 #endif
 #include <vector>
 
@@ -32,9 +33,11 @@
 #include <Base/Exception.h>
 #include <Base/Stream.h>
 #include <Base/Writer.h>
+#include <App/PropertyStandard.h>
 
 
 #include "PointsFeature.h"
+#include "Properties.h"
 
 using namespace Points;
 
@@ -94,6 +97,59 @@ void Feature::onChanged(const App::Property* prop)
     GeoFeature::onChanged(prop);
 }
 
+void Feature::removeIndices(const std::vector<unsigned long>& indices)
+{
+    std::vector<unsigned long> sorted = indices;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    // only properties that have a value for each point are adjusted
+    std::size_t numPoints = Points.getValue().size();
+    Points.removeIndices(sorted);
+
+    std::map<std::string,App::Property*> Map;
+    getPropertyMap(Map);
+
+    for (std::map<std::string,App::Property*>::iterator it = Map.begin(); it != Map.end(); ++it) {
+        Base::Type type = it->second->getTypeId();
+        if (type == PropertyNormalList::getClassTypeId()) {
+            PropertyNormalList* prop = static_cast<PropertyNormalList*>(it->second);
+            if (static_cast<std::size_t>(prop->getSize()) == numPoints)
+                prop->removeIndices(sorted);
+        }
+        else if (type == PropertyGreyValueList::getClassTypeId()) {
+            PropertyGreyValueList* prop = static_cast<PropertyGreyValueList*>(it->second);
+            if (static_cast<std::size_t>(prop->getSize()) == numPoints)
+                prop->removeIndices(sorted);
+        }
+        else if (type == PropertyCurvatureList::getClassTypeId()) {
+            PropertyCurvatureList* prop = static_cast<PropertyCurvatureList*>(it->second);
+            if (static_cast<std::size_t>(prop->getSize()) == numPoints)
+                prop->removeIndices(sorted);
+        }
+        else if (type == App::PropertyColorList::getClassTypeId()) {
+            App::PropertyColorList* prop = static_cast<App::PropertyColorList*>(it->second);
+            const std::vector<App::Color>& colors = prop->getValues();
+            if (colors.size() != numPoints)
+                continue;
+
+            std::vector<App::Color> remainValue;
+            remainValue.reserve(colors.size() - sorted.size());
+
+            std::vector<unsigned long>::iterator pos = sorted.begin();
+            for (std::vector<App::Color>::const_iterator jt = colors.begin(); jt != colors.end(); ++jt) {
+                unsigned long index = jt - colors.begin();
+                if (pos != sorted.end() && index == *pos)
+                    ++pos;
+                else
+                    remainValue.push_back(*jt);
+            }
+
+            prop->setValues(remainValue);
+        }
+    }
+}
+
 // ---------------------------------------------------------
 
 namespace App {
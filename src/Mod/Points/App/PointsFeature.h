@@ -77,6 +77,14 @@ protected:
     void onChanged(const App::Property* prop);
     //@}
 
+public:
+    /**
+     * Removes the points with the given indices. The per-point properties
+     * (normals, grey values, curvatures and colors) are shortened accordingly
+     * so that they stay aligned with the points.
+     */
+    void removeIndices(const std::vector<unsigned long>&);
+
 public:
     PropertyPointKernel Points; /**< The point kernel property. */
 };
@@ -0,0 +1,401 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+# include <limits>
+#endif
+
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <Eigen/Eigenvalues>
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Base/Converter.h>
+#include <Base/Exception.h>
+
+#include "PointsKDTree.h"
+#include "Points.h"
+
+using namespace Points;
+
+namespace {
+const std::size_t MaxLeafSize = 16;
+const std::size_t ChunkSize = 4096;
+
+typedef std::pair<std::size_t, std::size_t> Range;
+
+/// Splits [0, count) into ranges of ChunkSize for the worker threads
+std::vector<Range> makeChunks(std::size_t count)
+{
+    std::vector<Range> chunks;
+    chunks.reserve(count / ChunkSize + 1);
+    for (std::size_t first = 0; first < count; first += ChunkSize)
+        chunks.push_back(Range(first, std::min(first + ChunkSize, count)));
+    return chunks;
+}
+
+bool isValid(const Base::Vector3f& p)
+{
+    return !boost::math::isnan(p.x) && !boost::math::isnan(p.y) && !boost::math::isnan(p.z);
+}
+
+/// Orders the neighbours by distance, as heap the farthest is on top
+struct NearerNeighbour
+{
+    bool operator()(const KDTree::Neighbour& n1, const KDTree::Neighbour& n2) const
+    {
+        return n1.sqrDistance < n2.sqrDistance;
+    }
+};
+}
+
+KDTree::KDTree(const PointKernel& kernel)
+  : depth(0)
+{
+    items.reserve(kernel.size());
+    unsigned long index = 0;
+    for (PointKernel::const_iterator it = kernel.begin(); it != kernel.end(); ++it, ++index) {
+        Item item;
+        item.point = Base::convertTo<Base::Vector3f>(*it);
+        item.index = index;
+        if (isValid(item.point))
+            items.push_back(item);
+    }
+
+    build();
+}
+
+KDTree::KDTree(const std::vector<Base::Vector3f>& points)
+  : depth(0)
+{
+    items.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        Item item;
+        item.point = points[i];
+        item.index = static_cast<unsigned long>(i);
+        if (isValid(item.point))
+            items.push_back(item);
+    }
+
+    build();
+}
+
+KDTree::~KDTree()
+{
+}
+
+/**
+ * Builds the tree level by level. The nodes of a level work on disjoint ranges
+ * of the points and thus are handled in parallel.
+ */
+void KDTree::build()
+{
+    std::size_t count = items.size();
+    while ((count >> depth) > MaxLeafSize)
+        depth++;
+
+    std::size_t numNodes = (std::size_t(1) << depth) - 1;
+    splitValues.resize(numNodes);
+    splitAxes.resize(numNodes);
+
+    std::vector<Range> ranges(1, Range(0, count));
+    for (int level = 0; level < depth; level++) {
+        std::size_t firstNode = (std::size_t(1) << level) - 1;
+        std::vector<std::size_t> nodes(ranges.size());
+        for (std::size_t i = 0; i < nodes.size(); i++)
+            nodes[i] = i;
+
+        QtConcurrent::blockingMap(nodes, [this, &ranges, firstNode](std::size_t i) {
+            std::size_t begin = ranges[i].first;
+            std::size_t end = ranges[i].second;
+            std::size_t node = firstNode + i;
+            if (begin == end) {
+                splitAxes[node] = 0;
+                splitValues[node] = 0.0f;
+                return;
+            }
+
+            Base::Vector3f pmin = items[begin].point;
+            Base::Vector3f pmax = items[begin].point;
+            for (std::size_t j = begin + 1; j < end; j++) {
+                const Base::Vector3f& p = items[j].point;
+                pmin.x = std::min(pmin.x, p.x); pmax.x = std::max(pmax.x, p.x);
+                pmin.y = std::min(pmin.y, p.y); pmax.y = std::max(pmax.y, p.y);
+                pmin.z = std::min(pmin.z, p.z); pmax.z = std::max(pmax.z, p.z);
+            }
+
+            Base::Vector3f extent = pmax - pmin;
+            int axis = 0;
+            if (extent.y > extent.x)
+                axis = 1;
+            if (extent.z > extent[axis])
+                axis = 2;
+
+            std::size_t mid = (begin + end) / 2;
+            std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                             [axis](const Item& a, const Item& b) {
+                return a.point[axis] < b.point[axis];
+            });
+
+            splitAxes[node] = static_cast<unsigned char>(axis);
+            splitValues[node] = items[mid].point[axis];
+        });
+
+        std::vector<Range> next;
+        next.reserve(2 * ranges.size());
+        for (std::vector<Range>::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
+            std::size_t mid = (it->first + it->second) / 2;
+            next.push_back(Range(it->first, mid));
+            next.push_back(Range(mid, it->second));
+        }
+        ranges.swap(next);
+    }
+}
+
+void KDTree::searchNearest(std::size_t node, std::size_t begin, std::size_t end, int level,
+                           const Base::Vector3f& point, std::size_t k, float maxSqrDist,
+                           std::vector<Neighbour>& heap) const
+{
+    if (level == depth) {
+        for (std::size_t i = begin; i < end; i++) {
+            float dist = Base::DistanceP2(items[i].point, point);
+            float worst = heap.size() < k ? maxSqrDist : heap.front().sqrDistance;
+            if (dist < worst) {
+                if (heap.size() == k) {
+                    std::pop_heap(heap.begin(), heap.end(), NearerNeighbour());
+                    heap.pop_back();
+                }
+                Neighbour n;
+                n.index = items[i].index;
+                n.sqrDistance = dist;
+                heap.push_back(n);
+                std::push_heap(heap.begin(), heap.end(), NearerNeighbour());
+            }
+        }
+        return;
+    }
+
+    std::size_t mid = (begin + end) / 2;
+    float diff = point[splitAxes[node]] - splitValues[node];
+
+    // visit the side of the query point first
+    if (diff < 0.0f) {
+        searchNearest(2 * node + 1, begin, mid, level + 1, point, k, maxSqrDist, heap);
+        float worst = heap.size() < k ? maxSqrDist : heap.front().sqrDistance;
+        if (diff * diff < worst)
+            searchNearest(2 * node + 2, mid, end, level + 1, point, k, maxSqrDist, heap);
+    }
+    else {
+        searchNearest(2 * node + 2, mid, end, level + 1, point, k, maxSqrDist, heap);
+        float worst = heap.size() < k ? maxSqrDist : heap.front().sqrDistance;
+        if (diff * diff < worst)
+            searchNearest(2 * node + 1, begin, mid, level + 1, point, k, maxSqrDist, heap);
+    }
+}
+
+void KDTree::searchRadius(std::size_t node, std::size_t begin, std::size_t end, int level,
+                          const Base::Vector3f& point, float radius,
+                          std::vector<Neighbour>& result) const
+{
+    if (level == depth) {
+        float sqrRadius = radius * radius;
+        for (std::size_t i = begin; i < end; i++) {
+            float dist = Base::DistanceP2(items[i].point, point);
+            if (dist <= sqrRadius) {
+                Neighbour n;
+                n.index = items[i].index;
+                n.sqrDistance = dist;
+                result.push_back(n);
+            }
+        }
+        return;
+    }
+
+    std::size_t mid = (begin + end) / 2;
+    float diff = point[splitAxes[node]] - splitValues[node];
+    if (diff <= radius)
+        searchRadius(2 * node + 1, begin, mid, level + 1, point, radius, result);
+    if (diff >= -radius)
+        searchRadius(2 * node + 2, mid, end, level + 1, point, radius, result);
+}
+
+void KDTree::kNearest(const Base::Vector3f& point, int k, std::vector<Neighbour>& result,
+                      float maxDist) const
+{
+    result.clear();
+    if (k <= 0 || items.empty())
+        return;
+
+    float maxSqrDist = maxDist < FLT_MAX ? maxDist * maxDist : FLT_MAX;
+    searchNearest(0, 0, items.size(), 0, point, static_cast<std::size_t>(k), maxSqrDist, result);
+    std::sort_heap(result.begin(), result.end(), NearerNeighbour());
+}
+
+void KDTree::radiusSearch(const Base::Vector3f& point, float radius, std::vector<Neighbour>& result) const
+{
+    result.clear();
+    if (radius < 0.0f || items.empty())
+        return;
+
+    searchRadius(0, 0, items.size(), 0, point, radius, result);
+}
+
+void KDTree::kNearest(const std::vector<Base::Vector3f>& points, int k, std::vector<Neighbour>& result,
+                      float maxDist) const
+{
+    result.clear();
+    if (k <= 0)
+        return;
+
+    Neighbour none;
+    none.index = ULONG_MAX;
+    none.sqrDistance = FLT_MAX;
+    result.resize(points.size() * k, none);
+
+    std::vector<Range> chunks = makeChunks(points.size());
+    QtConcurrent::blockingMap(chunks, [this, &points, k, maxDist, &result](const Range& range) {
+        std::vector<Neighbour> found;
+        for (std::size_t i = range.first; i < range.second; i++) {
+            kNearest(points[i], k, found, maxDist);
+            std::copy(found.begin(), found.end(), result.begin() + i * k);
+        }
+    });
+}
+
+void KDTree::radiusSearch(const std::vector<Base::Vector3f>& points, float radius,
+                          std::vector<std::size_t>& offsets, std::vector<Neighbour>& result) const
+{
+    // each chunk collects its neighbours separately, they are joined afterwards
+    std::vector<Range> chunks = makeChunks(points.size());
+    std::vector<std::vector<Neighbour> > found(chunks.size());
+    std::vector<std::size_t> counts(points.size());
+
+    std::vector<std::size_t> chunkIndex(chunks.size());
+    for (std::size_t i = 0; i < chunkIndex.size(); i++)
+        chunkIndex[i] = i;
+
+    QtConcurrent::blockingMap(chunkIndex, [this, &points, radius, &chunks, &found, &counts](std::size_t c) {
+        std::vector<Neighbour> neighbours;
+        for (std::size_t i = chunks[c].first; i < chunks[c].second; i++) {
+            radiusSearch(points[i], radius, neighbours);
+            counts[i] = neighbours.size();
+            found[c].insert(found[c].end(), neighbours.begin(), neighbours.end());
+        }
+    });
+
+    offsets.resize(points.size() + 1);
+    offsets[0] = 0;
+    for (std::size_t i = 0; i < points.size(); i++)
+        offsets[i + 1] = offsets[i] + counts[i];
+
+    result.clear();
+    result.reserve(offsets.back());
+    for (std::vector<std::vector<Neighbour> >::iterator it = found.begin(); it != found.end(); ++it) {
+        result.insert(result.end(), it->begin(), it->end());
+        std::vector<Neighbour>().swap(*it);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+NormalEstimation::NormalEstimation(const PointKernel& kernel)
+  : kernel(kernel)
+  , kSearch(0)
+  , searchRadius(0)
+  , viewPoint(0.0f, 0.0f, 0.0f)
+{
+}
+
+void NormalEstimation::perform(std::vector<Base::Vector3f>& normals, std::vector<float>* curvature) const
+{
+    if (kSearch <= 0 && searchRadius <= 0)
+        throw Base::ValueError("Either the number of neighbours or the search radius must be set");
+
+    std::vector<Base::Vector3f> points;
+    points.reserve(kernel.size());
+    for (PointKernel::const_iterator it = kernel.begin(); it != kernel.end(); ++it)
+        points.push_back(Base::convertTo<Base::Vector3f>(*it));
+
+    KDTree tree(points);
+
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    normals.assign(points.size(), Base::Vector3f(nan, nan, nan));
+    if (curvature)
+        curvature->assign(points.size(), nan);
+
+    int k = kSearch;
+    float radius = searchRadius > 0 ? static_cast<float>(searchRadius) : FLT_MAX;
+    Base::Vector3f vp = viewPoint;
+
+    std::vector<Range> chunks = makeChunks(points.size());
+    QtConcurrent::blockingMap(chunks, [&](const Range& range) {
+        std::vector<KDTree::Neighbour> neighbours;
+        for (std::size_t i = range.first; i < range.second; i++) {
+            const Base::Vector3f& pnt = points[i];
+            if (!isValid(pnt))
+                continue;
+
+            if (k > 0)
+                tree.kNearest(pnt, k, neighbours, radius);
+            else
+                tree.radiusSearch(pnt, radius, neighbours);
+            if (neighbours.size() < 3)
+                continue;
+
+            Eigen::Vector3d center(0.0, 0.0, 0.0);
+            for (std::vector<KDTree::Neighbour>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+                const Base::Vector3f& p = points[it->index];
+                center += Eigen::Vector3d(p.x, p.y, p.z);
+            }
+            center /= static_cast<double>(neighbours.size());
+
+            Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+            for (std::vector<KDTree::Neighbour>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+                const Base::Vector3f& p = points[it->index];
+                Eigen::Vector3d d = Eigen::Vector3d(p.x, p.y, p.z) - center;
+                cov += d * d.transpose();
+            }
+
+            // the eigenvalues are sorted in increasing order
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+            solver.computeDirect(cov);
+            Eigen::Vector3d n = solver.eigenvectors().col(0);
+            Base::Vector3f normal(static_cast<float>(n.x()), static_cast<float>(n.y()), static_cast<float>(n.z()));
+            if (normal * (vp - pnt) < 0.0f)
+                normal = -normal;
+            normals[i] = normal;
+
+            if (curvature) {
+                Eigen::Vector3d ev = solver.eigenvalues();
+                double sum = ev.sum();
+                (*curvature)[i] = sum > 0.0 ? static_cast<float>(ev[0] / sum) : 0.0f;
+            }
+        }
+    });
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef POINTS_KDTREE_H
+#define POINTS_KDTREE_H
+
+#include <cfloat>
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace Points
+{
+
+class PointKernel;
+
+/**
+ * The KDTree class is a k-d tree over the points of a point cloud to search
+ * for the nearest neighbours of a point or for the points inside a sphere.
+ *
+ * The tree is balanced: each node splits its points at the median along the
+ * axis of the largest extent. Thus, the nodes need not be stored explicitly and
+ * the nodes of one level can be built in parallel. Once built the tree is
+ * read-only and can be queried by several threads at the same time.
+ *
+ * Points with NaN coordinates are not added to the tree. The found points are
+ * identified by their index in the point cloud.
+ */
+class PointsExport KDTree
+{
+public:
+    /// A point found by a query
+    struct Neighbour
+    {
+        /// The index of the point, ULONG_MAX if there is no point
+        unsigned long index;
+        float sqrDistance;
+    };
+
+    /// Builds the tree for the transformed points of the kernel
+    explicit KDTree(const PointKernel&);
+    explicit KDTree(const std::vector<Base::Vector3f>&);
+    ~KDTree();
+
+    /// The number of points in the tree
+    std::size_t size() const
+    { return items.size(); }
+
+    /** @name Single queries */
+    //@{
+    /**
+     * Searches for the \a k points nearest to \a point with a distance less
+     * than \a maxDist. The result is sorted by increasing distance.
+     */
+    void kNearest(const Base::Vector3f& point, int k, std::vector<Neighbour>& result,
+                  float maxDist = FLT_MAX) const;
+    /// Searches for the points inside the sphere, the result is not sorted
+    void radiusSearch(const Base::Vector3f& point, float radius, std::vector<Neighbour>& result) const;
+    //@}
+
+    /** @name Batched queries
+     * The queries are distributed over several threads.
+     */
+    //@{
+    /**
+     * Searches for the \a k nearest points of each query point. The result
+     * holds \a k entries per query point where missing neighbours have the
+     * index ULONG_MAX.
+     */
+    void kNearest(const std::vector<Base::Vector3f>& points, int k, std::vector<Neighbour>& result,
+                  float maxDist = FLT_MAX) const;
+    /**
+     * Searches for the points inside the sphere around each query point. The
+     * neighbours of the i-th query point are in the range [offsets[i], offsets[i+1])
+     * of \a result.
+     */
+    void radiusSearch(const std::vector<Base::Vector3f>& points, float radius,
+                      std::vector<std::size_t>& offsets, std::vector<Neighbour>& result) const;
+    //@}
+
+private:
+    struct Item
+    {
+        Base::Vector3f point;
+        unsigned long index;
+    };
+
+    void build();
+    void searchNearest(std::size_t node, std::size_t begin, std::size_t end, int level,
+                       const Base::Vector3f& point, std::size_t k, float maxSqrDist,
+                       std::vector<Neighbour>& heap) const;
+    void searchRadius(std::size_t node, std::size_t begin, std::size_t end, int level,
+                      const Base::Vector3f& point, float radius,
+                      std::vector<Neighbour>& result) const;
+
+private:
+    /// The points in the order of the leaves
+    std::vector<Item> items;
+    /// The split planes of the inner nodes, the children of node i are 2i+1 and 2i+2
+    std::vector<float> splitValues;
+    std::vector<unsigned char> splitAxes;
+    /// The level of the leaves
+    int depth;
+};
+
+/**
+ * The NormalEstimation class estimates the normal and the curvature of each
+ * point of a point cloud by a principal component analysis of its neighbourhood.
+ * The neighbourhood is either given by the k nearest neighbours, by a search
+ * radius or by both. The points are processed in parallel.
+ */
+class PointsExport NormalEstimation
+{
+public:
+    explicit NormalEstimation(const PointKernel&);
+
+    /// Sets the number of nearest neighbours to use
+    void setKSearch(int k)
+    { kSearch = k; }
+    /// Sets the radius of the sphere that contains the neighbours
+    void setSearchRadius(double radius)
+    { searchRadius = radius; }
+    /// The normals are oriented towards the view point, the default is the origin
+    void setViewPoint(const Base::Vector3f& pnt)
+    { viewPoint = pnt; }
+
+    /**
+     * Computes the normals and optionally the curvature of all points. The
+     * curvature is estimated by the surface variation l0/(l0+l1+l2) of the
+     * eigenvalues of the covariance matrix. Points with less than three
+     * neighbours or with NaN coordinates get NaN values.
+     */
+    void perform(std::vector<Base::Vector3f>& normals, std::vector<float>* curvature = nullptr) const;
+
+private:
+    const PointKernel& kernel;
+    int kSearch;
+    double searchRadius;
+    Base::Vector3f viewPoint;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_KDTREE_H
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsSampling.h"
 #include <Base/Builder3D.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
@@ -227,6 +228,54 @@ PyObject* PointsPy::fromValid(PyObject * args)
     }
 }
 
+namespace {
+Py::Tuple toTuple(const std::vector<unsigned long>& indices)
+{
+    Py::Tuple tuple(indices.size());
+    for (std::size_t i = 0; i < indices.size(); i++)
+        tuple.setItem(i, Py::Long(indices[i]));
+    return tuple;
+}
+}
+
+PyObject* PointsPy::voxelGridSampling(PyObject * args)
+{
+    double size;
+    if (!PyArg_ParseTuple(args, "d", &size))
+        return 0;
+
+    PY_TRY {
+        Sampling sampling(*getPointKernelPtr());
+        return Py::new_reference_to(toTuple(sampling.voxelGrid(size)));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::randomSampling(PyObject * args)
+{
+    unsigned long count;
+    unsigned int seed = 0;
+    if (!PyArg_ParseTuple(args, "k|I", &count, &seed))
+        return 0;
+
+    PY_TRY {
+        Sampling sampling(*getPointKernelPtr());
+        return Py::new_reference_to(toTuple(sampling.random(count, seed)));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::poissonDiskSampling(PyObject * args)
+{
+    double radius;
+    unsigned int seed = 0;
+    if (!PyArg_ParseTuple(args, "d|I", &radius, &seed))
+        return 0;
+
+    PY_TRY {
+        Sampling sampling(*getPointKernelPtr());
+        return Py::new_reference_to(toTuple(sampling.poissonDisk(radius, seed)));
+    } PY_CATCH;
+}
+
 Py::Long PointsPy::getCountPoints(void) const
 {
     return Py::Long((long)getPointKernelPtr()->size());
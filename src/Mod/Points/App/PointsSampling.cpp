@@ -0,0 +1,367 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstdint>
+# include <random>
+# include <unordered_map>
+#endif
+
+#include <QtConcurrentMap>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Base/BoundBox.h>
+#include <Base/Exception.h>
+
+#include "PointsSampling.h"
+#include "Points.h"
+
+using namespace Points;
+
+namespace {
+const std::size_t ChunkSize = 65536;
+const uint64_t InvalidKey = UINT64_MAX;
+/// The number of bits of a cell coordinate in a key
+const int KeyBits = 21;
+
+typedef std::pair<std::size_t, std::size_t> Range;
+
+std::vector<Range> makeChunks(std::size_t count)
+{
+    std::vector<Range> chunks;
+    chunks.reserve(count / ChunkSize + 1);
+    for (std::size_t first = 0; first < count; first += ChunkSize)
+        chunks.push_back(Range(first, std::min(first + ChunkSize, count)));
+    return chunks;
+}
+
+bool isValid(const Base::Vector3f& p)
+{
+    return !boost::math::isnan(p.x) && !boost::math::isnan(p.y) && !boost::math::isnan(p.z);
+}
+
+/**
+ * A regular grid of cubes over the bounding box of the points. A cell is
+ * identified by a key that packs its three coordinates.
+ */
+class CellGrid
+{
+public:
+    CellGrid(const std::vector<Base::Vector3f>& points, double size)
+      : size(static_cast<float>(size))
+    {
+        Base::BoundBox3f box;
+        for (std::vector<Base::Vector3f>::const_iterator it = points.begin(); it != points.end(); ++it) {
+            if (isValid(*it))
+                box.Add(*it);
+        }
+
+        empty = !box.IsValid();
+        if (empty)
+            return;
+
+        origin.Set(box.MinX, box.MinY, box.MinZ);
+        // keep a margin for the neighbours of the outer cells
+        double limit = static_cast<double>((1 << KeyBits) - 2);
+        if (box.LengthX() / size >= limit || box.LengthY() / size >= limit || box.LengthZ() / size >= limit)
+            throw Base::ValueError("The cell size is too small for the extent of the point cloud");
+    }
+
+    bool isEmpty() const
+    { return empty; }
+    uint64_t key(const Base::Vector3f& p) const
+    {
+        if (!isValid(p))
+            return InvalidKey;
+        uint64_t x = static_cast<uint64_t>((p.x - origin.x) / size);
+        uint64_t y = static_cast<uint64_t>((p.y - origin.y) / size);
+        uint64_t z = static_cast<uint64_t>((p.z - origin.z) / size);
+        return pack(x, y, z);
+    }
+    static uint64_t pack(uint64_t x, uint64_t y, uint64_t z)
+    {
+        return x | (y << KeyBits) | (z << (2 * KeyBits));
+    }
+    static void unpack(uint64_t key, int64_t cell[3])
+    {
+        const uint64_t mask = (uint64_t(1) << KeyBits) - 1;
+        cell[0] = static_cast<int64_t>(key & mask);
+        cell[1] = static_cast<int64_t>((key >> KeyBits) & mask);
+        cell[2] = static_cast<int64_t>((key >> (2 * KeyBits)) & mask);
+    }
+    Base::Vector3f center(uint64_t key) const
+    {
+        int64_t cell[3];
+        unpack(key, cell);
+        return Base::Vector3f(origin.x + (cell[0] + 0.5f) * size,
+                              origin.y + (cell[1] + 0.5f) * size,
+                              origin.z + (cell[2] + 0.5f) * size);
+    }
+
+private:
+    Base::Vector3f origin;
+    float size;
+    bool empty;
+};
+
+/// The point of a voxel nearest to its center
+struct Candidate
+{
+    float sqrDistance;
+    unsigned long index;
+
+    bool isBetter(const Candidate& c) const
+    {
+        return sqrDistance < c.sqrDistance || (sqrDistance == c.sqrDistance && index < c.index);
+    }
+};
+
+typedef std::unordered_map<uint64_t, Candidate> VoxelMap;
+}
+
+Sampling::Sampling(const PointKernel& kernel)
+  : kernel(kernel)
+{
+}
+
+/**
+ * Each chunk of points fills its own map of voxels in parallel, afterwards the
+ * maps are merged. Thus, the time is linear in the number of points.
+ */
+std::vector<unsigned long> Sampling::voxelGrid(double size) const
+{
+    if (size <= 0.0)
+        throw Base::ValueError("The voxel size must be positive");
+
+    const std::vector<Base::Vector3f>& points = kernel.getBasicPoints();
+    CellGrid grid(points, size);
+    if (grid.isEmpty())
+        return std::vector<unsigned long>();
+
+    std::vector<Range> chunks = makeChunks(points.size());
+    std::vector<VoxelMap> voxels(chunks.size());
+    std::vector<std::size_t> chunkIndex(chunks.size());
+    for (std::size_t i = 0; i < chunkIndex.size(); i++)
+        chunkIndex[i] = i;
+
+    QtConcurrent::blockingMap(chunkIndex, [&](std::size_t c) {
+        VoxelMap& map = voxels[c];
+        for (std::size_t i = chunks[c].first; i < chunks[c].second; i++) {
+            uint64_t key = grid.key(points[i]);
+            if (key == InvalidKey)
+                continue;
+
+            Candidate cand;
+            cand.sqrDistance = Base::DistanceP2(points[i], grid.center(key));
+            cand.index = static_cast<unsigned long>(i);
+            std::pair<VoxelMap::iterator, bool> it = map.insert(std::make_pair(key, cand));
+            if (!it.second && cand.isBetter(it.first->second))
+                it.first->second = cand;
+        }
+    });
+
+    VoxelMap merged;
+    for (std::vector<VoxelMap>::iterator jt = voxels.begin(); jt != voxels.end(); ++jt) {
+        for (VoxelMap::const_iterator it = jt->begin(); it != jt->end(); ++it) {
+            std::pair<VoxelMap::iterator, bool> kt = merged.insert(*it);
+            if (!kt.second && it->second.isBetter(kt.first->second))
+                kt.first->second = it->second;
+        }
+        VoxelMap().swap(*jt);
+    }
+
+    std::vector<unsigned long> indices;
+    indices.reserve(merged.size());
+    for (VoxelMap::const_iterator it = merged.begin(); it != merged.end(); ++it)
+        indices.push_back(it->second.index);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+/**
+ * Uses selection sampling so that the points are chosen in a single pass in
+ * their original order.
+ */
+std::vector<unsigned long> Sampling::random(std::size_t count, unsigned int seed) const
+{
+    const std::vector<Base::Vector3f>& points = kernel.getBasicPoints();
+    std::size_t numValid = 0;
+    for (std::vector<Base::Vector3f>::const_iterator it = points.begin(); it != points.end(); ++it) {
+        if (isValid(*it))
+            numValid++;
+    }
+
+    count = std::min(count, numValid);
+    std::vector<unsigned long> indices;
+    indices.reserve(count);
+
+    std::mt19937 gen(seed);
+    std::size_t remaining = numValid;
+    for (std::size_t i = 0; i < points.size() && indices.size() < count; i++) {
+        if (!isValid(points[i]))
+            continue;
+        std::uniform_int_distribution<std::size_t> dist(0, remaining - 1);
+        if (dist(gen) < count - indices.size())
+            indices.push_back(static_cast<unsigned long>(i));
+        remaining--;
+    }
+
+    return indices;
+}
+
+/**
+ * The points are sorted into cells with a diagonal of \a radius, so that each
+ * cell holds at most one sample and the samples near a point are in the
+ * neighbouring cells with a distance of up to two cells. The cells are
+ * processed in 27 passes where the cells of a pass are at least three cells
+ * apart and thus can be handled in parallel.
+ */
+std::vector<unsigned long> Sampling::poissonDisk(double radius, unsigned int seed) const
+{
+    if (radius <= 0.0)
+        throw Base::ValueError("The radius must be positive");
+
+    const std::vector<Base::Vector3f>& points = kernel.getBasicPoints();
+    CellGrid grid(points, radius / std::sqrt(3.0));
+    if (grid.isEmpty())
+        return std::vector<unsigned long>();
+
+    // compute the cell of each point
+    std::vector<uint64_t> keys(points.size());
+    std::vector<Range> chunks = makeChunks(points.size());
+    QtConcurrent::blockingMap(chunks, [&](const Range& range) {
+        for (std::size_t i = range.first; i < range.second; i++)
+            keys[i] = grid.key(points[i]);
+    });
+
+    // sort the points into the cells by counting
+    std::unordered_map<uint64_t, std::size_t> cells;
+    std::vector<uint64_t> cellKeys;
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == InvalidKey)
+            continue;
+        std::pair<std::unordered_map<uint64_t, std::size_t>::iterator, bool> it =
+            cells.insert(std::make_pair(keys[i], cellKeys.size()));
+        if (it.second) {
+            cellKeys.push_back(keys[i]);
+            offsets.push_back(0);
+        }
+        offsets[it.first->second]++;
+    }
+
+    std::size_t numCells = cellKeys.size();
+    std::size_t sum = 0;
+    for (std::size_t c = 0; c < numCells; c++) {
+        std::size_t num = offsets[c];
+        offsets[c] = sum;
+        sum += num;
+    }
+    offsets.push_back(sum);
+
+    std::vector<unsigned long> members(sum);
+    std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == InvalidKey)
+            continue;
+        members[fill[cells[keys[i]]]++] = static_cast<unsigned long>(i);
+    }
+    std::vector<uint64_t>().swap(keys);
+    std::vector<std::size_t>().swap(fill);
+
+    // group the cells into passes
+    std::vector<std::vector<std::size_t> > passes(27);
+    for (std::size_t c = 0; c < numCells; c++) {
+        int64_t cell[3];
+        CellGrid::unpack(cellKeys[c], cell);
+        passes[(cell[0] % 3) * 9 + (cell[1] % 3) * 3 + (cell[2] % 3)].push_back(c);
+    }
+
+    const long NoSample = -1;
+    std::vector<long> samples(numCells, NoSample);
+    float sqrRadius = static_cast<float>(radius * radius);
+
+    for (std::vector<std::vector<std::size_t> >::iterator pass = passes.begin(); pass != passes.end(); ++pass) {
+        QtConcurrent::blockingMap(*pass, [&](std::size_t c) {
+            // try the points of the cell in a random order
+            std::vector<unsigned long> candidates(members.begin() + offsets[c], members.begin() + offsets[c+1]);
+            std::mt19937 gen(static_cast<unsigned int>(seed ^ cellKeys[c] ^ (cellKeys[c] >> 32)));
+            std::shuffle(candidates.begin(), candidates.end(), gen);
+
+            int64_t cell[3];
+            CellGrid::unpack(cellKeys[c], cell);
+
+            for (std::vector<unsigned long>::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+                const Base::Vector3f& p = points[*it];
+                bool accept = true;
+                for (int64_t dx = -2; dx <= 2 && accept; dx++) {
+                    for (int64_t dy = -2; dy <= 2 && accept; dy++) {
+                        for (int64_t dz = -2; dz <= 2 && accept; dz++) {
+                            int64_t x = cell[0] + dx, y = cell[1] + dy, z = cell[2] + dz;
+                            if (x < 0 || y < 0 || z < 0)
+                                continue;
+                            std::unordered_map<uint64_t, std::size_t>::const_iterator jt =
+                                cells.find(CellGrid::pack(x, y, z));
+                            if (jt == cells.end())
+                                continue;
+                            long sample = samples[jt->second];
+                            if (sample != NoSample && Base::DistanceP2(points[sample], p) < sqrRadius)
+                                accept = false;
+                        }
+                    }
+                }
+
+                if (accept) {
+                    samples[c] = static_cast<long>(*it);
+                    break;
+                }
+            }
+        });
+    }
+
+    std::vector<unsigned long> indices;
+    for (std::vector<long>::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+        if (*it != NoSample)
+            indices.push_back(static_cast<unsigned long>(*it));
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+std::vector<unsigned long> Sampling::complement(const std::vector<unsigned long>& indices, std::size_t size)
+{
+    std::vector<unsigned long> result;
+    result.reserve(size > indices.size() ? size - indices.size() : 0);
+    std::vector<unsigned long>::const_iterator pos = indices.begin();
+    for (std::size_t i = 0; i < size; i++) {
+        if (pos != indices.end() && *pos == i)
+            ++pos;
+        else
+            result.push_back(static_cast<unsigned long>(i));
+    }
+    return result;
+}
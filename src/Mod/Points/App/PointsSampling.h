@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_SAMPLING_H
+#define POINTS_SAMPLING_H
+
+#include <vector>
+
+namespace Points
+{
+
+class PointKernel;
+
+/**
+ * The Sampling class thins out a point cloud. Each method returns the sorted
+ * indices of the points to keep. Points with NaN coordinates are never kept.
+ * To remove the other points together with the per-point properties of a
+ * feature use Feature::removeIndices() with the complement.
+ */
+class PointsExport Sampling
+{
+public:
+    explicit Sampling(const PointKernel&);
+
+    /**
+     * Divides the bounding box into cubes of edge length \a size and keeps
+     * of each occupied cube the point nearest to its center.
+     */
+    std::vector<unsigned long> voxelGrid(double size) const;
+    /// Keeps \a count randomly chosen points
+    std::vector<unsigned long> random(std::size_t count, unsigned int seed = 0) const;
+    /**
+     * Keeps a subset of the points where no two points are closer than
+     * \a radius while each removed point has a kept point within \a radius.
+     * The points are tried in a random order.
+     */
+    std::vector<unsigned long> poissonDisk(double radius, unsigned int seed = 0) const;
+
+    /// Returns the indices in [0, size) that are not in the sorted list \a indices
+    static std::vector<unsigned long> complement(const std::vector<unsigned long>& indices, std::size_t size);
+
+private:
+    const PointKernel& kernel;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_SAMPLING_H
@@ -149,7 +149,7 @@ void PropertyPointKernel::Paste(const App::Property &from)
 
 unsigned int PropertyPointKernel::getMemSize (void) const
 {
-    return sizeof(Base::Vector3f) * this->_cPoints->size();
+    return this->_cPoints->getMemSize();
 }
 
 PointKernel* PropertyPointKernel::startEditing()
@@ -29,6 +29,7 @@
 #include <CXX/Objects.hxx>
 
 #include "ViewProvider.h"
+#include "SoFCPointCloudLOD.h"
 #include "Workbench.h"
 
 #include <Base/Console.h>
@@ -92,6 +93,7 @@ PyMOD_INIT_FUNC(PointsGui)
     // instantiating the commands
     CreatePointsCommands();
 
+    PointsGui::SoFCPointCloudLOD        ::initClass();
     PointsGui::ViewProviderPoints       ::init();
     PointsGui::ViewProviderScattered    ::init();
     PointsGui::ViewProviderStructured   ::init();
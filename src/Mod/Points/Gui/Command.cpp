@@ -24,6 +24,8 @@
 #include "PreCompiled.h"
 #ifndef _PreComp_
 # include <algorithm>
+# include <cfloat>
+# include <climits>
 # include <QFileInfo>
 # include <QInputDialog>
 # include <Python.h>
@@ -49,6 +51,7 @@
 #include "../App/PointsFeature.h"
 #include "../App/Structured.h"
 #include "../App/Properties.h"
+#include "../App/PointsSampling.h"
 #include "DlgPointsReadImp.h"
 #include "ViewProvider.h"
 
@@ -462,6 +465,88 @@ bool CmdPointsStructure::isActive(void)
     return getSelection().countObjectsOfType(Points::Feature::getClassTypeId()) == 1;
 }
 
+DEF_STD_CMD_A(CmdPointsDownsample)
+
+CmdPointsDownsample::CmdPointsDownsample()
+  :Command("Points_Downsample")
+{
+    sAppModule    = "Points";
+    sGroup        = QT_TR_NOOP("Points");
+    sMenuText     = QT_TR_NOOP("Downsample point cloud...");
+    sToolTipText  = QT_TR_NOOP("Reduces the number of points of a point cloud");
+    sWhatsThis    = "Points_Downsample";
+    sStatusTip    = QT_TR_NOOP("Reduces the number of points of a point cloud");
+}
+
+void CmdPointsDownsample::activated(int iMsg)
+{
+    Q_UNUSED(iMsg);
+
+    QStringList methods;
+    methods << QObject::tr("Voxel grid")
+            << QObject::tr("Poisson disk")
+            << QObject::tr("Random");
+
+    bool ok;
+    QString method = QInputDialog::getItem(Gui::getMainWindow(), QObject::tr("Downsample"),
+        QObject::tr("Sampling method:"), methods, 0, false, &ok, Qt::MSWindowsFixedSizeDialogHint);
+    if (!ok)
+        return;
+
+    std::vector<App::DocumentObject*> docObj = Gui::Selection().getObjectsOfType(Points::Feature::getClassTypeId());
+
+    // propose values based on the first selected point cloud
+    const Points::PointKernel& first = static_cast<Points::Feature*>(docObj.front())->Points.getValue();
+    double size = 0;
+    int count = 0;
+    if (method == methods[2]) {
+        count = QInputDialog::getInt(Gui::getMainWindow(), QObject::tr("Downsample"),
+            QObject::tr("Number of points:"), static_cast<int>(first.size() / 10), 1, INT_MAX, 1,
+            &ok, Qt::MSWindowsFixedSizeDialogHint);
+    }
+    else {
+        double length = first.getBoundBox().CalcDiagonalLength();
+        size = QInputDialog::getDouble(Gui::getMainWindow(), QObject::tr("Downsample"),
+            method == methods[0] ? QObject::tr("Voxel size:") : QObject::tr("Minimum distance:"),
+            length / 100.0, 0.0, DBL_MAX, 4, &ok, Qt::MSWindowsFixedSizeDialogHint);
+    }
+    if (!ok)
+        return;
+
+    Gui::WaitCursor wc;
+    openCommand(QT_TRANSLATE_NOOP("Command", "Downsample points"));
+    try {
+        for (std::vector<App::DocumentObject*>::iterator it = docObj.begin(); it != docObj.end(); ++it) {
+            Points::Feature* fea = static_cast<Points::Feature*>(*it);
+            const Points::PointKernel& kernel = fea->Points.getValue();
+            Points::Sampling sampling(kernel);
+
+            std::vector<unsigned long> keep;
+            if (method == methods[0])
+                keep = sampling.voxelGrid(size);
+            else if (method == methods[1])
+                keep = sampling.poissonDisk(size);
+            else
+                keep = sampling.random(static_cast<std::size_t>(count));
+
+            // the per-point properties are adjusted by the feature
+            fea->removeIndices(Points::Sampling::complement(keep, kernel.size()));
+            fea->purgeTouched();
+        }
+
+        commitCommand();
+    }
+    catch (const Base::Exception& e) {
+        abortCommand();
+        e.ReportException();
+    }
+}
+
+bool CmdPointsDownsample::isActive(void)
+{
+    return getSelection().countObjectsOfType(Points::Feature::getClassTypeId()) > 0;
+}
+
 void CreatePointsCommands(void)
 {
     Gui::CommandManager &rcCmdMgr = Gui::Application::Instance->commandManager();
@@ -472,4 +557,5 @@ void CreatePointsCommands(void)
     rcCmdMgr.addCommand(new CmdPointsPolyCut());
     rcCmdMgr.addCommand(new CmdPointsMerge());
     rcCmdMgr.addCommand(new CmdPointsStructure());
+    rcCmdMgr.addCommand(new CmdPointsDownsample());
 }
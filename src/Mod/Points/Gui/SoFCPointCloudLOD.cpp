@@ -0,0 +1,436 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <cmath>
+# include <queue>
+# ifdef FC_OS_WIN32
+# include <windows.h>
+# endif
+# ifdef FC_OS_MACOSX
+# include <OpenGL/gl.h>
+# else
+# include <GL/gl.h>
+# endif
+# include <Inventor/SbViewVolume.h>
+# include <Inventor/SbViewportRegion.h>
+# include <Inventor/actions/SoGetPrimitiveCountAction.h>
+# include <Inventor/actions/SoGLRenderAction.h>
+# include <Inventor/bundles/SoMaterialBundle.h>
+# include <Inventor/details/SoPointDetail.h>
+# include <Inventor/elements/SoCacheElement.h>
+# include <Inventor/elements/SoGLLazyElement.h>
+# include <Inventor/elements/SoMaterialBindingElement.h>
+# include <Inventor/elements/SoModelMatrixElement.h>
+# include <Inventor/elements/SoViewportRegionElement.h>
+# include <Inventor/elements/SoViewVolumeElement.h>
+# include <Inventor/misc/SoState.h>
+# include <Inventor/SoPrimitiveVertex.h>
+#endif
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Mod/Points/App/Points.h>
+
+#include "SoFCPointCloudLOD.h"
+
+using namespace PointsGui;
+
+namespace {
+/// The maximum number of points of a leaf and of the subsample of an inner node
+const std::size_t LeafSize = 4096;
+const int MaxDepth = 21;
+}
+
+SO_NODE_SOURCE(SoFCPointCloudLOD)
+
+void SoFCPointCloudLOD::initClass()
+{
+    SO_NODE_INIT_CLASS(SoFCPointCloudLOD, SoShape, "Shape");
+}
+
+SoFCPointCloudLOD::SoFCPointCloudLOD()
+  : colorNodeId(0)
+  , numPoints(0)
+{
+    SO_NODE_CONSTRUCTOR(SoFCPointCloudLOD);
+    SO_NODE_ADD_FIELD(pointBudget, (2000000));
+    SO_NODE_ADD_FIELD(screenError, (1.0f));
+}
+
+SoFCPointCloudLOD::~SoFCPointCloudLOD()
+{
+}
+
+void SoFCPointCloudLOD::setPoints(const Points::PointKernel& kernel)
+{
+    nodes.clear();
+    vertices.clear();
+    colors.clear();
+    visible.clear();
+    colorNodeId = 0;
+    numPoints = kernel.size();
+
+    std::vector<Vertex> input;
+    input.reserve(numPoints);
+    auto addPoints = [&input](std::size_t first, const Base::Vector3f* points, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            const Base::Vector3f& p = points[i];
+            if (boost::math::isnan(p.x) || boost::math::isnan(p.y) || boost::math::isnan(p.z))
+                continue;
+            Vertex v;
+            v.point.setValue(p.x, p.y, p.z);
+            v.index = static_cast<uint32_t>(first + i);
+            input.push_back(v);
+        }
+    };
+
+    // a paged kernel is read page by page so that it is not loaded completely
+    if (const Points::PagedPointStore* store = kernel.getPagedStore()) {
+        store->visit(addPoints);
+    }
+    else {
+        const std::vector<Points::PointKernel::value_type>& points = kernel.getBasicPoints();
+        addPoints(0, points.data(), points.size());
+    }
+
+    vertices.swap(input);
+    if (!vertices.empty()) {
+        SbBox3f box;
+        for (std::vector<Vertex>::const_iterator it = vertices.begin(); it != vertices.end(); ++it)
+            box.extendBy(it->point);
+
+        // use a cube as root cell so that the cells of all levels are cubes
+        float size = 0.5f * std::max(std::max(box.getMax()[0] - box.getMin()[0],
+                                              box.getMax()[1] - box.getMin()[1]),
+                                              box.getMax()[2] - box.getMin()[2]);
+        SbVec3f center = box.getCenter();
+        SbVec3f half(size, size, size);
+        build(0, vertices.size(), center - half, center + half, 0);
+        addSamples();
+    }
+
+    touch();
+}
+
+/**
+ * Creates the node for the vertices in [first, last) and sorts them into the
+ * octants of the cell. The vertices of a subtree are stored consecutively.
+ */
+int32_t SoFCPointCloudLOD::build(std::size_t first, std::size_t last,
+                                 const SbVec3f& cmin, const SbVec3f& cmax, int depth)
+{
+    Node node;
+    node.bmin = vertices[first].point;
+    node.bmax = vertices[first].point;
+    for (std::size_t i = first + 1; i < last; i++) {
+        const SbVec3f& p = vertices[i].point;
+        for (int k = 0; k < 3; k++) {
+            node.bmin[k] = std::min(node.bmin[k], p[k]);
+            node.bmax[k] = std::max(node.bmax[k], p[k]);
+        }
+    }
+    node.first = static_cast<uint32_t>(first);
+    node.count = static_cast<uint32_t>(last - first);
+    std::fill(node.child, node.child + 8, -1);
+    node.leaf = (last - first <= LeafSize || depth >= MaxDepth);
+
+    int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.push_back(node);
+    if (node.leaf)
+        return index;
+
+    SbVec3f center = 0.5f * (cmin + cmax);
+    auto split = [this, &center](std::size_t begin, std::size_t end, int axis) {
+        std::vector<Vertex>::iterator it = std::partition(vertices.begin() + begin, vertices.begin() + end,
+                                                          [&center, axis](const Vertex& v) {
+            return v.point[axis] < center[axis];
+        });
+        return static_cast<std::size_t>(it - vertices.begin());
+    };
+
+    // octant i contains the vertices in [bounds[i], bounds[i+1]), its bits
+    // are set for the axes where the vertices are above the center
+    std::size_t bounds[9];
+    bounds[0] = first;
+    bounds[8] = last;
+    bounds[4] = split(bounds[0], bounds[8], 0);
+    bounds[2] = split(bounds[0], bounds[4], 1);
+    bounds[6] = split(bounds[4], bounds[8], 1);
+    for (int i = 1; i < 8; i += 2)
+        bounds[i] = split(bounds[i-1], bounds[i+1], 2);
+
+    for (int i = 0; i < 8; i++) {
+        if (bounds[i] == bounds[i+1])
+            continue;
+        SbVec3f omin, omax;
+        for (int k = 0; k < 3; k++) {
+            bool upper = (i & (4 >> k)) != 0;
+            omin[k] = upper ? center[k] : cmin[k];
+            omax[k] = upper ? cmax[k] : center[k];
+        }
+        int32_t child = build(bounds[i], bounds[i+1], omin, omax, depth + 1);
+        nodes[index].child[i] = child;
+    }
+
+    return index;
+}
+
+/**
+ * Appends a subsample of each inner node to the vertices. As the vertices of a
+ * subtree are sorted by octants taking every n-th vertex gives a subsample that
+ * is evenly distributed over the subtree.
+ */
+void SoFCPointCloudLOD::addSamples()
+{
+    std::size_t numInner = 0;
+    for (std::vector<Node>::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if (!it->leaf)
+            numInner++;
+    }
+    vertices.reserve(vertices.size() + numInner * LeafSize);
+
+    for (std::vector<Node>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if (it->leaf)
+            continue;
+        double stride = static_cast<double>(it->count) / LeafSize;
+        std::size_t offset = vertices.size();
+        for (std::size_t i = 0; i < LeafSize; i++) {
+            std::size_t pos = it->first + static_cast<std::size_t>(i * stride);
+            vertices.push_back(vertices[pos]);
+        }
+        it->first = static_cast<uint32_t>(offset);
+        it->count = static_cast<uint32_t>(LeafSize);
+    }
+}
+
+/**
+ * Computes the projected size of the node in pixels. Returns false if the node
+ * is outside of the view volume.
+ */
+bool SoFCPointCloudLOD::projectNode(const Node& node, const SbViewVolume& vv,
+                                    const SbMatrix& mat, float height, float& size) const
+{
+    SbBox3f box(node.bmin, node.bmax);
+    box.transform(mat);
+    if (!vv.intersect(box))
+        return false;
+
+    float diagonal = (box.getMax() - box.getMin()).length();
+    float scale = vv.getWorldToScreenScale(box.getCenter(), 1.0f);
+    if (scale > 0.0f)
+        size = diagonal / scale * height;
+    else
+        size = FLT_MAX;
+    return true;
+}
+
+/**
+ * Selects the nodes to render for the current view. The nodes with the largest
+ * projection are refined first until either the screen error is reached or
+ * the point budget is used up.
+ */
+void SoFCPointCloudLOD::selectNodes(SoState* state)
+{
+    visible.clear();
+    if (nodes.empty())
+        return;
+
+    const SbViewVolume& vv = SoViewVolumeElement::get(state);
+    const SbMatrix& mat = SoModelMatrixElement::get(state);
+    float height = static_cast<float>(SoViewportRegionElement::get(state).getViewportSizePixels()[1]);
+    std::size_t budget = static_cast<std::size_t>(std::max<int32_t>(pointBudget.getValue(), static_cast<int32_t>(LeafSize)));
+    float maxError = std::max(screenError.getValue(), 0.1f);
+
+    typedef std::pair<float, int32_t> Entry;
+    std::priority_queue<Entry> queue;
+    std::size_t used = 0;
+    std::size_t pending = 0;
+
+    float size;
+    if (projectNode(nodes[0], vv, mat, height, size)) {
+        queue.push(Entry(size, 0));
+        pending = nodes[0].count;
+    }
+
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+        const Node& node = nodes[entry.second];
+        pending -= node.count;
+
+        // the sample spacing assumes that the points are scanned from surfaces
+        if (!node.leaf && entry.first / std::sqrt(static_cast<float>(node.count)) > maxError) {
+            Entry children[8];
+            int numChildren = 0;
+            std::size_t cost = 0;
+            for (int i = 0; i < 8; i++) {
+                int32_t child = node.child[i];
+                if (child >= 0 && projectNode(nodes[child], vv, mat, height, size)) {
+                    children[numChildren++] = Entry(size, child);
+                    cost += nodes[child].count;
+                }
+            }
+
+            if (used + pending + cost <= budget) {
+                for (int i = 0; i < numChildren; i++)
+                    queue.push(children[i]);
+                pending += cost;
+                continue;
+            }
+        }
+
+        visible.push_back(entry.second);
+        used += node.count;
+    }
+}
+
+void SoFCPointCloudLOD::updateColors(SoState* state)
+{
+    uint32_t nodeId = SoLazyElement::getInstance(state)->getDiffuseNodeId();
+    if (!colors.empty() && nodeId == colorNodeId)
+        return;
+
+    colorNodeId = nodeId;
+    colors.resize(4 * vertices.size());
+    unsigned char* rgba = colors.data();
+    for (std::vector<Vertex>::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+        SbColor col = SoLazyElement::getDiffuse(state, static_cast<int>(it->index));
+        *rgba++ = static_cast<unsigned char>(col[0] * 255.0f + 0.5f);
+        *rgba++ = static_cast<unsigned char>(col[1] * 255.0f + 0.5f);
+        *rgba++ = static_cast<unsigned char>(col[2] * 255.0f + 0.5f);
+        *rgba++ = 255;
+    }
+}
+
+void SoFCPointCloudLOD::GLRender(SoGLRenderAction *action)
+{
+    if (!shouldGLRender(action))
+        return;
+
+    SoState* state = action->getState();
+
+    // the rendered nodes depend on the camera, so this node must not be cached
+    SoCacheElement::invalidate(state);
+
+    selectNodes(state);
+    if (visible.empty())
+        return;
+
+    SoMaterialBindingElement::Binding binding = SoMaterialBindingElement::get(state);
+    bool perVertex = (binding == SoMaterialBindingElement::PER_VERTEX ||
+                      binding == SoMaterialBindingElement::PER_VERTEX_INDEXED) &&
+                     numPoints > 1 &&
+                     static_cast<std::size_t>(SoLazyElement::getNumDiffuse(state)) == numPoints;
+    if (perVertex)
+        updateColors(state);
+
+    state->push();
+    SoLazyElement::setLightModel(state, SoLazyElement::BASE_COLOR);
+
+    SoMaterialBundle mb(action);
+    mb.sendFirst();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &vertices[0].point);
+    if (perVertex) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors.data());
+    }
+
+    for (std::vector<int32_t>::const_iterator it = visible.begin(); it != visible.end(); ++it) {
+        const Node& node = nodes[*it];
+        glDrawArrays(GL_POINTS, static_cast<GLint>(node.first), static_cast<GLsizei>(node.count));
+    }
+
+    if (perVertex) {
+        glDisableClientState(GL_COLOR_ARRAY);
+        // the color arrays changed the current color
+        SoGLLazyElement::getInstance(state)->reset(state, SoLazyElement::DIFFUSE_MASK);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    state->pop();
+}
+
+void SoFCPointCloudLOD::computeBBox(SoAction * /*action*/, SbBox3f &box, SbVec3f &center)
+{
+    if (!nodes.empty()) {
+        box.setBounds(nodes[0].bmin, nodes[0].bmax);
+        center = box.getCenter();
+    }
+    else {
+        box.setBounds(SbVec3f(0,0,0), SbVec3f(0,0,0));
+        center.setValue(0.0f,0.0f,0.0f);
+    }
+}
+
+void SoFCPointCloudLOD::getPrimitiveCount(SoGetPrimitiveCountAction * action)
+{
+    if (!this->shouldPrimitiveCount(action))
+        return;
+    action->addNumPoints(static_cast<int>(countRendered()));
+}
+
+std::size_t SoFCPointCloudLOD::countRendered() const
+{
+    std::size_t count = 0;
+    for (std::vector<int32_t>::const_iterator it = visible.begin(); it != visible.end(); ++it)
+        count += nodes[*it].count;
+    return count;
+}
+
+/**
+ * Creates the points rendered last, or the subsample of the root node if
+ * nothing was rendered yet.
+ */
+void SoFCPointCloudLOD::generatePrimitives(SoAction *action)
+{
+    if (nodes.empty())
+        return;
+
+    std::vector<int32_t> selection = visible;
+    if (selection.empty())
+        selection.push_back(0);
+
+    SoPrimitiveVertex vertex;
+    SoPointDetail pointDetail;
+    vertex.setDetail(&pointDetail);
+
+    beginShape(action, POINTS);
+    for (std::vector<int32_t>::const_iterator it = selection.begin(); it != selection.end(); ++it) {
+        const Node& node = nodes[*it];
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            const Vertex& v = vertices[i];
+            pointDetail.setCoordinateIndex(static_cast<int>(v.index));
+            vertex.setPoint(v.point);
+            shapeVertex(&vertex);
+        }
+    }
+    endShape();
+}
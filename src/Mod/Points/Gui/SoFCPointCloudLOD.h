@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef POINTSGUI_SOFCPOINTCLOUDLOD_H
+#define POINTSGUI_SOFCPOINTCLOUDLOD_H
+
+#include <cstdint>
+#include <vector>
+#include <Inventor/SbBox3f.h>
+#include <Inventor/fields/SoSFFloat.h>
+#include <Inventor/fields/SoSFInt32.h>
+#include <Inventor/nodes/SoShape.h>
+#include <Inventor/nodes/SoSubNode.h>
+
+class SbMatrix;
+class SbViewVolume;
+class SoState;
+
+namespace Points {
+    class PointKernel;
+}
+
+namespace PointsGui {
+
+/**
+ * The SoFCPointCloudLOD class is a shape node to render huge point clouds.
+ *
+ * The points are sorted into an octree where each leaf holds a limited number of
+ * points. Additionally, each inner node keeps a subsample of the points of its
+ * subtree. At rendering time the octree is traversed from the root, nodes outside
+ * the view volume are skipped and a node is only refined into its children as long
+ * as the spacing of its subsample on the screen exceeds \a screenError pixels and
+ * the number of points to render doesn't exceed \a pointBudget. The nodes with the
+ * largest projection are refined first. This way the time to render a frame is
+ * bounded independent of the size of the point cloud.
+ *
+ * If the current material binding is per vertex and the number of diffuse colors
+ * matches with the number of points then the points are colored. Points are always
+ * rendered without lighting.
+ *
+ * @note Picking only takes into account the points that were rendered last.
+ */
+class PointsGuiExport SoFCPointCloudLOD : public SoShape {
+    typedef SoShape inherited;
+
+    SO_NODE_HEADER(SoFCPointCloudLOD);
+
+public:
+    static void initClass();
+    SoFCPointCloudLOD();
+
+    /// The maximum number of points rendered in a frame
+    SoSFInt32 pointBudget;
+    /// The accepted spacing of the rendered points in pixels
+    SoSFFloat screenError;
+
+    /// Builds the octree from the points of the kernel, invalid points are skipped
+    void setPoints(const Points::PointKernel&);
+    /// Returns the number of points of the kernel including the invalid points
+    std::size_t countPoints() const
+    { return numPoints; }
+    /// Returns the number of points rendered last
+    std::size_t countRendered() const;
+
+protected:
+    virtual void GLRender(SoGLRenderAction *action);
+    virtual void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center);
+    virtual void getPrimitiveCount(SoGetPrimitiveCountAction * action);
+    virtual void generatePrimitives(SoAction *action);
+
+private:
+    struct Vertex
+    {
+        SbVec3f point;
+        /// the index of the point in the kernel
+        uint32_t index;
+    };
+    struct Node
+    {
+        SbVec3f bmin, bmax;
+        /// The range of the vertices to render, for inner nodes these are the samples
+        uint32_t first, count;
+        int32_t child[8];
+        bool leaf;
+    };
+
+    // Force using the reference count mechanism.
+    virtual ~SoFCPointCloudLOD();
+    int32_t build(std::size_t first, std::size_t last, const SbVec3f& cmin, const SbVec3f& cmax, int depth);
+    void addSamples();
+    void selectNodes(SoState*);
+    bool projectNode(const Node&, const SbViewVolume&, const SbMatrix&, float height, float& size) const;
+    void updateColors(SoState*);
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Vertex> vertices;
+    /// packed RGBA values in the order of the vertices
+    std::vector<unsigned char> colors;
+    uint32_t colorNodeId;
+    /// the nodes rendered last
+    std::vector<int32_t> visible;
+    std::size_t numPoints;
+};
+
+} // namespace PointsGui
+
+
+#endif // POINTSGUI_SOFCPOINTCLOUDLOD_H
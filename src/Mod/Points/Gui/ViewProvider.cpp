@@ -38,6 +38,7 @@
 #endif
 
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <climits>
 #include <limits>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui,...
@@ -58,6 +59,7 @@
 #include <Mod/Points/App/PointsFeature.h>
 
 #include "ViewProvider.h"
+#include "SoFCPointCloudLOD.h"
 #include "../App/Properties.h"
 
 
@@ -167,9 +169,14 @@ void ViewProviderPoints::setVertexNormalMode(Points::PropertyNormalList* pcPrope
     pcPointsNormal->vector.finishEditing();
 }
 
+int ViewProviderPoints::getNumPoints() const
+{
+    return pcPointsCoord->point.getNum();
+}
+
 void ViewProviderPoints::setDisplayMode(const char* ModeName)
 {
-    int numPoints = pcPointsCoord->point.getNum();
+    int numPoints = getNumPoints();
 
     if (strcmp("Color",ModeName) == 0) {
         std::map<std::string,App::Property*> Map;
@@ -354,15 +361,91 @@ void ViewProviderPoints::clipPointsCallback(void *, SoEventCallback * n)
 
 PROPERTY_SOURCE(PointsGui::ViewProviderScattered, PointsGui::ViewProviderPoints)
 
+App::PropertyIntegerConstraint::Constraints ViewProviderScattered::budgetRange = {100000,INT_MAX,100000};
+
 ViewProviderScattered::ViewProviderScattered()
 {
+    static const char *osgroup = "Object Style";
+
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+    ADD_PROPERTY_TYPE(LevelOfDetail, (hGrp->GetBool("LevelOfDetail", false)), osgroup, App::Prop_None,
+                      "Render only the points needed for the current view");
+    ADD_PROPERTY_TYPE(PointBudget, (2000000), osgroup, App::Prop_None,
+                      "Maximum number of points rendered in level of detail mode");
+    PointBudget.setConstraints(&budgetRange);
+
     pcPoints = new SoPointSet();
     pcPoints->ref();
+    pcCloud = new SoFCPointCloudLOD();
+    pcCloud->ref();
+    pcCloud->pointBudget = PointBudget.getValue();
 }
 
 ViewProviderScattered::~ViewProviderScattered()
 {
     pcPoints->unref();
+    pcCloud->unref();
+}
+
+void ViewProviderScattered::onChanged(const App::Property* prop)
+{
+    if (prop == &PointBudget) {
+        pcCloud->pointBudget = PointBudget.getValue();
+    }
+    else if (prop == &LevelOfDetail) {
+        if (pcObject) {
+            setupPointNodes();
+            std::map<std::string,App::Property*> Map;
+            pcObject->getPropertyMap(Map);
+            for (std::map<std::string,App::Property*>::iterator it = Map.begin(); it != Map.end(); ++it) {
+                if (it->second->getTypeId() == Points::PropertyPointKernel::getClassTypeId()) {
+                    updatePoints(it->second);
+                    break;
+                }
+            }
+        }
+    }
+    else {
+        ViewProviderPoints::onChanged(prop);
+    }
+}
+
+int ViewProviderScattered::getNumPoints() const
+{
+    if (LevelOfDetail.getValue())
+        return static_cast<int>(pcCloud->countPoints());
+    return ViewProviderPoints::getNumPoints();
+}
+
+void ViewProviderScattered::setupPointNodes()
+{
+    pcHighlight->removeAllChildren();
+    if (LevelOfDetail.getValue()) {
+        pcHighlight->addChild(pcCloud);
+    }
+    else {
+        pcHighlight->addChild(pcPointsCoord);
+        pcHighlight->addChild(pcPoints);
+    }
+}
+
+void ViewProviderScattered::updatePoints(const App::Property* prop)
+{
+    // only one of the representations holds the points
+    if (LevelOfDetail.getValue()) {
+        pcCloud->setPoints(static_cast<const Points::PropertyPointKernel*>(prop)->getValue());
+        pcPointsCoord->point.setNum(0);
+        pcPoints->numPoints = 0;
+    }
+    else {
+        pcCloud->setPoints(Points::PointKernel());
+        ViewProviderPointsBuilder builder;
+        builder.createPoints(prop, pcPointsCoord, pcPoints);
+    }
+
+    // The number of points might have changed, so force also a resize of the Inventor internals
+    setActiveMode();
 }
 
 void ViewProviderScattered::attach(App::DocumentObject* pcObj)
@@ -375,8 +458,7 @@ void ViewProviderScattered::attach(App::DocumentObject* pcObj)
     pcHighlight->subElementName = "Main";
 
     // Highlight for selection
-    pcHighlight->addChild(pcPointsCoord);
-    pcHighlight->addChild(pcPoints);
+    setupPointNodes();
 
     std::vector<std::string> modes = getDisplayModes();
 
@@ -415,11 +497,7 @@ void ViewProviderScattered::updateData(const App::Property* prop)
 {
     ViewProviderPoints::updateData(prop);
     if (prop->getTypeId() == Points::PropertyPointKernel::getClassTypeId()) {
-        ViewProviderPointsBuilder builder;
-        builder.createPoints(prop, pcPointsCoord, pcPoints);
-
-        // The number of points might have changed, so force also a resize of the Inventor internals
-        setActiveMode();
+        updatePoints(prop);
     }
     else if (prop->getTypeId() == Points::PropertyNormalList::getClassTypeId()) {
         setActiveMode();
@@ -55,6 +55,8 @@ namespace Points {
 
 namespace PointsGui {
 
+class SoFCPointCloudLOD;
+
 class ViewProviderPointsBuilder : public Gui::ViewProviderBuilder
 {
 public:
@@ -99,6 +101,8 @@ protected:
     void setVertexColorMode(App::PropertyColorList*);
     void setVertexGreyvalueMode(Points::PropertyGreyValueList*);
     void setVertexNormalMode(Points::PropertyNormalList*);
+    /// Returns the number of points of the Inventor representation
+    virtual int getNumPoints() const;
     virtual void cut(const std::vector<SbVec2f>& picked, Gui::View3DInventorViewer &Viewer) = 0;
 
 protected:
@@ -125,6 +129,11 @@ public:
     ViewProviderScattered();
     virtual ~ViewProviderScattered();
 
+    /// Renders the points with a level of detail octree
+    App::PropertyBool LevelOfDetail;
+    /// The maximum number of points rendered in level of detail mode
+    App::PropertyIntegerConstraint PointBudget;
+
     /**
      * Extracts the point data from the feature \a pcFeature and creates
      * an Inventor node \a SoNode with these data. 
@@ -134,10 +143,20 @@ public:
     virtual void updateData(const App::Property*);
 
 protected:
+    void onChanged(const App::Property* prop);
+    virtual int getNumPoints() const;
     virtual void cut(const std::vector<SbVec2f>& picked, Gui::View3DInventorViewer &Viewer);
 
+private:
+    void setupPointNodes();
+    void updatePoints(const App::Property*);
+
 protected:
     SoPointSet          * pcPoints;
+    SoFCPointCloudLOD   * pcCloud;
+
+private:
+    static App::PropertyIntegerConstraint::Constraints budgetRange;
 };
 
 /**
@@ -60,6 +60,7 @@ Gui::ToolBarItem* Workbench::setupToolBars() const
          << "Points_Convert"
          << "Points_Structure"
          << "Points_Merge"
+         << "Points_Downsample"
          << "Points_PolyCut";
     return root;
 }
@@ -74,7 +75,8 @@ Gui::ToolBarItem* Workbench::setupCommandBars() const
          << "Points_Export"
          << "Points_Convert"
          << "Points_Structure"
-         << "Points_Merge";
+         << "Points_Merge"
+         << "Points_Downsample";
     return root;
 }
 
@@ -93,6 +95,7 @@ Gui::MenuItem* Workbench::setupMenuBar() const
           << "Points_Export"
           << "Separator"
           << "Points_PolyCut"
-          << "Points_Merge";
+          << "Points_Merge"
+          << "Points_Downsample";
     return root;
 }
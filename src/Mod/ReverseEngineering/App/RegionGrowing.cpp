@@ -25,6 +25,7 @@
 
 #include "RegionGrowing.h"
 #include <Mod/Points/App/Points.h>
+#include <Mod/Points/App/PointsKDTree.h>
 #include <Base/Exception.h>
 #include <boost/math/special_functions/fpclassify.hpp>
 
@@ -53,48 +54,13 @@ RegionGrowing::RegionGrowing(const Points::PointKernel& pts, std::list<std::vect
 
 void RegionGrowing::perform(int ksearch)
 {
-    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
-    cloud->reserve(myPoints.size());
-    for (Points::PointKernel::const_iterator it = myPoints.begin(); it != myPoints.end(); ++it) {
-        if (!boost::math::isnan(it->x) && !boost::math::isnan(it->y) && !boost::math::isnan(it->z))
-            cloud->push_back(pcl::PointXYZ(it->x, it->y, it->z));
-    }
-
-    //normal estimation
-    pcl::search::Search<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
-    pcl::PointCloud <pcl::Normal>::Ptr normals (new pcl::PointCloud <pcl::Normal>);
-    pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> normal_estimator;
-    normal_estimator.setSearchMethod (tree);
-    normal_estimator.setInputCloud (cloud);
-    normal_estimator.setKSearch (ksearch);
-    normal_estimator.compute (*normals);
-
-    // pass through
-    pcl::IndicesPtr indices (new std::vector <int>);
-    pcl::PassThrough<pcl::PointXYZ> pass;
-    pass.setInputCloud (cloud);
-    pass.setFilterFieldName ("z");
-    pass.setFilterLimits (0.0, 1.0);
-    pass.filter (*indices);
-
-    pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> reg;
-    reg.setMinClusterSize (50);
-    reg.setMaxClusterSize (1000000);
-    reg.setSearchMethod (tree);
-    reg.setNumberOfNeighbours (30);
-    reg.setInputCloud (cloud);
-    //reg.setIndices (indices);
-    reg.setInputNormals (normals);
-    reg.setSmoothnessThreshold (3.0 / 180.0 * M_PI);
-    reg.setCurvatureThreshold (1.0);
-
-    std::vector <pcl::PointIndices> clusters;
-    reg.extract (clusters);
+    // estimate the normals with the built-in k-d tree
+    Points::NormalEstimation estimate(myPoints);
+    estimate.setKSearch(ksearch);
 
-    for (std::vector<pcl::PointIndices>::iterator it = clusters.begin (); it != clusters.end (); ++it) {
-        myClusters.push_back(std::vector<int>());
-        myClusters.back().swap(it->indices);
-    }
+    std::vector<Base::Vector3f> normals;
+    estimate.perform(normals);
+    perform(normals);
 }
 
 void RegionGrowing::perform(const std::vector<Base::Vector3f>& myNormals)
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #include "SampleConsensus.h"
+#include "Segmentation.h"
 #include <Mod/Points/App/Points.h>
 #include <Base/Exception.h>
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -65,26 +66,20 @@ double SampleConsensus::perform(std::vector<float>& parameters, std::vector<int>
 
     pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal> ());
     if (mySac == SACMODEL_CONE || mySac == SACMODEL_CYLINDER) {
-#if 0
-        // Create search tree
-        pcl::search::KdTree<pcl::PointXYZ>::Ptr tree;
-        tree.reset (new pcl::search::KdTree<PointXYZ> (false));
-        tree->setInputCloud (cloud);
+        // without given normals estimate them with the built-in k-d tree
+        std::vector<Base::Vector3d> estimated;
+        if (myNormals.empty()) {
+            NormalEstimation estimate(myPoints);
+            estimate.setKSearch(10);
+            estimate.perform(estimated);
+        }
 
-        // Normal estimation
-        int ksearch = 10;
-        pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> n;
-        n.setInputCloud (cloud);
-        n.setSearchMethod (tree);
-        n.setKSearch (ksearch);
-        n.compute (*normals);
-#else
-        normals->reserve(myNormals.size());
-        for (std::vector<Base::Vector3d>::const_iterator it = myNormals.begin(); it != myNormals.end(); ++it) {
+        const std::vector<Base::Vector3d>& input = myNormals.empty() ? estimated : myNormals;
+        normals->reserve(input.size());
+        for (std::vector<Base::Vector3d>::const_iterator it = input.begin(); it != input.end(); ++it) {
             if (!boost::math::isnan(it->x) && !boost::math::isnan(it->y) && !boost::math::isnan(it->z))
                 normals->push_back(pcl::Normal(it->x, it->y, it->z));
         }
-#endif
     }
 
     // created RandomSampleConsensus object and compute the appropriated model
@@ -25,6 +25,8 @@
 
 #include "Segmentation.h"
 #include <Mod/Points/App/Points.h>
+#include <Mod/Points/App/PointsKDTree.h>
+#include <Base/Converter.h>
 #include <Base/Exception.h>
 
 #if defined(HAVE_PCL_FILTERS)
@@ -159,7 +161,6 @@ void Segmentation::perform(int ksearch)
 
 // ----------------------------------------------------------------------------
 
-#if defined (HAVE_PCL_FILTERS)
 NormalEstimation::NormalEstimation(const Points::PointKernel& pts)
   : myPoints(pts)
   , kSearch(0)
@@ -169,43 +170,16 @@ NormalEstimation::NormalEstimation(const Points::PointKernel& pts)
 
 void NormalEstimation::perform(std::vector<Base::Vector3d>& normals)
 {
-    // Copy the points
-    pcl::PointCloud<PointXYZ>::Ptr cloud (new pcl::PointCloud<PointXYZ>);
-    cloud->reserve(myPoints.size());
-    for (Points::PointKernel::const_iterator it = myPoints.begin(); it != myPoints.end(); ++it) {
-        cloud->push_back(pcl::PointXYZ(it->x, it->y, it->z));
-    }
+    // the built-in k-d tree doesn't need PCL
+    Points::NormalEstimation estimate(myPoints);
+    estimate.setKSearch(kSearch);
+    estimate.setSearchRadius(searchRadius);
 
-    cloud->width = int (cloud->points.size ());
-    cloud->height = 1;
+    std::vector<Base::Vector3f> result;
+    estimate.perform(result);
 
-#if 0
-    // Build a passthrough filter to remove spurious NaNs
-    pcl::PointCloud<PointXYZ>::Ptr cloud_filtered (new pcl::PointCloud<PointXYZ>);
-    pcl::PassThrough<PointXYZ> pass;
-    pass.setInputCloud (cloud);
-    pass.setFilterFieldName ("z");
-    pass.setFilterLimits (0, 1.5);
-    pass.filter (*cloud_filtered);
-#endif
-
-    // Estimate point normals
-    pcl::PointCloud<pcl::Normal>::Ptr cloud_normals (new pcl::PointCloud<pcl::Normal>);
-    pcl::search::KdTree<PointXYZ>::Ptr tree (new pcl::search::KdTree<PointXYZ> ());
-    pcl::NormalEstimation<PointXYZ, pcl::Normal> ne;
-    ne.setSearchMethod (tree);
-    //ne.setInputCloud (cloud_filtered);
-    ne.setInputCloud (cloud);
-    if (kSearch > 0)
-        ne.setKSearch (kSearch);
-    if (searchRadius > 0)
-        ne.setRadiusSearch (searchRadius);
-    ne.compute (*cloud_normals);
-
-    normals.reserve(cloud_normals->size());
-    for (pcl::PointCloud<pcl::Normal>::const_iterator it = cloud_normals->begin(); it != cloud_normals->end(); ++it) {
-        normals.push_back(Base::Vector3d(it->normal_x, it->normal_y, it->normal_z));
+    normals.reserve(result.size());
+    for (std::vector<Base::Vector3f>::const_iterator it = result.begin(); it != result.end(); ++it) {
+        normals.push_back(Base::convertTo<Base::Vector3d>(*it));
     }
 }
-
-#endif // HAVE_PCL_FILTERS
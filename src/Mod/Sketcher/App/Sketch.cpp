@@ -31,6 +31,7 @@
 # include <TopoDS.hxx>
 # include <TopoDS_Edge.hxx>
 # include <BRepBuilderAPI_MakeWire.hxx>
+# include <algorithm>
 # include <cmath>
 # include <iostream>
 #endif
@@ -76,7 +77,8 @@ Sketch::Sketch()
   , RecalculateInitialSolutionWhileMovingPoint(false)
   , resolveAfterGeometryUpdated(false)
   , GCSsys(), ConstraintsCounter(0)
-  , isInitMove(false), isFine(true), moveStep(0)
+  , isInitMove(false), IncrementalMove(false), moveId(0)
+  , isFine(true), moveStep(0)
   , defaultSolver(GCS::DogLeg)
   , defaultSolverRedundant(GCS::DogLeg)
   , debugMode(GCS::Minimal)
@@ -126,6 +128,8 @@ void Sketch::clear(void)
 
     GCSsys.clear();
     isInitMove = false;
+    MovedGeoms.clear();
+    moveId++;
     ConstraintsCounter = 0;
     Conflicting.clear();
     Redundant.clear();
@@ -3289,6 +3293,8 @@ bool Sketch::updateGeometry()
 {
     int i=0;
     for (std::vector<GeoDef>::const_iterator it=Geoms.begin(); it != Geoms.end(); ++it, i++) {
+        if (!isMovedGeometry(i))
+            continue;
         try {
             if (it->type == Point) {
                 GeomPoint *point = static_cast<GeomPoint*>(it->geo);
@@ -3565,7 +3571,10 @@ int Sketch::internalSolve(std::string & solvername, int level)
 
     if(isInitMove){
         solvername = "DogLeg"; // DogLeg is used for dragging (same as before)
-        ret = GCSsys.solve(isFine, GCS::DogLeg);
+        if (IncrementalMove)
+            ret = GCSsys.solveAffected(isFine, GCS::DogLeg);
+        else
+            ret = GCSsys.solve(isFine, GCS::DogLeg);
     }
     else{
         switch (defaultSolver) {
@@ -3969,12 +3978,66 @@ int Sketch::initMove(int geoId, PointPos pos, bool fine)
 
     GCSsys.initSolution();
     isInitMove = true;
+    moveId++;
+    findMovedGeometries();
     return 0;
 }
 
 void Sketch::resetInitMove()
 {
     isInitMove = false;
+    MovedGeoms.clear();
+}
+
+void Sketch::findMovedGeometries()
+{
+    MovedGeoms.clear();
+    if (!IncrementalMove)
+        return;
+
+    // the parameters of the decoupled components that contain the move constraints
+    GCS::VEC_pD params;
+    GCSsys.getAffectedParams(params);
+    std::sort(params.begin(), params.end());
+
+    MovedGeoms.resize(Geoms.size(), false);
+    for (int geoId=0; geoId < int(Geoms.size()); geoId++) {
+        GCS::VEC_pD geoparams;
+        if (Geoms[geoId].type == Point) {
+            GCS::Point &point = Points[Geoms[geoId].startPointId];
+            geoparams.push_back(point.x);
+            geoparams.push_back(point.y);
+        }
+        else if (GCS::Curve* crv = getGCSCurveByGeoId(geoId)) {
+            crv->PushOwnParams(geoparams);
+        }
+
+        for (GCS::VEC_pD::const_iterator it = geoparams.begin(); it != geoparams.end(); ++it) {
+            if (std::binary_search(params.begin(), params.end(), *it)) {
+                MovedGeoms[geoId] = true;
+                break;
+            }
+        }
+    }
+
+    // the knots of a moved B-spline are recomputed together with the B-spline
+    for (int geoId=0; geoId < int(Geoms.size()); geoId++) {
+        if (Geoms[geoId].type == BSpline && MovedGeoms[geoId]) {
+            const GCS::BSpline &bsp = BSplines[Geoms[geoId].index];
+            for (GCS::VEC_I::const_iterator it = bsp.knotpointGeoids.begin(); it != bsp.knotpointGeoids.end(); ++it) {
+                if (*it != Constraint::GeoUndef)
+                    MovedGeoms[*it] = true;
+            }
+        }
+    }
+}
+
+bool Sketch::isMovedGeometry(int geoId) const
+{
+    if (!isInitMove || MovedGeoms.empty())
+        return true;
+    geoId = checkGeoId(geoId);
+    return MovedGeoms[geoId];
 }
 
 int Sketch::movePoint(int geoId, PointPos pos, Base::Vector3d toPoint, bool relative)
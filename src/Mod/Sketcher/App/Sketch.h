@@ -147,6 +147,24 @@ public:
     void setRecalculateInitialSolutionWhileMovingPoint(bool recalculateInitialSolutionWhileMovingPoint)
         {RecalculateInitialSolutionWhileMovingPoint = recalculateInitialSolutionWhileMovingPoint;}
 
+    /**
+     * Sets whether moving a point only solves the decoupled parts of the sketch that
+     * contain the moved geometry, starting from the previous solution of the move.
+     * Then only the geometries of these parts are updated.
+     */
+    bool getIncrementalMove() const
+        {return IncrementalMove;}
+
+    void setIncrementalMove(bool incrementalMove)
+        {IncrementalMove = incrementalMove;}
+
+    /// Returns false if the geometry keeps its shape during the current incremental move
+    bool isMovedGeometry(int geoId) const;
+
+    /// A number that changes whenever a move is initialized or the sketch is cleared
+    unsigned long getMoveId() const
+        {return moveId;}
+
     /// add dedicated geometry
     //@{
     /// add a point
@@ -458,6 +476,9 @@ protected:
     std::vector<GCS::BSpline> BSplines;
 
     bool isInitMove;
+    bool IncrementalMove;
+    unsigned long moveId;
+    std::vector<bool> MovedGeoms; // the geometries that are solved in incremental move mode
     bool isFine;
     Base::Vector3d initToPoint;
     double moveStep;
@@ -467,7 +488,7 @@ public:
     GCS::Algorithm defaultSolverRedundant;
     inline void setDogLegGaussStep(GCS::DogLegGaussStep mode){GCSsys.dogLegGaussStep=mode;}
     inline void setDebugMode(GCS::DebugMode mode) {debugMode=mode;GCSsys.debugMode=mode;}
-    inline GCS::DebugMode getDebugMode(void) {return debugMode;}
+    inline GCS::DebugMode getDebugMode(void) const {return debugMode;}
     inline void setMaxIter(int maxiter){GCSsys.maxIter=maxiter;}
     inline void setMaxIterRedundant(int maxiter){GCSsys.maxIterRedundant=maxiter;}
     inline void setSketchSizeMultiplier(bool mult){GCSsys.sketchSizeMultiplier=mult;}
@@ -477,6 +498,8 @@ public:
     inline void setQRAlgorithm(GCS::QRAlgorithm alg){GCSsys.qrAlgorithm=alg;}
     inline GCS::QRAlgorithm getQRAlgorithm(){return GCSsys.qrAlgorithm;}
     inline void setQRPivotThreshold(double val){GCSsys.qrpivotThreshold=val;}
+    inline void setJacobianType(GCS::JacobianType type){GCSsys.jacobianType=type;}
+    inline GCS::JacobianType getJacobianType(){return GCSsys.jacobianType;}
     inline void setLM_eps(double val){GCSsys.LM_eps=val;}
     inline void setLM_eps1(double val){GCSsys.LM_eps1=val;}
     inline void setLM_tau(double val){GCSsys.LM_tau=val;}
@@ -502,6 +525,8 @@ private:
 
     void clearTemporaryConstraints(void);
 
+    void findMovedGeometries(void);
+
     int internalSolve(std::string & solvername, int level = 0);
 
     /// checks if the index bounds and converts negative indices to positive
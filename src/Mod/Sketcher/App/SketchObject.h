@@ -408,6 +408,9 @@ public: /* Solver exposed interface */
     /// enables/disables solver initial solution recalculation when moving point mode (useful for dragging)
     inline void setRecalculateInitialSolutionWhileMovingPoint(bool recalculateInitialSolutionWhileMovingPoint)
         {solvedSketch.setRecalculateInitialSolutionWhileMovingPoint(recalculateInitialSolutionWhileMovingPoint);}
+    /// enables/disables solving only the parts of the sketch affected by a move (useful for dragging)
+    inline void setIncrementalMove(bool incrementalMove)
+        {solvedSketch.setIncrementalMove(incrementalMove);}
     /// Forwards a request for a temporary initMove to the solver using the current sketch state as a reference (enables dragging)
     inline int initTemporaryMove(int geoId, PointPos pos, bool fine=true);
     /** Forwards a request for point or curve temporary movement to the solver using the current state as a reference (enables dragging).
@@ -54,6 +54,8 @@
 #include <cfloat>
 #include <limits>
 #include <future>
+#include <atomic>
+#include <thread>
 
 #include "GCS.h"
 #include "qp_eq.h"
@@ -100,6 +102,7 @@
 
 #include <boost_graph_adjacency_list.hpp>
 #include <boost/graph/connected_components.hpp>
+#include <boost/functional/hash.hpp>
 
 typedef Eigen::FullPivHouseholderQR<Eigen::MatrixXd>::IntDiagSizeVectorType MatrixIndexType;
 
@@ -431,6 +434,33 @@ void SolverReportingManager::LogMatrix(const std::string str, MatrixIndexType ma
 
 typedef boost::adjacency_list <boost::vecS, boost::vecS, boost::undirectedS> Graph;
 
+// Decoupled subsystems with less parameters in total are solved sequentially, as
+// starting the threads would take longer than solving them
+#define ParallelSolveMinParams 200
+
+// Calls func(i) for all i in [0, count). If parallel is true the calls are distributed
+// over up to one thread per core, where the calling thread is one of them.
+template <typename Func>
+static void parallelFor(int count, bool parallel, Func func)
+{
+    int numThreads = 1;
+    if (parallel)
+        numThreads = std::min<int>(count, std::max<int>(1, std::thread::hardware_concurrency()));
+
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++)
+            func(i);
+    };
+
+    std::vector< std::future<void> > futures;
+    for (int t=1; t < numThreads; t++)
+        futures.push_back(std::async(std::launch::async, worker));
+    worker();
+    for (auto &fut : futures)
+        fut.get();
+}
+
 ///////////////////////////////////////
 // Solver
 ///////////////////////////////////////
@@ -459,6 +489,7 @@ System::System()
   , convergenceRedundant(1e-10)
   , qrAlgorithm(EigenSparseQR)
   , dogLegGaussStep(FullPivLU)
+  , jacobianType(DenseJacobian)
   , qrpivotThreshold(1E-13)
   , debugMode(Minimal)
   , LM_eps(1E-10)
@@ -1563,22 +1594,43 @@ int System::solve(bool isFine, Algorithm alg, bool isRedundantsolving)
     if (!isInit)
         return Failed;
 
-    bool isReset = false;
-    // return success by default in order to permit coincidence constraints to be applied
-    // even if no other system has to be solved
-    int res = Success;
+    // The decoupled components don't share any parameter or constraint and each subsystem
+    // works on its own copy of the parameters, so that they can be solved concurrently.
+    VEC_I cids;
+    int numParams = 0;
     for (int cid=0; cid < int(subSystems.size()); cid++) {
-        if ((subSystems[cid] || subSystemsAux[cid]) && !isReset) {
-             resetToReference();
-             isReset = true;
+        if (subSystems[cid] || subSystemsAux[cid]) {
+            cids.push_back(cid);
+            numParams += int(plists[cid].size());
         }
+    }
+
+    if (!cids.empty())
+        resetToReference();
+
+    // Base::Console is not thread-safe, so that the iteration level output needs sequential solving
+    bool parallel = cids.size() > 1 && numParams >= ParallelSolveMinParams && debugMode != IterationLevel;
+#ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
+    parallel = false;
+#endif
+
+    VEC_I results(cids.size(), Success);
+    parallelFor(int(cids.size()), parallel, [&](int i) {
+        int cid = cids[i];
         if (subSystems[cid] && subSystemsAux[cid])
-            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving));
+            results[i] = solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving);
         else if (subSystems[cid])
-            res = std::max(res, solve(subSystems[cid], isFine, alg, isRedundantsolving));
-        else if (subSystemsAux[cid])
-            res = std::max(res, solve(subSystemsAux[cid], isFine, alg, isRedundantsolving));
-    }
+            results[i] = solve(subSystems[cid], isFine, alg, isRedundantsolving);
+        else
+            results[i] = solve(subSystemsAux[cid], isFine, alg, isRedundantsolving);
+    });
+
+    // return success by default in order to permit coincidence constraints to be applied
+    // even if no other system has to be solved
+    int res = Success;
+    for (std::size_t i=0; i < results.size(); i++)
+        res = std::max(res, results[i]);
+
     if (res == Success) {
         for (std::set<Constraint *>::const_iterator constr=redundant.begin();
              constr != redundant.end(); ++constr){
@@ -1595,6 +1647,46 @@ int System::solve(bool isFine, Algorithm alg, bool isRedundantsolving)
     return res;
 }
 
+int System::solveAffected(bool isFine, Algorithm alg, bool isRedundantsolving)
+{
+    if (!isInit)
+        return Failed;
+
+    // The components without temporary constraints keep their current solution.
+    // There is no reset to the reference so that each component starts from the
+    // solution of the previous call.
+    int res = Success;
+    for (int cid=0; cid < int(subSystemsAux.size()); cid++) {
+        if (!subSystemsAux[cid])
+            continue;
+        if (subSystems[cid])
+            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving));
+        else
+            res = std::max(res, solve(subSystemsAux[cid], isFine, alg, isRedundantsolving));
+    }
+    if (res == Success) {
+        for (std::set<Constraint *>::const_iterator constr=redundant.begin();
+             constr != redundant.end(); ++constr) {
+            double err = (*constr)->error();
+            if (err*err > (isRedundantsolving?convergenceRedundant:convergence))
+                return Converged;
+        }
+    }
+    return res;
+}
+
+void System::getAffectedParams(VEC_pD &params) const
+{
+    params.clear();
+    if (!isInit)
+        return;
+
+    for (int cid=0; cid < int(subSystemsAux.size()); cid++) {
+        if (subSystemsAux[cid])
+            params.insert(params.end(), plists[cid].begin(), plists[cid].end());
+    }
+}
+
 int System::solve(SubSystem *subsys, bool isFine, Algorithm alg, bool isRedundantsolving)
 {
     if (alg == BFGS)
@@ -1743,10 +1835,16 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         return Success;
 
     Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
-    Eigen::MatrixXd J(csize, xsize);        // Jacobi of the subsystem
-    Eigen::MatrixXd A(xsize, xsize);
+    Eigen::MatrixXd J;                      // Jacobi of the subsystem
+    Eigen::MatrixXd A;
     Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
 
+    // sparse counterparts of J and A, the pattern of A doesn't change between the iterations
+    bool sparse = (jacobianType == SparseJacobian);
+    Eigen::SparseMatrix<double> Js, As, As_mu;
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldltA;
+    bool isPatternAnalyzed = false;
+
     subsys->redirectParams();
 
     subsys->getParams(x);
@@ -1792,14 +1890,23 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         }
 
         // J^T J, J^T e
-        subsys->calcJacobi(J);;
+        if (sparse) {
+            subsys->calcJacobi(Js);
+
+            As = Js.transpose()*Js;
+            g = Js.transpose()*e;
+            diag_A = As.diagonal();
+        }
+        else {
+            subsys->calcJacobi(J);
 
-        A = J.transpose()*J;
-        g = J.transpose()*e;
+            A = J.transpose()*J;
+            g = J.transpose()*e;
+            diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
+        }
 
         // Compute ||J^T e||_inf
         double g_inf = g.lpNorm<Eigen::Infinity>();
-        diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
 
         // check for convergence
         if (g_inf <= eps1) {
@@ -1815,13 +1922,35 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         // determine increment using adaptive damping
         int k=0;
         while (k < 50) {
-            // augment normal equations A = A+uI
-            for (int i=0; i < xsize; ++i)
-                A(i,i) += mu;
+            double rel_error;
+            if (sparse) {
+                // augment normal equations A = A+uI, A is kept unchanged
+                As_mu = As;
+                for (int i=0; i < xsize; ++i)
+                    As_mu.coeffRef(i,i) += mu;
+
+                //solve augmented functions A*h=-g
+                if (!isPatternAnalyzed) {
+                    ldltA.analyzePattern(As_mu);
+                    isPatternAnalyzed = true;
+                }
+                ldltA.factorize(As_mu);
+                if (ldltA.info() == Eigen::Success) {
+                    h = ldltA.solve(g);
+                    rel_error = (As_mu*h - g).norm() / g.norm();
+                }
+                else
+                    rel_error = 1.; // reject the increment and increase the damping
+            }
+            else {
+                // augment normal equations A = A+uI
+                for (int i=0; i < xsize; ++i)
+                    A(i,i) += mu;
 
-            //solve augmented functions A*h=-g
-            h = A.fullPivLu().solve(g);
-            double rel_error = (A*h - g).norm() / g.norm();
+                //solve augmented functions A*h=-g
+                h = A.fullPivLu().solve(g);
+                rel_error = (A*h - g).norm() / g.norm();
+            }
 
             // check if solving works
             if (rel_error < 1e-5) {
@@ -1868,8 +1997,10 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
 
             mu*=nu;
             nu*=2.0;
-            for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
-                A(i,i) = diag_A(i);
+            if (!sparse) {
+                for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
+                    A(i,i) = diag_A(i);
+            }
 
             k++;
         }
@@ -1937,17 +2068,30 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
 
     Eigen::VectorXd x(xsize), x_new(xsize);
     Eigen::VectorXd fx(csize), fx_new(csize);
-    Eigen::MatrixXd Jx(csize, xsize), Jx_new(csize, xsize);
+    Eigen::MatrixXd Jx, Jx_new;
     Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
 
+    // With a sparse Jacobian the gauss-newton step is always the least norm solution. J*J^T is
+    // factorized by a sparse Cholesky decomposition whose pattern doesn't change between the
+    // iterations. Only if it fails, e.g. for redundant constraints, a dense FullPivLU is used.
+    bool sparse = (jacobianType == SparseJacobian);
+    Eigen::SparseMatrix<double> Jsx, Jsx_new;
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldltJJt;
+    bool isPatternAnalyzed = false;
+
     subsys->redirectParams();
 
     double err;
     subsys->getParams(x);
     subsys->calcResidual(fx, err);
-    subsys->calcJacobi(Jx);
-
-    g = Jx.transpose()*(-fx);
+    if (sparse) {
+        subsys->calcJacobi(Jsx);
+        g = Jsx.transpose()*(-fx);
+    }
+    else {
+        subsys->calcJacobi(Jx);
+        g = Jx.transpose()*(-fx);
+    }
 
     // get the infinity norm fx_inf and g_inf
     double g_inf = g.lpNorm<Eigen::Infinity>();
@@ -1975,25 +2119,45 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         }
         else {
             // get the steepest descent direction
-            alpha = g.squaredNorm()/(Jx*g).squaredNorm();
+            if (sparse)
+                alpha = g.squaredNorm()/(Jsx*g).squaredNorm();
+            else
+                alpha = g.squaredNorm()/(Jx*g).squaredNorm();
             h_sd  = alpha*g;
 
             // get the gauss-newton step
             // http://forum.freecadweb.org/viewtopic.php?f=10&t=12769&start=50#p106220
             // https://forum.kde.org/viewtopic.php?f=74&t=129439#p346104
-            switch (dogLegGaussStep){
-                case FullPivLU:
-                    h_gn = Jx.fullPivLu().solve(-fx);
-                    break;
-                case LeastNormFullPivLU:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
-                    break;
-                case LeastNormLdlt:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
-                    break;
+            double rel_error;
+            if (sparse) {
+                Eigen::SparseMatrix<double> JJt = Jsx*Jsx.transpose();
+                if (!isPatternAnalyzed) {
+                    ldltJJt.analyzePattern(JJt);
+                    isPatternAnalyzed = true;
+                }
+                ldltJJt.factorize(JJt);
+                if (ldltJJt.info() == Eigen::Success)
+                    h_gn = Jsx.transpose()*ldltJJt.solve(-fx);
+                if (ldltJJt.info() != Eigen::Success || !h_gn.allFinite())
+                    h_gn = Eigen::MatrixXd(Jsx).fullPivLu().solve(-fx);
+
+                rel_error = (Jsx*h_gn + fx).norm() / fx.norm();
             }
+            else {
+                switch (dogLegGaussStep){
+                    case FullPivLU:
+                        h_gn = Jx.fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormFullPivLU:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormLdlt:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
+                        break;
+                }
 
-            double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+                rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+            }
             if (rel_error > 1e15)
                 break;
 
@@ -2041,20 +2205,33 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         x_new = x + h_dl;
         subsys->setParams(x_new);
         subsys->calcResidual(fx_new, err_new);
-        subsys->calcJacobi(Jx_new);
+        if (sparse)
+            subsys->calcJacobi(Jsx_new);
+        else
+            subsys->calcJacobi(Jx_new);
 
         // calculate the linear model and the update ratio
-        double dL = err - 0.5*(fx + Jx*h_dl).squaredNorm();
+        double dL;
+        if (sparse)
+            dL = err - 0.5*(fx + Jsx*h_dl).squaredNorm();
+        else
+            dL = err - 0.5*(fx + Jx*h_dl).squaredNorm();
         double dF = err - err_new;
         double rho = dL/dF;
 
         if (dF > 0 && dL > 0) {
             x  = x_new;
-            Jx = Jx_new;
             fx = fx_new;
             err = err_new;
 
-            g = Jx.transpose()*(-fx);
+            if (sparse) {
+                Jsx.swap(Jsx_new);
+                g = Jsx.transpose()*(-fx);
+            }
+            else {
+                Jx = Jx_new;
+                g = Jx.transpose()*(-fx);
+            }
 
             // get infinity norms
             g_inf = g.lpNorm<Eigen::Infinity>();
@@ -3827,10 +4004,11 @@ void System::makeReducedJacobian(Eigen::MatrixXd &J,
                                  std::map< int , int> &tagmultiplicity)
 {
     // construct specific parameter list for diagonose ignoring driven constraint parameters
+    SET_pD drivenset(pdrivenlist.begin(), pdrivenlist.end());
+    MAP_pD_I diagnoseindex; // column of a parameter in the reduced Jacobian
     for (int j=0; j < int(plist.size()); j++) {
-        auto result1 = std::find(std::begin(pdrivenlist), std::end(pdrivenlist), plist[j]);
-
-        if (result1 == std::end(pdrivenlist)) {
+        if (drivenset.find(plist[j]) == drivenset.end()) {
+            diagnoseindex[plist[j]] = static_cast<int>(pdiagnoselist.size());
             pdiagnoselist.push_back(plist[j]);
         }
     }
@@ -3845,8 +4023,12 @@ void System::makeReducedJacobian(Eigen::MatrixXd &J,
         ++allcount;
         if ((*constr)->getTag() >= 0 && (*constr)->isDriving()) {
             jacobianconstraintcount++;
-            for (int j=0; j < int(pdiagnoselist.size()); j++) {
-                J(jacobianconstraintcount-1,j) = (*constr)->grad(pdiagnoselist[j]);
+            // the gradient is zero for all parameters the constraint doesn't depend on
+            const VEC_pD &cparams = c2p[*constr];
+            for (VEC_pD::const_iterator param = cparams.begin(); param != cparams.end(); ++param) {
+                MAP_pD_I::const_iterator it = diagnoseindex.find(*param);
+                if (it != diagnoseindex.end())
+                    J(jacobianconstraintcount-1,it->second) = (*constr)->grad(*param);
             }
 
             // parallel processing: create tag multiplicity map
@@ -3979,116 +4161,339 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
     }
 #endif
 
-    if(qrAlgorithm==EigenDenseQR){
+    if (J.rows() > 0) {
     #ifdef PROFILE_DIAGNOSE
-        Base::TimeInfo DenseQR_start_time;
+        Base::TimeInfo QR_start_time;
     #endif
-        if (J.rows() > 0) {
-            int rank = 0; // rank is not cheap to retrieve from qrJT in DenseQR
-            Eigen::MatrixXd R;
-            Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT;
-            // Here we give the system the possibility to run the two QR decompositions in parallel, depending on the load of the system
-            // so we are using the default std::launch::async | std::launch::deferred policy, as nobody better than the system
-            // nows if it can run the task in parallel or is oversubscribed and should deferred it.
-            // Care to wait() for the future before any prospective detection of conflicting/redundant, because the redundant solve
-            // modifies pdiagnoselist and it would NOT be thread-safe. Care to call the thread with silent=true, unless the present thread
-            // does not use Base::Console, or the launch policy is set to std::launch::deferred policy, as it is not thread-safe to use them
-            // in both at the same time.
-            //
-            // identifyDependentParametersDenseQR(J, jacobianconstraintmap, pdiagnoselist, true)
-            //
-            auto fut = std::async(&System::identifyDependentParametersDenseQR,this,J,jacobianconstraintmap, pdiagnoselist, true);
+        // The reduced Jacobian is block diagonal with a block for each decoupled part of the sketch and the
+        // QR decomposition of a block diagonal matrix is made of the decompositions of the blocks. Thus, the
+        // blocks are decomposed on their own and concurrently. For each block the decomposition of the
+        // transposed block (constraints) and of the block (parameters) are independent tasks too.
+        //
+        // The tasks are silent as Base::Console is not thread-safe. For the iteration level output they run
+        // sequentially and the decomposition of the constraints reports to the console.
+        std::vector<DiagnoseBlock> blocks;
+        GCS::VEC_pD freeParams; // parameters that no driving constraint depends on
+        makeDiagnoseBlocks(J, jacobianconstraintmap, pdiagnoselist, blocks, freeParams);
+
+        // Only the blocks that are not known from the last diagnosis are decomposed
+        std::vector<std::size_t> hashes(blocks.size());
+        VEC_I decomposed;
+        for (std::size_t b=0; b < blocks.size(); b++) {
+            hashes[b] = hashDiagnoseBlock(blocks[b]);
+            if (!restoreDiagnoseBlock(blocks[b], hashes[b]))
+                decomposed.push_back(int(b));
+        }
 
-            makeDenseQRDecomposition( J, jacobianconstraintmap, qrJT, rank, R);
+        bool parallel = (debugMode != IterationLevel);
+    #ifdef _GCS_DEBUG
+        parallel = false;
+    #endif
+        parallelFor(2 * int(decomposed.size()), parallel, [&](int i) {
+            if (i % 2 == 0)
+                diagnoseBlockConstraints(blocks[decomposed[i/2]], /*silent=*/parallel);
+            else
+                diagnoseBlockParameters(blocks[decomposed[i/2]]);
+        });
 
-            int paramsNum = qrJT.rows();
-            int constrNum = qrJT.cols();
+        if(debugMode==Minimal || debugMode==IterationLevel) {
+            Base::Console().Log("Sketcher diagnosis: %d of %d blocks decomposed\n",
+                                int(decomposed.size()), int(blocks.size()));
+        }
 
-            // This function is legacy code that was used to obtain partial geometry dependency information from a SINGLE Dense QR
-            // decomposition. I am reluctant to remove it from here until everything new is well tested.
-            //identifyDependentGeometryParametersInTransposedJacobianDenseQRDecomposition( qrJT, pdiagnoselist, paramsNum, rank);
+        // keep the results for the next diagnosis
+        diagnoseCache.clear();
+        for (std::size_t b=0; b < blocks.size(); b++) {
+            DiagnoseCacheEntry entry;
+            entry.qrAlgorithm = qrAlgorithm;
+            entry.qrpivotThreshold = qrpivotThreshold;
+            entry.block.J = blocks[b].J;
+            entry.block.paramsNum = blocks[b].paramsNum;
+            entry.block.constrNum = blocks[b].constrNum;
+            entry.block.rank = blocks[b].rank;
+            entry.block.conflictGroups = blocks[b].conflictGroups;
+            entry.block.dependentParametersGroups = blocks[b].dependentParametersGroups;
+            diagnoseCache.insert(std::make_pair(hashes[b], entry));
+        }
 
-            fut.wait(); // wait for the execution of identifyDependentParametersSparseQR to finish
+        int paramsNum = int(pdiagnoselist.size());
+        int constrNum = 0;
+        int rank = 0;
+        std::vector< std::vector<Constraint *> > conflictGroups;
+        pDependentParameters.clear();
+        pDependentParametersGroups.clear();
+        for (std::vector<DiagnoseBlock>::iterator block=blocks.begin(); block != blocks.end(); ++block) {
+            constrNum += block->constrNum;
+            rank += block->rank;
+            for (std::size_t i=0; i < block->conflictGroups.size(); i++) {
+                const VEC_I &rows = block->conflictGroups[i];
+                std::vector<Constraint *> group;
+                for (std::size_t j=0; j < rows.size(); j++)
+                    group.push_back(clist[block->jacobianconstraintmap.at(rows[j])]);
+                conflictGroups.push_back(group);
+            }
+            for (std::size_t i=0; i < block->dependentParametersGroups.size(); i++) {
+                const VEC_I &cols = block->dependentParametersGroups[i];
+                std::vector<double *> group;
+                for (std::size_t j=0; j < cols.size(); j++)
+                    group.push_back(block->pdiagnoselist[cols[j]]);
+                pDependentParametersGroups.push_back(group);
+                pDependentParameters.insert(pDependentParameters.end(), group.begin(), group.end());
+            }
+        }
+        for (VEC_pD::const_iterator param=freeParams.begin(); param != freeParams.end(); ++param) {
+            pDependentParametersGroups.push_back(std::vector<double *>(1, *param));
+            pDependentParameters.push_back(*param);
+        }
 
-            dofs = paramsNum - rank; // unless overconstraint, which will be overridden below
+        dofs = paramsNum - rank; // unless overconstraint, which will be overridden below
 
-            // Detecting conflicting or redundant constraints
-            if (constrNum > rank) { // conflicting or redundant constraints
+        // Detecting conflicting or redundant constraints
+        if (constrNum > rank) { // conflicting or redundant constraints
 
-                int nonredundantconstrNum;
+            int nonredundantconstrNum;
 
-                identifyConflictingRedundantConstraints(alg, qrJT, jacobianconstraintmap, tagmultiplicity, pdiagnoselist,
-                                                        R, constrNum, rank, nonredundantconstrNum);
+            identifyConflictingRedundantConstraints(alg, conflictGroups, tagmultiplicity, blocks,
+                                                    constrNum, nonredundantconstrNum);
 
-                if (paramsNum == rank && nonredundantconstrNum > rank) // over-constrained
-                    dofs = paramsNum - nonredundantconstrNum;
-            }
+            if (paramsNum == rank && nonredundantconstrNum > rank) // over-constrained
+                dofs = paramsNum - nonredundantconstrNum;
         }
+
     #ifdef PROFILE_DIAGNOSE
-        Base::TimeInfo DenseQR_end_time;
+        Base::TimeInfo QR_end_time;
 
-        auto SolveTime = Base::TimeInfo::diffTimeF(DenseQR_start_time,DenseQR_end_time);
+        auto SolveTime = Base::TimeInfo::diffTimeF(QR_start_time,QR_end_time);
 
-        Base::Console().Log("\nDenseQR - Lapsed Time: %f seconds\n", SolveTime);
+        Base::Console().Log("\n%s - %d blocks - Lapsed Time: %f seconds\n",
+                            (qrAlgorithm == EigenSparseQR ? "SparseQR" : "DenseQR"), int(blocks.size()), SolveTime);
     #endif
     }
 
-#ifdef EIGEN_SPARSEQR_COMPATIBLE
-    else if(qrAlgorithm==EigenSparseQR){
-    #ifdef PROFILE_DIAGNOSE
-        Base::TimeInfo SparseQR_start_time;
-    #endif
-        if (J.rows() > 0) {
-            int rank = 0;
-            Eigen::MatrixXd R;
-            Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > SqrJT;
-            // Here we give the system the possibility to run the two QR decompositions in parallel, depending on the load of the system
-            // so we are using the default std::launch::async | std::launch::deferred policy, as nobody better than the system
-            // nows if it can run the task in parallel or is oversubscribed and should deferred it.
-            // Care to wait() for the future before any prospective detection of conflicting/redundant, because the redundant solve
-            // modifies pdiagnoselist and it would NOT be thread-safe. Care to call the thread with silent=true, unless the present thread
-            // does not use Base::Console, or the launch policy is set to std::launch::deferred policy, as it is not thread-safe to use them
-            // in both at the same time.
-            //
-            // identifyDependentParametersSparseQR(J, jacobianconstraintmap, pdiagnoselist, true)
-            //
-            // Debug:
-            //auto fut = std::async(std::launch::deferred,&System::identifyDependentParametersSparseQR,this,J,jacobianconstraintmap, pdiagnoselist, false);
-            auto fut = std::async(&System::identifyDependentParametersSparseQR,this,J,jacobianconstraintmap, pdiagnoselist, /*silent=*/true);
-
-            makeSparseQRDecomposition( J, jacobianconstraintmap, SqrJT, rank, R, /*transposed=*/true, /*silent=*/false);
-
-            int paramsNum = SqrJT.rows();
-            int constrNum = SqrJT.cols();
-
-            fut.wait(); // wait for the execution of identifyDependentParametersSparseQR to finish
-
-            dofs = paramsNum - rank; // unless overconstraint, which will be overridden below
-
-            // Detecting conflicting or redundant constraints
-            if (constrNum > rank) { // conflicting or redundant constraints
-
-                int nonredundantconstrNum;
-
-                identifyConflictingRedundantConstraints(alg, SqrJT, jacobianconstraintmap, tagmultiplicity, pdiagnoselist,
-                                                        R, constrNum, rank, nonredundantconstrNum);
-
-                if (paramsNum == rank && nonredundantconstrNum > rank) // over-constrained
-                    dofs = paramsNum - nonredundantconstrNum;
+    return dofs;
+}
+
+void System::makeDiagnoseBlocks(const Eigen::MatrixXd &J,
+                                const std::map<int,int> &jacobianconstraintmap,
+                                const GCS::VEC_pD &pdiagnoselist,
+                                std::vector<DiagnoseBlock> &blocks,
+                                GCS::VEC_pD &freeParams)
+{
+    int rowsNum = int(jacobianconstraintmap.size());
+    int colsNum = int(J.cols());
+
+    MAP_pD_I colIndex;
+    for (int j=0; j < colsNum; j++)
+        colIndex[pdiagnoselist[j]] = j;
+
+    // union-find of the columns that share a constraint, this uses the parameters of the
+    // constraints and not the values of J, so that blocks stay decoupled while solving
+    VEC_I parent(colsNum);
+    for (int j=0; j < colsNum; j++)
+        parent[j] = j;
+    auto findRoot = [&parent](int j) {
+        while (parent[j] != j) {
+            parent[j] = parent[parent[j]];
+            j = parent[j];
+        }
+        return j;
+    };
+
+    VEC_I firstCol(rowsNum, -1);
+    for (int i=0; i < rowsNum; i++) {
+        const VEC_pD &cparams = c2p[clist[jacobianconstraintmap.at(i)]];
+        for (VEC_pD::const_iterator param=cparams.begin(); param != cparams.end(); ++param) {
+            MAP_pD_I::const_iterator it = colIndex.find(*param);
+            if (it == colIndex.end())
+                continue;
+            if (firstCol[i] < 0)
+                firstCol[i] = it->second;
+            else
+                parent[findRoot(it->second)] = findRoot(firstCol[i]);
+        }
+    }
+
+    // the constraints without any diagnosed parameter make up an extra block without columns
+    VEC_I blockOfRoot(colsNum, -1);
+    std::vector<VEC_I> blockRows, blockCols;
+    int zeroBlock = -1;
+    for (int i=0; i < rowsNum; i++) {
+        int b;
+        if (firstCol[i] < 0) {
+            if (zeroBlock < 0) {
+                zeroBlock = int(blockRows.size());
+                blockRows.push_back(VEC_I());
+                blockCols.push_back(VEC_I());
             }
+            b = zeroBlock;
         }
+        else {
+            int root = findRoot(firstCol[i]);
+            if (blockOfRoot[root] < 0) {
+                blockOfRoot[root] = int(blockRows.size());
+                blockRows.push_back(VEC_I());
+                blockCols.push_back(VEC_I());
+            }
+            b = blockOfRoot[root];
+        }
+        blockRows[b].push_back(i);
+    }
 
-        #ifdef PROFILE_DIAGNOSE
-        Base::TimeInfo SparseQR_end_time;
+    for (int j=0; j < colsNum; j++) {
+        int b = blockOfRoot[findRoot(j)];
+        if (b < 0)
+            freeParams.push_back(pdiagnoselist[j]);
+        else
+            blockCols[b].push_back(j);
+    }
 
-        auto SolveTime = Base::TimeInfo::diffTimeF(SparseQR_start_time,SparseQR_end_time);
+    blocks.resize(blockRows.size());
+    for (std::size_t b=0; b < blocks.size(); b++) {
+        const VEC_I &rows = blockRows[b];
+        const VEC_I &cols = blockCols[b];
+        DiagnoseBlock &block = blocks[b];
+        block.J.resize(rows.size(), cols.size());
+        for (std::size_t i=0; i < rows.size(); i++) {
+            block.jacobianconstraintmap[int(i)] = jacobianconstraintmap.at(rows[i]);
+            for (std::size_t j=0; j < cols.size(); j++)
+                block.J(i,j) = J(rows[i],cols[j]);
+        }
+        for (std::size_t j=0; j < cols.size(); j++)
+            block.pdiagnoselist.push_back(pdiagnoselist[cols[j]]);
+    }
+}
 
-        Base::Console().Log("\nSparseQR - Lapsed Time: %f seconds\n", SolveTime);
-        #endif
+std::size_t System::hashDiagnoseBlock(const DiagnoseBlock &block)
+{
+    std::size_t hash = 0;
+    boost::hash_combine(hash, block.J.rows());
+    boost::hash_combine(hash, block.J.cols());
+    boost::hash_range(hash, block.J.data(), block.J.data() + block.J.size());
+    return hash;
+}
+
+bool System::restoreDiagnoseBlock(DiagnoseBlock &block, std::size_t hash) const
+{
+    auto range = diagnoseCache.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const DiagnoseCacheEntry &entry = it->second;
+        // the block must be identical, not only similar, as the rank decisions depend on the exact values
+        if (entry.qrAlgorithm == qrAlgorithm && entry.qrpivotThreshold == qrpivotThreshold &&
+            entry.block.J.rows() == block.J.rows() && entry.block.J.cols() == block.J.cols() &&
+            entry.block.J == block.J) {
+            block.paramsNum = entry.block.paramsNum;
+            block.constrNum = entry.block.constrNum;
+            block.rank = entry.block.rank;
+            block.conflictGroups = entry.block.conflictGroups;
+            block.dependentParametersGroups = entry.block.dependentParametersGroups;
+            return true;
+        }
+    }
+    return false;
+}
+
+void System::makeRedundancySignature(const DiagnoseBlock &block, const std::set<Constraint *> &skipped,
+                                     Algorithm alg, VEC_D &signature)
+{
+    signature.clear();
+    signature.push_back(alg);
+    signature.push_back(jacobianType);
+    signature.push_back(maxIterRedundant);
+    signature.push_back(sketchSizeMultiplierRedundant);
+    signature.push_back(convergenceRedundant);
+    signature.push_back(LM_epsRedundant);
+    signature.push_back(LM_eps1Redundant);
+    signature.push_back(LM_tauRedundant);
+    signature.push_back(DL_tolgRedundant);
+    signature.push_back(DL_tolxRedundant);
+    signature.push_back(DL_tolfRedundant);
+
+    std::map<double *,int> colIndex;
+    for (std::size_t j=0; j < block.pdiagnoselist.size(); j++)
+        colIndex[block.pdiagnoselist[j]] = int(j);
+
+    for (std::map<int,int>::const_iterator it=block.jacobianconstraintmap.begin();
+        it != block.jacobianconstraintmap.end(); ++it) {
+        Constraint *constr = clist[it->second];
+        signature.push_back(constr->getTypeId());
+        signature.push_back(skipped.count(constr));
+        signature.push_back(constr->error());
+        VEC_pD params = constr->params();
+        signature.push_back(params.size());
+        for (VEC_pD::const_iterator param=params.begin(); param != params.end(); ++param) {
+            std::map<double *,int>::const_iterator col = colIndex.find(*param);
+            signature.push_back(col != colIndex.end() ? col->second : -1);
+            signature.push_back(**param);
+        }
+    }
+}
+
+bool System::restoreRedundancy(RedundancyCacheEntry &entry, std::size_t hash) const
+{
+    auto range = redundancyCache.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.signature == entry.signature) {
+            entry.result = it->second.result;
+            entry.redundantRows = it->second.redundantRows;
+            return true;
+        }
+    }
+    return false;
+}
+
+void System::diagnoseBlockConstraints(DiagnoseBlock &block, bool silent)
+{
+    block.rank = 0;
+    if (block.J.cols() == 0) {
+        // a constraint with a zero gradient is a conflict group on its own
+        block.constrNum = int(block.J.rows());
+        for (int i=0; i < block.constrNum; i++)
+            block.conflictGroups.push_back(VEC_I(1, i));
+        return;
+    }
+
+    Eigen::MatrixXd R;
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+    if (qrAlgorithm==EigenSparseQR) {
+        Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > SqrJT;
+        makeSparseQRDecomposition(block.J, block.jacobianconstraintmap, SqrJT, block.rank, R, /*transposed=*/true, silent);
+
+        block.paramsNum = SqrJT.rows();
+        block.constrNum = SqrJT.cols();
+        if (block.constrNum > block.rank)
+            makeConflictGroups(SqrJT, R, block.constrNum, block.rank, block.conflictGroups);
+        return;
     }
 #endif
 
-    return dofs;
+    Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT;
+    makeDenseQRDecomposition(block.J, block.jacobianconstraintmap, qrJT, block.rank, R, /*transposed=*/true, silent);
+
+    // This function is legacy code that was used to obtain partial geometry dependency information from a SINGLE Dense QR
+    // decomposition. I am reluctant to remove it from here until everything new is well tested.
+    //identifyDependentGeometryParametersInTransposedJacobianDenseQRDecomposition( qrJT, pdiagnoselist, paramsNum, rank);
+
+    block.paramsNum = qrJT.rows();
+    block.constrNum = qrJT.cols();
+    if (block.constrNum > block.rank)
+        makeConflictGroups(qrJT, R, block.constrNum, block.rank, block.conflictGroups);
+}
+
+void System::diagnoseBlockParameters(DiagnoseBlock &block)
+{
+    if (block.J.cols() == 0)
+        return;
+
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+    if (qrAlgorithm==EigenSparseQR) {
+        identifyDependentParametersSparseQR(block.J, block.jacobianconstraintmap, block.pdiagnoselist,
+                                            block.dependentParametersGroups, /*silent=*/true);
+        return;
+    }
+#endif
+
+    identifyDependentParametersDenseQR(block.J, block.jacobianconstraintmap, block.pdiagnoselist,
+                                       block.dependentParametersGroups, /*silent=*/true);
 }
 
 void System::makeDenseQRDecomposition(  const Eigen::MatrixXd &J,
@@ -4250,32 +4655,34 @@ void System::makeSparseQRDecomposition( const Eigen::MatrixXd &J,
 void System::identifyDependentParametersDenseQR( const Eigen::MatrixXd &J,
                                                   const std::map<int,int> &jacobianconstraintmap,
                                                   const GCS::VEC_pD &pdiagnoselist,
+                                                  std::vector<VEC_I> &dependentParametersGroups,
                                                   bool silent)
 {
     Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJ;
     Eigen::MatrixXd Rparams;
 
-    int rank;
+    int rank = 0;
 
     makeDenseQRDecomposition( J, jacobianconstraintmap, qrJ, rank, Rparams, false, true);
 
-    identifyDependentParameters(qrJ, Rparams, rank, pdiagnoselist, silent);
+    identifyDependentParameters(qrJ, Rparams, rank, pdiagnoselist, dependentParametersGroups, silent);
 }
 
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
 void System::identifyDependentParametersSparseQR( const Eigen::MatrixXd &J,
                                                   const std::map<int,int> &jacobianconstraintmap,
                                                   const GCS::VEC_pD &pdiagnoselist,
+                                                  std::vector<VEC_I> &dependentParametersGroups,
                                                   bool silent)
 {
     Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > SqrJ;
     Eigen::MatrixXd Rparams;
 
-    int nontransprank;
+    int nontransprank = 0;
 
     makeSparseQRDecomposition( J, jacobianconstraintmap, SqrJ, nontransprank, Rparams, false, true); // do not transpose allow to diagnose parameters
 
-    identifyDependentParameters(SqrJ, Rparams, nontransprank, pdiagnoselist, silent);
+    identifyDependentParameters(SqrJ, Rparams, nontransprank, pdiagnoselist, dependentParametersGroups, silent);
 }
 #endif
 
@@ -4284,9 +4691,11 @@ void System::identifyDependentParameters(   T & qrJ,
                                             Eigen::MatrixXd &Rparams,
                                             int rank,
                                             const GCS::VEC_pD &pdiagnoselist,
+                                            std::vector<VEC_I> &dependentParametersGroups,
                                             bool silent)
 {
     (void) silent; // silent is only used in debug code, but it is important as Base::Console is not thread-safe. Removes warning in non Debug mode.
+    (void) pdiagnoselist; // only used in debug code too
 
     //int constrNum = SqrJ.rows(); // this is the other way around than for the transposed J
     //int paramsNum = SqrJ.cols();
@@ -4298,27 +4707,30 @@ void System::identifyDependentParameters(   T & qrJ,
         SolverReportingManager::Manager().LogMatrix("Rparams_nonzeros_over_pilot", Rparams);
 #endif
 
-    pDependentParametersGroups.resize(qrJ.cols()-rank);
+    dependentParametersGroups.resize(qrJ.cols()-rank);
     for (int j=rank; j < qrJ.cols(); j++) {
         for (int row=0; row < rank; row++) {
             if (fabs(Rparams(row,j)) > 1e-10) {
                 int origCol = qrJ.colsPermutation().indices()[row];
 
-                pDependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
-                pDependentParameters.push_back(pdiagnoselist[origCol]);
+                dependentParametersGroups[j-rank].push_back(origCol);
             }
         }
         int origCol = qrJ.colsPermutation().indices()[j];
 
-        pDependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
-        pDependentParameters.push_back(pdiagnoselist[origCol]);
+        dependentParametersGroups[j-rank].push_back(origCol);
     }
 
 #ifdef _GCS_DEBUG
     if(!silent) {
         SolverReportingManager::Manager().LogMatrix("PermMatrix", (Eigen::MatrixXd)qrJ.colsPermutation());
 
-        SolverReportingManager::Manager().LogGroupOfParameters("ParameterGroups",pDependentParametersGroups);
+        std::vector< std::vector<double *> > parameterGroups(dependentParametersGroups.size());
+        for (std::size_t i=0; i < dependentParametersGroups.size(); i++) {
+            for (std::size_t j=0; j < dependentParametersGroups[i].size(); j++)
+                parameterGroups[i].push_back(pdiagnoselist[dependentParametersGroups[i][j]]);
+        }
+        SolverReportingManager::Manager().LogGroupOfParameters("ParameterGroups",parameterGroups);
     }
 
 #endif
@@ -4426,32 +4838,37 @@ void System::eliminateNonZerosOverPivotInUpperTriangularMatrix( Eigen::MatrixXd
 }
 
 template <typename T>
-void System::identifyConflictingRedundantConstraints(   Algorithm alg,
-                                                        const T & qrJT,
-                                                        const std::map<int,int> &jacobianconstraintmap,
-                                                        const std::map< int , int> &tagmultiplicity,
-                                                        GCS::VEC_pD &pdiagnoselist,
-                                                        Eigen::MatrixXd &R,
-                                                        int constrNum, int rank,
-                                                        int &nonredundantconstrNum
-                                                    )
+void System::makeConflictGroups(    const T & qrJT,
+                                    Eigen::MatrixXd &R,
+                                    int constrNum, int rank,
+                                    std::vector<VEC_I> &conflictGroups
+                                )
 {
     eliminateNonZerosOverPivotInUpperTriangularMatrix(R, rank);
 
-    std::vector< std::vector<Constraint *> > conflictGroups(constrNum-rank);
+    conflictGroups.resize(constrNum-rank);
     for (int j=rank; j < constrNum; j++) {
         for (int row=0; row < rank; row++) {
             if (fabs(R(row,j)) > 1e-10) {
                 int origCol = qrJT.colsPermutation().indices()[row];
 
-                conflictGroups[j-rank].push_back(clist[jacobianconstraintmap.at(origCol)]);
+                conflictGroups[j-rank].push_back(origCol);
             }
         }
         int origCol = qrJT.colsPermutation().indices()[j];
 
-        conflictGroups[j-rank].push_back(clist[jacobianconstraintmap.at(origCol)]);
+        conflictGroups[j-rank].push_back(origCol);
     }
+}
 
+void System::identifyConflictingRedundantConstraints(   Algorithm alg,
+                                                        std::vector< std::vector<Constraint *> > &conflictGroups,
+                                                        const std::map< int , int> &tagmultiplicity,
+                                                        const std::vector<DiagnoseBlock> &blocks,
+                                                        int constrNum,
+                                                        int &nonredundantconstrNum
+                                                    )
+{
     // Augment the information regarding the group of constraints that are conflicting or redundant.
     if(debugMode==IterationLevel) {
         SolverReportingManager::Manager().LogGroupOfConstraints("Analysing groups of constraints of special interest", conflictGroups);
@@ -4506,16 +4923,70 @@ void System::identifyConflictingRedundantConstraints(   Algorithm alg,
         SolverReportingManager::Manager().LogSetOfConstraints("Chosen redundants", skipped);
     }
 
-    std::vector<Constraint *> clistTmp;
-    clistTmp.reserve(clist.size());
-    for (std::vector<Constraint *>::iterator constr=clist.begin();
-        constr != clist.end(); ++constr) {
-        if ((*constr)->isDriving() && skipped.count(*constr) == 0)
-            clistTmp.push_back(*constr);
+    // Only the blocks with skipped constraints have to be solved, as the blocks are decoupled.
+    // A block that is unchanged since the last diagnosis is taken from the cache.
+    std::vector<const DiagnoseBlock *> solvedBlocks;
+    std::vector<RedundancyCacheEntry> entries;
+    std::vector<std::size_t> hashes;
+    std::vector<SubSystem *> subSysTmp; // NULL for the blocks taken from the cache
+    for (std::vector<DiagnoseBlock>::const_iterator block=blocks.begin(); block != blocks.end(); ++block) {
+        std::vector<Constraint *> clistTmp;
+        bool hasSkipped = false;
+        for (std::map<int,int>::const_iterator it=block->jacobianconstraintmap.begin();
+            it != block->jacobianconstraintmap.end(); ++it) {
+            Constraint *constr = clist[it->second];
+            if (skipped.count(constr) == 0)
+                clistTmp.push_back(constr);
+            else
+                hasSkipped = true;
+        }
+        if (hasSkipped) {
+            RedundancyCacheEntry entry;
+            makeRedundancySignature(*block, skipped, alg, entry.signature);
+            std::size_t hash = boost::hash_range(entry.signature.begin(), entry.signature.end());
+            if (restoreRedundancy(entry, hash)) {
+                subSysTmp.push_back(NULL);
+            }
+            else {
+                GCS::VEC_pD pdiagnoselist = block->pdiagnoselist;
+                subSysTmp.push_back(new SubSystem(clistTmp, pdiagnoselist));
+            }
+            solvedBlocks.push_back(&*block);
+            entries.push_back(entry);
+            hashes.push_back(hash);
+        }
     }
 
-    SubSystem *subSysTmp = new SubSystem(clistTmp, pdiagnoselist);
-    int res = solve(subSysTmp,true,alg,true);
+    bool parallel = subSysTmp.size() > 1 && debugMode != IterationLevel;
+#ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
+    parallel = false;
+#endif
+
+    parallelFor(int(subSysTmp.size()), parallel, [&](int i) {
+        if (subSysTmp[i])
+            entries[i].result = solve(subSysTmp[i],true,alg,true);
+    });
+
+    // As the blocks don't share any parameters the skipped constraints can be checked block by block
+    for (std::size_t i=0; i < subSysTmp.size(); i++) {
+        if (subSysTmp[i] && entries[i].result == Success) {
+            subSysTmp[i]->applySolution();
+            const std::map<int,int> &rows = solvedBlocks[i]->jacobianconstraintmap;
+            for (std::map<int,int>::const_iterator it=rows.begin(); it != rows.end(); ++it) {
+                Constraint *constr = clist[it->second];
+                if (skipped.count(constr) > 0) {
+                    double err = constr->error();
+                    if (err * err < convergenceRedundant)
+                        entries[i].redundantRows.push_back(it->first);
+                }
+            }
+        }
+    }
+    resetToReference();
+
+    int res = Success;
+    for (std::size_t i=0; i < entries.size(); i++)
+        res = std::max(res, entries[i].result);
 
     if(debugMode==Minimal || debugMode==IterationLevel) {
         std::string solvername;
@@ -4535,14 +5006,10 @@ void System::identifyConflictingRedundantConstraints(   Algorithm alg,
     }
 
     if (res == Success) {
-        subSysTmp->applySolution();
-        for (std::set<Constraint *>::const_iterator constr=skipped.begin();
-                constr != skipped.end(); ++constr) {
-            double err = (*constr)->error();
-            if (err * err < convergenceRedundant)
-                redundant.insert(*constr);
+        for (std::size_t i=0; i < entries.size(); i++) {
+            for (std::size_t j=0; j < entries[i].redundantRows.size(); j++)
+                redundant.insert(clist[solvedBlocks[i]->jacobianconstraintmap.at(entries[i].redundantRows[j])]);
         }
-        resetToReference();
 
         if(debugMode==Minimal || debugMode==IterationLevel) {
             Base::Console().Log("Sketcher Redundant solving: %d redundants\n",redundant.size());
@@ -4569,7 +5036,14 @@ void System::identifyConflictingRedundantConstraints(   Algorithm alg,
                 constrNum--;
         }
     }
-    delete subSysTmp;
+
+    // keep the results for the next diagnosis
+    redundancyCache.clear();
+    for (std::size_t i=0; i < entries.size(); i++)
+        redundancyCache.insert(std::make_pair(hashes[i], entries[i]));
+
+    for (std::size_t i=0; i < subSysTmp.size(); i++)
+        delete subSysTmp[i];
 
     // simplified output of conflicting tags
     SET_I conflictingTagsSet;
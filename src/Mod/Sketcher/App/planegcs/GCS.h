@@ -74,6 +74,11 @@ namespace GCS
         EigenSparseQR = 1
     };
 
+    enum JacobianType {
+        DenseJacobian = 0,
+        SparseJacobian = 1
+    };
+
     enum DebugMode {
         NoDebug = 0,
         Minimal = 1,
@@ -139,6 +144,53 @@ namespace GCS
 
         void makeReducedJacobian(Eigen::MatrixXd &J, std::map<int,int> &jacobianconstraintmap, GCS::VEC_pD &pdiagnoselist, std::map< int , int> &tagmultiplicity);
 
+        // A block of the reduced Jacobian that is decoupled from the rest of the matrix
+        // and the results of its QR decompositions. The groups refer to the rows and
+        // columns of the block.
+        struct DiagnoseBlock {
+            Eigen::MatrixXd J;
+            std::map<int,int> jacobianconstraintmap; // maps the rows of the block to clist
+            GCS::VEC_pD pdiagnoselist; // the parameters of the columns of the block
+            int paramsNum = 0;
+            int constrNum = 0;
+            int rank = 0;
+            std::vector<VEC_I> conflictGroups;
+            std::vector<VEC_I> dependentParametersGroups;
+        };
+
+        // The diagnosis of a block only depends on the values of its Jacobian. Thus, the results
+        // for the blocks of the last diagnosis are kept and reused for an identical block, e.g. if
+        // only constraints of other parts of the sketch were changed. The key is the hash of J.
+        struct DiagnoseCacheEntry {
+            QRAlgorithm qrAlgorithm;
+            double qrpivotThreshold;
+            DiagnoseBlock block;
+        };
+        std::multimap<std::size_t, DiagnoseCacheEntry> diagnoseCache;
+
+        // The check which of the skipped constraints of a block are redundant is kept as well.
+        // The signature consists of the solver settings, the types, errors and parameters of the
+        // constraints of the block and which of them were skipped.
+        struct RedundancyCacheEntry {
+            VEC_D signature;
+            int result = 0;
+            VEC_I redundantRows; // the skipped rows of the block that are redundant
+        };
+        std::multimap<std::size_t, RedundancyCacheEntry> redundancyCache;
+
+        void makeDiagnoseBlocks(const Eigen::MatrixXd &J,
+                                const std::map<int,int> &jacobianconstraintmap,
+                                const GCS::VEC_pD &pdiagnoselist,
+                                std::vector<DiagnoseBlock> &blocks,
+                                GCS::VEC_pD &freeParams);
+        void diagnoseBlockConstraints(DiagnoseBlock &block, bool silent);
+        void diagnoseBlockParameters(DiagnoseBlock &block);
+        bool restoreDiagnoseBlock(DiagnoseBlock &block, std::size_t hash) const;
+        static std::size_t hashDiagnoseBlock(const DiagnoseBlock &block);
+        void makeRedundancySignature(const DiagnoseBlock &block, const std::set<Constraint *> &skipped,
+                                     Algorithm alg, VEC_D &signature);
+        bool restoreRedundancy(RedundancyCacheEntry &entry, std::size_t hash) const;
+
         void makeDenseQRDecomposition(  const Eigen::MatrixXd &J,
                                         const std::map<int,int> &jacobianconstraintmap,
                                         Eigen::FullPivHouseholderQR<Eigen::MatrixXd>& qrJT,
@@ -160,13 +212,17 @@ namespace GCS
         );
 
         template <typename T>
+        void makeConflictGroups(    const T & qrJT,
+                                    Eigen::MatrixXd &R,
+                                    int constrNum, int rank,
+                                    std::vector<VEC_I> &conflictGroups
+        );
+
         void identifyConflictingRedundantConstraints(   Algorithm alg,
-                                                        const T & qrJT,
-                                                        const std::map<int,int> &jacobianconstraintmap,
+                                                        std::vector< std::vector<Constraint *> > &conflictGroups,
                                                         const std::map< int , int> &tagmultiplicity,
-                                                        GCS::VEC_pD &pdiagnoselist,
-                                                        Eigen::MatrixXd &R,
-                                                        int constrNum, int rank,
+                                                        const std::vector<DiagnoseBlock> &blocks,
+                                                        int constrNum,
                                                         int &nonredundantconstrNum
         );
 
@@ -176,12 +232,14 @@ namespace GCS
         void identifyDependentParametersSparseQR( const Eigen::MatrixXd &J,
                                                   const std::map<int,int> &jacobianconstraintmap,
                                                   const GCS::VEC_pD &pdiagnoselist,
+                                                  std::vector<VEC_I> &dependentParametersGroups,
                                                   bool silent=true);
 #endif
 
         void identifyDependentParametersDenseQR(  const Eigen::MatrixXd &J,
                                                   const std::map<int,int> &jacobianconstraintmap,
                                                   const GCS::VEC_pD &pdiagnoselist,
+                                                  std::vector<VEC_I> &dependentParametersGroups,
                                                   bool silent=true);
 
         template <typename T>
@@ -189,6 +247,7 @@ namespace GCS
                                             Eigen::MatrixXd &Rparams,
                                             int rank,
                                             const GCS::VEC_pD &pdiagnoselist,
+                                            std::vector<VEC_I> &dependentParametersGroups,
                                             bool silent=true);
 
         #ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
@@ -203,6 +262,7 @@ namespace GCS
         double convergenceRedundant;
         QRAlgorithm qrAlgorithm;
         DogLegGaussStep dogLegGaussStep;
+        JacobianType jacobianType; // with a sparse Jacobian LM and DogLeg use sparse Cholesky factorizations
         double qrpivotThreshold;
         DebugMode debugMode;
         double LM_eps;
@@ -347,6 +407,14 @@ namespace GCS
         int solve(SubSystem *subsys, bool isFine=true, Algorithm alg=DogLeg, bool isRedundantsolving=false);
         int solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine=true, bool isRedundantsolving=false);
 
+        // Solves only the decoupled components that hold temporary constraints (negative tags),
+        // e.g. the components of a dragged geometry. Unlike solve() the solvers start from the
+        // current parameter values instead of the reference, and the other components are not
+        // touched at all. This is meant for consecutive solutions of a drag operation.
+        int solveAffected(bool isFine=true, Algorithm alg=DogLeg, bool isRedundantsolving=false);
+        // Gets the unknown parameters of the components solved by solveAffected()
+        void getAffectedParams(VEC_pD &params) const;
+
         void applySolution();
         void undoSolution();
         //FIXME: looks like XconvergenceFine is not the solver precision, at least in DogLeg solver.
@@ -275,6 +275,28 @@ void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
     calcJacobi(plist, jacobi);
 }
 
+void SubSystem::calcJacobi(Eigen::SparseMatrix<double> &jacobi)
+{
+    typedef Eigen::Triplet<double> Triplet;
+    std::vector<Triplet> entries;
+    for (int i=0; i < csize; i++) {
+        std::map<Constraint *,VEC_pD >::const_iterator
+          constr = c2p.find(clist[i]);
+        if (constr == c2p.end())
+            continue;
+        for (VEC_pD::const_iterator param = constr->second.begin();
+             param != constr->second.end(); ++param) {
+            // c2p refers to pvals, so the position in pvals is the column
+            int j = static_cast<int>(*param - &pvals[0]);
+            entries.push_back(Triplet(i, j, clist[i]->grad(*param)));
+        }
+    }
+
+    jacobi.resize(csize, psize);
+    jacobi.setFromTriplets(entries.begin(), entries.end());
+    jacobi.makeCompressed();
+}
+
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
 {
     assert(grad.size() == int(params.size()));
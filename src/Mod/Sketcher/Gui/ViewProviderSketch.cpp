@@ -74,6 +74,7 @@
 
 # include <boost_bind_bind.hpp>
 # include <boost/scoped_ptr.hpp>
+# include <cstring>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -81,6 +82,7 @@
 #include <Base/Tools.h>
 #include <Base/Parameter.h>
 #include <Base/Console.h>
+#include <Base/TimeInfo.h>
 #include <Base/Vector3D.h>
 #include <Base/Interpreter.h>
 #include <Base/UnitsSchema.h>
@@ -214,7 +216,9 @@ struct EditData {
     RootCrossDrawStyle(0),
     EditCurvesDrawStyle(0),
     ConstraintDrawStyle(0),
-    InformationDrawStyle(0)
+    InformationDrawStyle(0),
+    DragCacheMoveId(0),
+    DrawTime(0)
     {}
 
     // pointer to the active handler for new sketch objects
@@ -248,9 +252,34 @@ struct EditData {
     std::vector<int> CurvIdToGeoId; // conversion of SoLineSet index to GeoId
     std::vector<int> PointIdToGeoId; // conversion of SoCoordinate3 index to GeoId
 
+    // Tessellation of a geometry as drawn while dragging. Geometries that are not
+    // changed by an incremental move are taken from here instead of tessellating
+    // them again, see draw().
+    struct GeoTessellation {
+        GeoTessellation() : valid(false) {}
+        std::vector<Base::Vector3d> Coords;
+        std::vector<unsigned int> Index;
+        std::vector<Base::Vector3d> Points;
+        bool valid;
+    };
+    std::vector<GeoTessellation> DragCache;
+    unsigned long DragCacheMoveId; // the solver move the cache belongs to
+
     // helper data structures for the constraint rendering
     std::vector<ConstraintType> vConstrType;
 
+    // Constraint icons as rendered by renderConstrIcon(). The key is made of all
+    // the arguments that affect the image, see constrIconKey().
+    struct RenderedConstrIcon {
+        QImage image;
+        std::vector<QRect> boundingBoxes;
+        int vPad;
+    };
+    std::map<QString, RenderedConstrIcon> ConstrIconCache;
+
+    // time of the last call of draw() in seconds
+    float DrawTime;
+
     // For each of the combined constraint icons drawn, also create a vector
     // of bounding boxes and associated constraint IDs, to go from the icon's
     // pixel coordinates to the relevant constraint IDs.
@@ -292,6 +321,32 @@ struct EditData {
 };
 
 
+// Sets the values of a multiple-value field, but only writes the range between the first
+// and the last changed value. An unchanged field isn't touched at all, so that Coin
+// doesn't have to notify the scene graph and to send the data to the GPU again.
+template <typename Field, typename Value>
+static void updateFieldValues(Field &field, const std::vector<Value> &values)
+{
+    int num = static_cast<int>(values.size());
+    if (field.getNum() != num) {
+        field.setNum(num);
+        if (num > 0)
+            field.setValues(0, num, values.data());
+        return;
+    }
+
+    const Value *old = field.getValues(0);
+    int first = 0;
+    while (first < num && old[first] == values[first])
+        first++;
+    if (first == num)
+        return;
+    int last = num - 1;
+    while (last > first && old[last] == values[last])
+        last--;
+    field.setValues(first, last - first + 1, &values[first]);
+}
+
 // this function is used to simulate cyclic periodic negative geometry indices (for external geometry)
 const Part::Geometry* GeoById(const std::vector<Part::Geometry*> GeoList, int Id)
 {
@@ -1300,7 +1355,8 @@ bool ViewProviderSketch::mouseMove(const SbVec2s &cursorPos, Gui::View3DInventor
                     if (getSketchObject()->moveTemporaryPoint(GeoId, PosId, vec, false) == 0) {
                         setPositionText(Base::Vector2d(x,y));
                         draw(true,false);
-                        signalSolved(QString::fromLatin1("Solved in %1 sec").arg(getSolvedSketch().getSolveTime()));
+                        signalSolved(QString::fromLatin1("Solved in %1 sec, drawn in %2 sec")
+                                      .arg(getSolvedSketch().getSolveTime()).arg(edit->DrawTime));
                     } else {
                         signalSolved(QString::fromLatin1("Unsolved (%1 sec)").arg(getSolvedSketch().getSolveTime()));
                         //Base::Console().Log("Error solving:%d\n",ret);
@@ -1341,7 +1397,8 @@ bool ViewProviderSketch::mouseMove(const SbVec2s &cursorPos, Gui::View3DInventor
                 if (getSketchObject()->moveTemporaryPoint(edit->DragCurve, Sketcher::none, vec, relative) == 0) {
                     setPositionText(Base::Vector2d(x,y));
                     draw(true,false);
-                    signalSolved(QString::fromLatin1("Solved in %1 sec").arg(getSolvedSketch().getSolveTime()));
+                    signalSolved(QString::fromLatin1("Solved in %1 sec, drawn in %2 sec")
+                                  .arg(getSolvedSketch().getSolveTime()).arg(edit->DrawTime));
                 } else {
                     signalSolved(QString::fromLatin1("Unsolved (%1 sec)").arg(getSolvedSketch().getSolveTime()));
                 }
@@ -3274,7 +3331,17 @@ void ViewProviderSketch::sendConstraintIconToCoin(const QImage &icon, SoImage *s
     SbVec2s iconSize(icon.width(), icon.height());
 
     int four = 4;
-    soImagePtr->image.setValue(iconSize, 4, icondata.getValue(iconSize, four));
+    const unsigned char *data = icondata.getValue(iconSize, four);
+
+    // Don't replace an identical image, as Coin would create its texture again
+    SbVec2s oldSize;
+    int oldComponents;
+    const unsigned char *oldData = soImagePtr->image.getValue(oldSize, oldComponents);
+    if (oldData && oldSize == iconSize && oldComponents == 4 &&
+        std::memcmp(oldData, data, 4 * iconSize[0] * iconSize[1]) == 0)
+        return;
+
+    soImagePtr->image.setValue(iconSize, 4, data);
 
     //Set Image Alignment to Center
     soImagePtr->vertAlignment = SoImage::HALF;
@@ -3540,7 +3607,8 @@ void ViewProviderSketch::combineConstraintIcons(IconQueue iconQueue)
 
 void ViewProviderSketch::drawMergedConstraintIcons(IconQueue iconQueue)
 {
-    for(IconQueue::iterator i = iconQueue.begin(); i != iconQueue.end(); ++i) {
+    // the first destination receives the combined icon
+    for(IconQueue::iterator i = iconQueue.begin() + 1; i != iconQueue.end(); ++i) {
         clearCoinImage(i->destination);
     }
 
@@ -3674,7 +3742,9 @@ void ViewProviderSketch::drawMergedConstraintIcons(IconQueue iconQueue)
     }
 
     edit->combinedConstrBoxes[idString] = boundingBoxes;
-    thisInfo->string.setValue(idString.toLatin1().data());
+    SbString ids(idString.toLatin1().data());
+    if (thisInfo->string.getValue() != ids)
+        thisInfo->string.setValue(ids);
     sendConstraintIconToCoin(compositeIcon, thisDest);
 }
 
@@ -3688,6 +3758,63 @@ QImage ViewProviderSketch::renderConstrIcon(const QString &type,
                                             double iconRotation,
                                             std::vector<QRect> *boundingBoxes,
                                             int *vPad)
+{
+    // Rendering the SVG and the labels is expensive, so the icons are cached
+    QString key = constrIconKey(type, iconColor, labels, labelColors, iconRotation);
+    std::map<QString, EditData::RenderedConstrIcon>::const_iterator cached = edit->ConstrIconCache.find(key);
+    if (cached != edit->ConstrIconCache.end()) {
+        if(boundingBoxes)
+            boundingBoxes->insert(boundingBoxes->end(), cached->second.boundingBoxes.begin(),
+                                  cached->second.boundingBoxes.end());
+        if(vPad)
+            *vPad = cached->second.vPad;
+        return cached->second.image;
+    }
+
+    EditData::RenderedConstrIcon rendered;
+    rendered.image = renderConstrIconImage(type, iconColor, labels, labelColors, iconRotation,
+                                           &rendered.boundingBoxes, &rendered.vPad);
+
+    // The labels contain the constraint numbers, so the cache keeps growing while
+    // constraints are added. It is simply started again if it gets too big.
+    if (edit->ConstrIconCache.size() >= 1000)
+        edit->ConstrIconCache.clear();
+    edit->ConstrIconCache[key] = rendered;
+
+    if(boundingBoxes)
+        boundingBoxes->insert(boundingBoxes->end(), rendered.boundingBoxes.begin(),
+                              rendered.boundingBoxes.end());
+    if(vPad)
+        *vPad = rendered.vPad;
+    return rendered.image;
+}
+
+QString ViewProviderSketch::constrIconKey(const QString &type,
+                                          const QColor &iconColor,
+                                          const QStringList &labels,
+                                          const QList<QColor> &labelColors,
+                                          double iconRotation) const
+{
+    QString key = type;
+    QLatin1Char sep('\n');
+    key += sep + iconColor.name(QColor::HexArgb);
+    key += sep + QString::number(iconRotation);
+    key += sep + QString::number(edit->constraintIconSize);
+    key += sep + QString::number(labels.size());
+    for (int i = 0; i < labels.size(); i++)
+        key += sep + labels[i];
+    for (int i = 0; i < labelColors.size(); i++)
+        key += sep + labelColors[i].name(QColor::HexArgb);
+    return key;
+}
+
+QImage ViewProviderSketch::renderConstrIconImage(const QString &type,
+                                                 const QColor &iconColor,
+                                                 const QStringList &labels,
+                                                 const QList<QColor> &labelColors,
+                                                 double iconRotation,
+                                                 std::vector<QRect> *boundingBoxes,
+                                                 int *vPad)
 {
     // Constants to help create constraint icons
     QString joinStr = QString::fromLatin1(", ");
@@ -3775,7 +3902,9 @@ void ViewProviderSketch::drawTypicalConstraintIcon(const constrIconQueueItem &i)
                                     QList<QColor>() << color,
                                     i.iconRotation);
 
-    i.infoPtr->string.setValue(QString::number(i.constraintId).toLatin1().data());
+    SbString id(QString::number(i.constraintId).toLatin1().data());
+    if (i.infoPtr->string.getValue() != id)
+        i.infoPtr->string.setValue(id);
     sendConstraintIconToCoin(image, i.destination);
 }
 
@@ -3885,6 +4014,8 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
 {
     assert(edit);
 
+    Base::TimeInfo start_time;
+
     // Render Geometry ===================================================
     std::vector<Base::Vector3d> Coords;
     std::vector<Base::Vector3d> Points;
@@ -3937,9 +4068,42 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
     // RootPoint
     Points.emplace_back(0.,0.,0.);
 
+    // While dragging with incremental solving only the geometries moved by the solver
+    // need to be tessellated again, the others are taken from the previous draw.
+    const Sketcher::Sketch &solvedSketch = getSolvedSketch();
+    bool useDragCache = temp && solvedSketch.getIncrementalMove();
+    if (!useDragCache || edit->DragCacheMoveId != solvedSketch.getMoveId()) {
+        edit->DragCache.clear();
+        edit->DragCacheMoveId = useDragCache ? solvedSketch.getMoveId() : 0;
+    }
+    if (useDragCache)
+        edit->DragCache.resize(geomlist->size() - 2);
+
     for (std::vector<Part::Geometry *>::const_iterator it = geomlist->begin(); it != geomlist->end()-2; ++it, GeoId++) {
         if (GeoId >= intGeoCount)
             GeoId = -extGeoCount;
+
+        std::size_t coordsBegin = Coords.size();
+        std::size_t indexBegin = Index.size();
+        std::size_t pointsBegin = Points.size();
+        EditData::GeoTessellation *cache = nullptr;
+        if (useDragCache) {
+            // B-splines and their control points also build the information layer
+            auto gf = GeometryFacade::getFacade(*it);
+            if ((*it)->getTypeId() != Part::GeomBSplineCurve::getClassTypeId() &&
+                gf->getInternalType() != InternalType::BSplineControlPoint)
+                cache = &edit->DragCache[it - geomlist->begin()];
+        }
+
+        if (cache && cache->valid && !solvedSketch.isMovedGeometry(GeoId)) {
+            Coords.insert(Coords.end(), cache->Coords.begin(), cache->Coords.end());
+            Index.insert(Index.end(), cache->Index.begin(), cache->Index.end());
+            Points.insert(Points.end(), cache->Points.begin(), cache->Points.end());
+            edit->CurvIdToGeoId.insert(edit->CurvIdToGeoId.end(), cache->Index.size(), GeoId);
+            edit->PointIdToGeoId.insert(edit->PointIdToGeoId.end(), cache->Points.size(), GeoId);
+            continue;
+        }
+
         if ((*it)->getTypeId() == Part::GeomPoint::getClassTypeId()) { // add a point
             const Part::GeomPoint *point = static_cast<const Part::GeomPoint *>(*it);
             Points.push_back(point->getPoint());
@@ -4335,6 +4499,13 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
             if (temprepscale > combrepscale)
                 combrepscale = temprepscale;
         }
+
+        if (cache) {
+            cache->Coords.assign(Coords.begin() + coordsBegin, Coords.end());
+            cache->Index.assign(Index.begin() + indexBegin, Index.end());
+            cache->Points.assign(Points.begin() + pointsBegin, Points.end());
+            cache->valid = true;
+        }
     }
 
     if ( (combrepscale > (2 * combrepscalehyst)) || (combrepscale < (combrepscalehyst/2)))
@@ -4797,15 +4968,12 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
 
     visibleInformationChanged=false; // whatever that changed in Information layer is already updated
 
-    edit->CurvesCoordinate->point.setNum(Coords.size());
-    edit->CurveSet->numVertices.setNum(Index.size());
     edit->CurvesMaterials->diffuseColor.setNum(Index.size());
-    edit->PointsCoordinate->point.setNum(Points.size());
     edit->PointsMaterials->diffuseColor.setNum(Points.size());
 
-    SbVec3f *verts = edit->CurvesCoordinate->point.startEditing();
-    int32_t *index = edit->CurveSet->numVertices.startEditing();
-    SbVec3f *pverts = edit->PointsCoordinate->point.startEditing();
+    std::vector<SbVec3f> verts(Coords.size());
+    std::vector<int32_t> index(Index.size());
+    std::vector<SbVec3f> pverts(Points.size());
 
     float dMg = 100;
 
@@ -4827,9 +4995,10 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
         pverts[i].setValue(it->x,it->y,zLowPoints);
     }
 
-    edit->CurvesCoordinate->point.finishEditing();
-    edit->CurveSet->numVertices.finishEditing();
-    edit->PointsCoordinate->point.finishEditing();
+    // only the changed vertices are passed to Coin, e.g. those of the dragged geometries
+    updateFieldValues(edit->CurvesCoordinate->point, verts);
+    updateFieldValues(edit->CurveSet->numVertices, index);
+    updateFieldValues(edit->PointsCoordinate->point, pverts);
 
     // set cross coordinates
     edit->RootCrossSet->numVertices.set1Value(0,2);
@@ -4857,6 +5026,8 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
     edit->RootCrossCoordinate->point.set1Value(2,SbVec3f(0.0f, -dMagF, zCross));
     edit->RootCrossCoordinate->point.set1Value(3,SbVec3f(0.0f, dMagF, zCross));
 
+    Base::TimeInfo geometry_time;
+
     // Render Constraints ===================================================
     const std::vector<Sketcher::Constraint *> &constrlist = getSketchObject()->Constraints.getValues();
     // After an undo/redo it can happen that we have an empty geometry list but a non-empty constraint list
@@ -5879,9 +6050,23 @@ Restart:
 
     }
 
+    Base::TimeInfo constraints_time;
+
     this->drawConstraintIcons();
     this->updateColor();
 
+    Base::TimeInfo end_time;
+    edit->DrawTime = Base::TimeInfo::diffTimeF(start_time,end_time);
+
+    GCS::DebugMode debugMode = getSolvedSketch().getDebugMode();
+    if (debugMode==GCS::Minimal || debugMode==GCS::IterationLevel) {
+        Base::Console().Log("Sketcher::draw()-T:%s (geometry %s, constraints %s, icons %s)\n",
+                            Base::TimeInfo::diffTime(start_time,end_time).c_str(),
+                            Base::TimeInfo::diffTime(start_time,geometry_time).c_str(),
+                            Base::TimeInfo::diffTime(geometry_time,constraints_time).c_str(),
+                            Base::TimeInfo::diffTime(constraints_time,end_time).c_str());
+    }
+
     // delete the cloned objects
     if (temp) {
         for (std::vector<Part::Geometry *>::iterator it=tempGeo.begin(); it != tempGeo.end(); ++it) {
@@ -6419,6 +6604,9 @@ bool ViewProviderSketch::setEdit(int ModNum)
 
     getSketchObject()->setRecalculateInitialSolutionWhileMovingPoint(hGrp2->GetBool("RecalculateInitialSolutionWhileDragging",true));
 
+    // Only solve and redraw the parts of the sketch affected by dragging.
+    getSketchObject()->setIncrementalMove(hGrp2->GetBool("IncrementalDragSolving",true));
+
     // intercept del key press from main app
     listener = new ShortcutListener(this);
 
@@ -396,6 +396,22 @@ protected:
                             //! that the text extends below the icon base.
                             int *vPad = NULL);
 
+    /// Renders the icon for renderConstrIcon if it isn't cached yet
+    QImage renderConstrIconImage(const QString &type,
+                                 const QColor &iconColor,
+                                 const QStringList &labels,
+                                 const QList<QColor> &labelColors,
+                                 double iconRotation,
+                                 std::vector<QRect> *boundingBoxes,
+                                 int *vPad);
+
+    /// The key of a rendered icon in the icon cache
+    QString constrIconKey(const QString &type,
+                          const QColor &iconColor,
+                          const QStringList &labels,
+                          const QList<QColor> &labelColors,
+                          double iconRotation) const;
+
     /// Copies a QImage constraint icon into a SoImage*
     /*! Used by drawTypicalConstraintIcon() and drawMergedConstraintIcons() */
     void sendConstraintIconToCoin(const QImage &icon, SoImage *soImagePtr);